@@ -0,0 +1,148 @@
+//
+// Copyright (C) 2020 Codership Oy
+//
+
+#ifndef GALERA_CAUSAL_COALESCER_HPP
+#define GALERA_CAUSAL_COALESCER_HPP
+
+#include "wsrep_api.h"
+
+#include <gu_lock.hpp>
+#include <gu_atomic.hpp>
+#include <gu_datetime.hpp>
+#include <gu_throw.hpp>
+
+#include <cerrno>
+
+namespace galera
+{
+    /* Concurrent causal reads share gcs_caused() round trips: a read waits
+     * for the first round trip which is started after the read was issued,
+     * so the seqno it gets is never older than the one from its own round
+     * trip would be. Reads issued while a round trip is in flight all wait
+     * for the next one, which is started by one of them as soon as the
+     * current one finishes.
+     *
+     * Round trip times out at the deadline of the read which started it.
+     * Reads with later deadlines don't fail with it, but wait for the next
+     * round trip. Other errors are returned to all reads waiting for the
+     * round trip. */
+    class CausalCoalescer
+    {
+    public:
+
+        CausalCoalescer()
+            :
+            mutex_      (),
+            cond_       (),
+            started_    (0),
+            done_       (0),
+            in_flight_  (false),
+            seqno_      (WSREP_SEQNO_UNDEFINED),
+            err_        (0),
+            round_trips_()
+        { }
+
+        long long round_trips() const { return round_trips_(); }
+
+        // Returns causal seqno in seqno, throws gu::Exception on error.
+        // Round trip C must provide
+        //   void operator()(wsrep_seqno_t&, gu::datetime::Date& wait_until);
+        // which throws gu::Exception on error.
+        template <class C>
+        void seqno(wsrep_seqno_t&      seqno,
+                   gu::datetime::Date& wait_until,
+                   C&                  caused)
+        {
+            gu::Lock lock(mutex_);
+
+            long long round(started_ + 1);
+
+            while (true)
+            {
+                while (done_ < round)
+                {
+                    if (!in_flight_)
+                    {
+                        assert(started_ + 1 == round);
+                        round_trip(round, wait_until, caused);
+                        break;
+                    }
+
+                    lock.wait(cond_, wait_until);
+                }
+
+                if (0 == err_)
+                {
+                    seqno = seqno_;
+                    return;
+                }
+
+                if (ETIMEDOUT != err_ ||
+                    !(gu::datetime::Date::calendar() < wait_until))
+                {
+                    gu_throw_error(err_);
+                }
+
+                // timed out at the deadline of another read, all round trips
+                // started from now on are still after this read was issued
+                round = done_ + 1;
+            }
+        }
+
+    private:
+
+        CausalCoalescer(const CausalCoalescer&);
+        void operator=(const CausalCoalescer&);
+
+        // must be called with mutex_ locked
+        template <class C>
+        void round_trip(long long const     round,
+                        gu::datetime::Date& wait_until,
+                        C&                  caused)
+        {
+            started_   = round;
+            in_flight_ = true;
+
+            mutex_.unlock();
+
+            wsrep_seqno_t seqno(WSREP_SEQNO_UNDEFINED);
+            int           err(0);
+
+            try
+            {
+                caused(seqno, wait_until);
+                assert(seqno >= 0);
+            }
+            catch (gu::Exception& e)
+            {
+                err = e.get_errno();
+            }
+
+            ++round_trips_;
+
+            mutex_.lock();
+
+            assert(in_flight_);
+            assert(started_ == round);
+
+            in_flight_ = false;
+            done_      = round;
+            seqno_     = seqno;
+            err_       = err;
+
+            cond_.broadcast();
+        }
+
+        gu::Mutex             mutex_;
+        gu::Cond              cond_;
+        long long             started_;   // last started round trip
+        long long             done_;      // last finished round trip
+        bool                  in_flight_;
+        wsrep_seqno_t         seqno_;     // result of done_
+        int                   err_;       // error of done_
+        gu::Atomic<long long> round_trips_;
+    };
+}
+
+#endif // GALERA_CAUSAL_COALESCER_HPP
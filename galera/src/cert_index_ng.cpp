@@ -0,0 +1,104 @@
+//
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+//
+
+#include "cert_index_ng.hpp"
+
+#include "gu_utils.hpp" // gu::DeleteObject
+#include "gu_lock.hpp"
+
+#include <algorithm>
+
+galera::CertIndexNG::CertIndexNG(size_t const n_shards,
+                                 long   const parallel_keys)
+    :
+    shards_       (),
+    pool_         (n_shards > 1 ? n_shards - 1 : 0),
+    parallel_keys_(parallel_keys)
+{
+    assert(n_shards > 0);
+    assert(n_shards <= SHARDS_MAX);
+
+    shards_.reserve(n_shards);
+
+    for (size_t i(0); i < std::max<size_t>(n_shards, 1); ++i)
+    {
+        shards_.push_back(new Shard());
+    }
+}
+
+galera::CertIndexNG::~CertIndexNG()
+{
+    for (size_t i(0); i < shards_.size(); ++i)
+    {
+        delete shards_[i];
+    }
+}
+
+size_t
+galera::CertIndexNG::size()
+{
+    size_t ret(0);
+
+    for (size_t i(0); i < shards_.size(); ++i)
+    {
+        gu::Lock lock(shards_[i]->mutex());
+        ret += shards_[i]->set().size();
+    }
+
+    return ret;
+}
+
+void
+galera::CertIndexNG::clear()
+{
+    for (size_t i(0); i < shards_.size(); ++i)
+    {
+        Set& set(shards_[i]->set());
+        std::for_each(set.begin(), set.end(), gu::DeleteObject());
+        set.clear();
+    }
+}
+
+galera::CertIndexNG::Lock::Lock(CertIndexNG& index, const KeySetIn& keys)
+    :
+    index_ (index),
+    locked_()
+{
+    if (index_.shards_.size() > 1)
+    {
+        keys.rewind();
+        for (long i(0); i < keys.count(); ++i)
+        {
+            locked_.set(index_.shard_idx(keys.next()));
+        }
+    }
+    else
+    {
+        locked_.set(0);
+    }
+
+    /* always lock in the same order to avoid deadlocks */
+    for (size_t i(0); i < index_.shards_.size(); ++i)
+    {
+        if (!locked_.test(i)) continue;
+
+        int const err(index_.shards_[i]->mutex().lock());
+        if (gu_unlikely(err != 0))
+        {
+            while (i > 0)
+            {
+                if (locked_.test(--i)) index_.shards_[i]->mutex().unlock();
+            }
+            gu_throw_error(err) << "Failed to lock cert index shard";
+        }
+    }
+}
+
+galera::CertIndexNG::Lock::~Lock()
+{
+    for (size_t i(index_.shards_.size()); i > 0; --i)
+    {
+        if (locked_.test(i - 1)) index_.shards_[i - 1]->mutex().unlock();
+    }
+}
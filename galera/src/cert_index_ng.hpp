@@ -0,0 +1,126 @@
+//
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+//
+
+#ifndef GALERA_CERT_INDEX_NG_HPP
+#define GALERA_CERT_INDEX_NG_HPP
+
+#include "key_entry_ng.hpp"
+
+#include "gu_flat_set.hpp"
+#include "gu_mutex.hpp"
+#include "gu_thread_pool.hpp"
+
+#include <bitset>
+#include <vector>
+
+namespace galera
+{
+    /*
+     * Certification index for KeyEntryNG split into hash-partitioned shards.
+     *
+     * Every shard is a separate hash set protected by its own mutex, so keys
+     * which belong to different shards can be looked up and modified
+     * concurrently. The index also owns a pool of (shards - 1) worker
+     * threads which certification uses to process key sets of at least
+     * parallel_keys keys one shard per thread, the calling thread taking the
+     * remaining shard.
+     */
+    class CertIndexNG
+    {
+    public:
+
+        /* Key hashes are stored inline with entry pointers, so that most
+         * lookups don't need to touch either the entry or the key bytes */
+        typedef gu::FlatPtrSet<KeyEntryNG,
+                               KeyEntryPtrHashNG, KeyEntryPtrEqualNG> Set;
+
+        class Shard
+        {
+        public:
+
+            Shard() : mtx_(), set_() { }
+
+            gu::Mutex& mutex() { return mtx_; }
+            Set&       set()   { return set_; }
+
+        private:
+
+            Shard(const Shard&);
+            Shard& operator=(const Shard&);
+
+            gu::Mutex mtx_;
+            Set       set_;
+        };
+
+        /* Upper limit on the number of shards (and worker threads) */
+        static size_t const SHARDS_MAX = 256;
+
+        /* Locks the shards which keys of a key set belong to for the
+         * lifetime of the object */
+        class Lock
+        {
+        public:
+
+            Lock(CertIndexNG& index, const KeySetIn& keys);
+            ~Lock();
+
+        private:
+
+            Lock(const Lock&);
+            Lock& operator=(const Lock&);
+
+            CertIndexNG&            index_;
+            std::bitset<SHARDS_MAX> locked_;
+        };
+
+        CertIndexNG(size_t n_shards, long parallel_keys);
+        ~CertIndexNG();
+
+        size_t shards() const { return shards_.size(); }
+
+        size_t shard_idx(const KeySet::KeyPart& kp) const
+        {
+            /* Slots within a shard are selected by a multiplicative hash
+             * of the whole key hash, so some of its bits can be used here */
+            return (shards_.size() > 1 ? (kp.hash() >> 16) % shards_.size() :
+                    0);
+        }
+
+        Shard& shard(size_t const idx) { return *shards_[idx]; }
+
+        Shard& shard(const KeySet::KeyPart& kp)
+        {
+            return *shards_[shard_idx(kp)];
+        }
+
+        /* True if key set of key_count keys should be certified in
+         * parallel */
+        bool parallel(long const key_count) const
+        {
+            return (pool_.size() > 0 && key_count >= parallel_keys_);
+        }
+
+        gu::ThreadPool& pool() { return pool_; }
+
+        /* Total number of entries in the index. Locks shards one by one, so
+         * must not be called while holding Lock. */
+        size_t size();
+
+        bool empty() { return (size() == 0); }
+
+        /* Delete all entries and clear the index */
+        void clear();
+
+    private:
+
+        CertIndexNG(const CertIndexNG&);
+        CertIndexNG& operator=(const CertIndexNG&);
+
+        std::vector<Shard*> shards_;
+        gu::ThreadPool      pool_;
+        long          const parallel_keys_;
+    };
+}
+
+#endif // GALERA_CERT_INDEX_NG_HPP
@@ -7,8 +7,10 @@
 
 #include "gu_lock.hpp"
 #include "gu_throw.hpp"
+#include "gu_datetime.hpp"
 
 #include <map>
+#include <sstream>
 #include <algorithm> // std::for_each
 
 using namespace galera;
@@ -30,9 +32,18 @@ static std::string const CERT_PARAM_MAX_LENGTH   (CERT_PARAM_PREFIX +
                                                   "max_length");
 static std::string const CERT_PARAM_LENGTH_CHECK (CERT_PARAM_PREFIX +
                                                   "length_check");
+static std::string const CERT_PARAM_INDEX_SHARDS (CERT_PARAM_PREFIX +
+                                                  "index_shards");
+static std::string const CERT_PARAM_PURGE_BATCH  (CERT_PARAM_PREFIX +
+                                                  "purge_batch");
+static std::string const CERT_PARAM_PARALLEL_KEYS(CERT_PARAM_PREFIX +
+                                                  "parallel_keys");
 
 static std::string const CERT_PARAM_LOG_CONFLICTS_DEFAULT("no");
 static std::string const CERT_PARAM_OPTIMISTIC_PA_DEFAULT("yes");
+static std::string const CERT_PARAM_INDEX_SHARDS_DEFAULT ("1");
+static std::string const CERT_PARAM_PURGE_BATCH_DEFAULT  ("256");
+static std::string const CERT_PARAM_PARALLEL_KEYS_DEFAULT("128");
 
 /*** It is EXTREMELY important that these constants are the same on all nodes.
  *** Don't change them ever!!! ***/
@@ -44,6 +55,9 @@ galera::Certification::register_params(gu::Config& cnf)
 {
     cnf.add(CERT_PARAM_LOG_CONFLICTS, CERT_PARAM_LOG_CONFLICTS_DEFAULT);
     cnf.add(CERT_PARAM_OPTIMISTIC_PA, CERT_PARAM_OPTIMISTIC_PA_DEFAULT);
+    cnf.add(CERT_PARAM_INDEX_SHARDS,  CERT_PARAM_INDEX_SHARDS_DEFAULT);
+    cnf.add(CERT_PARAM_PURGE_BATCH,   CERT_PARAM_PURGE_BATCH_DEFAULT);
+    cnf.add(CERT_PARAM_PARALLEL_KEYS, CERT_PARAM_PARALLEL_KEYS_DEFAULT);
     /* The defaults below are deliberately not reflected in conf: people
      * should not know about these dangerous setting unless they read RTFM. */
     cnf.add(CERT_PARAM_MAX_LENGTH);
@@ -70,6 +84,52 @@ length_check(const gu::Config& conf)
         return gu::Config::from_config<int>(CERT_PARAM_LENGTH_CHECK_DEFAULT);
 }
 
+static size_t
+index_shards(const gu::Config& conf)
+{
+    int const ret(conf.get<int>(CERT_PARAM_INDEX_SHARDS));
+
+    if (ret < 1 || size_t(ret) > galera::CertIndexNG::SHARDS_MAX)
+    {
+        gu_throw_error(EINVAL) << "Bad value " << ret << " for '"
+                               << CERT_PARAM_INDEX_SHARDS
+                               << "': must be between 1 and "
+                               << galera::CertIndexNG::SHARDS_MAX;
+    }
+
+    return ret;
+}
+
+static long
+parallel_keys(const gu::Config& conf)
+{
+    long const ret(conf.get<long>(CERT_PARAM_PARALLEL_KEYS));
+
+    if (ret < 1)
+    {
+        gu_throw_error(EINVAL) << "Bad value " << ret << " for '"
+                               << CERT_PARAM_PARALLEL_KEYS
+                               << "': must be positive";
+    }
+
+    return ret;
+}
+
+static size_t
+purge_batch_size(const gu::Config& conf)
+{
+    int const ret(conf.get<int>(CERT_PARAM_PURGE_BATCH));
+
+    if (ret < 0)
+    {
+        gu_throw_error(EINVAL) << "Bad value " << ret << " for '"
+                               << CERT_PARAM_PURGE_BATCH
+                               << "': must be non-negative";
+    }
+
+    return ret;
+}
+
 void
 galera::Certification::purge_for_trx_v1to2(TrxHandle* trx)
 {
@@ -112,6 +172,40 @@ galera::Certification::purge_for_trx_v1to2(TrxHandle* trx)
     }
 }
 
+/* Unrefs key entry referenced by trx and removes it from index if it is no
+ * longer referenced. Shard containing the key must be locked. */
+static void
+purge_key_v3(galera::CertIndexNG::Set&      index,
+             const galera::KeySet::KeyPart& kp,
+             galera::TrxHandle*       const trx)
+{
+    galera::KeyEntryNG ke(kp);
+    galera::CertIndexNG::Set::iterator const ci(index.find(&ke));
+
+//    assert(ci != index.end());
+    if (gu_unlikely(index.end() == ci))
+    {
+        log_warn << "Missing key";
+        return;
+    }
+
+    galera::KeyEntryNG* const kep(*ci);
+    assert(kep->referenced());
+
+    wsrep_key_type_t const p(kp.wsrep_type(trx->version()));
+
+    if (kep->ref_trx(p) == trx)
+    {
+        kep->unref(p, trx);
+
+        if (kep->referenced() == false)
+        {
+            index.erase(ci);
+            delete kep;
+        }
+    }
+}
+
 void
 galera::Certification::purge_for_trx_v3(TrxHandle* trx)
 {
@@ -123,31 +217,10 @@ galera::Certification::purge_for_trx_v3(TrxHandle* trx)
     {
         const KeySet::KeyPart& kp(keys.next());
 
-        KeyEntryNG ke(kp);
-        CertIndexNG::iterator const ci(cert_index_ng_.find(&ke));
-
-//        assert(ci != cert_index_ng_.end());
-        if (gu_unlikely(cert_index_ng_.end() == ci))
-        {
-            log_warn << "Missing key";
-            continue;
-        }
-
-        KeyEntryNG* const kep(*ci);
-        assert(kep->referenced());
-
-        wsrep_key_type_t const p(kp.wsrep_type(trx->version()));
+        CertIndexNG::Shard& shard(cert_index_ng_.shard(kp));
+        gu::Lock            shard_lock(shard.mutex());
 
-        if (kep->ref_trx(p) == trx)
-        {
-            kep->unref(p, trx);
-
-            if (kep->referenced() == false)
-            {
-                cert_index_ng_.erase(ci);
-                delete kep;
-            }
-        }
+        purge_key_v3(shard.set(), kp, trx);
     }
 }
 
@@ -485,6 +558,7 @@ check_against(const galera::KeyEntryNG*   const found,
               const galera::KeySet::KeyPart&    key,
               wsrep_key_type_t            const key_type,
               galera::TrxHandle*          const trx,
+              wsrep_seqno_t               const index_cut,
               bool                        const log_conflict,
               wsrep_seqno_t&                    depends_seqno)
 {
@@ -495,7 +569,9 @@ check_against(const galera::KeyEntryNG*   const found,
 
     bool conflict(false);
 
-    if (gu_likely(0 != ref_trx))
+    // references at or below index cut belong to trxs which still wait for
+    // background purge, they are treated as purged already
+    if (gu_likely(0 != ref_trx) && ref_trx->global_seqno() > index_cut)
     {
         if (REF_KEY_TYPE == WSREP_KEY_EXCLUSIVE && ref_trx)
         {
@@ -549,9 +625,11 @@ static inline bool
 certify_and_depend_v3to4(const galera::KeyEntryNG*   const found,
                          const galera::KeySet::KeyPart&    key,
                          galera::TrxHandle*          const trx,
-                         bool                        const log_conflict)
+                         wsrep_seqno_t               const index_cut,
+                         bool                        const log_conflict,
+                         wsrep_seqno_t&                    depends)
 {
-    wsrep_seqno_t depends_seqno(trx->depends_seqno());
+    wsrep_seqno_t depends_seqno(depends);
     wsrep_key_type_t const key_type(key.wsrep_type(trx->version()));
 
     /*
@@ -570,34 +648,35 @@ certify_and_depend_v3to4(const galera::KeyEntryNG*   const found,
      * step.
      */
     if (check_against<WSREP_KEY_EXCLUSIVE>
-        (found, key, key_type, trx, log_conflict, depends_seqno) ||
+        (found, key, key_type, trx, index_cut, log_conflict, depends_seqno) ||
         (key_type == WSREP_KEY_EXCLUSIVE &&
          /* exclusive keys must be checked against shared */
          (check_against<WSREP_KEY_SEMI>
-          (found, key, key_type, trx, log_conflict, depends_seqno) ||
+          (found, key, key_type, trx, index_cut, log_conflict, depends_seqno) ||
           check_against<WSREP_KEY_SHARED>
-          (found, key, key_type, trx, log_conflict, depends_seqno))))
+          (found, key, key_type, trx, index_cut, log_conflict, depends_seqno))))
     {
         return true;
     }
     else
     {
-        if (depends_seqno > trx->depends_seqno())
-            trx->set_depends_seqno(depends_seqno);
+        if (depends_seqno > depends) depends = depends_seqno;
         return false;
     }
 }
 
 /* returns true on collision, false otherwise */
 static bool
-certify_v3to4(galera::Certification::CertIndexNG& cert_index_ng,
-              const galera::KeySet::KeyPart&      key,
-              galera::TrxHandle*                  trx,
-              bool const                          store_keys,
-              bool const                          log_conflicts)
+certify_v3to4(galera::CertIndexNG::Set&      cert_index_ng,
+              const galera::KeySet::KeyPart& key,
+              galera::TrxHandle*             trx,
+              wsrep_seqno_t const            index_cut,
+              bool const                     store_keys,
+              bool const                     log_conflicts,
+              wsrep_seqno_t&                 depends_seqno)
 {
     galera::KeyEntryNG ke(key);
-    galera::Certification::CertIndexNG::iterator ci(cert_index_ng.find(&ke));
+    galera::CertIndexNG::Set::iterator ci(cert_index_ng.find(&ke));
 
     if (cert_index_ng.end() == ci)
     {
@@ -618,15 +697,110 @@ certify_v3to4(galera::Certification::CertIndexNG& cert_index_ng,
         // Note: For we skip certification for isolated trxs, only
         // cert index and key_list is populated.
         return (!trx->is_toi() &&
-                certify_and_depend_v3to4(kep, key, trx, log_conflicts));
+                certify_and_depend_v3to4(kep, key, trx, index_cut,
+                                         log_conflicts, depends_seqno));
     }
 }
 
+/* references key entry by trx after successful certification,
+ * returns false if the entry is missing from the index */
+static inline bool
+ref_v3to4(galera::CertIndexNG::Set&      cert_index_ng,
+          const galera::KeySet::KeyPart& key,
+          galera::TrxHandle*             trx)
+{
+    galera::KeyEntryNG ke(key);
+    galera::CertIndexNG::Set::const_iterator ci(cert_index_ng.find(&ke));
+
+    if (gu_unlikely(ci == cert_index_ng.end())) return false;
+
+    galera::KeyEntryNG* const kep(*ci);
+
+    kep->ref(key.wsrep_type(trx->version()), key, trx);
+
+    return true;
+}
+
+/* removes key entry added by trx which failed certification */
+static inline void
+cleanup_v3to4(galera::CertIndexNG::Set&      cert_index_ng,
+              const galera::KeySet::KeyPart& key,
+              galera::TrxHandle*             trx)
+{
+    galera::KeyEntryNG ke(key);
+
+    // Clean up cert_index_ from entries which were added by this trx
+    galera::CertIndexNG::Set::iterator ci(cert_index_ng.find(&ke));
+
+    if (gu_likely(ci != cert_index_ng.end()))
+    {
+        galera::KeyEntryNG* kep(*ci);
+
+        if (kep->referenced() == false)
+        {
+            // kel was added to cert_index_ by this trx -
+            // remove from cert_index_ and fall through to delete
+            cert_index_ng.erase(ci);
+        }
+        else return;
+
+        assert(kep->referenced() == false);
+
+        delete kep;
+
+    }
+    else if(ke.key().wsrep_type(trx->version()) == WSREP_KEY_SHARED)
+    {
+        assert(0); // we actually should never be here, the key should
+                   // be either added to cert_index_ or be there already
+        log_warn  << "could not find shared key '"
+                  << ke.key() << "' from cert index";
+    }
+    else { /* non-shared keys can duplicate shared in the key set */ }
+}
+
 galera::Certification::TestResult
 galera::Certification::do_test_v3to4(TrxHandle* trx, bool store_keys)
 {
     cert_debug << "BEGIN CERTIFICATION v" << trx->version() << ": " << *trx;
 
+    long const key_count(trx->write_set_in().keyset().count());
+
+    TestResult res;
+    {
+        CertIndexNG::Lock index_lock(cert_index_ng_,
+                                     trx->write_set_in().keyset());
+
+        res = (cert_index_ng_.parallel(key_count) ?
+               do_test_v3to4_parallel(trx, store_keys) :
+               do_test_v3to4_serial(trx, store_keys));
+    }
+
+    if (TEST_OK == res)
+    {
+        trx->set_depends_seqno(std::max(trx->depends_seqno(),
+                                        last_pa_unsafe_));
+
+        if (store_keys == true)
+        {
+            if (trx->pa_unsafe()) last_pa_unsafe_ = trx->global_seqno();
+
+            key_count_ += key_count;
+        }
+
+        cert_debug << "END CERTIFICATION (success): " << *trx;
+    }
+    else
+    {
+        cert_debug << "END CERTIFICATION (failed): " << *trx;
+    }
+
+    return res;
+}
+
+galera::Certification::TestResult
+galera::Certification::do_test_v3to4_serial(TrxHandle* trx, bool store_keys)
+{
 #ifndef NDEBUG
     // to check that cleanup after cert failure returns cert_index_
     // to original size
@@ -636,7 +810,7 @@ galera::Certification::do_test_v3to4(TrxHandle* trx, bool store_keys)
     const KeySetIn& key_set(trx->write_set_in().keyset());
     long const      key_count(key_set.count());
     long            processed(0);
-
+    wsrep_seqno_t   depends_seqno(trx->depends_seqno());
 
     key_set.rewind();
 
@@ -644,13 +818,15 @@ galera::Certification::do_test_v3to4(TrxHandle* trx, bool store_keys)
     {
         const KeySet::KeyPart& key(key_set.next());
 
-        if (certify_v3to4(cert_index_ng_, key, trx, store_keys, log_conflicts_))
+        if (certify_v3to4(cert_index_ng_.shard(key).set(), key, trx,
+                          index_cut_, store_keys, log_conflicts_,
+                          depends_seqno))
         {
             goto cert_fail;
         }
     }
 
-    trx->set_depends_seqno(std::max(trx->depends_seqno(), last_pa_unsafe_));
+    trx->set_depends_seqno(depends_seqno);
 
     if (store_keys == true)
     {
@@ -660,32 +836,19 @@ galera::Certification::do_test_v3to4(TrxHandle* trx, bool store_keys)
         for (long i(0); i < key_count; ++i)
         {
             const KeySet::KeyPart& k(key_set.next());
-            KeyEntryNG ke(k);
-            CertIndexNG::const_iterator ci(cert_index_ng_.find(&ke));
 
-            if (ci == cert_index_ng_.end())
+            if (!ref_v3to4(cert_index_ng_.shard(k).set(), k, trx))
             {
                 gu_throw_fatal << "could not find key '" << k
                                << "' from cert index";
             }
-
-            KeyEntryNG* const kep(*ci);
-
-            kep->ref(k.wsrep_type(trx->version()), k, trx);
-
         }
-
-        if (trx->pa_unsafe()) last_pa_unsafe_ = trx->global_seqno();
-
-        key_count_ += key_count;
     }
-    cert_debug << "END CERTIFICATION (success): " << *trx;
+
     return TEST_OK;
 
 cert_fail:
 
-    cert_debug << "END CERTIFICATION (failed): " << *trx;
-
     assert (processed < key_count);
 
     if (store_keys == true)
@@ -697,41 +860,238 @@ cert_fail:
          * processed key failed cert and was not added to index */
         for (long i(0); i < processed; ++i)
         {
-            KeyEntryNG ke(key_set.next());
+            const KeySet::KeyPart& k(key_set.next());
 
-            // Clean up cert_index_ from entries which were added by this trx
-            CertIndexNG::iterator ci(cert_index_ng_.find(&ke));
+            cleanup_v3to4(cert_index_ng_.shard(k).set(), k, trx);
+        }
+        assert(cert_index_.size() == prev_cert_index_size);
+    }
+
+    return TEST_FAILED;
+}
+
+namespace
+{
+    /* Processes the subset of trx keys which belongs to a single shard of
+     * the certification index. Keys are processed in the order they appear
+     * in the key set, so the result for every shard is the same as that of
+     * serial certification. */
+    class CertShardJob : public gu::ThreadPool::Job
+    {
+    public:
 
-            if (gu_likely(ci != cert_index_ng_.end()))
+        enum Op
+        {
+            OP_TEST,
+            OP_REF,
+            OP_CLEANUP
+        };
+
+        CertShardJob(galera::CertIndexNG::Set& index,
+                     galera::TrxHandle*  const trx,
+                     wsrep_seqno_t       const index_cut,
+                     bool                const store_keys,
+                     bool                const log_conflicts)
+            :
+            gu::ThreadPool::Job(),
+            index_        (index),
+            keys_         (),
+            trx_          (trx),
+            index_cut_    (index_cut),
+            depends_seqno_(trx->depends_seqno()),
+            processed_    (0),
+            op_           (OP_TEST),
+            store_keys_   (store_keys),
+            log_conflicts_(log_conflicts),
+            conflict_     (false),
+            error_        ()
+        { }
+
+        void add(const galera::KeySet::KeyPart& key) { keys_.push_back(key); }
+
+        bool empty() const { return keys_.empty(); }
+
+        void set_op(Op const op) { op_ = op; }
+
+        void run()
+        {
+            try
+            {
+                switch (op_)
+                {
+                case OP_TEST:    test();    break;
+                case OP_REF:     ref();     break;
+                case OP_CLEANUP: cleanup(); break;
+                }
+            }
+            catch (std::exception& e)
             {
-                KeyEntryNG* kep(*ci);
+                error_ = e.what();
+            }
+        }
+
+        bool               conflict()      const { return conflict_; }
+        wsrep_seqno_t      depends_seqno() const { return depends_seqno_; }
+        const std::string& error()         const { return error_; }
+
+    private:
 
-                if (kep->referenced() == false)
+        void test()
+        {
+            for (processed_ = 0; processed_ < keys_.size(); ++processed_)
+            {
+                if (certify_v3to4(index_, keys_[processed_], trx_,
+                                  index_cut_, store_keys_, log_conflicts_,
+                                  depends_seqno_))
                 {
-                    // kel was added to cert_index_ by this trx -
-                    // remove from cert_index_ and fall through to delete
-                    cert_index_ng_.erase(ci);
+                    conflict_ = true;
+                    break;
                 }
-                else continue;
+            }
+        }
 
-                assert(kep->referenced() == false);
+        void ref()
+        {
+            assert(processed_ == keys_.size());
 
-                delete kep;
+            for (size_t i(0); i < keys_.size(); ++i)
+            {
+                if (!ref_v3to4(index_, keys_[i], trx_))
+                {
+                    std::ostringstream os;
+                    os << "could not find key '" << keys_[i]
+                       << "' from cert index";
+                    error_ = os.str();
+                    break;
+                }
+            }
+        }
 
+        void cleanup()
+        {
+            /* failed key (if any) was not added to index, see
+             * do_test_v3to4_serial() */
+            for (size_t i(0); i < processed_; ++i)
+            {
+                cleanup_v3to4(index_, keys_[i], trx_);
             }
-            else if(ke.key().wsrep_type(trx->version()) == WSREP_KEY_SHARED)
+        }
+
+        galera::CertIndexNG::Set&            index_;
+        std::vector<galera::KeySet::KeyPart> keys_;
+        galera::TrxHandle*             const trx_;
+        wsrep_seqno_t                  const index_cut_;
+        wsrep_seqno_t                        depends_seqno_;
+        size_t                               processed_;
+        Op                                   op_;
+        bool                           const store_keys_;
+        bool                           const log_conflicts_;
+        bool                                 conflict_;
+        std::string                          error_;
+    };
+
+    class CertShardJobs
+    {
+    public:
+
+        CertShardJobs(gu::ThreadPool& pool) : pool_(pool), jobs_() { }
+
+        ~CertShardJobs()
+        {
+            std::for_each(jobs_.begin(), jobs_.end(), gu::DeleteObject());
+        }
+
+        void add(CertShardJob* job) { jobs_.push_back(job); }
+
+        CertShardJob& operator[](size_t const i) { return *jobs_[i]; }
+
+        size_t size() const { return jobs_.size(); }
+
+        /* runs operation on all shards: the first shard is processed by
+         * the calling thread, the rest are handed to the pool */
+        void run(CertShardJob::Op const op)
+        {
+            for (size_t i(1); i < jobs_.size(); ++i)
             {
-                assert(0); // we actually should never be here, the key should
-                           // be either added to cert_index_ or be there already
-                log_warn  << "could not find shared key '"
-                          << ke.key() << "' from cert index";
+                if (jobs_[i]->empty()) continue;
+                jobs_[i]->set_op(op);
+                pool_.submit(*jobs_[i]);
+            }
+
+            jobs_[0]->set_op(op);
+            jobs_[0]->run();
+
+            for (size_t i(1); i < jobs_.size(); ++i)
+            {
+                if (jobs_[i]->empty()) continue;
+                pool_.wait(*jobs_[i]);
+            }
+
+            for (size_t i(0); i < jobs_.size(); ++i)
+            {
+                if (gu_unlikely(!jobs_[i]->error().empty()))
+                {
+                    gu_throw_fatal << "parallel certification failed: "
+                                   << jobs_[i]->error();
+                }
             }
-            else { /* non-shared keys can duplicate shared in the key set */ }
         }
-        assert(cert_index_.size() == prev_cert_index_size);
+
+    private:
+
+        CertShardJobs(const CertShardJobs&);
+        CertShardJobs& operator=(const CertShardJobs&);
+
+        gu::ThreadPool&            pool_;
+        std::vector<CertShardJob*> jobs_;
+    };
+}
+
+galera::Certification::TestResult
+galera::Certification::do_test_v3to4_parallel(TrxHandle* trx, bool store_keys)
+{
+    const KeySetIn& key_set(trx->write_set_in().keyset());
+    long const      key_count(key_set.count());
+
+    CertShardJobs jobs(cert_index_ng_.pool());
+
+    for (size_t i(0); i < cert_index_ng_.shards(); ++i)
+    {
+        jobs.add(new CertShardJob(cert_index_ng_.shard(i).set(), trx,
+                                  index_cut_, store_keys, log_conflicts_));
     }
 
-    return TEST_FAILED;
+    key_set.rewind();
+
+    for (long i(0); i < key_count; ++i)
+    {
+        const KeySet::KeyPart& key(key_set.next());
+        jobs[cert_index_ng_.shard_idx(key)].add(key);
+    }
+
+    jobs.run(CertShardJob::OP_TEST);
+
+    bool          conflict(false);
+    wsrep_seqno_t depends_seqno(trx->depends_seqno());
+
+    for (size_t i(0); i < jobs.size(); ++i)
+    {
+        conflict = conflict || jobs[i].conflict();
+        depends_seqno = std::max(depends_seqno, jobs[i].depends_seqno());
+    }
+
+    if (conflict)
+    {
+        if (store_keys == true) jobs.run(CertShardJob::OP_CLEANUP);
+
+        return TEST_FAILED;
+    }
+
+    trx->set_depends_seqno(depends_seqno);
+
+    if (store_keys == true) jobs.run(CertShardJob::OP_REF);
+
+    return TEST_OK;
 }
 
 /* Determine whether a given trx can be correctly certified under the
@@ -818,6 +1178,7 @@ galera::Certification::do_test(TrxHandle* trx, bool store_keys)
         break;
     case 3:
     case 4:
+    case 5:
         res = do_test_v3to4(trx, store_keys);
         break;
     default:
@@ -887,7 +1248,7 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd)
     conf_                  (conf),
     trx_map_               (),
     cert_index_            (),
-    cert_index_ng_         (),
+    cert_index_ng_         (index_shards(conf), parallel_keys(conf)),
     deps_set_              (),
     service_thd_           (thd),
     mutex_                 (),
@@ -896,6 +1257,7 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd)
     position_              (-1),
     safe_to_discard_seqno_ (-1),
     last_pa_unsafe_        (-1),
+    index_cut_             (-1),
     last_preordered_seqno_ (position_),
     last_preordered_id_    (0),
     stats_mutex_           (),
@@ -910,8 +1272,31 @@ galera::Certification::Certification(gu::Config& conf, ServiceThd& thd)
     max_length_            (max_length(conf)),
     max_length_check_      (length_check(conf)),
     log_conflicts_         (conf.get<bool>(CERT_PARAM_LOG_CONFLICTS)),
-    optimistic_pa_         (conf.get<bool>(CERT_PARAM_OPTIMISTIC_PA))
-{}
+    optimistic_pa_         (conf.get<bool>(CERT_PARAM_OPTIMISTIC_PA)),
+    purge_batch_           (purge_batch_size(conf)),
+    purge_mtx_             (),
+    purge_cond_            (),
+    purge_done_            (),
+    purge_queue_           (),
+    purge_seqno_           (-1),
+    purged_seqno_          (-1),
+    purge_release_seqno_   (-1),
+    purge_busy_seqno_      (-1),
+    purge_time_            (0),
+    purge_thd_             (),
+    purge_busy_            (0),
+    purge_exit_            (false)
+{
+    if (purge_batch_ > 0)
+    {
+        int const err(gu_thread_create(&purge_thd_, NULL, purge_thd_func,
+                                       this));
+        if (gu_unlikely(err != 0))
+        {
+            gu_throw_error(err) << "Failed to create cert index purge thread";
+        }
+    }
+}
 
 
 galera::Certification::~Certification()
@@ -928,6 +1313,19 @@ galera::Certification::~Certification()
     log_info << "avg cert interval "          << avg_cert_interval;
     log_info << "cert index size "            << index_size;
 
+    if (purge_batch_ > 0)
+    {
+        purge_drain();
+
+        {
+            gu::Lock lock(purge_mtx_);
+            purge_exit_ = true;
+            purge_cond_.signal();
+        }
+
+        gu_thread_join(purge_thd_, NULL);
+    }
+
     gu::Lock lock(mutex_);
 
     for_each(trx_map_.begin(), trx_map_.end(), PurgeAndDiscard(*this));
@@ -948,6 +1346,7 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
     case 2:
     case 3:
     case 4:
+    case 5:
         break;
     default:
         gu_throw_fatal << "certification/trx version "
@@ -956,6 +1355,8 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
 
     gu::Lock lock(mutex_);
 
+    purge_drain();
+
     if (seqno >= position_)
     {
         std::for_each(trx_map_.begin(), trx_map_.end(), PurgeAndDiscard(*this));
@@ -968,12 +1369,10 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
                  << seqno;
         std::for_each(cert_index_.begin(), cert_index_.end(),
                       gu::DeleteObject());
-        std::for_each(cert_index_ng_.begin(), cert_index_ng_.end(),
-                      gu::DeleteObject());
+        cert_index_ng_.clear();
         std::for_each(trx_map_.begin(), trx_map_.end(),
                       Unref2nd<TrxMap::value_type>());
         cert_index_.clear();
-        cert_index_ng_.clear();
     }
 
     trx_map_.clear();
@@ -985,9 +1384,15 @@ void galera::Certification::assign_initial_position(wsrep_seqno_t seqno,
     position_              = seqno;
     safe_to_discard_seqno_ = seqno;
     last_pa_unsafe_        = seqno;
+    index_cut_             = seqno;
     last_preordered_seqno_ = position_;
     last_preordered_id_    = 0;
     version_               = version;
+
+    gu::Lock purge_lock(purge_mtx_);
+    purge_seqno_           = seqno;
+    purged_seqno_          = seqno;
+    purge_release_seqno_   = -1;
 }
 
 
@@ -1035,10 +1440,40 @@ galera::Certification::purge_trxs_upto_(wsrep_seqno_t const seqno,
 
     cert_debug << "purging index up to " << seqno;
 
-    for_each(trx_map_.begin(), purge_bound, PurgeAndDiscard(*this));
-    trx_map_.erase(trx_map_.begin(), purge_bound);
+    if (seqno > index_cut_) index_cut_ = seqno;
 
-    if (handle_gcache) service_thd_.release_seqno(seqno);
+    if (purge_batch_ > 0 && version_ >= 3)
+    {
+        {
+            gu::Lock lock(purge_mtx_);
+
+            for (TrxMap::iterator i(trx_map_.begin()); i != purge_bound; ++i)
+            {
+                purge_queue_.push_back(i->second);
+            }
+
+            if (seqno > purge_seqno_) purge_seqno_ = seqno;
+
+            if (handle_gcache && seqno > purge_release_seqno_)
+            {
+                purge_release_seqno_ = seqno;
+            }
+
+            purge_update_purged_seqno_();
+            purge_release_gcache_();
+
+            if (!purge_queue_.empty()) purge_cond_.signal();
+        }
+
+        trx_map_.erase(trx_map_.begin(), purge_bound);
+    }
+    else
+    {
+        for_each(trx_map_.begin(), purge_bound, PurgeAndDiscard(*this));
+        trx_map_.erase(trx_map_.begin(), purge_bound);
+
+        if (handle_gcache) service_thd_.release_seqno(seqno);
+    }
 
     if (0 == ((trx_map_.size() + 1) % 10000))
     {
@@ -1051,6 +1486,152 @@ galera::Certification::purge_trxs_upto_(wsrep_seqno_t const seqno,
 }
 
 
+/* Must be called with purge_mtx_ locked. Batch being purged precedes
+ * the queue, which is ordered by seqno, so index is purged up to the first
+ * seqno of the batch or, if there is none, of the queue. */
+void
+galera::Certification::purge_update_purged_seqno_()
+{
+    wsrep_seqno_t s;
+
+    if (purge_busy_ > 0)
+    {
+        s = purge_busy_seqno_ - 1;
+    }
+    else if (!purge_queue_.empty())
+    {
+        s = purge_queue_.front()->global_seqno() - 1;
+    }
+    else
+    {
+        s = purge_seqno_;
+    }
+
+    if (s > purged_seqno_) purged_seqno_ = s;
+}
+
+/* Must be called with purge_mtx_ locked. Write sets still waiting in the
+ * purge queue are referenced from the index, so GCache can release only what
+ * has been purged already. The rest is released by the purge thread as it
+ * gets there, even if no more purges are requested. */
+void
+galera::Certification::purge_release_gcache_()
+{
+    wsrep_seqno_t const s(std::min(purged_seqno_, purge_release_seqno_));
+
+    if (s > 0) service_thd_.release_seqno(s);
+}
+
+/* Waits until purge queue is empty. Must not be called with purge_mtx_
+ * locked. */
+void
+galera::Certification::purge_drain()
+{
+    gu::Lock lock(purge_mtx_);
+
+    while (!purge_queue_.empty() || purge_busy_ > 0) lock.wait(purge_done_);
+}
+
+void*
+galera::Certification::purge_thd_func(void* arg)
+{
+    static_cast<Certification*>(arg)->purge_thd_loop();
+    return 0;
+}
+
+void
+galera::Certification::purge_thd_loop()
+{
+    std::vector<TrxHandle*> batch;
+    batch.reserve(purge_batch_);
+
+    gu::Lock lock(purge_mtx_);
+
+    while (true)
+    {
+        while (purge_queue_.empty() && !purge_exit_) lock.wait(purge_cond_);
+
+        if (purge_queue_.empty()) break; // purge_exit_ is set
+
+        size_t const n(std::min(purge_batch_, purge_queue_.size()));
+        batch.assign(purge_queue_.begin(), purge_queue_.begin() + n);
+        purge_queue_.erase(purge_queue_.begin(), purge_queue_.begin() + n);
+        purge_busy_       = n;
+        purge_busy_seqno_ = batch.front()->global_seqno();
+
+        purge_mtx_.unlock();
+
+        gu::datetime::Date const start(gu::datetime::Date::monotonic());
+        purge_batch(batch);
+        gu::datetime::Period const time
+            (gu::datetime::Date::monotonic() - start);
+
+        purge_mtx_.lock();
+
+        purge_busy_  = 0;
+        purge_time_ += time.get_nsecs();
+        purge_update_purged_seqno_();
+        purge_release_gcache_();
+
+        if (purge_queue_.empty()) purge_done_.broadcast();
+    }
+}
+
+/* Purges a batch of trxs from index. Keys are grouped by index shard, so that
+ * every shard is locked only once per batch and certification is blocked
+ * for a bounded time. */
+void
+galera::Certification::purge_batch(const std::vector<TrxHandle*>& batch)
+{
+    typedef std::vector<std::pair<TrxHandle*, KeySet::KeyPart> > ShardKeys;
+
+    std::vector<ShardKeys> keys(cert_index_ng_.shards());
+
+    for (size_t i(0); i < batch.size(); ++i)
+    {
+        TrxHandle* const trx(batch[i]);
+
+        {
+            TrxHandleLock lock(*trx);
+
+            if (trx->is_committed() == false)
+            {
+                log_warn << "trx not committed in purge and discard: "
+                         << *trx;
+            }
+        }
+
+        if (trx->depends_seqno() > -1)
+        {
+            const KeySetIn& ks(trx->write_set_in().keyset());
+            ks.rewind();
+
+            for (long k(0); k < ks.count(); ++k)
+            {
+                const KeySet::KeyPart& kp(ks.next());
+                keys[cert_index_ng_.shard_idx(kp)].push_back(
+                    std::make_pair(trx, kp));
+            }
+        }
+    }
+
+    for (size_t s(0); s < keys.size(); ++s)
+    {
+        if (keys[s].empty()) continue;
+
+        CertIndexNG::Shard& shard(cert_index_ng_.shard(s));
+        gu::Lock            shard_lock(shard.mutex());
+
+        for (size_t k(0); k < keys[s].size(); ++k)
+        {
+            purge_key_v3(shard.set(), keys[s][k].second, keys[s][k].first);
+        }
+    }
+
+    for (size_t i(0); i < batch.size(); ++i) batch[i]->unref();
+}
+
+
 galera::Certification::TestResult
 galera::Certification::append_trx(TrxHandle* trx)
 {
@@ -1203,6 +1784,12 @@ galera::Certification::param_set(const std::string& key,
         set_boolean_parameter(optimistic_pa_, value, CERT_PARAM_OPTIMISTIC_PA,
                               "\"optimistic\" parallel applying.");
     }
+    else if (key == CERT_PARAM_INDEX_SHARDS ||
+             key == CERT_PARAM_PURGE_BATCH)
+    {
+        gu_throw_error(EPERM) << "setting '" << key
+                              << "' during runtime not allowed";
+    }
     else
     {
         throw gu::NotFound();
@@ -7,6 +7,7 @@
 
 #include "trx_handle.hpp"
 #include "key_entry_ng.hpp"
+#include "cert_index_ng.hpp"
 #include "galera_service_thd.hpp"
 
 #include "gu_unordered.hpp"
@@ -16,6 +17,8 @@
 #include <map>
 #include <set>
 #include <list>
+#include <deque>
+#include <vector>
 
 namespace galera
 {
@@ -31,10 +34,6 @@ namespace galera
         typedef gu::UnorderedSet<KeyEntryOS*,
                                  KeyEntryPtrHash, KeyEntryPtrEqual> CertIndex;
 
-        typedef gu::UnorderedSet<KeyEntryNG*,
-                                 KeyEntryPtrHashNG, KeyEntryPtrEqualNG>
-        CertIndexNG;
-
     private:
 
         typedef std::multiset<wsrep_seqno_t>        DepsSet;
@@ -106,6 +105,15 @@ namespace galera
             index_size_ = 0;
         }
 
+        // purge_lag:  number of trxs waiting to be purged from index
+        // purge_time: total time spent purging index in background (ns)
+        void purge_stats_get(long long& purge_lag, long long& purge_time) const
+        {
+            gu::Lock lock(purge_mtx_);
+            purge_lag  = purge_queue_.size() + purge_busy_;
+            purge_time = purge_time_;
+        }
+
         void param_set(const std::string& key, const std::string& value);
 
     private:
@@ -113,11 +121,25 @@ namespace galera
         TestResult do_test(TrxHandle*, bool);
         TestResult do_test_v1to2(TrxHandle*, bool);
         TestResult do_test_v3to4(TrxHandle*, bool);
+        TestResult do_test_v3to4_serial(TrxHandle*, bool);
+        TestResult do_test_v3to4_parallel(TrxHandle*, bool);
         TestResult do_test_preordered(TrxHandle*);
         void purge_for_trx(TrxHandle*);
         void purge_for_trx_v1to2(TrxHandle*);
         void purge_for_trx_v3(TrxHandle*);
 
+        /* Background index purge: trxs are moved from trx_map_ to the purge
+         * queue and purged from index by purge thread in batches of
+         * purge_batch_ trxs. */
+        typedef std::deque<TrxHandle*> PurgeQueue;
+
+        static void* purge_thd_func(void*);
+        void purge_thd_loop();
+        void purge_batch(const std::vector<TrxHandle*>& batch);
+        void purge_update_purged_seqno_();
+        void purge_release_gcache_();
+        void purge_drain();
+
         // unprotected variants for internal use
         wsrep_seqno_t get_safe_to_discard_seqno_() const;
         wsrep_seqno_t purge_trxs_upto_(wsrep_seqno_t, bool sync);
@@ -191,6 +213,10 @@ namespace galera
         wsrep_seqno_t position_;
         wsrep_seqno_t safe_to_discard_seqno_;
         wsrep_seqno_t last_pa_unsafe_;
+        /* Index is logically purged up to this seqno: index entries of
+         * trxs at or below it may still wait for background purge and are
+         * ignored by certification. Changes only in total order. */
+        wsrep_seqno_t index_cut_;
         wsrep_seqno_t last_preordered_seqno_;
         wsrep_trx_id_t last_preordered_id_;
         gu::Mutex     stats_mutex_;
@@ -214,6 +240,20 @@ namespace galera
 
         bool               log_conflicts_;
         bool               optimistic_pa_;
+
+        size_t        const purge_batch_;  /* 0 means synchronous purge */
+        gu::Mutex     mutable purge_mtx_;
+        gu::Cond      purge_cond_;         /* purge queue not empty */
+        gu::Cond      purge_done_;         /* purge queue drained */
+        PurgeQueue    purge_queue_;
+        wsrep_seqno_t purge_seqno_;        /* highest seqno queued for purge */
+        wsrep_seqno_t purged_seqno_;       /* index purged up to this seqno */
+        wsrep_seqno_t purge_release_seqno_;/* GCache to release once purged */
+        wsrep_seqno_t purge_busy_seqno_;   /* first seqno of batch in purge */
+        long long     purge_time_;
+        gu_thread_t   purge_thd_;
+        size_t        purge_busy_;         /* size of batch in purge, or 0 */
+        bool          purge_exit_;
     };
 }
 
@@ -0,0 +1,139 @@
+//
+// Copyright (C) 2020 Codership Oy
+//
+
+#ifndef GALERA_DISPATCH_QUEUE_HPP
+#define GALERA_DISPATCH_QUEUE_HPP
+
+#include "trx_handle.hpp"
+#include <gu_lock.hpp>
+
+#include <map>
+#include <set>
+
+namespace galera
+{
+    /* Certified trx is queued instead of being applied by the receiving
+     * thread right away. Then the thread applies queued trxs whose
+     * dependencies are already committed and goes on to receive more,
+     * leaving the rest in the queue, so that independent trxs don't wait
+     * behind dependent ones. Any thread can apply any queued trx.
+     *
+     * To guarantee progress, as long as the queue is not empty there must be
+     * a thread holding a trx preceding all queued ones: it waits for it in
+     * apply monitor, as all threads do without dispatching. Threads also stay
+     * behind and hold queued trxs when the queue is full. So the queue is
+     * always drained by the threads which filled it and apply monitor can be
+     * drained on configuration change as usual.
+     *
+     * Zero window disables the queue: trx is applied by the receiving
+     * thread. */
+    class DispatchQueue
+    {
+    public:
+
+        explicit DispatchQueue(size_t const window)
+            :
+            window_(window),
+            mutex_ (),
+            queue_ (),
+            held_  ()
+        { }
+
+        ~DispatchQueue() { assert(queue_.empty()); }
+
+        size_t window() const { return window_; }
+
+        size_t size() const
+        {
+            gu::Lock lock(mutex_);
+            return queue_.size();
+        }
+
+        // Applies trx and possibly other queued trxs, returns true if any of
+        // them asked the calling thread to exit receive loop. Trx is locked
+        // by the caller. Applier A must provide
+        //   wsrep_seqno_t last_left() const; - last trx left apply monitor
+        //   void apply(TrxHandle*);          - applies locked trx, nothrow
+        template <class A>
+        bool dispatch(TrxHandle* const trx, A& applier)
+        {
+            if (0 == window_)
+            {
+                applier.apply(trx);
+                return trx->exit_loop();
+            }
+
+            bool exit(false);
+
+            // trx must be unlocked for another thread to apply it,
+            // the reference is released by the thread that applies it
+            trx->ref();
+            trx->unlock();
+
+            mutex_.lock();
+
+            queue_.insert(std::make_pair(trx->global_seqno(), trx));
+
+            while (!queue_.empty())
+            {
+                Queue::iterator i(queue_.begin());
+                bool hold(held_.empty() || *held_.begin() > i->first);
+
+                if (!hold)
+                {
+                    wsrep_seqno_t const last_left(applier.last_left());
+
+                    while (i != queue_.end() &&
+                           i->second->depends_seqno() > last_left) ++i;
+
+                    if (i == queue_.end())
+                    {
+                        if (queue_.size() < window_) break;
+
+                        i    = queue_.begin();
+                        hold = true;
+                    }
+                }
+
+                TrxHandle* const next(i->second);
+                wsrep_seqno_t const seqno(i->first);
+
+                queue_.erase(i);
+                if (hold) held_.insert(seqno);
+
+                mutex_.unlock();
+
+                next->lock();
+                applier.apply(next);
+                exit = exit || next->exit_loop();
+                next->unlock();
+                next->unref();
+
+                mutex_.lock();
+
+                if (hold) held_.erase(seqno);
+            }
+
+            mutex_.unlock();
+
+            trx->lock();
+
+            return exit;
+        }
+
+    private:
+
+        DispatchQueue(const DispatchQueue&);
+        void operator=(const DispatchQueue&);
+
+        typedef std::map<wsrep_seqno_t, TrxHandle*> Queue;
+
+        size_t const            window_;
+        gu::Mutex mutable       mutex_;
+        Queue                   queue_;
+        std::set<wsrep_seqno_t> held_;
+    };
+}
+
+#endif // GALERA_DISPATCH_QUEUE_HPP
@@ -7,8 +7,8 @@
 
 #include "gu_unordered.hpp"
 #include "gu_throw.hpp"
+#include "gu_vector.hpp"
 #include <list>
-#include <vector>
 
 namespace galera
 {
@@ -101,7 +101,7 @@ namespace galera
                 (*ai)();
             }
 
-            state_hist_.push_back(state_);
+            state_hist_().push_back(state_);
             state_ = state;
 
             for (ai = i->second.post_action_.begin();
@@ -188,7 +188,8 @@ namespace galera
         bool delete_;
         TransMap* const trans_map_;
         State state_;
-        std::vector<State> state_hist_;
+        // reserved space covers typical trx lifetime without heap allocation
+        gu::Vector<State, 8> state_hist_;
     };
 
 }
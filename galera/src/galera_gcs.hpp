@@ -33,7 +33,8 @@ namespace galera
         virtual ssize_t set_initial_position(const wsrep_uuid_t& uuid,
                                              gcs_seqno_t seqno) = 0;
         virtual void    close() = 0;
-        virtual ssize_t recv(gcs_action& act) = 0;
+        /* returns number of actions received or negative error code */
+        virtual ssize_t recv_batch(gcs_action* acts, long max) = 0;
 
         typedef WriteSetNG::GatherVector WriteSetVector;
 
@@ -114,9 +115,9 @@ namespace galera
             gcs_close(conn_);
         }
 
-        ssize_t recv(struct gcs_action& act)
+        ssize_t recv_batch(struct gcs_action* acts, long const max)
         {
-            return gcs_recv(conn_, &act);
+            return gcs_recv_batch(conn_, acts, max);
         }
 
         ssize_t sendv(const WriteSetVector& actv, size_t act_len,
@@ -282,7 +283,7 @@ namespace galera
 
         void close();
 
-        ssize_t recv(gcs_action& act);
+        ssize_t recv_batch(gcs_action* acts, long max);
 
         ssize_t sendv(const WriteSetVector&, size_t, gcs_act_type_t, bool)
         { return -ENOSYS; }
@@ -413,6 +414,7 @@ namespace galera
 
         ssize_t generate_seqno_action (gcs_action& act, gcs_act_type_t type);
         ssize_t generate_cc (bool primary);
+        ssize_t recv (gcs_action& act);
 
         gu::Config*  gconf_;
         gcache::GCache* gcache_;
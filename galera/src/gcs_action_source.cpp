@@ -10,6 +10,7 @@
 
 #include "galera_info.hpp"
 
+#include <algorithm>
 #include <cassert>
 
 // Exception-safe way to release action pointer when it goes out
@@ -70,7 +71,8 @@ static galera::Replicator::State state2repl(const gcs_act_conf_t& conf)
 
 
 galera::GcsActionTrx::GcsActionTrx(TrxHandle::SlavePool&    pool,
-                                   const struct gcs_action& act)
+                                   const struct gcs_action& act,
+                                   gu::ThreadPool*          checksum_pool)
     :
     trx_(TrxHandle::New(pool))
     // TODO: this dynamic allocation should be unnecessary
@@ -81,7 +83,7 @@ galera::GcsActionTrx::GcsActionTrx(TrxHandle::SlavePool&    pool,
     const gu::byte_t* const buf = static_cast<const gu::byte_t*>(act.buf);
 
 //    size_t offset(trx_->unserialize(buf, act.size, 0));
-    gu_trace(trx_->unserialize(buf, act.size, 0));
+    gu_trace(trx_->unserialize(buf, act.size, 0, checksum_pool));
 
     //trx_->append_write_set(buf + offset, act.size - offset);
     // moved to unserialize trx_->set_write_set_buffer(buf + offset, act.size - offset);
@@ -110,10 +112,9 @@ void galera::GcsActionSource::dispatch(void* const              recv_ctx,
     case GCS_ACT_TORDERED:
     {
         assert(act.seqno_g > 0);
-        GcsActionTrx trx(trx_pool_, act);
+        GcsActionTrx trx(trx_pool_, act, &checksum_pool_);
         trx.trx()->set_state(TrxHandle::S_REPLICATING);
-        gu_trace(replicator_.process_trx(recv_ctx, trx.trx()));
-        exit_loop = trx.trx()->exit_loop(); // this is the end of trx lifespan
+        gu_trace(replicator_.process_trx(recv_ctx, trx.trx(), exit_loop));
         break;
     }
     case GCS_ACT_COMMIT_CUT:
@@ -167,22 +168,131 @@ void galera::GcsActionSource::dispatch(void* const              recv_ctx,
 }
 
 
+// Keeps count of threads receiving from the action source
+class ReceiverCount
+{
+public:
+    ReceiverCount(gu::Atomic<long>& count)
+        :
+        count_(count),
+        value_(count_.add_and_fetch(1))
+    {}
+
+    ~ReceiverCount() { count_.sub_and_fetch(1); }
+
+    long value() const { return value_; }
+
+private:
+    gu::Atomic<long>& count_;
+    long const        value_;
+};
+
+
+galera::GcsActionSource::~GcsActionSource()
+{
+    /* actions left behind by the last receivers */
+    for (std::deque<gcs_action>::iterator i(pushed_back_.begin());
+         i != pushed_back_.end(); ++i)
+    {
+        Release release(*i, gcache_);
+    }
+
+    log_info << trx_pool_;
+}
+
+
+void galera::GcsActionSource::put_back(const gcs_action* const acts,
+                                       long const               n)
+{
+    gu::Lock lock(pushed_back_mtx_);
+    pushed_back_.insert(pushed_back_.begin(), acts, acts + n);
+    pushed_back_count_.add_and_fetch(n);
+}
+
+
+long galera::GcsActionSource::take_back(gcs_action* const acts, long const max)
+{
+    /* nothing is pushed back normally, don't take the lock for it */
+    if (gu_likely(0 == pushed_back_count_())) return 0;
+
+    gu::Lock lock(pushed_back_mtx_);
+
+    long n(0);
+    for (; n < max && !pushed_back_.empty(); ++n)
+    {
+        acts[n] = pushed_back_.front();
+        pushed_back_.pop_front();
+    }
+
+    pushed_back_count_.sub_and_fetch(n);
+
+    return n;
+}
+
+
 ssize_t galera::GcsActionSource::process(void* recv_ctx, bool& exit_loop)
 {
-    struct gcs_action act;
+    ReceiverCount const rc_count(receivers_);
+
+    /* Actions of a batch are processed one after another, their order
+     * relative to other receivers' actions is enforced by the monitors.
+     * Receivers share the queue, so that one of them does not take all
+     * queued actions while the others have nothing to apply. */
+    long const max(std::max(RECV_BATCH_MAX / rc_count.value(), 1L));
+
+    struct gcs_action acts[RECV_BATCH_MAX];
 
-    ssize_t rc(gcs_.recv(act));
-    if (rc > 0)
+    ssize_t rc(take_back(acts, max));
+    if (0 == rc) rc = gcs_.recv_batch(acts, max);
+    if (rc <= 0) return rc;
+
+    long const n(rc);
+    long       i(0);
+
+    rc = 0;
+    exit_loop = false;
+
+    try
     {
-        Release release(act, gcache_);
-        ++received_;
-        received_bytes_ += rc;
-        gu_trace(dispatch(recv_ctx, act, exit_loop));
+        for (; i < n; ++i)
+        {
+            struct gcs_action& act(acts[i]);
+
+            if (gu_unlikely(act.size <= 0))
+            {
+                /* error action is always the only one in the batch */
+                assert(1 == n);
+                rc = (GCS_ACT_INCONSISTENCY == act.type ?
+                      INCONSISTENCY_CODE : 0);
+                break;
+            }
+
+            Release release(act, gcache_);
+            ++received_;
+            received_bytes_ += act.size;
+            rc += act.size;
+
+            bool exit_act(false);
+            gu_trace(dispatch(recv_ctx, act, exit_act));
+
+            if (gu_unlikely(exit_act))
+            {
+                /* receiver must leave now, actions after this one are to be
+                 * processed by those who stay */
+                exit_loop = true;
+                ++i;
+                break;
+            }
+        }
     }
-    else if (GCS_ACT_INCONSISTENCY == act.type)
+    catch (...)
     {
-        assert(0 == rc);
-        rc = INCONSISTENCY_CODE;
+        /* release actions which were not processed */
+        for (++i; i < n; ++i) Release release(acts[i], gcache_);
+        throw;
     }
+
+    if (gu_unlikely(i < n)) put_back(acts + i, n - i);
+
     return rc;
 }
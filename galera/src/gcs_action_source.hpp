@@ -13,6 +13,9 @@
 #include "GCache.hpp"
 
 #include "gu_atomic.hpp"
+#include "gu_lock.hpp"
+
+#include <deque>
 
 namespace galera
 {
@@ -23,23 +26,29 @@ namespace galera
         /* to be returned in case of inconsistency event */
         static int const INCONSISTENCY_CODE = -ENOTRECOVERABLE;
 
+        /* maximum number of actions received at once */
+        static long const RECV_BATCH_MAX = 64;
+
         GcsActionSource(TrxHandle::SlavePool& sp,
                         GCS_IMPL&             gcs,
                         Replicator&           replicator,
-                        gcache::GCache&       gcache)
+                        gcache::GCache&       gcache,
+                        gu::ThreadPool&       checksum_pool)
             :
             trx_pool_      (sp        ),
             gcs_           (gcs       ),
             replicator_    (replicator),
             gcache_        (gcache    ),
+            checksum_pool_ (checksum_pool),
             received_      (0         ),
-            received_bytes_(0         )
+            received_bytes_(0         ),
+            receivers_     (0         ),
+            pushed_back_mtx_(),
+            pushed_back_   (),
+            pushed_back_count_(0)
         { }
 
-        ~GcsActionSource()
-        {
-            log_info << trx_pool_;
-        }
+        ~GcsActionSource();
 
         ssize_t   process(void*, bool& exit_loop);
         long long received()       const { return received_(); }
@@ -49,18 +58,29 @@ namespace galera
 
         void dispatch(void*, const gcs_action&, bool& exit_loop);
 
+        /* actions received by a thread which exits before processing them
+         * are taken by the next call to process() */
+        void put_back (const gcs_action* acts, long n);
+        long take_back(gcs_action* acts, long max);
+
         TrxHandle::SlavePool& trx_pool_;
         GCS_IMPL&             gcs_;
         Replicator&           replicator_;
         gcache::GCache&       gcache_;
+        gu::ThreadPool&       checksum_pool_;
         gu::Atomic<long long> received_;
         gu::Atomic<long long> received_bytes_;
+        gu::Atomic<long>      receivers_; // threads inside process()
+        gu::Mutex             pushed_back_mtx_;
+        std::deque<gcs_action> pushed_back_;
+        gu::Atomic<long>      pushed_back_count_; // pushed_back_.size()
     };
 
     class GcsActionTrx
     {
     public:
-        GcsActionTrx(TrxHandle::SlavePool& sp, const struct gcs_action& act);
+        GcsActionTrx(TrxHandle::SlavePool& sp, const struct gcs_action& act,
+                     gu::ThreadPool* checksum_pool = NULL);
         ~GcsActionTrx();
         TrxHandle* trx() const { return trx_; }
     private:
@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2011-2017 Codership Oy <info@codership.com>
+// Copyright (C) 2011-2020 Codership Oy <info@codership.com>
 //
 
 #include "ist.hpp"
@@ -9,17 +9,425 @@
 #include "gu_uri.hpp"
 #include "gu_debug_sync.hpp"
 #include "gu_progress.hpp"
+#include "gu_datetime.hpp"
+#include "gu_mem_policy.hpp"
 
 #include "GCache.hpp"
 #include "galera_common.hpp"
 #include <boost/bind.hpp>
 #include <fstream>
+#include <sstream>
 #include <algorithm>
 
 namespace
 {
     static std::string const CONF_KEEP_KEYS     ("ist.keep_keys");
     static bool        const CONF_KEEP_KEYS_DEFAULT (true);
+    static int         const CONF_SEND_STREAMS_DEFAULT (1);
+    static std::string const CONF_ZERO_COPY     ("ist.zero_copy");
+    static bool        const CONF_ZERO_COPY_DEFAULT (true);
+
+    /* maximum number of received write sets waiting for appliers */
+    static size_t      const RECV_QUEUE_MAX (256);
+
+    typedef asio::ssl::stream<asio::ip::tcp::socket> SSLStream;
+
+    inline void new_stream(asio::io_service&       io,
+                           asio::ssl::context&     ctx,
+                           asio::ip::tcp::socket*& stream)
+    {
+        stream = new asio::ip::tcp::socket(io);
+    }
+
+    inline void new_stream(asio::io_service&   io,
+                           asio::ssl::context& ctx,
+                           SSLStream*&         stream)
+    {
+        stream = new SSLStream(io, ctx);
+    }
+
+    inline void handshake_stream(asio::ip::tcp::socket&, SSLStream::handshake_type)
+    { }
+
+    inline void handshake_stream(SSLStream& stream, SSLStream::handshake_type t)
+    {
+        stream.handshake(t);
+    }
+
+    template <class ST>
+    void accept_stream(asio::ip::tcp::acceptor& acceptor, ST& stream)
+    {
+        acceptor.accept(stream.lowest_layer());
+        gu::set_fd_options(stream.lowest_layer());
+        handshake_stream(stream, SSLStream::server);
+    }
+
+    template <class ST>
+    void connect_stream(const asio::ip::tcp::endpoint& endpoint, ST& stream)
+    {
+        stream.lowest_layer().connect(endpoint);
+        gu::set_fd_options(stream.lowest_layer());
+        handshake_stream(stream, SSLStream::client);
+    }
+
+    template <class ST>
+    void close_streams(const std::vector<ST*>& streams)
+    {
+        for (size_t i(0); i < streams.size(); ++i)
+        {
+            asio::error_code ec;
+            streams[i]->lowest_layer().close(ec);
+        }
+    }
+
+    template <class ST>
+    void delete_streams(std::vector<ST*>& streams)
+    {
+        close_streams(streams);
+        for (size_t i(0); i < streams.size(); ++i) delete streams[i];
+        streams.clear();
+    }
+
+    /* deletes streams when going out of scope */
+    template <class ST>
+    class StreamsGuard
+    {
+    public:
+        explicit StreamsGuard(std::vector<ST*>& streams) : streams_(streams)
+        { }
+        ~StreamsGuard() { delete_streams(streams_); }
+    private:
+        std::vector<ST*>& streams_;
+        StreamsGuard(const StreamsGuard&);
+        void operator=(const StreamsGuard&);
+    };
+
+    /*
+     * Fetches batches of buffers from GCache in a separate thread, ahead of
+     * the stream senders, and advises the kernel to read page backed buffers
+     * in. Every batch must be released by all consumers before its slot is
+     * reused.
+     */
+    class ReadAhead
+    {
+    public:
+
+        static size_t const BATCH = 256; // buffers per batch
+        static size_t const DEPTH = 4;   // batches fetched ahead
+
+        struct Batch
+        {
+            std::vector<gcache::GCache::Buffer> bufs;
+            size_t size;    // number of fetched buffers
+            int    pending; // consumers which did not release it yet
+        };
+
+        ReadAhead(gcache::GCache& gcache,
+                  wsrep_seqno_t first, wsrep_seqno_t last, int consumers)
+            :
+            gcache_   (gcache),
+            mtx_      (),
+            cond_     (),
+            slots_    (DEPTH),
+            next_     (first),
+            last_     (last),
+            consumers_(consumers),
+            produced_ (0),
+            fetched_  (0),
+            error_    (0),
+            done_     (false),
+            complete_ (false),
+            thread_   ()
+        {
+            for (size_t i(0); i < slots_.size(); ++i)
+            {
+                slots_[i].size    = 0;
+                slots_[i].pending = 0;
+            }
+
+            int const err(gu_thread_create(&thread_, 0, run_thread, this));
+            if (err != 0)
+            {
+                gu_throw_error(err) << "Failed to start IST read-ahead thread";
+            }
+        }
+
+        ~ReadAhead()
+        {
+            interrupt(ECANCELED);
+            gu_thread_join(thread_, 0);
+        }
+
+        /*! @return batch number n, 0 if there are no more buffers
+         *  @throws gu::Exception if interrupted */
+        const Batch* wait(size_t const n)
+        {
+            gu::Lock lock(mtx_);
+
+            while (n >= produced_ && !done_ && 0 == error_) lock.wait(cond_);
+
+            if (error_ != 0)
+            {
+                gu_throw_error(error_) << "IST read-ahead interrupted";
+            }
+
+            if (n >= produced_) return 0;
+
+            assert(n + DEPTH >= produced_);
+            return &slots_[n % DEPTH];
+        }
+
+        void release(size_t const n)
+        {
+            gu::Lock lock(mtx_);
+            Batch& b(slots_[n % DEPTH]);
+            assert(b.pending > 0);
+            if (0 == --b.pending) cond_.broadcast();
+        }
+
+        void interrupt(int const err)
+        {
+            gu::Lock lock(mtx_);
+            if (0 == error_ && !done_) error_ = err;
+            done_ = true;
+            cond_.broadcast();
+        }
+
+        /*! @return true if all buffers up to last were fetched */
+        bool complete() const { gu::Lock lock(mtx_); return complete_; }
+
+        /*! @return number of buffers fetched */
+        wsrep_seqno_t fetched() const { gu::Lock lock(mtx_); return fetched_; }
+
+    private:
+
+        static void* run_thread(void* arg)
+        {
+            static_cast<ReadAhead*>(arg)->run();
+            return 0;
+        }
+
+        /* coalesces neighbouring buffers into ranges to reduce syscalls */
+        static void advise(const std::vector<gcache::GCache::Buffer>& bufs,
+                           size_t const n)
+        {
+            static ptrdiff_t const MAX_GAP(4096);
+
+            const gu::byte_t* begin(0);
+            const gu::byte_t* end(0);
+
+            for (size_t i(0); i < n; ++i)
+            {
+                /* only file mappings have anything to read ahead, the rest
+                 * are malloc()'ed and may share pages with other data */
+                if (bufs[i].fd() < 0) continue;
+
+                const gu::byte_t* const ptr(bufs[i].ptr());
+
+                if (begin && ptr >= end && ptr - end <= MAX_GAP)
+                {
+                    end = ptr + bufs[i].size();
+                    continue;
+                }
+
+                if (begin) gu::mem_advise_willneed(begin, end - begin);
+
+                begin = ptr;
+                end   = ptr + bufs[i].size();
+            }
+
+            if (begin) gu::mem_advise_willneed(begin, end - begin);
+        }
+
+        void run()
+        {
+            try
+            {
+                while (true)
+                {
+                    size_t slot;
+                    {
+                        gu::Lock lock(mtx_);
+                        slot = produced_ % DEPTH;
+                        while (slots_[slot].pending > 0 && !done_)
+                            lock.wait(cond_);
+                        if (done_) return;
+                    }
+
+                    Batch& b(slots_[slot]);
+                    b.bufs.resize(std::min(static_cast<size_t>(last_-next_+1),
+                                           size_t(BATCH)));
+
+                    size_t const n(gcache_.seqno_get_buffers(b.bufs, next_));
+                    GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
+
+                    advise(b.bufs, n);
+
+                    gu::Lock lock(mtx_);
+
+                    if (done_) return;
+
+                    if (n > 0)
+                    {
+                        b.size    = n;
+                        b.pending = consumers_;
+                        ++produced_;
+                        fetched_ += n;
+                        next_    += n;
+                    }
+
+                    if (0 == n || next_ > last_)
+                    {
+                        complete_ = (n > 0);
+                        done_     = true;
+                    }
+
+                    cond_.broadcast();
+
+                    if (done_) return;
+                }
+            }
+            catch (gu::Exception& e)
+            {
+                log_error << "IST read-ahead failed: " << e.what();
+                interrupt(e.get_errno());
+            }
+        }
+
+        gcache::GCache&    gcache_;
+        gu::Mutex          mtx_;
+        gu::Cond           cond_;
+        std::vector<Batch> slots_;
+        wsrep_seqno_t      next_;
+        wsrep_seqno_t      const last_;
+        int                const consumers_;
+        size_t             produced_;
+        wsrep_seqno_t      fetched_;
+        int                error_;
+        bool               done_;
+        bool               complete_;
+        gu_thread_t        thread_;
+
+        ReadAhead(const ReadAhead&);
+        void operator=(const ReadAhead&);
+    };
+
+    /*
+     * Sends every n-th write set of the read-ahead batches over a stream,
+     * starting with write set k.
+     */
+    template <class ST>
+    class StreamSender
+    {
+    public:
+
+        StreamSender(ST& stream, ReadAhead& ra, int version, bool keep_keys,
+                     bool zero_copy, size_t k, size_t n, wsrep_seqno_t first)
+            :
+            stream_(stream),
+            ra_    (ra),
+            pool_  (1, 0, ""),
+            proto_ (pool_, version, keep_keys, zero_copy),
+            k_     (k),
+            n_     (n),
+            first_ (first),
+            error_ (0),
+            what_  ()
+        { }
+
+        static void* run_thread(void* arg)
+        {
+            static_cast<StreamSender*>(arg)->run();
+            return 0;
+        }
+
+        void run()
+        {
+            try
+            {
+                send();
+                return;
+            }
+            catch (asio::system_error& e)
+            {
+                std::ostringstream os;
+                os << "ist send failed: " << e.code()
+                   << "', asio error '" << e.what() << "'";
+                what_  = os.str();
+                error_ = e.code().value();
+            }
+            catch (gu::Exception& e)
+            {
+                what_  = e.what();
+                error_ = e.get_errno();
+            }
+
+            /* unblock receiver and other streams */
+            asio::error_code ec;
+            stream_.lowest_layer().close(ec);
+            ra_.interrupt(error_);
+        }
+
+        int                error() const { return error_; }
+        const std::string& what()  const { return what_;  }
+        uint64_t           sent()  const { return proto_.sent(); }
+
+    private:
+
+        void send()
+        {
+            for (size_t b(0); ; ++b)
+            {
+                const ReadAhead::Batch* const batch(ra_.wait(b));
+
+                if (0 == batch) break;
+
+                for (size_t i(0); i < batch->size; ++i)
+                {
+                    const gcache::GCache::Buffer& buf(batch->bufs[i]);
+
+                    if (size_t(buf.seqno_g() - first_) % n_ == k_)
+                    {
+                        proto_.send_trx(stream_, buf);
+                    }
+                }
+
+                ra_.release(b);
+            }
+
+            /* history is not available anymore, receiver will notice
+             * missing write sets */
+            if (!ra_.complete()) return;
+
+            proto_.send_ctrl(stream_, galera::ist::Ctrl::C_EOF);
+
+            // wait until receiver closes the connection
+            try
+            {
+                gu::byte_t b;
+                size_t n(asio::read(stream_, asio::buffer(&b, 1)));
+                if (n > 0)
+                {
+                    log_warn << "received " << n << " bytes, expected none";
+                }
+            }
+            catch (asio::system_error& e)
+            { }
+        }
+
+        ST&                              stream_;
+        ReadAhead&                       ra_;
+        galera::TrxHandle::SlavePool     pool_;
+        galera::ist::Proto               proto_;
+        size_t                     const k_;
+        size_t                     const n_;
+        wsrep_seqno_t              const first_;
+        int                              error_;
+        std::string                      what_;
+
+        StreamSender(const StreamSender&);
+        void operator=(const StreamSender&);
+    };
 }
 
 
@@ -75,6 +483,8 @@ std::string const
 galera::ist::Receiver::RECV_ADDR("ist.recv_addr");
 std::string const
 galera::ist::Receiver::RECV_BIND("ist.recv_bind");
+std::string const
+galera::ist::Sender::SEND_STREAMS("ist.send_streams");
 
 void
 galera::ist::register_params(gu::Config& conf)
@@ -82,11 +492,14 @@ galera::ist::register_params(gu::Config& conf)
     conf.add(Receiver::RECV_ADDR);
     conf.add(Receiver::RECV_BIND);
     conf.add(CONF_KEEP_KEYS);
+    conf.add(Sender::SEND_STREAMS, gu::to_string(CONF_SEND_STREAMS_DEFAULT));
+    conf.add(CONF_ZERO_COPY, gu::to_string(CONF_ZERO_COPY_DEFAULT));
 }
 
 galera::ist::Receiver::Receiver(gu::Config&           conf,
                                 TrxHandle::SlavePool& sp,
-                                const char*           addr)
+                                const char*           addr,
+                                gu::ThreadPool*       checksum_pool)
     :
     recv_addr_    (),
     recv_bind_    (),
@@ -95,11 +508,13 @@ galera::ist::Receiver::Receiver(gu::Config&           conf,
     ssl_ctx_      (io_service_, asio::ssl::context::sslv23),
     mutex_        (),
     cond_         (),
-    consumers_    (),
+    recv_cond_    (),
+    queue_        (),
     current_seqno_(-1),
     last_seqno_   (-1),
     conf_         (conf),
     trx_pool_     (sp),
+    checksum_pool_(checksum_pool),
     thread_       (),
     error_code_   (0),
     version_      (-1),
@@ -356,21 +771,29 @@ galera::ist::Receiver::prepare(wsrep_seqno_t first_seqno,
 
 void galera::ist::Receiver::run()
 {
-    asio::ip::tcp::socket socket(io_service_);
-    asio::ssl::stream<asio::ip::tcp::socket> ssl_stream(io_service_, ssl_ctx_);
+    if (use_ssl_ == true)
+    {
+        run_streams<SSLStream>();
+    }
+    else
+    {
+        run_streams<asio::ip::tcp::socket>();
+    }
+}
+
+
+template <class ST>
+void galera::ist::Receiver::run_streams()
+{
+    std::vector<ST*> streams;
+    StreamsGuard<ST> guard(streams);
+
+    streams.push_back(0);
+    new_stream(io_service_, ssl_ctx_, streams.back());
+
     try
     {
-        if (use_ssl_ == true)
-        {
-            acceptor_.accept(ssl_stream.lowest_layer());
-            gu::set_fd_options(ssl_stream.lowest_layer());
-            ssl_stream.handshake(asio::ssl::stream<asio::ip::tcp::socket>::server);
-        }
-        else
-        {
-            acceptor_.accept(socket);
-            gu::set_fd_options(socket);
-        }
+        accept_stream(acceptor_, *streams[0]);
     }
     catch (asio::system_error& e)
     {
@@ -379,24 +802,39 @@ void galera::ist::Receiver::run()
                                          << e.what() << "': "
                                          << gu::extra_error_info(e.code());
     }
-    acceptor_.close();
     int ec(0);
     try
     {
         Proto p(trx_pool_, version_,
-                conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
+                conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT), false,
+                checksum_pool_);
 
-        if (use_ssl_ == true)
+        p.send_handshake(*streams[0], MAX_STREAMS);
+        size_t const n_streams(
+            std::max<size_t>(1, p.recv_handshake_response(*streams[0])));
+        if (n_streams > size_t(MAX_STREAMS))
         {
-            p.send_handshake(ssl_stream);
-            p.recv_handshake_response(ssl_stream);
-            p.send_ctrl(ssl_stream, Ctrl::C_OK);
+            gu_throw_error(EPROTO) << "sender requested " << n_streams
+                                   << " streams, at most " << MAX_STREAMS
+                                   << " supported";
         }
-        else
+        p.send_ctrl(*streams[0], Ctrl::C_OK);
+
+        /* additional streams are connected right after the first one */
+        while (streams.size() < n_streams)
+        {
+            streams.push_back(0);
+            new_stream(io_service_, ssl_ctx_, streams.back());
+            accept_stream(acceptor_, *streams.back());
+            p.send_handshake(*streams.back(), MAX_STREAMS);
+            p.recv_handshake_response(*streams.back());
+            p.send_ctrl(*streams.back(), Ctrl::C_OK);
+        }
+        acceptor_.close();
+
+        if (n_streams > 1)
         {
-            p.send_handshake(socket);
-            p.recv_handshake_response(socket);
-            p.send_ctrl(socket, Ctrl::C_OK);
+            log_info << "IST receiving over " << n_streams << " streams";
         }
 
         /* wait for ready signal from the STR thread */
@@ -413,17 +851,11 @@ void galera::ist::Receiver::run()
              * once per BOTH 10 seconds (default) and 16 events */
             16);
 
+        /* write sets are striped over streams in seqno order */
+        size_t k(0);
         while (true)
         {
-            TrxHandle* trx;
-            if (use_ssl_ == true)
-            {
-                trx = p.recv_trx(ssl_stream);
-            }
-            else
-            {
-                trx = p.recv_trx(socket);
-            }
+            TrxHandle* trx(p.recv_trx(*streams[k]));
             if (trx != 0)
             {
                 if (trx->global_seqno() != current_seqno_)
@@ -434,21 +866,23 @@ void galera::ist::Receiver::run()
                     goto err;
                 }
                 ++current_seqno_;
+                k = (k + 1) % streams.size();
 
                 progress.update(1);
             }
-            gu::Lock lock(mutex_);
-            assert(ready_);
-            while (consumers_.empty()) lock.wait(cond_);
-            Consumer* cons(consumers_.top());
-            consumers_.pop();
-            cons->trx(trx);
-            cons->cond().signal();
             if (trx == 0)
             {
                 log_debug << "eof received, closing socket";
                 break;
             }
+
+            /* appliers pick write sets from the queue while the next ones
+             * are being received */
+            gu::Lock lock(mutex_);
+            assert(ready_);
+            while (queue_.size() >= RECV_QUEUE_MAX) lock.wait(cond_);
+            queue_.push_back(trx);
+            recv_cond_.signal();
         }
 
         progress.finish();
@@ -469,15 +903,7 @@ void galera::ist::Receiver::run()
 
 err:
     gu::Lock lock(mutex_);
-    if (use_ssl_ == true)
-    {
-        ssl_stream.lowest_layer().close();
-        // ssl_stream.shutdown();
-    }
-    else
-    {
-        socket.close();
-    }
+    close_streams(streams);
 
     running_ = false;
     if (ec != EINTR && current_seqno_ - 1 < last_seqno_)
@@ -490,11 +916,7 @@ err:
     {
         error_code_ = ec;
     }
-    while (consumers_.empty() == false)
-    {
-        consumers_.top()->cond().signal();
-        consumers_.pop();
-    }
+    recv_cond_.broadcast();
 }
 
 
@@ -507,28 +929,19 @@ void galera::ist::Receiver::ready()
 
 int galera::ist::Receiver::recv(TrxHandle** trx)
 {
-    Consumer cons;
     gu::Lock lock(mutex_);
-    if (running_ == false)
+    while (queue_.empty() && running_ == true) lock.wait(recv_cond_);
+    if (error_code_ != 0)
     {
-        if (error_code_ != 0)
-        {
-            gu_throw_error(error_code_) << "IST receiver reported error";
-        }
-        return EINTR;
+        gu_throw_error(error_code_) << "IST receiver reported error";
     }
-    consumers_.push(&cons);
-    cond_.signal();
-    lock.wait(cons.cond());
-    if (cons.trx() == 0)
+    if (queue_.empty())
     {
-        if (error_code_ != 0)
-        {
-            gu_throw_error(error_code_) << "IST receiver reported error";
-        }
         return EINTR;
     }
-    *trx = cons.trx();
+    *trx = queue_.front();
+    queue_.pop_front();
+    cond_.signal();
     return 0;
 }
 
@@ -555,12 +968,16 @@ wsrep_seqno_t galera::ist::Receiver::finished()
 
         running_ = false;
 
-        while (consumers_.empty() == false)
+        /* write sets which were received but not applied */
+        while (queue_.empty() == false)
         {
-            consumers_.top()->cond().signal();
-            consumers_.pop();
+            queue_.back()->unref();
+            queue_.pop_back();
+            --current_seqno_;
         }
 
+        recv_cond_.broadcast();
+
         recv_addr_ = "";
     }
 
@@ -627,15 +1044,19 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
                             const std::string& peer,
                             int                version)
     :
-    io_service_(),
-    socket_    (io_service_),
-    ssl_ctx_   (io_service_, asio::ssl::context::sslv23),
-    ssl_stream_(0),
-    conf_      (conf),
-    gcache_    (gcache),
-    version_   (version),
-    use_ssl_   (false)
+    io_service_ (),
+    ssl_ctx_    (io_service_, asio::ssl::context::sslv23),
+    endpoint_   (),
+    sockets_    (),
+    ssl_streams_(),
+    conf_       (conf),
+    gcache_     (gcache),
+    version_    (version),
+    use_ssl_    (false)
 {
+    int const n_streams(std::max(1, std::min(int(MAX_STREAMS),
+        conf.get(SEND_STREAMS, CONF_SEND_STREAMS_DEFAULT))));
+
     gu::URI uri(peer);
     try
     {
@@ -645,29 +1066,39 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
                   uri.get_port(),
                   asio::ip::tcp::resolver::query::flags(0));
         asio::ip::tcp::resolver::iterator i(resolver.resolve(query));
+        endpoint_ = *i;
         if (uri.get_scheme() == "ssl")
         {
             use_ssl_ = true;
         }
+        /* all streams are allocated beforehand so that cancel() can close
+         * them while they are being connected */
         if (use_ssl_ == true)
         {
             log_info << "IST sender using ssl";
             ssl_prepare_context(conf, ssl_ctx_);
-            // ssl_stream must be created after ssl_ctx_ is prepared...
-            ssl_stream_ = new asio::ssl::stream<asio::ip::tcp::socket>(
-                io_service_, ssl_ctx_);
-            ssl_stream_->lowest_layer().connect(*i);
-            gu::set_fd_options(ssl_stream_->lowest_layer());
-            ssl_stream_->handshake(asio::ssl::stream<asio::ip::tcp::socket>::client);
+            // ssl streams must be created after ssl_ctx_ is prepared...
+            ssl_streams_.resize(n_streams);
+            for (int s(0); s < n_streams; ++s)
+            {
+                new_stream(io_service_, ssl_ctx_, ssl_streams_[s]);
+            }
+            connect_stream(endpoint_, *ssl_streams_[0]);
         }
         else
         {
-            socket_.connect(*i);
-            gu::set_fd_options(socket_);
+            sockets_.resize(n_streams);
+            for (int s(0); s < n_streams; ++s)
+            {
+                new_stream(io_service_, ssl_ctx_, sockets_[s]);
+            }
+            connect_stream(endpoint_, *sockets_[0]);
         }
     }
     catch (asio::system_error& e)
     {
+        delete_streams(ssl_streams_);
+        delete_streams(sockets_);
         gu_throw_error(e.code().value()) << "IST sender, failed to connect '"
                                          << peer.c_str() << "': " << e.what();
     }
@@ -676,18 +1107,19 @@ galera::ist::Sender::Sender(const gu::Config&  conf,
 
 galera::ist::Sender::~Sender()
 {
-    if (use_ssl_ == true)
-    {
-        ssl_stream_->lowest_layer().close();
-        delete ssl_stream_;
-    }
-    else
-    {
-        socket_.close();
-    }
+    delete_streams(ssl_streams_);
+    delete_streams(sockets_);
     gcache_.seqno_unlock();
 }
 
+
+void galera::ist::Sender::cancel()
+{
+    close_streams(ssl_streams_);
+    close_streams(sockets_);
+}
+
+
 void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
 {
     if (first > last)
@@ -695,104 +1127,124 @@ void galera::ist::Sender::send(wsrep_seqno_t first, wsrep_seqno_t last)
         gu_throw_error(EINVAL) << "sender send first greater than last: "
                                << first << " > " << last ;
     }
+
+    if (use_ssl_ == true)
+    {
+        send_streams(ssl_streams_, first, last);
+    }
+    else
+    {
+        send_streams(sockets_, first, last);
+    }
+}
+
+
+template <class ST>
+void galera::ist::Sender::send_streams(std::vector<ST*>& streams,
+                                       wsrep_seqno_t     first,
+                                       wsrep_seqno_t     last)
+{
+    bool const keep_keys(conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
+    bool const zero_copy(conf_.get(CONF_ZERO_COPY, CONF_ZERO_COPY_DEFAULT));
+    size_t n_streams;
+
     try
     {
         TrxHandle::SlavePool unused(1, 0, "");
-        Proto p(unused, version_,
-                conf_.get(CONF_KEEP_KEYS, CONF_KEEP_KEYS_DEFAULT));
-        int32_t ctrl;
+        Proto p(unused, version_, keep_keys);
 
-        if (use_ssl_ == true)
-        {
-            p.recv_handshake(*ssl_stream_);
-            p.send_handshake_response(*ssl_stream_);
-            ctrl = p.recv_ctrl(*ssl_stream_);
-        }
-        else
+        /* receiver tells how many streams it can accept, 0 means 1 */
+        n_streams = std::max<size_t>(1, std::min<size_t>(
+                                         streams.size(),
+                                         p.recv_handshake(*streams[0])));
+        p.send_handshake_response(*streams[0], n_streams);
+        int32_t ctrl(p.recv_ctrl(*streams[0]));
+
+        for (size_t s(1); ctrl >= 0 && s < n_streams; ++s)
         {
-            p.recv_handshake(socket_);
-            p.send_handshake_response(socket_);
-            ctrl = p.recv_ctrl(socket_);
+            connect_stream(endpoint_, *streams[s]);
+            p.recv_handshake(*streams[s]);
+            p.send_handshake_response(*streams[s], n_streams);
+            ctrl = p.recv_ctrl(*streams[s]);
         }
+
         if (ctrl < 0)
         {
             gu_throw_error(EPROTO)
                 << "ist send failed, peer reported error: " << ctrl;
         }
+    }
+    catch (asio::system_error& e)
+    {
+        gu_throw_error(e.code().value()) << "ist send failed: " << e.code()
+                                         << "', asio error '" << e.what()
+                                         << "'";
+    }
+
+    gu::datetime::Date const start(gu::datetime::Date::monotonic());
+
+    ReadAhead ra(gcache_, first, last, n_streams);
+
+    std::vector<StreamSender<ST>*> senders(n_streams);
+    std::vector<gu_thread_t>       threads(n_streams);
 
-        std::vector<gcache::GCache::Buffer> buf_vec(
-            std::min(static_cast<size_t>(last - first + 1),
-                     static_cast<size_t>(1024)));
-        ssize_t n_read;
-        while ((n_read = gcache_.seqno_get_buffers(buf_vec, first)) > 0)
+    for (size_t s(0); s < n_streams; ++s)
+    {
+        senders[s] = new StreamSender<ST>(*streams[s], ra, version_,
+                                          keep_keys, zero_copy,
+                                          s, n_streams, first);
+    }
+
+    /* first stream is served by the calling thread */
+    size_t n_threads(1);
+    for (; n_threads < n_streams; ++n_threads)
+    {
+        int const err(gu_thread_create(&threads[n_threads], 0,
+                                       StreamSender<ST>::run_thread,
+                                       senders[n_threads]));
+        if (err != 0)
         {
-            GU_DBUG_SYNC_WAIT("ist_sender_send_after_get_buffers")
-            //log_info << "read " << first << " + " << n_read << " from gcache";
-            for (wsrep_seqno_t i(0); i < n_read; ++i)
-            {
-                // log_info << "sending " << buf_vec[i].seqno_g();
-                if (use_ssl_ == true)
-                {
-                    p.send_trx(*ssl_stream_, buf_vec[i]);
-                }
-                else
-                {
-                    p.send_trx(socket_, buf_vec[i]);
-                }
+            log_error << "Failed to start IST stream thread: " << err;
+            close_streams(streams);
+            ra.interrupt(err);
+            break;
+        }
+    }
 
-                if (buf_vec[i].seqno_g() == last)
-                {
-                    if (use_ssl_ == true)
-                    {
-                        p.send_ctrl(*ssl_stream_, Ctrl::C_EOF);
-                    }
-                    else
-                    {
-                        p.send_ctrl(socket_, Ctrl::C_EOF);
-                    }
-                    // wait until receiver closes the connection
-                    try
-                    {
-                        gu::byte_t b;
-                        size_t n;
-                        if (use_ssl_ == true)
-                        {
-                            n = asio::read(*ssl_stream_, asio::buffer(&b, 1));
-                        }
-                        else
-                        {
-                            n = asio::read(socket_, asio::buffer(&b, 1));
-                        }
-                        if (n > 0)
-                        {
-                            log_warn << "received " << n
-                                     << " bytes, expected none";
-                        }
-                    }
-                    catch (asio::system_error& e)
-                    { }
-                    return;
-                }
-            }
-            first += n_read;
-            // resize buf_vec to avoid scanning gcache past last
-            size_t next_size(std::min(static_cast<size_t>(last - first + 1),
-                                      static_cast<size_t>(1024)));
+    senders[0]->run();
 
-            if (buf_vec.size() != next_size)
-            {
-                buf_vec.resize(next_size);
-            }
+    for (size_t s(1); s < n_threads; ++s) gu_thread_join(threads[s], 0);
+
+    int         err(0);
+    std::string what;
+    uint64_t    bytes(0);
+
+    for (size_t s(0); s < n_streams; ++s)
+    {
+        if (0 == err && senders[s]->error() != 0)
+        {
+            err  = senders[s]->error();
+            what = senders[s]->what();
         }
+        bytes += senders[s]->sent();
+        delete senders[s];
     }
-    catch (asio::system_error& e)
+
+    if (n_threads < n_streams && 0 == err)
     {
-        gu_throw_error(e.code().value()) << "ist send failed: " << e.code()
-                                         << "', asio error '" << e.what()
-                                         << "'";
+        err  = EAGAIN;
+        what = "failed to start IST stream threads";
     }
-}
 
+    if (err != 0) gu_throw_error(err) << what;
+
+    double const secs(double((gu::datetime::Date::monotonic() - start).
+                             get_nsecs()) / gu::datetime::Sec);
+    log_info << "IST sent " << ra.fetched() << " events, " << bytes
+             << " bytes in " << secs << " sec ("
+             << (secs > 0 ? bytes / secs / (1 << 20) : 0.)
+             << " MB/sec) over " << n_streams << " stream(s)";
+}
 
 
 
@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2011-2017 Codership Oy <info@codership.com>
+// Copyright (C) 2011-2020 Codership Oy <info@codership.com>
 //
 
 
@@ -14,8 +14,9 @@
 #include "gu_monitor.hpp"
 #include "gu_asio.hpp"
 
-#include <stack>
+#include <deque>
 #include <set>
+#include <vector>
 
 namespace gcache
 {
@@ -36,7 +37,8 @@ namespace galera
             static std::string const RECV_ADDR;
             static std::string const RECV_BIND;
 
-            Receiver(gu::Config& conf, TrxHandle::SlavePool&, const char* addr);
+            Receiver(gu::Config& conf, TrxHandle::SlavePool&, const char* addr,
+                     gu::ThreadPool* checksum_pool = NULL);
             ~Receiver();
 
             std::string   prepare(wsrep_seqno_t, wsrep_seqno_t, int);
@@ -47,8 +49,13 @@ namespace galera
 
         private:
 
+            typedef asio::ssl::stream<asio::ip::tcp::socket> SSLStream;
+
             void interrupt();
 
+            template <class ST>
+            void run_streams();
+
             std::string                                   recv_addr_;
             std::string                                   recv_bind_;
             asio::io_service                              io_service_;
@@ -57,32 +64,15 @@ namespace galera
             gu::Mutex                                     mutex_;
             gu::Cond                                      cond_;
 
-            class Consumer
-            {
-            public:
-
-                Consumer() : cond_(), trx_(0) { }
-                ~Consumer() { }
-
-                gu::Cond&  cond()              { return cond_; }
-                void       trx(TrxHandle* trx) { trx_ = trx;   }
-                TrxHandle* trx() const         { return trx_;  }
-
-            private:
-
-                // Non-copyable
-                Consumer(const Consumer&);
-                Consumer& operator=(const Consumer&);
+            gu::Cond                                      recv_cond_;
 
-                gu::Cond   cond_;
-                TrxHandle* trx_;
-            };
-
-            std::stack<Consumer*> consumers_;
+            /* received write sets waiting for appliers, in seqno order */
+            std::deque<TrxHandle*> queue_;
             wsrep_seqno_t         current_seqno_;
             wsrep_seqno_t         last_seqno_;
             gu::Config&           conf_;
             TrxHandle::SlavePool& trx_pool_;
+            gu::ThreadPool*       checksum_pool_;
             gu_thread_t           thread_;
             int                   error_code_;
             int                   version_;
@@ -99,6 +89,8 @@ namespace galera
         {
         public:
 
+            static std::string const SEND_STREAMS;
+
             Sender(const gu::Config& conf,
                    gcache::GCache& gcache,
                    const std::string& peer,
@@ -107,24 +99,21 @@ namespace galera
 
             void send(wsrep_seqno_t first, wsrep_seqno_t last);
 
-            void cancel()
-            {
-                if (use_ssl_ == true)
-                {
-                    ssl_stream_->lowest_layer().close();
-                }
-                else
-                {
-                    socket_.close();
-                }
-            }
+            void cancel();
 
         private:
 
+            typedef asio::ssl::stream<asio::ip::tcp::socket> SSLStream;
+
+            template <class ST>
+            void send_streams(std::vector<ST*>& streams,
+                              wsrep_seqno_t first, wsrep_seqno_t last);
+
             asio::io_service                          io_service_;
-            asio::ip::tcp::socket                     socket_;
             asio::ssl::context                        ssl_ctx_;
-            asio::ssl::stream<asio::ip::tcp::socket>* ssl_stream_;
+            asio::ip::tcp::endpoint                   endpoint_;
+            std::vector<asio::ip::tcp::socket*>       sockets_;
+            std::vector<SSLStream*>                   ssl_streams_;
             const gu::Config&                         conf_;
             gcache::GCache&                           gcache_;
             int                                       version_;
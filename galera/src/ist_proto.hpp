@@ -1,5 +1,5 @@
 //
-// Copyright (C) 2011-2017 Codership Oy <info@codership.com>
+// Copyright (C) 2011-2020 Codership Oy <info@codership.com>
 //
 
 #ifndef GALERA_IST_PROTO_HPP
@@ -14,6 +14,13 @@
 #include "gu_vector.hpp"
 #include "gu_array.hpp"
 
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <poll.h>
+#define GALERA_IST_SENDFILE 1
+#endif
+
 //
 // Message class must have non-virtual destructor until
 // support up to version 3 is removed as serialization/deserialization
@@ -37,6 +44,13 @@
 // send_ctrl(EOF)            ----->
 //                          <-----   close()
 // close()
+//
+// Handshake flags carry the number of parallel streams: receiver advertises
+// how many it can accept, sender replies with how many it is going to use
+// (older peers send 0, which means 1). Each additional stream is connected
+// and handshaked the same way right after the first one. Write sets are
+// striped over streams round robin in seqno order, starting with the first
+// stream, and every stream is terminated with EOF.
 
 //
 // Note about protocol/message versioning:
@@ -195,21 +209,24 @@ namespace galera
         class Handshake : public Message
         {
         public:
-            Handshake(int version = -1)
+            Handshake(int version = -1, uint8_t flags = 0)
                 :
-                Message(version, Message::T_HANDSHAKE, 0, 0, 0)
+                Message(version, Message::T_HANDSHAKE, flags, 0, 0)
             { }
         };
 
         class HandshakeResponse : public Message
         {
         public:
-            HandshakeResponse(int version = -1)
+            HandshakeResponse(int version = -1, uint8_t flags = 0)
                 :
-                Message(version, Message::T_HANDSHAKE_RESPONSE, 0, 0, 0)
+                Message(version, Message::T_HANDSHAKE_RESPONSE, flags, 0, 0)
             { }
         };
 
+        /* maximum number of parallel streams (handshake flags) */
+        static int const MAX_STREAMS = 16;
+
         class Ctrl : public Message
         {
         public:
@@ -239,13 +256,17 @@ namespace galera
         {
         public:
 
-            Proto(TrxHandle::SlavePool& sp, int version, bool keep_keys)
+            Proto(TrxHandle::SlavePool& sp, int version, bool keep_keys,
+                  bool zero_copy = false,
+                  gu::ThreadPool* checksum_pool = NULL)
                 :
                 trx_pool_ (sp),
+                checksum_pool_(checksum_pool),
                 raw_sent_ (0),
                 real_sent_(0),
                 version_  (version),
-                keep_keys_(keep_keys)
+                keep_keys_(keep_keys),
+                zero_copy_(zero_copy)
             { }
 
             ~Proto()
@@ -262,10 +283,12 @@ namespace galera
                 }
             }
 
+            uint64_t sent() const { return real_sent_; }
+
             template <class ST>
-            void send_handshake(ST& socket)
+            void send_handshake(ST& socket, uint8_t flags = 0)
             {
-                Handshake  hs(version_);
+                Handshake  hs(version_, flags);
                 gu::Buffer buf(hs.serial_size());
                 size_t offset(hs.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0],
@@ -276,8 +299,9 @@ namespace galera
                 }
             }
 
+            /* returns handshake flags */
             template <class ST>
-            void recv_handshake(ST& socket)
+            uint8_t recv_handshake(ST& socket)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -319,12 +343,14 @@ namespace galera
                                            << version_;
                 }
                 // TODO: Figure out protocol versions to use
+
+                return msg.flags();
             }
 
             template <class ST>
-            void send_handshake_response(ST& socket)
+            void send_handshake_response(ST& socket, uint8_t flags = 0)
             {
-                HandshakeResponse hsr(version_);
+                HandshakeResponse hsr(version_, flags);
                 gu::Buffer buf(hsr.serial_size());
                 size_t offset(hsr.serialize(&buf[0], buf.size(), 0));
                 size_t n(asio::write(socket, asio::buffer(&buf[0], buf.size())));
@@ -335,8 +361,9 @@ namespace galera
                 }
             }
 
+            /* returns handshake response flags */
             template <class ST>
-            void recv_handshake_response(ST& socket)
+            uint8_t recv_handshake_response(ST& socket)
             {
                 Message    msg(version_);
                 gu::Buffer buf(msg.serial_size());
@@ -370,6 +397,8 @@ namespace galera
                     gu_throw_error(EINVAL) << "unexpected message type: "
                                            << msg.type();
                 }
+
+                return msg.flags();
             }
 
             template <class ST>
@@ -467,14 +496,10 @@ namespace galera
                                         &buf[0], buf.size(), offset);
                 cbs[0] = asio::const_buffer(&buf[0], buf.size());
 
-                if (gu_likely(payload_size))
-                {
-                    sent = asio::write(socket, cbs);
-                }
-                else
-                {
-                    sent = asio::write(socket, asio::buffer(cbs[0]));
-                }
+                sent = write_trx(socket, cbs, payload_size > 0, buffer);
+
+                raw_sent_  += buf.size() + (rolled_back ? 0 : buffer.size());
+                real_sent_ += sent;
 
                 log_debug << "sent " << sent << " bytes";
             }
@@ -547,7 +572,8 @@ namespace galera
                                 << "error reading write set data";
                         }
 
-                        trx->unserialize(&wbuf[0], wbuf.size(), 0);
+                        trx->unserialize(&wbuf[0], wbuf.size(), 0,
+                                         checksum_pool_);
                     }
 
                     if (seqno_d == WSREP_SEQNO_UNDEFINED ||
@@ -594,12 +620,145 @@ namespace galera
 
         private:
 
+            typedef gu::array<asio::const_buffer, 3>::type TrxBuffers;
+
+            template <class ST>
+            size_t write_trx(ST&                           socket,
+                             const TrxBuffers&             cbs,
+                             bool                    const payload,
+                             const gcache::GCache::Buffer& buffer)
+            {
+                if (gu_likely(payload))
+                {
+                    return asio::write(socket, cbs);
+                }
+                else
+                {
+                    return asio::write(socket, asio::buffer(cbs[0]));
+                }
+            }
+
+            /* on plain TCP sockets payload which lies in a GCache file is
+             * sent by kernel straight from page cache */
+            size_t write_trx(asio::ip::tcp::socket&        socket,
+                             const TrxBuffers&             cbs,
+                             bool                    const payload,
+                             const gcache::GCache::Buffer& buffer)
+            {
+#ifdef GALERA_IST_SENDFILE
+                if (zero_copy_ && payload && buffer.fd() >= 0)
+                {
+                    int const sock(socket.native());
+                    size_t sent(send_mem(sock, cbs[0], MSG_MORE));
+
+                    for (size_t i(1); i < cbs.size(); ++i)
+                    {
+                        size_t const len(asio::buffer_size(cbs[i]));
+                        const gu::byte_t* const ptr
+                            (asio::buffer_cast<const gu::byte_t*>(cbs[i]));
+
+                        if (0 == len) continue;
+
+                        /* gathered write set header is a modified copy */
+                        if (ptr >= buffer.ptr() &&
+                            ptr + len <= buffer.ptr() + buffer.size())
+                        {
+                            sent += send_file(sock, buffer.fd(),
+                                              buffer.offset() +
+                                              (ptr - buffer.ptr()), ptr, len);
+                        }
+                        else
+                        {
+                            sent += send_mem(sock, cbs[i], 0);
+                        }
+                    }
+
+                    return sent;
+                }
+#endif /* GALERA_IST_SENDFILE */
+                return write_trx<asio::ip::tcp::socket>(socket, cbs, payload,
+                                                        buffer);
+            }
+
+#ifdef GALERA_IST_SENDFILE
+            static void throw_errno(int const err)
+            {
+                throw asio::system_error(
+                    asio::error_code(err, asio::error::get_system_category()));
+            }
+
+            /* waits until a socket which returned EAGAIN is writable */
+            static void wait_writable(int const sock)
+            {
+                struct pollfd pfd = { sock, POLLOUT, 0 };
+                if (::poll(&pfd, 1, -1) < 0 && errno != EINTR)
+                {
+                    throw_errno(errno);
+                }
+            }
+
+            static size_t send_mem(int const sock, const asio::const_buffer& b,
+                                   int const flags)
+            {
+                const gu::byte_t* ptr(asio::buffer_cast<const gu::byte_t*>(b));
+                size_t            len(asio::buffer_size(b));
+                size_t      const ret(len);
+
+                while (len > 0)
+                {
+                    ssize_t const n(::send(sock, ptr, len,
+                                           flags | MSG_NOSIGNAL));
+                    if (n < 0)
+                    {
+                        if (EAGAIN == errno) wait_writable(sock);
+                        else if (EINTR != errno) throw_errno(errno);
+                        continue;
+                    }
+                    ptr += n;
+                    len -= n;
+                }
+
+                return ret;
+            }
+
+            /* ptr is the mapping of the file range, used as a fallback if
+             * file system does not support sendfile() */
+            static size_t send_file(int const sock, int const fd, off_t offset,
+                                    const gu::byte_t* ptr, size_t len)
+            {
+                size_t const ret(len);
+
+                while (len > 0)
+                {
+                    ssize_t const n(::sendfile(sock, fd, &offset, len));
+                    if (n < 0)
+                    {
+                        if (EAGAIN == errno) wait_writable(sock);
+                        else if (EINVAL == errno || ENOSYS == errno)
+                        {
+                            send_mem(sock, asio::const_buffer(ptr, len), 0);
+                            break;
+                        }
+                        else if (EINTR != errno) throw_errno(errno);
+                        continue;
+                    }
+                    if (0 == n) throw_errno(EPIPE);
+                    ptr += n;
+                    len -= n;
+                }
+
+                return ret;
+            }
+#endif /* GALERA_IST_SENDFILE */
+
             TrxHandle::SlavePool& trx_pool_;
+            gu::ThreadPool*       checksum_pool_;
 
             uint64_t raw_sent_;
             uint64_t real_sent_;
             int      version_;
             bool     keep_keys_;
+            bool     zero_copy_;
         };
     }
 }
@@ -435,7 +435,7 @@ KeySetOut::append (const KeyData& kd)
             }
             parent = &new_[j];
 #else
-            if (kd.copy) kp.acquire();
+            if (kd.copy) kp.acquire(parts_);
             if (i + 1 != kd.parts_num)
                 tmp = kp; // <- updating parent for next iteration
 #endif /* CHECK_PREVIOUS_KEY */
@@ -468,7 +468,7 @@ KeySetOut::append (const KeyData& kd)
     if (kd.copy)
         for (int k(anc + 1); size_t(k) < prev_.size(); ++k)
         {
-            prev_[k].acquire();
+            prev_[k].acquire(parts_);
         }
 #endif /* CHECK_PREVIOUS_KEY */
 
@@ -134,7 +134,7 @@ public:
          * version */
         static int prefix(wsrep_key_type_t const ws_type, int const ws_ver)
         {
-            if (ws_ver >= 0 && ws_ver <= 4)
+            if (ws_ver >= 0 && ws_ver <= 5)
             {
                 switch (ws_type)
                 {
@@ -159,7 +159,7 @@ public:
 
         wsrep_key_type_t wsrep_type(int const ws_ver) const
         {
-            assert(ws_ver >= 0 && ws_ver <= 4);
+            assert(ws_ver >= 0 && ws_ver <= 5);
 
             wsrep_key_type_t ret;
 
@@ -169,10 +169,10 @@ public:
                 ret = WSREP_KEY_SHARED;
                 break;
             case 1:
-                ret = ws_ver == 4 ? WSREP_KEY_SEMI : WSREP_KEY_EXCLUSIVE;
+                ret = ws_ver >= 4 ? WSREP_KEY_SEMI : WSREP_KEY_EXCLUSIVE;
                 break;
             case 2:
-                assert(ws_ver == 4);
+                assert(ws_ver >= 4);
                 ret = WSREP_KEY_EXCLUSIVE;
                 break;
             default:
@@ -556,6 +556,40 @@ public:
     };
 #endif /* 1 */
 
+    /* Bump allocator for copies of volatile key parts: memory is never
+     * returned to it and goes away together with the key set. */
+    class PartStore
+    {
+    public:
+
+        PartStore (gu::byte_t* const ptr = 0, size_t const size = 0)
+            : ptr_(ptr), left_(size), used_(0)
+        {}
+
+        /* returns 0 if there is not enough space left */
+        gu::byte_t*
+        alloc (size_t const size)
+        {
+            used_ += size;
+
+            if (gu_unlikely(size > left_)) return 0;
+
+            gu::byte_t* const ret(ptr_);
+            ptr_  += size;
+            left_ -= size;
+            return ret;
+        }
+
+        /* total size requested, including what did not fit */
+        size_t used() const { return used_; }
+
+    private:
+
+        gu::byte_t* ptr_;
+        size_t      left_;
+        size_t      used_;
+    };
+
     class KeyPart
     {
     public:
@@ -621,12 +655,15 @@ public:
         int
         prefix() const { return (part_ ? part_->prefix() : 0); }
 
+        /* copies the value to the store or, if it is full, to the heap */
         void
-        acquire()
+        acquire(PartStore& store)
         {
-            gu::byte_t* tmp = new gu::byte_t[size_];
+            gu::byte_t* tmp = store.alloc(size_);
+            own_ = (0 == tmp);
+            if (own_) tmp = new gu::byte_t[size_];
             std::copy(value_, value_ + size_, tmp);
-            value_ = tmp; own_ = true;
+            value_ = tmp;
         }
 
         void
@@ -667,6 +704,7 @@ public:
         added_(),
         prev_ (),
         new_  (),
+        parts_(),
         version_()
     {}
 
@@ -675,7 +713,9 @@ public:
                const BaseName&         base_name,
                KeySet::Version const   version,
                gu::RecordSet::Version const rsv,
-               int const               ws_ver)
+               int const               ws_ver,
+               gu::byte_t*             part_store      = 0,
+               size_t                  part_store_size = 0)
         :
         gu::RecordSetOut<KeySet::KeyPart> (
             reserved,
@@ -687,12 +727,13 @@ public:
         added_(),
         prev_ (),
         new_  (),
+        parts_(part_store, part_store_size),
         version_(version),
         ws_ver_(ws_ver)
     {
         assert (version_ != KeySet::EMPTY);
         assert ((uintptr_t(reserved) % GU_WORD_BYTES) == 0);
-        assert (ws_ver <= 4);
+        assert (ws_ver <= 5);
         KeyPart zero(version_);
         prev_().push_back(zero);
     }
@@ -705,12 +746,17 @@ public:
     KeySet::Version
     version () { return count() ? version_ : KeySet::EMPTY; }
 
+    /* total size of key part copies */
+    size_t
+    part_store_used () const { return parts_.used(); }
+
 private:
 
     // depending on version we may pack data differently
     KeyParts              added_;
     gu::Vector<KeyPart,5> prev_;
     gu::Vector<KeyPart,5> new_;
+    PartStore             parts_;
     KeySet::Version       version_;
     int                   ws_ver_;
 
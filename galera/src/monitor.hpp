@@ -8,6 +8,7 @@
 #include "trx_handle.hpp"
 #include <gu_lock.hpp> // for gu::Mutex and gu::Cond
 #include <gu_limits.h>
+#include <gu_atomic.h>
 
 #include <vector>
 
@@ -46,7 +47,12 @@ namespace galera
 
     public:
 
-        Monitor()
+        // In group mode a process which enters the monitor takes along all
+        // consecutive processes waiting behind it, so that they can leave
+        // together. Within a group processes may leave in any order, only
+        // the next group waits for the whole previous one. Makes sense only
+        // for in-order conditions.
+        explicit Monitor(bool const group = false)
             :
             mutex_(),
             cond_(),
@@ -54,11 +60,15 @@ namespace galera
             last_left_(-1),
             drain_seqno_(GU_LLONG_MAX),
             process_(new Process[process_size_]),
+            waiting_(0),
             entered_(0),
             oooe_(0),
             oool_(0),
             win_size_(0),
-            waits_(0)
+            waits_(0),
+            group_(group),
+            groups_(0),
+            grouped_(0)
         { }
 
         ~Monitor()
@@ -69,6 +79,12 @@ namespace galera
                 log_info << "mon: entered " << entered_
                          << " oooe fraction " << double(oooe_)/entered_
                          << " oool fraction " << double(oool_)/entered_;
+                if (groups_ > 0)
+                {
+                    log_info << "mon: groups " << groups_
+                             << " avg group size "
+                             << double(groups_ + grouped_)/groups_;
+                }
             }
             else
             {
@@ -82,7 +98,8 @@ namespace galera
             if (last_entered_ == -1 || seqno == -1)
             {
                 // first call or reset
-                last_entered_ = last_left_ = seqno;
+                last_entered_ = seqno;
+                set_last_left(seqno);
             }
             else
             {
@@ -114,6 +131,7 @@ namespace galera
 
                 process_[idx].state_ = Process::S_WAITING;
                 process_[idx].obj_   = &obj;
+                ++waiting_;
 
 #ifdef GU_DBUG_ON
                 obj.debug_sync(mutex_);
@@ -132,7 +150,12 @@ namespace galera
                     assert(process_[idx].state_ == Process::S_WAITING ||
                            process_[idx].state_ == Process::S_APPLYING);
 
-                    process_[idx].state_ = Process::S_APPLYING;
+                    if (process_[idx].state_ == Process::S_WAITING)
+                    {
+                        --waiting_;
+                        process_[idx].state_ = Process::S_APPLYING;
+                        enter_group(obj_seqno);
+                    }
 
                     ++entered_;
                     oooe_     += ((last_left_ + 1) < obj_seqno);
@@ -215,6 +238,11 @@ namespace galera
                  obj.seqno()          >  last_left_ ) ||
                 process_[idx].state_ == Process::S_WAITING )
             {
+                if (process_[idx].state_ == Process::S_WAITING)
+                {
+                    assert(waiting_ > 0);
+                    --waiting_;
+                }
                 process_[idx].state_ = Process::S_CANCELED;
                 process_[idx].cond_.signal();
                 // since last_left + 1 cannot be <= S_WAITING we're not
@@ -229,10 +257,13 @@ namespace galera
             }
         }
 
+        // does not take the mutex: last_left_ is always updated atomically
+        // and callers can't rely on it not moving after return anyway
         wsrep_seqno_t last_left()   const
         {
-            gu::Lock lock(mutex_);
-            return last_left_;
+            wsrep_seqno_t ret;
+            gu_atomic_get(&last_left_, &ret);
+            return ret;
         }
         ssize_t       size()        const { return process_size_; }
 
@@ -262,6 +293,8 @@ namespace galera
 
         void wait(wsrep_seqno_t seqno)
         {
+            if (last_left() >= seqno) return;
+
             gu::Lock lock(mutex_);
             if (last_left_ < seqno)
             {
@@ -272,6 +305,8 @@ namespace galera
 
         void wait(wsrep_seqno_t seqno, const gu::datetime::Date& wait_until)
         {
+            if (last_left() >= seqno) return;
+
             gu::Lock lock(mutex_);
             if (last_left_ < seqno)
             {
@@ -302,6 +337,7 @@ namespace galera
         {
             gu::Lock lock(mutex_);
             oooe_ = 0; oool_ = 0; win_size_ = 0; entered_ = 0; waits_ = 0;
+            groups_ = 0; grouped_ = 0;
         }
 
     private:
@@ -343,7 +379,7 @@ namespace galera
                 if (Process::S_FINISHED == a.state_)
                 {
                     a.state_   = Process::S_IDLE;
-                    last_left_ = i;
+                    set_last_left(i);
                     a.wait_cond_.broadcast();
                 }
                 else
@@ -354,13 +390,22 @@ namespace galera
             assert(last_left_ <= last_entered_);
         }
 
+        // Scans the window only as far as the last waiting process: with no
+        // waiters leave() does not depend on the window size.
         void wake_up_next()
         {
-            for (wsrep_seqno_t i = last_left_ + 1; i <= last_entered_; ++i)
+            long to_visit(waiting_);
+
+            for (wsrep_seqno_t i = last_left_ + 1;
+                 to_visit > 0 && i <= last_entered_; ++i)
             {
                 Process& a(process_[indexof(i)]);
-                if (a.state_           == Process::S_WAITING &&
-                    may_enter(*a.obj_) == true)
+
+                if (a.state_ != Process::S_WAITING) continue;
+
+                --to_visit;
+
+                if (may_enter(*a.obj_) == true)
                 {
                     // We need to set state to APPLYING here because if
                     // it is  the last_left_ + 1 and it gets canceled in
@@ -368,11 +413,51 @@ namespace galera
                     // there will be  nobody to clean up and advance
                     // last_left_.
                     a.state_ = Process::S_APPLYING;
+                    --waiting_;
                     a.cond_.signal();
+
+                    to_visit -= enter_group(i);
                 }
             }
         }
 
+        // In group mode lets in the waiting processes that immediately
+        // follow the one that has just entered. Finished (self-canceled)
+        // processes don't break the group. Returns the number of processes
+        // let in.
+        long enter_group(wsrep_seqno_t const seqno)
+        {
+            if (!group_) return 0;
+
+            long ret(0);
+
+            for (wsrep_seqno_t i = seqno + 1; i <= last_entered_; ++i)
+            {
+                Process& a(process_[indexof(i)]);
+
+                if (a.state_ == Process::S_FINISHED) continue;
+                if (a.state_ != Process::S_WAITING)  break;
+
+                a.state_ = Process::S_APPLYING;
+                --waiting_;
+                a.cond_.signal();
+                ++ret;
+            }
+
+            if (ret > 0)
+            {
+                ++groups_;
+                grouped_ += ret;
+            }
+
+            return ret;
+        }
+
+        void set_last_left(wsrep_seqno_t const seqno)
+        {
+            gu_atomic_set(&last_left_, &seqno);
+        }
+
         void post_leave(const C& obj, gu::Lock& lock)
         {
             const wsrep_seqno_t obj_seqno(obj.seqno());
@@ -381,7 +466,7 @@ namespace galera
             if (last_left_ + 1 == obj_seqno) // we're shrinking window
             {
                 process_[idx].state_ = Process::S_IDLE;
-                last_left_           = obj_seqno;
+                set_last_left(obj_seqno);
                 process_[idx].wait_cond_.broadcast();
 
                 update_last_left();
@@ -437,9 +522,15 @@ namespace galera
         gu::Mutex mutex_;
         gu::Cond  cond_;
         wsrep_seqno_t last_entered_;
+#if !defined(__ATOMIC_RELAXED)
+        // implementation of gu_atomic_get() via __sync_fetch_and_or()
+        // is not read-only for GCC
+        mutable
+#endif
         wsrep_seqno_t last_left_;
         wsrep_seqno_t drain_seqno_;
         Process*      process_;
+        long          waiting_; // number of processes in S_WAITING state
         long entered_;  // entered
         long oooe_;     // out of order entered
         long oool_;     // out of order left
@@ -447,6 +538,9 @@ namespace galera
         // Total number of waits in the monitor. Incremented before
         // entering into waiting state.
         long long waits_;
+        bool const group_;
+        long groups_;  // groups of two or more entered in group mode
+        long grouped_; // processes that entered along with group leader
     };
 }
 
@@ -95,7 +95,8 @@ namespace galera
                                             int                 rcode) = 0;
 
         // action source interface
-        virtual void process_trx(void* recv_ctx, TrxHandle* trx) = 0;
+        virtual void process_trx(void* recv_ctx, TrxHandle* trx,
+                                 bool& exit_loop) = 0;
         virtual void process_commit_cut(wsrep_seqno_t seq,
                                         wsrep_seqno_t seqno_l) = 0;
         virtual void process_conf_change(void*                    recv_ctx,
@@ -15,6 +15,57 @@
 #include <sstream>
 #include <iostream>
 
+/* Upper limit on the number of write set checksum threads */
+static int const CHECKSUM_THREADS_MAX(256);
+
+static size_t
+checksum_threads(const gu::Config& conf, const std::string& key)
+{
+    int const ret(conf.get<int>(key));
+
+    if (ret < 0 || ret > CHECKSUM_THREADS_MAX)
+    {
+        gu_throw_error(EINVAL) << "Bad value " << ret << " for '" << key
+                               << "': must be between 0 and "
+                               << CHECKSUM_THREADS_MAX;
+    }
+
+    return ret;
+}
+
+static size_t
+dispatch_window(const gu::Config& conf, const std::string& key)
+{
+    long const ret(conf.get<long>(key));
+
+    if (ret < 0)
+    {
+        gu_throw_error(EINVAL) << "Bad value " << ret << " for '" << key
+                               << "': must not be negative";
+    }
+
+    return ret;
+}
+
+/* Upper limit on the size of local trx arena */
+static size_t const TRX_ARENA_SIZE_MAX(1 << 24);
+
+static size_t
+trx_arena_size(const gu::Config& conf, const std::string& key)
+{
+    long long const val(conf.get<long long>(key));
+
+    if (val < 0 || val > ssize_t(TRX_ARENA_SIZE_MAX))
+    {
+        gu_throw_error(EINVAL) << "Bad value " << val << " for '" << key
+                               << "': must be between 0 and "
+                               << TRX_ARENA_SIZE_MAX;
+    }
+
+    // smaller values are rounded up to the default
+    return std::max(gu_page_size_multiple(val),
+                    galera::TrxHandle::LOCAL_STORAGE_SIZE());
+}
 
 static void
 apply_trx_ws(void*                    recv_ctx,
@@ -160,17 +211,24 @@ galera::ReplicatorSMM::ReplicatorSMM(const struct wsrep_init_args* args)
     gcs_                (config_, gcache_, proto_max_, args->proto_ver,
                          args->node_name, args->node_incoming),
     service_thd_        (gcs_, gcache_),
+    checksum_pool_      (checksum_threads(config_, Param::checksum_threads)),
     slave_pool_         (sizeof(TrxHandle), 1024, "SlaveTrxHandle"),
     as_                 (0),
-    gcs_as_             (slave_pool_, gcs_, *this, gcache_),
-    ist_receiver_       (config_, slave_pool_, args->node_address),
+    gcs_as_             (slave_pool_, gcs_, *this, gcache_, checksum_pool_),
+    ist_receiver_       (config_, slave_pool_, args->node_address,
+                         &checksum_pool_),
     ist_senders_        (gcs_, gcache_),
-    wsdb_               (),
+    wsdb_               (trx_arena_size(config_, Param::trx_arena_size)),
     cert_               (config_, service_thd_),
     local_monitor_      (),
     apply_monitor_      (),
-    commit_monitor_     (),
+    commit_monitor_     (co_mode_ == CommitOrder::GROUP),
     causal_read_timeout_(config_.get(Param::causal_read_timeout)),
+    causal_             (),
+    causal_mutex_       (),
+    causal_latency_     ("0.0,0.0005,0.001,0.002,0.005,0.01,0.02,0.05,0.1,"
+                         "0.5,1.,5."),
+    dispatch_queue_     (dispatch_window(config_, Param::dispatch_window)),
     receivers_          (),
     replicated_         (),
     replicated_bytes_   (),
@@ -631,7 +689,7 @@ wsrep_status_t galera::ReplicatorSMM::replicate(TrxHandle* trx,
     if (trx->new_version())
     {
         gu_trace(trx->unserialize(static_cast<const gu::byte_t*>(act.buf),
-                                  act.size, 0));
+                                  act.size, 0, &checksum_pool_));
         trx->update_stats(keys_count_, keys_bytes_, data_bytes_, unrd_bytes_);
     }
 
@@ -978,13 +1036,15 @@ wsrep_status_t galera::ReplicatorSMM::post_rollback(TrxHandle* trx)
 
 wsrep_status_t galera::ReplicatorSMM::causal_read(wsrep_gtid_t* gtid)
 {
+    gu::datetime::Date const start(gu::datetime::Date::monotonic());
     wsrep_seqno_t cseq;
     gu::datetime::Date wait_until(gu::datetime::Date::calendar() +
                                   causal_read_timeout_);
 
     try
     {
-        gcs_.caused(cseq, wait_until);
+        CausalRoundTrip caused(gcs_);
+        causal_.seqno(cseq, wait_until, caused);
         assert(cseq >= 0);
     }
     catch (gu::Exception& e)
@@ -1017,6 +1077,12 @@ wsrep_status_t galera::ReplicatorSMM::causal_read(wsrep_gtid_t* gtid)
             gtid->seqno = cseq;
         }
         ++causal_reads_;
+
+        double const latency(double((gu::datetime::Date::monotonic() -
+                                     start).get_nsecs())/gu::datetime::Sec);
+        gu::Lock lock(causal_mutex_);
+        causal_latency_.insert(latency);
+
         return WSREP_OK;
     }
     catch (gu::Exception& e)
@@ -1120,7 +1186,11 @@ writeset_from_handle (wsrep_po_handle_t& handle,
                 /* key format is not essential since we're not adding keys */
                 KeySet::version(trx_params.key_format_), NULL, 0, 0,
                 trx_params.record_set_ver_,
-                WriteSetNG::MAX_VERSION, DataSet::MAX_VERSION, DataSet::MAX_VERSION,
+                WriteSetNG::MAX_VERSION,
+                WriteSetNG::max_data_set_version(
+                    WriteSetNG::Version(trx_params.version_)),
+                WriteSetNG::max_data_set_version(
+                    WriteSetNG::Version(trx_params.version_)),
                 trx_params.max_write_set_size_);
 
             handle.opaque = ret;
@@ -1239,7 +1309,9 @@ galera::ReplicatorSMM::sst_sent(const wsrep_gtid_t& state_id, int const rcode)
 }
 
 
-void galera::ReplicatorSMM::process_trx(void* recv_ctx, TrxHandle* trx)
+void galera::ReplicatorSMM::process_trx(void*      recv_ctx,
+                                        TrxHandle* trx,
+                                        bool&      exit_loop)
 {
     assert(recv_ctx != 0);
     assert(trx != 0);
@@ -1251,23 +1323,16 @@ void galera::ReplicatorSMM::process_trx(void* recv_ctx, TrxHandle* trx)
 
     wsrep_status_t const retval(cert_and_catch(trx));
 
+    exit_loop = false;
+
     switch (retval)
     {
     case WSREP_OK:
-        try
-        {
-            gu_trace(apply_trx(recv_ctx, trx));
-        }
-        catch (std::exception& e)
-        {
-            st_.mark_corrupt();
-
-            log_fatal << "Failed to apply trx: " << *trx;
-            log_fatal << e.what();
-            log_fatal << "Node consistency compromised, aborting...";
-            abort();
-        }
+    {
+        DispatchApplier applier(*this, recv_ctx);
+        exit_loop = dispatch_queue_.dispatch(trx, applier);
         break;
+    }
     case WSREP_TRX_FAIL:
         // certification failed, apply monitor has been canceled
         trx->set_state(TrxHandle::S_ABORTING);
@@ -1282,6 +1347,24 @@ void galera::ReplicatorSMM::process_trx(void* recv_ctx, TrxHandle* trx)
 }
 
 
+void galera::ReplicatorSMM::apply_certified(void* recv_ctx, TrxHandle* trx)
+{
+    try
+    {
+        gu_trace(apply_trx(recv_ctx, trx));
+    }
+    catch (std::exception& e)
+    {
+        st_.mark_corrupt();
+
+        log_fatal << "Failed to apply trx: " << *trx;
+        log_fatal << e.what();
+        log_fatal << "Node consistency compromised, aborting...";
+        abort();
+    }
+}
+
+
 void galera::ReplicatorSMM::process_commit_cut(wsrep_seqno_t seq,
                                                wsrep_seqno_t seqno_l)
 {
@@ -1345,6 +1428,12 @@ void galera::ReplicatorSMM::establish_protocol_versions (int proto_ver)
         trx_params_.record_set_ver_ = gu::RecordSet::VER2;
         str_proto_ver_ = 2;
         break;
+    case 10:
+        // Protocol upgrade to enable CRC32C data set checksums.
+        trx_params_.version_ = 5;
+        trx_params_.record_set_ver_ = gu::RecordSet::VER2;
+        str_proto_ver_ = 2;
+        break;
     default:
         log_fatal << "Configuration change resulted in an unsupported protocol "
             "version: " << proto_ver << ". Can't continue.";
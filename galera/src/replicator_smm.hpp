@@ -23,10 +23,13 @@
 #include "galera_service_thd.hpp"
 #include "fsm.hpp"
 #include "gcs_action_source.hpp"
+#include "dispatch_queue.hpp"
+#include "causal_coalescer.hpp"
 #include "ist.hpp"
 #include "gu_atomic.hpp"
 #include "saved_state.hpp"
 #include "gu_debug_sync.hpp"
+#include "gu_histogram.hpp"
 
 
 #include <map>
@@ -75,6 +78,7 @@ namespace galera
 
         void discard_local_trx(TrxHandle* trx)
         {
+            wsdb_.update_arena_peak(trx->arena_size());
             trx->release_write_set_out();
             wsdb_.discard_trx(trx->trx_id());
         }
@@ -117,7 +121,8 @@ namespace galera
                                     size_t              state_len,
                                     int                 rcode);
 
-        void process_trx(void* recv_ctx, TrxHandle* trx);
+        void process_trx(void* recv_ctx, TrxHandle* trx, bool& exit_loop);
+        void apply_certified(void* recv_ctx, TrxHandle* trx);
         void process_commit_cut(wsrep_seqno_t seq, wsrep_seqno_t seqno_l);
         void process_conf_change(void* recv_ctx,
                                  const wsrep_view_info_t& view,
@@ -172,6 +177,9 @@ namespace galera
             static const std::string commit_order;
             static const std::string causal_read_timeout;
             static const std::string max_write_set_size;
+            static const std::string checksum_threads;
+            static const std::string dispatch_window;
+            static const std::string trx_arena_size;
         };
 
         typedef std::pair<std::string, std::string> Default;
@@ -310,7 +318,8 @@ namespace galera
                 BYPASS     = 0,
                 OOOC       = 1,
                 LOCAL_OOOC = 2,
-                NO_OOOC    = 3
+                NO_OOOC    = 3,
+                GROUP      = 4
             } Mode;
 
             static Mode from_string(const std::string& str)
@@ -322,6 +331,7 @@ namespace galera
                 case OOOC:
                 case LOCAL_OOOC:
                 case NO_OOOC:
+                case GROUP:
                     break;
                 default:
                     gu_throw_error(EINVAL)
@@ -353,6 +363,8 @@ namespace galera
                     return trx_.is_local();
                     // in case of remote trx fall through
                 case NO_OOOC:
+                case GROUP: // the rest of the group enters with the first
+                            // and commits out of order within the group
                     return (last_left + 1 == trx_.global_seqno());
                 }
                 gu_throw_fatal << "invalid commit mode value " << mode_;
@@ -391,6 +403,51 @@ namespace galera
         };
 
     private:
+        // applies trxs from dispatch_queue_, see DispatchQueue::dispatch()
+        class DispatchApplier
+        {
+        public:
+
+            DispatchApplier(ReplicatorSMM& repl, void* recv_ctx)
+                :
+                repl_    (repl),
+                recv_ctx_(recv_ctx)
+            { }
+
+            wsrep_seqno_t last_left() const
+            {
+                return repl_.apply_monitor_.last_left();
+            }
+
+            void apply(TrxHandle* trx)
+            {
+                repl_.apply_certified(recv_ctx_, trx);
+            }
+
+        private:
+            DispatchApplier(const DispatchApplier&);
+            ReplicatorSMM& repl_;
+            void* const    recv_ctx_;
+        };
+
+        // gcs_caused() round trip for causal_
+        class CausalRoundTrip
+        {
+        public:
+
+            CausalRoundTrip(GcsI& gcs) : gcs_(gcs) { }
+
+            void operator()(wsrep_seqno_t& seqno,
+                            gu::datetime::Date& wait_until)
+            {
+                gcs_.caused(seqno, wait_until);
+            }
+
+        private:
+            CausalRoundTrip(const CausalRoundTrip&);
+            GcsI& gcs_;
+        };
+
         // state machine
         class Transition
         {
@@ -495,6 +552,7 @@ namespace galera
          * |                 7 |           3 |              2 |               1 |
          * |                 8 |           3 |              2 |               2 |
          * |                 9 |           4 |              2 |               2 |
+         * |                10 |           5 |              2 |               2 |
          * |--------------------------------------------------------------------|
          */
 
@@ -553,6 +611,8 @@ namespace galera
         gcache::GCache gcache_;
         GCS_IMPL       gcs_;
         ServiceThd     service_thd_;
+        // must outlive all slave trx handles
+        gu::ThreadPool checksum_pool_;
 
         // action sources
         TrxHandle::SlavePool slave_pool_;
@@ -571,6 +631,14 @@ namespace galera
         Monitor<CommitOrder> commit_monitor_;
         gu::datetime::Period causal_read_timeout_;
 
+        // causal read round trip coalescing
+        CausalCoalescer       causal_;
+        gu::Mutex             causal_mutex_;
+        gu::Histogram         causal_latency_;  // protected by causal_mutex_
+
+        // certified slave trxs waiting for dependencies
+        DispatchQueue         dispatch_queue_;
+
         // counters
         gu::Atomic<size_t>    receivers_;
         gu::Atomic<long long> replicated_;
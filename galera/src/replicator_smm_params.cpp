@@ -24,8 +24,14 @@ const std::string galera::ReplicatorSMM::Param::key_format =
     common_prefix + "key_format";
 const std::string galera::ReplicatorSMM::Param::max_write_set_size =
     common_prefix + "max_ws_size";
+const std::string galera::ReplicatorSMM::Param::checksum_threads =
+    common_prefix + "checksum_threads";
+const std::string galera::ReplicatorSMM::Param::dispatch_window =
+    common_prefix + "dispatch_window";
+const std::string galera::ReplicatorSMM::Param::trx_arena_size =
+    common_prefix + "trx_arena_size";
 
-int const galera::ReplicatorSMM::MAX_PROTO_VER(9);
+int const galera::ReplicatorSMM::MAX_PROTO_VER(10);
 
 galera::ReplicatorSMM::Defaults::Defaults() : map_()
 {
@@ -38,6 +44,9 @@ galera::ReplicatorSMM::Defaults::Defaults() : map_()
     const int max_write_set_size(galera::WriteSetNG::MAX_SIZE);
     map_.insert(Default(Param::max_write_set_size,
                         gu::to_string(max_write_set_size)));
+    map_.insert(Default(Param::checksum_threads, "2"));
+    map_.insert(Default(Param::dispatch_window, "0"));
+    map_.insert(Default(Param::trx_arena_size, "8K"));
 }
 
 const galera::ReplicatorSMM::Defaults galera::ReplicatorSMM::defaults;
@@ -157,7 +166,10 @@ void
 galera::ReplicatorSMM::set_param (const std::string& key,
                                   const std::string& value)
 {
-    if (key == Param::commit_order)
+    if (key == Param::commit_order ||
+        key == Param::checksum_threads ||
+        key == Param::dispatch_window ||
+        key == Param::trx_arena_size)
     {
         log_error << "setting '" << key << "' during runtime not allowed";
         gu_throw_error(EPERM)
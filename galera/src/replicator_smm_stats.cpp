@@ -109,6 +109,7 @@ typedef enum status_vars
     STATS_APPLY_OOOL,
     STATS_APPLY_WINDOW,
     STATS_APPLY_WAITS,
+    STATS_DISPATCH_QUEUE,
     STATS_COMMIT_OOOE,
     STATS_COMMIT_OOOL,
     STATS_COMMIT_WINDOW,
@@ -116,9 +117,22 @@ typedef enum status_vars
     STATS_LOCAL_STATE_COMMENT,
     STATS_CERT_INDEX_SIZE,
     STATS_CAUSAL_READS,
+    STATS_CAUSAL_ROUND_TRIPS,
+    STATS_CAUSAL_COALESCING,
     STATS_CERT_INTERVAL,
+    STATS_CERT_PURGE_LAG,
+    STATS_CERT_PURGE_NS,
     STATS_OPEN_TRX,
     STATS_OPEN_CONN,
+    STATS_TRX_ARENA_PEAK,
+    STATS_GCACHE_RECOVER_NS,
+    STATS_GCACHE_PAGE_ALLOCS,
+    STATS_GCACHE_PAGE_REUSES,
+    STATS_GCACHE_PAGE_ALLOC_NS,
+    STATS_GCACHE_RB_PAGE_SIZE,
+    STATS_GCACHE_COMPRESS_RATIO,
+    STATS_GCACHE_COMPRESS_NS,
+    STATS_GCACHE_DECOMPRESS_NS,
     STATS_INCOMING_LIST,
     STATS_MAX
 } StatusVars;
@@ -160,6 +174,7 @@ static const struct wsrep_stats_var wsrep_stats[STATS_MAX + 1] =
     { "apply_oool",               WSREP_VAR_DOUBLE, { 0 }  },
     { "apply_window",             WSREP_VAR_DOUBLE, { 0 }  },
     { "apply_waits",              WSREP_VAR_INT64,  { 0 }  },
+    { "dispatch_queue",           WSREP_VAR_INT64,  { 0 }  },
     { "commit_oooe",              WSREP_VAR_DOUBLE, { 0 }  },
     { "commit_oool",              WSREP_VAR_DOUBLE, { 0 }  },
     { "commit_window",            WSREP_VAR_DOUBLE, { 0 }  },
@@ -167,9 +182,22 @@ static const struct wsrep_stats_var wsrep_stats[STATS_MAX + 1] =
     { "local_state_comment",      WSREP_VAR_STRING, { 0 }  },
     { "cert_index_size",          WSREP_VAR_INT64,  { 0 }  },
     { "causal_reads",             WSREP_VAR_INT64,  { 0 }  },
+    { "causal_round_trips",       WSREP_VAR_INT64,  { 0 }  },
+    { "causal_coalescing",        WSREP_VAR_DOUBLE, { 0 }  },
     { "cert_interval",            WSREP_VAR_DOUBLE, { 0 }  },
+    { "cert_purge_lag",           WSREP_VAR_INT64,  { 0 }  },
+    { "cert_purge_ns",            WSREP_VAR_INT64,  { 0 }  },
     { "open_transactions",        WSREP_VAR_INT64,  { 0 }  },
     { "open_connections",         WSREP_VAR_INT64,  { 0 }  },
+    { "trx_arena_peak",           WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_recover_ns",        WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_page_allocs",       WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_page_reuses",       WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_page_alloc_ns",     WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_rb_page_size",      WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_compress_ratio",    WSREP_VAR_DOUBLE, { 0 }  },
+    { "gcache_compress_ns",       WSREP_VAR_INT64,  { 0 }  },
+    { "gcache_decompress_ns",     WSREP_VAR_INT64,  { 0 }  },
     { "incoming_addresses",       WSREP_VAR_STRING, { 0 }  },
     { 0,                          WSREP_VAR_STRING, { 0 }  }
 };
@@ -241,6 +269,13 @@ galera::ReplicatorSMM::stats_get() const
     sv[STATS_CERT_INTERVAL       ].value._double = avg_cert_interval;
     sv[STATS_CERT_INDEX_SIZE     ].value._int64  = index_size;
 
+    long long purge_lag(0);
+    long long purge_time(0);
+    cert_.purge_stats_get(purge_lag, purge_time);
+
+    sv[STATS_CERT_PURGE_LAG      ].value._int64  = purge_lag;
+    sv[STATS_CERT_PURGE_NS       ].value._int64  = purge_time;
+
     double oooe;
     double oool;
     double win;
@@ -251,6 +286,7 @@ galera::ReplicatorSMM::stats_get() const
     sv[STATS_APPLY_OOOL          ].value._double = oool;
     sv[STATS_APPLY_WINDOW        ].value._double = win;
     sv[STATS_APPLY_WAITS         ].value._int64 = waits;
+    sv[STATS_DISPATCH_QUEUE      ].value._int64 = dispatch_queue_.size();
     commit_monitor_.get_stats(&oooe, &oool, &win, &waits);
 
     sv[STATS_COMMIT_OOOE         ].value._double = oooe;
@@ -262,14 +298,38 @@ galera::ReplicatorSMM::stats_get() const
                                                                    sst_state_);
     sv[STATS_CAUSAL_READS].value._int64    = causal_reads_();
 
+    long long const causal_round_trips(causal_.round_trips());
+    sv[STATS_CAUSAL_ROUND_TRIPS].value._int64  = causal_round_trips;
+    sv[STATS_CAUSAL_COALESCING ].value._double = causal_round_trips > 0 ?
+        double(causal_reads_()) / causal_round_trips : 0.0;
+
     Wsdb::stats wsdb_stats(wsdb_.get_stats());
     sv[STATS_OPEN_TRX].value._int64 = wsdb_stats.n_trx_;
     sv[STATS_OPEN_CONN].value._int64 = wsdb_stats.n_conn_;
+    sv[STATS_TRX_ARENA_PEAK].value._int64 = wsdb_stats.arena_peak_;
+    sv[STATS_GCACHE_RECOVER_NS].value._int64 = gcache_.recover_time();
+
+    gcache::PageStore::Stats const page_stats(gcache_.page_stats());
+    sv[STATS_GCACHE_PAGE_ALLOCS  ].value._int64 = page_stats.page_allocs;
+    sv[STATS_GCACHE_PAGE_REUSES  ].value._int64 = page_stats.page_reuses;
+    sv[STATS_GCACHE_PAGE_ALLOC_NS].value._int64 = page_stats.page_alloc_ns;
+    sv[STATS_GCACHE_RB_PAGE_SIZE ].value._int64 = gcache_.rb_page_size();
+
+    gcache::GCache::CompressStats const cstats(gcache_.compress_stats());
+    sv[STATS_GCACHE_COMPRESS_RATIO].value._double =
+        cstats.compressed_bytes > 0 ?
+        double(cstats.raw_bytes) / cstats.compressed_bytes : 0.0;
+    sv[STATS_GCACHE_COMPRESS_NS  ].value._int64 = cstats.compress_ns;
+    sv[STATS_GCACHE_DECOMPRESS_NS].value._int64 = cstats.decompress_ns;
 
 
     // Get gcs backend status
     gu::Status status;
     gcs_.get_status(status);
+    {
+        gu::Lock lock(causal_mutex_);
+        status.insert("causal_latency_histogram", causal_latency_.to_string());
+    }
 #ifdef GU_DBUG_ON
     status.insert("debug_sync_waiters", gu_debug_sync_waiters());
 #endif // GU_DBUG_ON
@@ -359,7 +419,14 @@ galera::ReplicatorSMM::stats_reset()
 
     commit_monitor_.flush_stats();
 
+    {
+        gu::Lock lock(causal_mutex_);
+        causal_latency_.clear();
+    }
+
     cert_.stats_reset();
+
+    wsdb_.reset_arena_peak();
 }
 
 void
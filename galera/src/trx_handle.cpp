@@ -194,7 +194,8 @@ galera::TrxHandle::serialize(gu::byte_t* buf, size_t buflen, size_t offset)const
 
 size_t
 galera::TrxHandle::unserialize(const gu::byte_t* const buf, size_t const buflen,
-                               size_t offset)
+                               size_t offset,
+                               gu::ThreadPool* const checksum_pool)
 {
     try
     {
@@ -231,7 +232,8 @@ galera::TrxHandle::unserialize(const gu::byte_t* const buf, size_t const buflen,
             break;
         case 3:
         case 4:
-            write_set_in_.read_buf (buf, buflen);
+        case 5:
+            write_set_in_.read_buf (buf, buflen, checksum_pool);
             write_set_flags_ = wsng_flags_to_trx_flags(write_set_in_.flags());
             source_id_       = write_set_in_.source_id();
             conn_id_         = write_set_in_.conn_id();
@@ -627,7 +627,21 @@ namespace galera
 
         size_t serial_size() const;
         size_t serialize  (gu::byte_t* buf, size_t buflen, size_t offset) const;
-        size_t unserialize(const gu::byte_t* buf, size_t buflen, size_t offset);
+        /* checksum_pool - see WriteSetIn */
+        size_t unserialize(const gu::byte_t* buf, size_t buflen, size_t offset,
+                           gu::ThreadPool* checksum_pool = NULL);
+
+        /* memory used by local trx: the handle itself, write set and its
+         * contents, whether it fit in the pool buffer or not */
+        size_t arena_size() const
+        {
+            size_t ret(sizeof(TrxHandle));
+            if (wso_)
+            {
+                ret += sizeof(WriteSetOut) + write_set_out().alloc_size();
+            }
+            return ret;
+        }
 
         void release_write_set_out()
         {
@@ -743,8 +757,10 @@ namespace galera
                                        0,
                                        params.record_set_ver_,
                                        WriteSetNG::Version(params.version_),
-                                       DataSet::MAX_VERSION,
-                                       DataSet::MAX_VERSION,
+                                       WriteSetNG::max_data_set_version(
+                                           WriteSetNG::Version(params.version_)),
+                                       WriteSetNG::max_data_set_version(
+                                           WriteSetNG::Version(params.version_)),
                                        params.max_write_set_size_);
             }
         }
@@ -189,9 +189,8 @@ const char WriteSetOut::data_suffix[] = "_data";
 const char WriteSetOut::unrd_suffix[] = "_unrd";
 const char WriteSetOut::annt_suffix[] = "_annt";
 
-
 void
-WriteSetIn::init (ssize_t const st)
+WriteSetIn::init (ssize_t const st, gu::ThreadPool* const pool)
 {
     assert(false == check_thr_);
 
@@ -205,26 +204,15 @@ WriteSetIn::init (ssize_t const st)
     if (kver != KeySet::EMPTY) gu_trace(keys_.init (kver, pptr, psize));
 
     assert (false == check_);
-    assert (false == check_thr_);
 
     if (gu_likely(st > 0)) /* checksum enforced */
     {
-        if (size_ >= st)
+        if (size_ >= st && pool != NULL && pool->size() > 0)
         {
             /* buffer too big, start checksumming in background */
-            int const err(gu_thread_create (&check_thr_id_, NULL,
-                                            checksum_thread, this));
-
-            if (gu_likely(0 == err))
-            {
-                check_thr_ = true;
-                return;
-            }
-
-            log_warn << "Starting checksum thread failed: " << err
-                     << '(' << ::strerror(err) << ')';
-
-            /* fall through to checksum in foreground */
+            check_job_.submit(*pool);
+            check_thr_ = true;
+            return;
         }
 
         checksum();
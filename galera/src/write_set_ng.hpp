@@ -20,13 +20,12 @@
 
 #include "gu_serialize.hpp"
 #include "gu_vector.hpp"
+#include "gu_thread_pool.hpp"
 
 #include <vector>
 #include <string>
 #include <iomanip>
 
-#include <gu_threads.h>
-
 namespace galera
 {
     class WriteSetNG
@@ -38,11 +37,12 @@ namespace galera
         enum Version
         {
             VER3 = 3,
-            VER4
+            VER4,
+            VER5
         };
 
         /* Max header version that we can understand */
-        static Version const MAX_VERSION = VER4;
+        static Version const MAX_VERSION = VER5;
 
         /* Parses beginning of the header to detect writeset version and
          * returns it as raw integer for backward compatibility
@@ -89,11 +89,19 @@ namespace galera
             {
             case VER3: return VER3;
             case VER4: return VER4;
+            case VER5: return VER5;
             }
 
             gu_throw_error (EPROTO) << "Unrecognized writeset version: " << v;
         }
 
+        /* Max data set version that can be used with a given writeset version:
+         * CRC32C data set checksums are understood only since VER5 */
+        static DataSet::Version max_data_set_version(Version const ver)
+        {
+            return (ver >= VER5 ? DataSet::VER2 : DataSet::VER1);
+        }
+
         /* These flags should be fixed to wire protocol version and so
          * technically can't be initialized to WSREP_FLAG_xxx macros as the
          * latter may arbitrarily change. */
@@ -134,6 +142,7 @@ namespace galera
                 {
                 case VER3:
                 case VER4:
+                case VER5:
                 {
                     GU_COMPILE_ASSERT(0 == (V3_SIZE % GU_MIN_ALIGNMENT),
                                       unaligned_header_size);
@@ -496,17 +505,20 @@ namespace galera
             :
             header_(ver),
             base_name_(dir_name, id),
-            /* 1/8 of reserved (aligned by 8) goes to key set  */
+            /* last 1/8 of reserved goes to key part copies,
+             * 1/8 of the rest goes to key set */
             kbn_   (base_name_),
-            keys_  (reserved,
-                    (reserved_size >>= 6, reserved_size <<= 3, reserved_size),
-                    kbn_, kver, rsv, ver),
-            /* 5/8 of reserved goes to data set  */
+            keys_  (reserved, eighth(rsets_size(reserved_size)), kbn_, kver,
+                    rsv, ver, reserved + rsets_size(reserved_size),
+                    eighth(reserved_size)),
+            /* 5/8 of the rest goes to data set  */
             dbn_   (base_name_),
-            data_  (reserved + reserved_size, reserved_size*5, dbn_, dver, rsv),
-            /* 2/8 of reserved goes to unordered set  */
+            data_  (reserved + eighth(rsets_size(reserved_size)),
+                    eighth(rsets_size(reserved_size))*5, dbn_, dver, rsv),
+            /* 2/8 of the rest goes to unordered set  */
             ubn_   (base_name_),
-            unrd_  (reserved + reserved_size*6, reserved_size*2, ubn_, uver,rsv),
+            unrd_  (reserved + eighth(rsets_size(reserved_size))*6,
+                    eighth(rsets_size(reserved_size))*2, ubn_, uver, rsv),
             /* annotation set is not allocated unless requested */
             abn_   (base_name_),
             annt_  (NULL),
@@ -538,7 +550,9 @@ namespace galera
         {
             if (NULL == annt_)
             {
-                annt_ = new DataSetOut(NULL, 0, abn_, DataSet::MAX_VERSION,
+                annt_ = new DataSetOut(NULL, 0, abn_,
+                                       WriteSetNG::max_data_set_version(
+                                           header_.version()),
                                        // use the same version as the dataset
                                        data_.gu::RecordSet::version());
                 left_ -= annt_->size();
@@ -593,6 +607,15 @@ namespace galera
             header_.set_last_seen(ls);
         }
 
+        /* memory taken by stored write set contents, in reserved buffer
+         * or beyond it */
+        size_t alloc_size() const
+        {
+            return (keys_.alloc_size() + keys_.part_store_used() +
+                    data_.alloc_size() + unrd_.alloc_size() +
+                    (annt_ ? annt_->alloc_size() : 0));
+        }
+
         void set_preordered (ssize_t pa_range)
         {
             assert (pa_range >= 0);
@@ -658,6 +681,15 @@ namespace galera
         ssize_t             left_;
         uint16_t            flags_;
 
+        /* 1/8 of reserved size, aligned by 8 */
+        static size_t eighth(size_t const size) { return (size >> 6) << 3; }
+
+        /* reserved size left for record sets after key part copies */
+        static size_t rsets_size(size_t const size)
+        {
+            return size - eighth(size);
+        }
+
         void check_size()
         {
             if (gu_unlikely(left_ < 0))
@@ -674,18 +706,24 @@ namespace galera
     {
     public:
 
-        WriteSetIn (const gu::Buf& buf, ssize_t const st = SIZE_THRESHOLD)
+        /* checksum_pool - threads to checksum writesets of st bytes or more
+         *                 in background. NULL or a pool without threads
+         *                 makes checksumming synchronous. The pool must
+         *                 outlive the writeset. */
+        WriteSetIn (const gu::Buf&        buf,
+                    ssize_t         const st            = SIZE_THRESHOLD,
+                    gu::ThreadPool* const checksum_pool = NULL)
             : header_(buf),
               size_  (buf.size),
               keys_  (),
               data_  (),
               unrd_  (),
               annt_  (NULL),
-              check_thr_id_(),
+              check_job_(*this),
               check_thr_(false),
               check_ (false)
         {
-            gu_trace(init(st));
+            gu_trace(init(st, checksum_pool));
         }
 
         WriteSetIn ()
@@ -695,28 +733,31 @@ namespace galera
               data_  (),
               unrd_  (),
               annt_  (NULL),
-              check_thr_id_(),
+              check_job_(*this),
               check_thr_(false),
               check_ (false)
         {}
 
         /* WriteSetIn(buf) == WriteSetIn() + read_buf(buf) */
-        void read_buf (const gu::Buf& buf, ssize_t const st = SIZE_THRESHOLD)
+        void read_buf (const gu::Buf&        buf,
+                       ssize_t         const st            = SIZE_THRESHOLD,
+                       gu::ThreadPool* const checksum_pool = NULL)
         {
             assert (0 == size_);
             assert (false == check_);
 
             header_.read_buf (buf);
             size_ = buf.size;
-            gu_trace(init(st));
+            gu_trace(init(st, checksum_pool));
         }
 
-        void read_buf (const gu::byte_t* const ptr, ssize_t const len)
+        void read_buf (const gu::byte_t* const ptr, ssize_t const len,
+                       gu::ThreadPool*   const checksum_pool = NULL)
         {
             assert (ptr != NULL);
             assert (len >= 0);
             gu::Buf tmp = { ptr, len };
-            read_buf (tmp);
+            read_buf (tmp, SIZE_THRESHOLD, checksum_pool);
         }
 
         ~WriteSetIn ()
@@ -724,7 +765,7 @@ namespace galera
             if (gu_unlikely(check_thr_))
             {
                 /* checksum was performed in a parallel thread */
-                gu_thread_join (check_thr_id_, NULL);
+                check_job_.wait();
             }
 
             delete annt_;
@@ -760,7 +801,7 @@ namespace galera
             if (gu_unlikely(check_thr_))
             {
                 /* checksum was performed in a parallel thread */
-                gu_thread_join (check_thr_id_, NULL);
+                check_job_.wait();
                 check_thr_ = false;
                 gu_trace(checksum_fin());
             }
@@ -794,14 +835,36 @@ namespace galera
 
     private:
 
+        class ChecksumJob : public gu::ThreadPool::Job
+        {
+        public:
+
+            explicit ChecksumJob (WriteSetIn& ws) : ws_(ws), pool_(NULL) {}
+
+            void run() { ws_.checksum(); }
+
+            void submit(gu::ThreadPool& pool)
+            {
+                pool_ = &pool;
+                pool_->submit(*this);
+            }
+
+            void wait() { pool_->wait(*this); }
+
+        private:
+
+            WriteSetIn&     ws_;
+            gu::ThreadPool* pool_;
+        };
+
         WriteSetNG::Header header_;
         ssize_t            size_;
         KeySetIn           keys_;
         DataSetIn          data_;
         DataSetIn          unrd_;
         DataSetIn*         annt_;
-        gu_thread_t        check_thr_id_;
-        bool mutable       check_thr_;
+        mutable ChecksumJob check_job_;
+        mutable bool       check_thr_; /* check_job_ was submitted */
         bool               check_;
 
         static size_t const SIZE_THRESHOLD = 1 << 22; /* 4Mb */
@@ -816,15 +879,8 @@ namespace galera
             }
         }
 
-        static void* checksum_thread (void* arg)
-        {
-            WriteSetIn* ws(reinterpret_cast<WriteSetIn*>(arg));
-            ws->checksum();
-            return NULL;
-        }
-
         /* late initialization after default constructor */
-        void init (ssize_t size_threshold);
+        void init (ssize_t size_threshold, gu::ThreadPool* checksum_pool);
 
         WriteSetIn (const WriteSetIn&);
         WriteSetIn& operator=(WriteSetIn);
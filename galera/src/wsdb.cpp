@@ -31,13 +31,14 @@ void galera::Wsdb::print(std::ostream& os) const
 }
 
 
-galera::Wsdb::Wsdb()
+galera::Wsdb::Wsdb(size_t const trx_arena_size)
     :
-    trx_pool_  (TrxHandle::LOCAL_STORAGE_SIZE(), 512, "LocalTrxHandle"),
+    trx_pool_  (trx_arena_size, 512, "LocalTrxHandle"),
     trx_map_   (),
     trx_mutex_ (),
     conn_map_  (),
-    conn_mutex_()
+    conn_mutex_(),
+    arena_peak_(0)
 {}
 
 
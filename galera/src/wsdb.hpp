@@ -78,29 +78,46 @@ namespace galera
 
         void discard_conn_query(wsrep_conn_id_t conn_id);
 
-        Wsdb();
+        /* trx_arena_size - size of pool buffer allocated for each local trx:
+         * it holds TrxHandle, WriteSetOut and reserved space for its
+         * contents */
+        explicit Wsdb(size_t trx_arena_size = TrxHandle::LOCAL_STORAGE_SIZE());
         ~Wsdb();
 
         void print(std::ostream& os) const;
 
         struct stats
         {
-            stats(size_t n_trx, size_t n_conn)
+            stats(size_t n_trx, size_t n_conn, size_t arena_peak)
                 : n_trx_(n_trx)
                 , n_conn_(n_conn)
+                , arena_peak_(arena_peak)
             { }
             size_t n_trx_;
             size_t n_conn_;
+            size_t arena_peak_;
         };
 
         stats get_stats() const
         {
             gu::Lock trx_lock(trx_mutex_);
             gu::Lock conn_lock(conn_mutex_);
-            stats ret(trx_map_.size(), conn_map_.size());
+            stats ret(trx_map_.size(), conn_map_.size(), arena_peak_());
             return ret;
         }
 
+        // accounts memory used by local trx for arena peak stats
+        void update_arena_peak(size_t const size)
+        {
+            if (gu_unlikely(size > arena_peak_()))
+            {
+                gu::Lock lock(trx_mutex_);
+                if (size > arena_peak_()) arena_peak_ = size;
+            }
+        }
+
+        void reset_arena_peak() { arena_peak_ = 0; }
+
     private:
         // Find existing trx handle in the map
         TrxHandle* find_trx(wsrep_trx_id_t trx_id);
@@ -120,6 +137,7 @@ namespace galera
         gu::Mutex    trx_mutex_;
         ConnMap      conn_map_;
         gu::Mutex    conn_mutex_;
+        gu::Atomic<size_t> arena_peak_;
     };
 
     inline std::ostream& operator<<(std::ostream& os, const Wsdb& w)
@@ -0,0 +1,306 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "../src/causal_coalescer.hpp"
+
+#include <gu_threads.h>
+
+#include <check.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace
+{
+    /* Round trip which returns its number as causal seqno or fails with
+     * a given error. Blocks until released by the test. */
+    class TestRoundTrip
+    {
+    public:
+
+        TestRoundTrip() : mutex_(), cond_(), calls_(0), released_(0), errs_()
+        { }
+
+        void operator()(wsrep_seqno_t& seqno, gu::datetime::Date&)
+        {
+            gu::Lock lock(mutex_);
+
+            long long const call(++calls_);
+            cond_.broadcast();
+
+            while (released_ < call) lock.wait(cond_);
+
+            if (size_t(call) <= errs_.size() && errs_[call - 1] != 0)
+            {
+                gu_throw_error(errs_[call - 1]);
+            }
+
+            seqno = call;
+        }
+
+        // round trip number n fails with err
+        void set_error(long long const n, int const err)
+        {
+            gu::Lock lock(mutex_);
+            if (errs_.size() < size_t(n)) errs_.resize(n, 0);
+            errs_[n - 1] = err;
+        }
+
+        // returns false if there were less than n calls in 10 seconds
+        bool wait_calls(long long const n)
+        {
+            gu::datetime::Date const until(gu::datetime::Date::calendar() +
+                                           gu::datetime::Period("PT10S"));
+            gu::Lock lock(mutex_);
+
+            try
+            {
+                while (calls_ < n) lock.wait(cond_, until);
+            }
+            catch (gu::Exception&) {}
+
+            return (calls_ >= n);
+        }
+
+        void release(long long const n)
+        {
+            gu::Lock lock(mutex_);
+            released_ = n;
+            cond_.broadcast();
+        }
+
+        long long calls() const
+        {
+            gu::Lock lock(mutex_);
+            return calls_;
+        }
+
+    private:
+
+        gu::Mutex mutable mutex_;
+        gu::Cond          cond_;
+        long long         calls_;
+        long long         released_;
+        std::vector<int>  errs_;
+    };
+
+    /* causal read issued from a separate thread */
+    struct TestRead
+    {
+        TestRead(galera::CausalCoalescer& causal, TestRoundTrip& caused,
+                 const gu::datetime::Period& timeout)
+            :
+            causal_    (causal),
+            caused_    (caused),
+            wait_until_(gu::datetime::Date::calendar() + timeout),
+            seqno_     (WSREP_SEQNO_UNDEFINED),
+            err_       (0),
+            thd_       ()
+        { }
+
+        galera::CausalCoalescer& causal_;
+        TestRoundTrip&           caused_;
+        gu::datetime::Date       wait_until_;
+        wsrep_seqno_t            seqno_;
+        int                      err_;
+        gu_thread_t              thd_;
+    };
+}
+
+extern "C" void* causal_read_thread(void* arg)
+{
+    TestRead* const read(static_cast<TestRead*>(arg));
+
+    try
+    {
+        read->causal_.seqno(read->seqno_, read->wait_until_, read->caused_);
+    }
+    catch (gu::Exception& e)
+    {
+        read->err_ = e.get_errno();
+    }
+
+    return 0;
+}
+
+static void
+causal_read_start(TestRead& read)
+{
+    ck_assert(0 == gu_thread_create(&read.thd_, NULL, causal_read_thread,
+                                    &read));
+}
+
+static void
+causal_read_join(TestRead& read)
+{
+    gu_thread_join(read.thd_, NULL);
+}
+
+#define TEST_PAUSE 100000 // 100ms for reads to start waiting
+
+/* Starts the first read, which leads the first round trip, and then n more
+ * reads while the first round trip is in flight */
+static void
+causal_reads_start(galera::CausalCoalescer& causal, TestRoundTrip& caused,
+                   const gu::datetime::Period& first_timeout,
+                   std::vector<TestRead*>& reads, size_t const n)
+{
+    reads.push_back(new TestRead(causal, caused, first_timeout));
+    causal_read_start(*reads.back());
+    ck_assert(caused.wait_calls(1));
+
+    for (size_t i(0); i < n; ++i)
+    {
+        reads.push_back(new TestRead(causal, caused,
+                                     gu::datetime::Period("PT1M")));
+        causal_read_start(*reads.back());
+    }
+
+    usleep(TEST_PAUSE);
+}
+
+static void
+causal_reads_join(std::vector<TestRead*>& reads)
+{
+    for (size_t i(0); i < reads.size(); ++i)
+    {
+        causal_read_join(*reads[i]);
+    }
+}
+
+static void
+causal_reads_delete(std::vector<TestRead*>& reads)
+{
+    for (size_t i(0); i < reads.size(); ++i) delete reads[i];
+    reads.clear();
+}
+
+/* reads issued while a round trip is in flight share the next one */
+START_TEST(causal_coalescer_share)
+{
+    galera::CausalCoalescer causal;
+    TestRoundTrip caused;
+    std::vector<TestRead*> reads;
+
+    causal_reads_start(causal, caused, gu::datetime::Period("PT1M"),
+                       reads, 4);
+    ck_assert(1 == caused.calls());
+
+    caused.release(1);
+    ck_assert(caused.wait_calls(2));
+    usleep(TEST_PAUSE);
+    ck_assert(2 == caused.calls());
+
+    caused.release(2);
+    causal_reads_join(reads);
+
+    ck_assert(2 == caused.calls());
+    ck_assert(2 == causal.round_trips());
+
+    ck_assert(0 == reads[0]->err_);
+    ck_assert(1 == reads[0]->seqno_);
+    for (size_t i(1); i < reads.size(); ++i)
+    {
+        ck_assert_msg(0 == reads[i]->err_, "read %zu: %d", i, reads[i]->err_);
+        ck_assert_msg(2 == reads[i]->seqno_, "read %zu: seqno %lld", i,
+                      (long long)reads[i]->seqno_);
+    }
+
+    causal_reads_delete(reads);
+}
+END_TEST
+
+/* round trip times out at the deadline of the read which started it, but
+ * reads with later deadlines sharing it start a new one */
+START_TEST(causal_coalescer_timeout)
+{
+    galera::CausalCoalescer causal;
+    TestRoundTrip caused;
+    std::vector<TestRead*> reads;
+
+    caused.set_error(2, ETIMEDOUT);
+
+    causal_reads_start(causal, caused, gu::datetime::Period("PT1M"),
+                       reads, 4);
+
+    // read with short deadline shares the second round trip, which
+    // completes after the deadline, no matter which read started it
+    reads.push_back(new TestRead(causal, caused,
+                                 gu::datetime::Period("PT0.3S")));
+    causal_read_start(*reads.back());
+    usleep(TEST_PAUSE);
+
+    caused.release(1);
+    ck_assert(caused.wait_calls(2));
+    usleep(4 * TEST_PAUSE);
+    caused.release(2);
+    ck_assert(caused.wait_calls(3));
+    usleep(TEST_PAUSE);
+    caused.release(3);
+    causal_reads_join(reads);
+
+    ck_assert(3 == caused.calls());
+    ck_assert(3 == causal.round_trips());
+
+    ck_assert(0 == reads[0]->err_);
+    ck_assert(1 == reads[0]->seqno_);
+    for (size_t i(1); i < reads.size() - 1; ++i)
+    {
+        ck_assert_msg(0 == reads[i]->err_, "read %zu: %d", i, reads[i]->err_);
+        ck_assert_msg(3 == reads[i]->seqno_, "read %zu: seqno %lld", i,
+                      (long long)reads[i]->seqno_);
+    }
+    ck_assert_msg(ETIMEDOUT == reads.back()->err_, "err: %d",
+                  reads.back()->err_);
+
+    causal_reads_delete(reads);
+}
+END_TEST
+
+/* other errors are returned to all reads sharing the round trip */
+START_TEST(causal_coalescer_error)
+{
+    galera::CausalCoalescer causal;
+    TestRoundTrip caused;
+    std::vector<TestRead*> reads;
+
+    caused.set_error(2, ENOTCONN);
+
+    causal_reads_start(causal, caused, gu::datetime::Period("PT1M"),
+                       reads, 4);
+
+    caused.release(1);
+    ck_assert(caused.wait_calls(2));
+    usleep(TEST_PAUSE);
+    caused.release(3);
+    causal_reads_join(reads);
+
+    ck_assert(2 == caused.calls());
+    ck_assert(2 == causal.round_trips());
+
+    ck_assert(0 == reads[0]->err_);
+    ck_assert(1 == reads[0]->seqno_);
+    for (size_t i(1); i < reads.size(); ++i)
+    {
+        ck_assert_msg(ENOTCONN == reads[i]->err_, "read %zu: %d", i,
+                      reads[i]->err_);
+    }
+
+    causal_reads_delete(reads);
+}
+END_TEST
+
+Suite* causal_coalescer_suite()
+{
+    Suite* s = suite_create ("causal_coalescer");
+    TCase* tc;
+
+    tc = tcase_create ("causal_coalescer");
+    tcase_add_test  (tc, causal_coalescer_share);
+    tcase_add_test  (tc, causal_coalescer_timeout);
+    tcase_add_test  (tc, causal_coalescer_error);
+    suite_add_tcase (s, tc);
+
+    return s;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark certification throughput with different number of
+ * certification index shards (cert.index_shards).
+ *
+ * Usage: certification_bench [trxs] [keys per trx] [key space]
+ *                            [cert.parallel_keys]
+ */
+
+#include "test_trx.hpp"
+
+#include "../src/certification.hpp"
+#include "../src/galera_service_thd.hpp"
+#include "../src/replicator_smm.hpp"
+
+#include <sys/time.h>
+#include <iostream>
+#include <cstdlib>
+
+static double time_diff(const struct timeval& l,
+                        const struct timeval& r)
+{
+    double const left(double(l.tv_usec)*1.0e-06 + l.tv_sec);
+    double const right(double(r.tv_usec)*1.0e-06 + r.tv_sec);
+    return left - right;
+}
+
+static const char* const GCACHE_NAME = "certification_bench.gcache";
+
+/* Certification marks write set buffers certified in place, so they can't be
+ * reused between runs */
+static void
+prepare(std::vector<TestWriteSet>& ws, int const trxs, int const keys,
+        int const key_space)
+{
+    wsrep_uuid_t const source(test_source());
+
+    ws.clear();
+    ws.reserve(trxs);
+
+    ::srand(trxs);
+    for (int i(0); i < trxs; ++i)
+    {
+        int const begin(::rand() % (key_space - keys + 1));
+        ws.push_back(TestWriteSet(source, i + 1, i,
+                                  test_keys(begin, begin + keys)));
+    }
+}
+
+static double
+bench(const std::vector<TestWriteSet>& ws, const char* const index_shards,
+      const char* const parallel_keys)
+{
+    gu::Config conf;
+    galera::ReplicatorSMM::InitConfig init(conf, NULL, NULL);
+    conf.set("gcache.name", GCACHE_NAME);
+    conf.set("gcache.size", "1M");
+    conf.set("cert.index_shards", index_shards);
+    if (parallel_keys) conf.set("cert.parallel_keys", parallel_keys);
+
+    double ret;
+    {
+        gcache::GCache     gcache(conf, ".");
+        galera::DummyGcs   gcs(conf, gcache);
+        galera::ServiceThd thd(gcs, gcache);
+        TrxHandle::SlavePool pool(sizeof(TrxHandle), 1024,
+                                  "certification_bench");
+
+        galera::Certification cert(conf, thd);
+        cert.assign_initial_position(0, WriteSetNG::MAX_VERSION);
+
+        struct timeval start, stop;
+        gettimeofday(&start, NULL);
+
+        for (size_t i(0); i < ws.size(); ++i)
+        {
+            wsrep_seqno_t const seqno(i + 1);
+            TrxHandle* const trx(ws[i].trx(pool, seqno));
+
+            cert.append_trx(trx);
+
+            wsrep_seqno_t const purge(cert.set_trx_committed(trx));
+            trx->mark_committed();
+            trx->unref();
+
+            if (purge > 0) cert.purge_trxs_upto(purge, false);
+        }
+
+        cert.purge_trxs_upto(cert.position(), false);
+
+        gettimeofday(&stop, NULL);
+        ret = time_diff(stop, start);
+    }
+
+    ::unlink(GCACHE_NAME);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    int const trxs     (argc > 1 ? ::atoi(argv[1]) : 20000);
+    int const keys     (argc > 2 ? ::atoi(argv[2]) : 256);
+    int const key_space(argc > 3 ? ::atoi(argv[3]) : 1000000);
+    const char* const parallel_keys(argc > 4 ? argv[4] : NULL);
+
+    if (trxs <= 0 || keys <= 0 || key_space < keys)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [trxs] [keys per trx] [key space]"
+                     " [cert.parallel_keys]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    gu_crc32c_configure(); // normally done by gu_init()
+
+    std::cout << "Certifying " << trxs << " write sets of " << keys
+              << " keys each" << std::endl;
+
+    const char* const shards[] = { "1", "2", "4", "8" };
+    std::vector<TestWriteSet> ws;
+
+    for (size_t i(0); i < sizeof(shards)/sizeof(shards[0]); ++i)
+    {
+        prepare(ws, trxs, keys, key_space);
+        double const t(bench(ws, shards[i], parallel_keys));
+        std::cout << "index_shards: " << shards[i]
+                  << "\ttime: " << t << " sec"
+                  << "\ttrx/sec: " << trxs/t << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
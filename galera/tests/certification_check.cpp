@@ -0,0 +1,332 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "test_trx.hpp"
+
+#include "../src/certification.hpp"
+#include "../src/galera_service_thd.hpp"
+#include "../src/replicator_smm.hpp"
+
+#include <check.h>
+
+namespace
+{
+    class TestEnv
+    {
+        class GCache_setup
+        {
+        public:
+            GCache_setup(gu::Config& conf) : name_("certification_check.gcache")
+            {
+                conf.set("gcache.name", name_);
+                conf.set("gcache.size", "1M");
+                conf.set("gcache.page_size", "1M");
+            }
+
+            ~GCache_setup()
+            {
+                unlink(name_.c_str());
+            }
+        private:
+            std::string const name_;
+        };
+
+    public:
+
+        TestEnv(const char* const index_shards,
+                const char* const purge_batch = "256") :
+            conf_   (),
+            init_   (conf_, NULL, NULL),
+            gcache_setup_(conf_),
+            gcache_ (conf_, "."),
+            gcs_    (conf_, gcache_),
+            thd_    (gcs_, gcache_),
+            pool_   (sizeof(TrxHandle), 16, "certification_check")
+        {
+            conf_.set("cert.index_shards", index_shards);
+            conf_.set("cert.purge_batch", purge_batch);
+        }
+
+        gu::Config&           conf()   { return conf_;   }
+        gcache::GCache&       gcache() { return gcache_; }
+        galera::ServiceThd&   thd()    { return thd_;    }
+        TrxHandle::SlavePool& pool()   { return pool_;   }
+
+    private:
+
+        gu::Config       conf_;
+        galera::ReplicatorSMM::InitConfig init_;
+        GCache_setup     gcache_setup_;
+        gcache::GCache   gcache_;
+        galera::DummyGcs gcs_;
+        galera::ServiceThd   thd_;
+        TrxHandle::SlavePool pool_;
+    };
+}
+
+using namespace galera;
+
+/* Certification results must not depend on index sharding and on whether
+ * the key set was processed serially or in parallel */
+static void
+test_certification_shards(const char* const index_shards,
+                          const char* const parallel_keys = "128")
+{
+    TestEnv env(index_shards);
+    env.conf().set("cert.parallel_keys", parallel_keys);
+
+    wsrep_uuid_t const node1(test_source());
+    wsrep_uuid_t const node2(test_source());
+
+    /* must outlive certification, which refers to write set buffers */
+    std::vector<TestWriteSet> ws;
+    // big key sets for parallel certification
+    ws.push_back(TestWriteSet(node1, 1, 0, test_keys(0, 200)));
+    ws.push_back(TestWriteSet(node2, 2, 0, test_keys(150, 350)));
+    ws.push_back(TestWriteSet(node2, 3, 1, test_keys(100, 300)));
+    // small key sets for serial certification
+    ws.push_back(TestWriteSet(node1, 4, 3, test_keys(299, 301)));
+    ws.push_back(TestWriteSet(node2, 5, 3, test_keys(299, 300)));
+
+    Certification::TestResult const expected[] =
+    {
+        Certification::TEST_OK,
+        Certification::TEST_FAILED, // did not see 1
+        Certification::TEST_OK,     // saw 1
+        Certification::TEST_OK,     // saw 3
+        Certification::TEST_FAILED, // did not see 4
+    };
+    wsrep_seqno_t const expected_depends[] = { 0, -1, 1, 3, -1 };
+
+    Certification cert(env.conf(), env.thd());
+    cert.assign_initial_position(0, WriteSetNG::MAX_VERSION);
+
+    std::vector<TrxHandle*> trxs;
+
+    for (size_t i(0); i < ws.size(); ++i)
+    {
+        wsrep_seqno_t const seqno(i + 1);
+        TrxHandle* const trx(ws[i].trx(env.pool(), seqno));
+        trxs.push_back(trx);
+
+        Certification::TestResult const res(cert.append_trx(trx));
+        ck_assert_msg(res == expected[i],
+                      "index_shards: %s, seqno %lld: expected %d, got %d",
+                      index_shards, (long long)seqno, expected[i], res);
+        ck_assert_msg(trx->depends_seqno() == expected_depends[i],
+                      "index_shards: %s, seqno %lld: expected depends %lld, "
+                      "got %lld", index_shards, (long long)seqno,
+                      (long long)expected_depends[i],
+                      (long long)trx->depends_seqno());
+    }
+
+    for (size_t i(0); i < trxs.size(); ++i)
+    {
+        cert.set_trx_committed(trxs[i]);
+        trxs[i]->mark_committed();
+    }
+
+    cert.purge_trxs_upto(cert.position(), false);
+    ck_assert(cert.get_trx(1) == 0);
+
+    for (size_t i(0); i < trxs.size(); ++i) trxs[i]->unref();
+}
+
+START_TEST(test_certification_single_shard)
+{
+    test_certification_shards("1");
+}
+END_TEST
+
+START_TEST(test_certification_multi_shard)
+{
+    test_certification_shards("4");
+}
+END_TEST
+
+/* all key sets are certified in parallel */
+START_TEST(test_certification_multi_shard_parallel)
+{
+    test_certification_shards("4", "1");
+}
+END_TEST
+
+/* Index entries of purged trxs must be gone after purge, no matter if it
+ * was done synchronously or in background */
+static void
+test_certification_purge(const char* const purge_batch)
+{
+    TestEnv env("2", purge_batch);
+
+    wsrep_uuid_t const node1(test_source());
+    wsrep_uuid_t const node2(test_source());
+
+    int const n_trxs(10);
+
+    std::vector<TestWriteSet> ws;
+    for (int i(0); i < n_trxs; ++i)
+    {
+        ws.push_back(TestWriteSet(node1, i + 1, i,
+                                  test_keys(i * 10, i * 10 + 10)));
+    }
+    // conflicts only with trxs which are not purged
+    ws.push_back(TestWriteSet(node2, n_trxs + 1, 0,
+                              test_keys(0, (n_trxs - 1) * 10)));
+    ws.push_back(TestWriteSet(node2, n_trxs + 2, 0,
+                              test_keys((n_trxs - 1) * 10, n_trxs * 10)));
+
+    Certification cert(env.conf(), env.thd());
+    cert.assign_initial_position(0, WriteSetNG::MAX_VERSION);
+
+    std::vector<TrxHandle*> trxs;
+
+    for (int i(0); i < n_trxs; ++i)
+    {
+        TrxHandle* const trx(ws[i].trx(env.pool(), i + 1));
+        trxs.push_back(trx);
+        ck_assert(cert.append_trx(trx) == Certification::TEST_OK);
+    }
+
+    for (int i(0); i < n_trxs; ++i)
+    {
+        cert.set_trx_committed(trxs[i]);
+        trxs[i]->mark_committed();
+    }
+
+    // safe to discard seqno is the last seen seqno of the last trx
+    cert.purge_trxs_upto(n_trxs, false);
+    ck_assert(cert.get_trx(n_trxs - 1) == 0);
+    TrxHandle* const last(cert.get_trx(n_trxs));
+    ck_assert(last == trxs[n_trxs - 1]);
+    last->unref();
+
+    // certification result must not depend on background purge progress,
+    // so don't wait for it
+    for (int i(n_trxs); i < n_trxs + 2; ++i)
+    {
+        TrxHandle* const trx(ws[i].trx(env.pool(), i + 1));
+        trxs.push_back(trx);
+    }
+
+    ck_assert(cert.append_trx(trxs[n_trxs]) == Certification::TEST_OK);
+    ck_assert(cert.append_trx(trxs[n_trxs + 1]) ==
+              Certification::TEST_FAILED);
+
+    long long purge_lag(0);
+    long long purge_time(0);
+    for (int i(0); i < 10000; ++i)
+    {
+        cert.purge_stats_get(purge_lag, purge_time);
+        if (0 == purge_lag) break;
+        usleep(1000);
+    }
+    ck_assert_msg(0 == purge_lag, "purge lag: %lld", purge_lag);
+
+    for (size_t i(0); i < trxs.size(); ++i) trxs[i]->unref();
+}
+
+START_TEST(test_certification_purge_sync)
+{
+    test_certification_purge("0");
+}
+END_TEST
+
+START_TEST(test_certification_purge_background)
+{
+    test_certification_purge("4");
+}
+END_TEST
+
+/* GCache is released up to purged seqno as background purge advances, it
+ * does not wait for the next purge request, which may never come if the
+ * cluster is idle */
+START_TEST(test_certification_purge_gcache)
+{
+    TestEnv env("2", "1");
+    gcache::GCache& gcache(env.gcache());
+
+    wsrep_uuid_t const node(test_source());
+
+    int const n_trxs(8);
+
+    std::vector<TestWriteSet> ws;
+    for (int i(0); i < n_trxs; ++i)
+    {
+        ws.push_back(TestWriteSet(node, i + 1, i,
+                                  test_keys(i * 10, i * 10 + 10)));
+        // bigger than ring buffer: goes to page store, which discards
+        // buffers as soon as they are released
+        void* const buf(gcache.malloc(3 << 19));
+        ck_assert(buf != 0);
+        gcache.seqno_assign(buf, i + 1, i);
+    }
+    ck_assert(gcache.seqno_min() == 1);
+
+    Certification cert(env.conf(), env.thd());
+    cert.assign_initial_position(0, WriteSetNG::MAX_VERSION);
+
+    std::vector<TrxHandle*> trxs;
+
+    for (int i(0); i < n_trxs; ++i)
+    {
+        TrxHandle* const trx(ws[i].trx(env.pool(), i + 1));
+        trxs.push_back(trx);
+        ck_assert(cert.append_trx(trx) == Certification::TEST_OK);
+    }
+
+    for (int i(0); i < n_trxs; ++i)
+    {
+        cert.set_trx_committed(trxs[i]);
+        trxs[i]->mark_committed();
+    }
+
+    // safe to discard seqno is the last seen seqno of the last trx
+    cert.purge_trxs_upto(n_trxs, true);
+
+    for (int i(0); i < 10000 && gcache.seqno_min() < n_trxs; ++i)
+    {
+        usleep(1000);
+    }
+    ck_assert_msg(gcache.seqno_min() == n_trxs, "seqno_min: %lld",
+                  (long long)gcache.seqno_min());
+
+    for (size_t i(0); i < trxs.size(); ++i) trxs[i]->unref();
+}
+END_TEST
+
+START_TEST(test_certification_bad_shards)
+{
+    TestEnv env("0");
+    try
+    {
+        Certification cert(env.conf(), env.thd());
+        ck_abort_msg("Zero index shards accepted");
+    }
+    catch (gu::Exception& e)
+    {
+        ck_assert(e.get_errno() == EINVAL);
+    }
+}
+END_TEST
+
+Suite* certification_suite()
+{
+    Suite* s = suite_create("certification");
+    TCase* tc;
+
+    tc = tcase_create("certification");
+    tcase_add_test(tc, test_certification_single_shard);
+    tcase_add_test(tc, test_certification_multi_shard);
+    tcase_add_test(tc, test_certification_multi_shard_parallel);
+    tcase_add_test(tc, test_certification_bad_shards);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("purge");
+    tcase_add_test(tc, test_certification_purge_sync);
+    tcase_add_test(tc, test_certification_purge_background);
+    tcase_add_test(tc, test_certification_purge_gcache);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
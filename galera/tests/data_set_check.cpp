@@ -104,7 +104,8 @@ private:
 };
 
 
-static void test_ver(gu::RecordSet::Version const rsv)
+static void test_ver(gu::RecordSet::Version const rsv,
+                     DataSet::Version       const dsv = DataSet::VER1)
 {
     int const alignment
         (rsv >= gu::RecordSet::VER2 ? gu::RecordSet::VER2_ALIGNMENT : 1);
@@ -128,8 +129,7 @@ static void test_ver(gu::RecordSet::Version const rsv)
 
     union { gu::byte_t buf[1024]; gu_word_t align; } reserved;
     TestBaseName str("data_set_test");
-    DataSetOut dset_out(reserved.buf, sizeof(reserved.buf), str, DataSet::VER1,
-                        rsv);
+    DataSetOut dset_out(reserved.buf, sizeof(reserved.buf), str, dsv, rsv);
 
     size_t offset(dset_out.size());
 
@@ -256,6 +256,13 @@ START_TEST (ver2)
 }
 END_TEST
 
+START_TEST (ver2_crc32c)
+{
+    gu_crc32c_configure();
+    test_ver(gu::RecordSet::VER2, DataSet::VER2);
+}
+END_TEST
+
 Suite* data_set_suite ()
 {
     TCase* t = tcase_create ("DataSet");
@@ -263,6 +270,7 @@ Suite* data_set_suite ()
     tcase_add_test (t, ver1);
 #endif
     tcase_add_test (t, ver2);
+    tcase_add_test (t, ver2_crc32c);
     tcase_set_timeout(t, 60);
 
     Suite* s = suite_create ("DataSet");
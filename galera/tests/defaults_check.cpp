@@ -28,8 +28,11 @@ static const char* Defaults[] =
 {
     "base_dir",                    ".",
     "base_port",                   "4567",
+    "cert.index_shards",           "1",
     "cert.log_conflicts",          "no",
     "cert.optimistic_pa",          "yes",
+    "cert.parallel_keys",          "128",
+    "cert.purge_batch",            "256",
     "debug",                       "no",
 #ifdef GU_DBUG_ON
     "dbug",                        "",
@@ -53,17 +56,23 @@ static const char* Defaults[] =
     "evs.user_send_window",        "2",
     "evs.version",                 "0",
     "evs.view_forget_timeout",     "P1D",
+    "gcache.compress",             "no",
 #ifndef NDEBUG
     "gcache.debug",                "0",
 #endif
     "gcache.dir",                  ".",
+    "gcache.huge_pages",           "no",
     "gcache.keep_pages_size",      "0",
     "gcache.mem_size",             "0",
     "gcache.name",                 "./galera.cache",
+    "gcache.numa_bind",            "no",
+    "gcache.page_pool_size",       "0",
     "gcache.page_size",            "128M",
     "gcache.recover",              "no",
+    "gcache.recover_threads",      "4",
     "gcache.size",                 "128M",
     "gcomm.thread_prio",           "",
+    "gcs.adaptive_fragments",      "no",
     "gcs.fc_debug",                "0",
     "gcs.fc_factor",               "1.0",
     "gcs.fc_limit",                "16",
@@ -76,6 +85,7 @@ static const char* Defaults[] =
     "gcs.recv_q_hard_limit",       "9223372036854775807",
 #endif
     "gcs.recv_q_soft_limit",       "0.25",
+    "gcs.send_batch",              "0",
     "gcs.sync_donor",              "no",
     "gmcast.listen_addr",          "tcp://0.0.0.0:4567",
     "gmcast.mcast_addr",           "",
@@ -85,6 +95,8 @@ static const char* Defaults[] =
     "gmcast.time_wait",            "PT5S",
     "gmcast.version",              "0",
 //  "ist.recv_addr",               no default,
+    "ist.send_streams",            "1",
+    "ist.zero_copy",               "true",
     "pc.announce_timeout",         "PT3S",
     "pc.checksum",                 "false",
     "pc.ignore_quorum",            "false",
@@ -97,12 +109,16 @@ static const char* Defaults[] =
     "pc.wait_prim_timeout",        "PT30S",
     "pc.weight",                   "1",
     "protonet.backend",            "asio",
+    "protonet.io_threads",         "0",
     "protonet.version",            "0",
     "repl.causal_read_timeout",    "PT30S",
+    "repl.checksum_threads",       "2",
     "repl.commit_order",           "3",
+    "repl.dispatch_window",        "0",
     "repl.key_format",             "FLAT8",
     "repl.max_ws_size",            "2147483647",
-    "repl.proto_max",              "9",
+    "repl.proto_max",              "10",
+    "repl.trx_arena_size",         "8K",
 #ifdef GU_DBUG_ON
     "signal",                      "",
 #endif
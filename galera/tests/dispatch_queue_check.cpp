@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "test_trx.hpp"
+
+#include "../src/dispatch_queue.hpp"
+#include "../src/monitor.hpp"
+
+#include <check.h>
+
+#include <algorithm>
+
+namespace
+{
+    /* apply order of remote trxs, as in ReplicatorSMM::ApplyOrder */
+    class TestOrder
+    {
+    public:
+        TestOrder(galera::TrxHandle& trx) : trx_(trx) { }
+        void lock()   { trx_.lock();   }
+        void unlock() { trx_.unlock(); }
+        wsrep_seqno_t seqno() const { return trx_.global_seqno(); }
+        bool condition(wsrep_seqno_t last_entered,
+                       wsrep_seqno_t last_left) const
+        {
+            return (last_left >= trx_.depends_seqno());
+        }
+#ifdef GU_DBUG_ON
+        void debug_sync(gu::Mutex&) { }
+#endif // GU_DBUG_ON
+    private:
+        TestOrder(const TestOrder&);
+        galera::TrxHandle& trx_;
+    };
+
+    /* passes trxs through apply monitor and records the order they enter */
+    class TestApplier
+    {
+    public:
+
+        TestApplier() : monitor_(), mutex_(), entered_()
+        {
+            monitor_.set_initial_position(0);
+        }
+
+        wsrep_seqno_t last_left() const { return monitor_.last_left(); }
+
+        void apply(galera::TrxHandle* trx)
+        {
+            TestOrder to(*trx);
+            monitor_.enter(to);
+            {
+                gu::Lock lock(mutex_);
+                entered_.push_back(trx->global_seqno());
+            }
+            monitor_.leave(to);
+        }
+
+        void drain(wsrep_seqno_t seqno) { monitor_.drain(seqno); }
+
+        const std::vector<wsrep_seqno_t>& entered() const { return entered_; }
+
+    private:
+
+        galera::Monitor<TestOrder> monitor_;
+        gu::Mutex                  mutex_;
+        std::vector<wsrep_seqno_t> entered_;
+    };
+
+    /* hands out trxs in seqno order to dispatching threads, as certification
+     * does, the last one asks to exit receive loop */
+    class TestReceiver
+    {
+    public:
+
+        TestReceiver(galera::DispatchQueue& queue, TestApplier& applier,
+                     wsrep_seqno_t const n_trx, wsrep_seqno_t const deps)
+            :
+            pool_   (sizeof(galera::TrxHandle), 16, "dispatch_queue_check"),
+            ws_     (test_source(), 1, 0, test_keys(0, 1)),
+            queue_  (queue),
+            applier_(applier),
+            mutex_  (),
+            trxs_   (),
+            next_   (0),
+            exits_  (0)
+        {
+            for (wsrep_seqno_t seqno(1); seqno <= n_trx; ++seqno)
+            {
+                galera::TrxHandle* const trx(ws_.trx(pool_, seqno));
+                // depends on one of the deps preceding trxs
+                trx->set_depends_seqno(std::max<wsrep_seqno_t>
+                                       (seqno - 1 - seqno % deps, 0));
+                if (seqno == n_trx) trx->set_exit_loop(true);
+                trxs_.push_back(trx);
+            }
+        }
+
+        ~TestReceiver()
+        {
+            for (size_t i(next_); i < trxs_.size(); ++i) trxs_[i]->unref();
+        }
+
+        int exits() const { return exits_; }
+
+        // returns false if there are no more trxs
+        bool dispatch_next()
+        {
+            galera::TrxHandle* const trx(next());
+
+            if (0 == trx) return false;
+
+            trx->lock();
+            bool const exit(queue_.dispatch(trx, applier_));
+            trx->unlock();
+            trx->unref();
+
+            if (exit)
+            {
+                gu::Lock lock(mutex_);
+                ++exits_;
+            }
+
+            return true;
+        }
+
+        void run() { while (dispatch_next()) {} }
+
+    private:
+
+        galera::TrxHandle* next()
+        {
+            gu::Lock lock(mutex_);
+            return (next_ < trxs_.size() ? trxs_[next_++] : 0);
+        }
+
+        galera::TrxHandle::SlavePool     pool_;
+        TestWriteSet const               ws_;
+        galera::DispatchQueue&           queue_;
+        TestApplier&                     applier_;
+        gu::Mutex                        mutex_;
+        std::vector<galera::TrxHandle*>  trxs_;
+        size_t                           next_;
+        int                              exits_;
+    };
+}
+
+extern "C" void* dispatch_thread(void* arg)
+{
+    static_cast<TestReceiver*>(arg)->run();
+    return 0;
+}
+
+static void
+dispatch_threads_start(TestReceiver& recv, std::vector<gu_thread_t>& threads)
+{
+    for (size_t i(0); i < threads.size(); ++i)
+    {
+        ck_assert(0 == gu_thread_create(&threads[i], NULL, dispatch_thread,
+                                        &recv));
+    }
+}
+
+static void
+dispatch_threads_join(std::vector<gu_thread_t>& threads)
+{
+    for (size_t i(0); i < threads.size(); ++i)
+    {
+        gu_thread_join(threads[i], NULL);
+    }
+}
+
+/* zero window: trx is applied by the calling thread before dispatch()
+ * returns, nothing is queued */
+START_TEST(dispatch_queue_window0)
+{
+    galera::DispatchQueue queue(0);
+    TestApplier applier;
+    wsrep_seqno_t const n_trx(8);
+    TestReceiver recv(queue, applier, n_trx, 1);
+
+    for (wsrep_seqno_t seqno(1); seqno <= n_trx; ++seqno)
+    {
+        ck_assert(recv.dispatch_next());
+        ck_assert(0 == queue.size());
+        ck_assert(applier.last_left() == seqno);
+        ck_assert(recv.exits() == (seqno == n_trx));
+    }
+
+    ck_assert(!recv.dispatch_next());
+
+    ck_assert(applier.entered().size() == size_t(n_trx));
+    for (wsrep_seqno_t seqno(1); seqno <= n_trx; ++seqno)
+    {
+        ck_assert(applier.entered()[seqno - 1] == seqno);
+    }
+}
+END_TEST
+
+/* each trx depends on the previous one: trxs enter apply monitor in seqno
+ * order no matter which thread applies them, the queue is drained by the
+ * threads which filled it and exit request reaches one of them */
+START_TEST(dispatch_queue_order)
+{
+    galera::DispatchQueue queue(4);
+    TestApplier applier;
+    wsrep_seqno_t const n_trx(1024);
+    TestReceiver recv(queue, applier, n_trx, 1);
+    std::vector<gu_thread_t> threads(8);
+
+    dispatch_threads_start(recv, threads);
+    dispatch_threads_join(threads);
+
+    ck_assert(0 == queue.size());
+    ck_assert(applier.last_left() == n_trx);
+    ck_assert_msg(1 == recv.exits(), "exits: %d", recv.exits());
+
+    ck_assert(applier.entered().size() == size_t(n_trx));
+    for (wsrep_seqno_t seqno(1); seqno <= n_trx; ++seqno)
+    {
+        ck_assert_msg(applier.entered()[seqno - 1] == seqno,
+                      "expected %lld, entered %lld", (long long)seqno,
+                      (long long)applier.entered()[seqno - 1]);
+    }
+}
+END_TEST
+
+/* trxs depend on one of a few preceding ones: every trx is applied exactly
+ * once and apply monitor can be drained, as on configuration change, while
+ * threads are still dispatching */
+START_TEST(dispatch_queue_drain)
+{
+    galera::DispatchQueue queue(4);
+    TestApplier applier;
+    wsrep_seqno_t const n_trx(1024);
+    TestReceiver recv(queue, applier, n_trx, 4);
+    std::vector<gu_thread_t> threads(8);
+
+    dispatch_threads_start(recv, threads);
+
+    applier.drain(n_trx / 2);
+    ck_assert(applier.last_left() >= n_trx / 2);
+
+    applier.drain(n_trx);
+
+    ck_assert(0 == queue.size());
+    ck_assert(applier.last_left() == n_trx);
+
+    dispatch_threads_join(threads);
+
+    ck_assert_msg(1 == recv.exits(), "exits: %d", recv.exits());
+
+    std::vector<wsrep_seqno_t> entered(applier.entered());
+    ck_assert(entered.size() == size_t(n_trx));
+    std::sort(entered.begin(), entered.end());
+    for (wsrep_seqno_t seqno(1); seqno <= n_trx; ++seqno)
+    {
+        ck_assert(entered[seqno - 1] == seqno);
+    }
+}
+END_TEST
+
+Suite* dispatch_queue_suite()
+{
+    Suite* s = suite_create ("dispatch_queue");
+    TCase* tc;
+
+    tc = tcase_create ("dispatch_queue");
+    tcase_add_test  (tc, dispatch_queue_window0);
+    tcase_add_test  (tc, dispatch_queue_order);
+    tcase_add_test  (tc, dispatch_queue_drain);
+    suite_add_tcase (s, tc);
+
+    return s;
+}
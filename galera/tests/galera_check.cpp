@@ -17,10 +17,14 @@ extern Suite* key_set_suite();
 extern Suite* write_set_ng_suite();
 extern Suite* write_set_suite();
 extern Suite* trx_handle_suite();
+extern Suite* certification_suite();
 extern Suite* service_thd_suite();
 extern Suite* ist_suite();
 extern Suite* saved_state_suite();
 extern Suite* defaults_suite();
+extern Suite* gcs_action_source_suite();
+extern Suite* dispatch_queue_suite();
+extern Suite* causal_coalescer_suite();
 
 static suite_creator_t suites[] =
 {
@@ -29,10 +33,14 @@ static suite_creator_t suites[] =
     write_set_ng_suite,
     write_set_suite,
     trx_handle_suite,
+    certification_suite,
     service_thd_suite,
     ist_suite,
     saved_state_suite,
     defaults_suite,
+    gcs_action_source_suite,
+    dispatch_queue_suite,
+    causal_coalescer_suite,
     0
 };
 
@@ -40,6 +48,8 @@ extern "C" {
 #include <galerautils.h>
 }
 
+#include <gu_crc32c.h>
+
 #define LOG_FILE "galera_check.log"
 
 int main(int argc, char* argv[])
@@ -55,6 +65,7 @@ int main(int argc, char* argv[])
     }
 
     gu_conf_debug_on();
+    gu_crc32c_configure(); // normally done by gu_init()
 
     int failed = 0;
 
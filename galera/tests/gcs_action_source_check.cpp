@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "test_trx.hpp"
+
+#include "../src/gcs_action_source.hpp"
+#include "../src/replicator_smm.hpp"
+
+#include <check.h>
+#include <unistd.h>
+
+namespace
+{
+    /* Records received trxs and asks the receiver to exit on one of them */
+    class TestReplicator : public galera::Replicator
+    {
+    public:
+
+        TestReplicator(galera::Gcs& gcs)
+            : gcs_(gcs), conf_(), seqnos_(), exit_after_(0)
+        {}
+
+        std::vector<wsrep_seqno_t>& seqnos() { return seqnos_; }
+        void exit_after(size_t n) { exit_after_ = n; }
+
+        void process_trx(void*, galera::TrxHandle* trx, bool& exit_loop)
+        {
+            seqnos_.push_back(trx->global_seqno());
+            exit_loop = (seqnos_.size() == exit_after_);
+        }
+
+        void process_conf_change(void*, const wsrep_view_info_t&, int, State,
+                                 wsrep_seqno_t)
+        {
+            gcs_.resume_recv();
+        }
+
+        void process_sync(wsrep_seqno_t) {}
+
+        /* not used by GcsActionSource */
+        wsrep_status_t connect(const std::string&, const std::string&,
+                               const std::string&, bool)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t close() { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t async_recv(void*) { return WSREP_NOT_IMPLEMENTED; }
+        int trx_proto_ver() const { return 0; }
+        int repl_proto_ver() const { return 0; }
+        galera::TrxHandle* get_local_trx(wsrep_trx_id_t, bool) { return 0; }
+        void unref_local_trx(galera::TrxHandle*) {}
+        void discard_local_trx(galera::TrxHandle*) {}
+        galera::TrxHandle* local_conn_trx(wsrep_conn_id_t, bool) { return 0; }
+        void discard_local_conn_trx(wsrep_conn_id_t) {}
+        wsrep_status_t replicate(galera::TrxHandle*, wsrep_trx_meta_t*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t pre_commit(galera::TrxHandle*, wsrep_trx_meta_t*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t post_commit(galera::TrxHandle*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t post_rollback(galera::TrxHandle*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t replay_trx(galera::TrxHandle*, void*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        void abort_trx(galera::TrxHandle*) {}
+        wsrep_status_t causal_read(wsrep_gtid_t*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t to_isolation_begin(galera::TrxHandle*,
+                                          wsrep_trx_meta_t*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t to_isolation_end(galera::TrxHandle*)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t preordered_collect(wsrep_po_handle_t&,
+                                          const struct wsrep_buf*, size_t, bool)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t preordered_commit(wsrep_po_handle_t&,
+                                         const wsrep_uuid_t&, uint64_t, int,
+                                         bool)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t sst_sent(const wsrep_gtid_t&, int)
+        { return WSREP_NOT_IMPLEMENTED; }
+        wsrep_status_t sst_received(const wsrep_gtid_t&, const void*, size_t,
+                                    int)
+        { return WSREP_NOT_IMPLEMENTED; }
+        void process_commit_cut(wsrep_seqno_t, wsrep_seqno_t) {}
+        void process_state_req(void*, const void*, size_t, wsrep_seqno_t,
+                               wsrep_seqno_t) {}
+        void process_join(wsrep_seqno_t, wsrep_seqno_t) {}
+        const struct wsrep_stats_var* stats_get() const { return 0; }
+        void stats_reset() {}
+        void param_set(const std::string&, const std::string&) {}
+        std::string param_get(const std::string&) const { return ""; }
+        const gu::Config& params() const { return conf_; }
+        wsrep_seqno_t pause() { return WSREP_SEQNO_UNDEFINED; }
+        void resume() {}
+        void desync() {}
+        void resync() {}
+
+    private:
+
+        galera::Gcs&               gcs_;
+        gu::Config                 conf_;
+        std::vector<wsrep_seqno_t> seqnos_;
+        size_t                     exit_after_;
+    };
+
+    class TestEnv
+    {
+    public:
+
+        TestEnv() :
+            conf_   (),
+            init_   (conf_, NULL, NULL),
+            name_   (gcache_name(conf_)),
+            gcache_ (conf_, "."),
+            gcs_    (conf_, gcache_)
+        {}
+
+        ~TestEnv() { unlink(name_.c_str()); }
+
+        gcache::GCache& gcache() { return gcache_; }
+        galera::Gcs&    gcs()    { return gcs_;    }
+
+    private:
+
+        static std::string gcache_name(gu::Config& conf)
+        {
+            std::string const name("gcs_action_source_check.gcache");
+            conf.set("gcache.name", name);
+            conf.set("gcache.size", "1M");
+            return name;
+        }
+
+        gu::Config        conf_;
+        galera::ReplicatorSMM::InitConfig init_;
+        std::string const name_;
+        gcache::GCache    gcache_;
+        galera::Gcs       gcs_;
+    };
+}
+
+#define TEST_USLEEP 1000 // 1ms
+#define WAIT_FOR(cond)                                                  \
+    { int count = 1000; while (--count && !(cond)) { usleep (TEST_USLEEP); }}
+
+static int
+recv_q_len (galera::Gcs& gcs)
+{
+    struct gcs_stats stats;
+    gcs.get_stats(&stats);
+    return stats.recv_q_len;
+}
+
+static void*
+close_thread (void* gcs)
+{
+    static_cast<galera::Gcs*>(gcs)->close();
+    return NULL;
+}
+
+/* actions received in the same batch after the one which makes the receiver
+ * exit are left for the next call to process() */
+START_TEST(gcs_action_source_exit)
+{
+    TestEnv env;
+    galera::Gcs& gcs(env.gcs());
+    galera::TrxHandle::SlavePool sp(sizeof(galera::TrxHandle), 4,
+                                    "gcs_action_source_exit");
+    TestReplicator repl(gcs);
+    gu::ThreadPool checksum_pool(0);
+    galera::GcsActionSource as(sp, gcs, repl, env.gcache(), checksum_pool);
+    int ctx;
+    bool exit_loop;
+
+    ck_assert(0 == gcs.connect("gcs_action_source_exit", "dummy://", true));
+    ck_assert(as.process(&ctx, exit_loop) > 0); // configuration change
+    ck_assert(!exit_loop);
+
+    wsrep_uuid_t const source(test_source());
+    int const n_trx(4);
+    for (int i(0); i < n_trx; ++i)
+    {
+        TestWriteSet const ws(source, i + 1, 0, test_keys(i, i + 1));
+        std::vector<gu::byte_t> const& buf(ws.buf());
+        ck_assert(gcs.send(buf.data(), buf.size(), GCS_ACT_TORDERED, false) ==
+                  ssize_t(buf.size()));
+    }
+
+    /* SYNC message and all trxs are received in one batch */
+    WAIT_FOR(recv_q_len(gcs) == n_trx + 1);
+    ck_assert(recv_q_len(gcs) == n_trx + 1);
+
+    repl.exit_after(2);
+    ck_assert(as.process(&ctx, exit_loop) > 0);
+    ck_assert(exit_loop);
+    ck_assert_msg(repl.seqnos().size() == 2, "processed %zu trxs",
+                  repl.seqnos().size());
+    ck_assert(recv_q_len(gcs) == 0);
+
+    ck_assert(as.process(&ctx, exit_loop) > 0);
+    ck_assert(!exit_loop);
+    ck_assert(repl.seqnos().size() == size_t(n_trx));
+
+    for (int i(1); i < n_trx; ++i)
+    {
+        ck_assert(repl.seqnos()[i] == repl.seqnos()[i - 1] + 1);
+    }
+
+    gu_thread_t thd;
+    gu_thread_create(&thd, NULL, close_thread, &gcs);
+    while (as.process(&ctx, exit_loop) > 0) {}
+    gu_thread_join(thd, NULL);
+}
+END_TEST
+
+Suite* gcs_action_source_suite()
+{
+    Suite* s = suite_create ("gcs_action_source");
+    TCase* tc;
+
+    tc = tcase_create ("gcs_action_source");
+    tcase_add_test  (tc, gcs_action_source_exit);
+    suite_add_tcase (s, tc);
+
+    return s;
+}
@@ -92,16 +92,18 @@ struct sender_args
     wsrep_seqno_t first_;
     wsrep_seqno_t last_;
     int version_;
+    int streams_;
     sender_args(gcache::GCache& gcache,
                 const std::string& peer,
                 wsrep_seqno_t first, wsrep_seqno_t last,
-                int version)
+                int version, int streams)
         :
         gcache_(gcache),
         peer_  (peer),
         first_ (first),
         last_  (last),
-        version_(version)
+        version_(version),
+        streams_(streams)
     { }
 };
 
@@ -147,6 +149,7 @@ extern "C" void* sender_thd(void* arg)
 
     gu::Config conf;
     galera::ReplicatorSMM::InitConfig(conf, NULL, NULL);
+    conf.set(galera::ist::Sender::SEND_STREAMS, sargs->streams_);
     gu_barrier_wait(&start_barrier);
     sargs->gcache_.seqno_lock(sargs->first_); // unlocked in sender dtor
     galera::ist::Sender sender(conf, sargs->gcache_, sargs->peer_,
@@ -240,7 +243,8 @@ static int select_trx_version(int protocol_version)
 }
 
 
-static void test_ist_common(int const version)
+static void test_ist_common(int const version, int const streams = 1,
+                            size_t const appliers = 1)
 {
     using galera::KeyData;
     using galera::TrxHandle;
@@ -324,8 +328,8 @@ static void test_ist_common(int const version)
 
     mark_point();
 
-    receiver_args rargs(receiver_addr, 1, 10, 1, sp, version);
-    sender_args sargs(*gcache, rargs.listen_addr_, 1, 10, version);
+    receiver_args rargs(receiver_addr, 1, 10, appliers, sp, version);
+    sender_args sargs(*gcache, rargs.listen_addr_, 1, 10, version, streams);
 
     gu_barrier_init(&start_barrier, 0, 1 + 1 + rargs.n_receivers_);
 
@@ -382,6 +386,18 @@ START_TEST(test_ist_v5)
 }
 END_TEST
 
+START_TEST(test_ist_streams)
+{
+    test_ist_common(5, 3);
+}
+END_TEST
+
+START_TEST(test_ist_appliers)
+{
+    test_ist_common(5, 1, 4);
+}
+END_TEST
+
 Suite* ist_suite()
 {
     Suite* s  = suite_create("ist");
@@ -416,5 +432,15 @@ Suite* ist_suite()
     tcase_add_test(tc, test_ist_v5);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_ist_streams");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_streams);
+    suite_add_tcase(s, tc);
+
+    tc = tcase_create("test_ist_appliers");
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, test_ist_appliers);
+    suite_add_tcase(s, tc);
+
     return s;
 }
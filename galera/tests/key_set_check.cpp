@@ -332,6 +332,48 @@ START_TEST (ver2_4)
 }
 END_TEST
 
+/* Volatile key parts are copied to part store while there is space in it
+ * and to the heap after that */
+START_TEST (ver2_part_store)
+{
+    union { gu::byte_t buf[1024]; gu_word_t align; } reserved;
+    gu::byte_t parts[16];
+    TestBaseName const str("key_set_test");
+    KeySetOut kso (reserved.buf, sizeof(reserved.buf), str, KeySet::FLAT16A,
+                   gu::RecordSet::VER2, 4, parts, sizeof(parts));
+
+    char db[]  = "db";
+    char key[] = "key0";
+    TestKey tk(KeySet::FLAT16A, WSREP_KEY_EXCLUSIVE, true, db, key);
+
+    kso.append(tk());
+    ck_assert_msg(kso.count() == 2, "key count: expected 2, got %d",
+                  kso.count());
+    ck_assert_msg(kso.part_store_used() == sizeof(db) + sizeof(key),
+                  "part store used: %zu", kso.part_store_used());
+
+    /* if the previous key was not copied, it would change as well and the
+     * new key would not be appended */
+    key[3] = '1';
+    kso.append(tk());
+    ck_assert_msg(kso.count() == 3, "key count: expected 3, got %d",
+                  kso.count());
+    ck_assert(kso.part_store_used() == sizeof(db) + 2*sizeof(key));
+
+    /* this one does not fit in part store */
+    key[3] = '2';
+    kso.append(tk());
+    ck_assert_msg(kso.count() == 4, "key count: expected 4, got %d",
+                  kso.count());
+    ck_assert(kso.part_store_used() > sizeof(parts));
+
+    key[3] = '3';
+    kso.append(tk());
+    ck_assert_msg(kso.count() == 5, "key count: expected 5, got %d",
+                  kso.count());
+}
+END_TEST
+
 Suite* key_set_suite ()
 {
     TCase* t = tcase_create ("KeySet");
@@ -340,6 +382,7 @@ Suite* key_set_suite ()
 #endif
     tcase_add_test (t, ver2_3);
     tcase_add_test (t, ver2_4);
+    tcase_add_test (t, ver2_part_store);
     tcase_set_timeout(t, 60);
 
     Suite* s = suite_create ("KeySet");
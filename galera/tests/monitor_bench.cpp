@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark Monitor enter()/leave() throughput depending on the
+ * number of threads contending for it. Optional commit time is spent inside
+ * the monitor to emulate e.g. fsync on commit.
+ *
+ * Usage: monitor_bench [seqnos] [max threads] [commit usec]
+ */
+
+#include "../src/monitor.hpp"
+
+#include <gu_atomic.hpp>
+
+#include <sys/time.h>
+#include <unistd.h>
+#include <iostream>
+#include <cstdlib>
+
+static double time_diff(const struct timeval& l,
+                        const struct timeval& r)
+{
+    double const left(double(l.tv_usec)*1.0e-06 + l.tv_sec);
+    double const right(double(r.tv_usec)*1.0e-06 + r.tv_sec);
+    return left - right;
+}
+
+/* OUT_OF_ORDER emulates apply monitor for non-conflicting trxs, IN_ORDER -
+ * commit monitor in NO_OOOC mode, GROUP - commit monitor in GROUP mode */
+enum BenchMode
+{
+    OUT_OF_ORDER,
+    IN_ORDER,
+    GROUP
+};
+
+static const char* const bench_mode_str[] =
+{
+    "out of order", "in order", "group"
+};
+
+class BenchOrder
+{
+public:
+
+    BenchOrder(wsrep_seqno_t const seqno, bool const in_order)
+        : seqno_(seqno), in_order_(in_order)
+    {}
+
+    void lock()   {}
+    void unlock() {}
+
+    wsrep_seqno_t seqno() const { return seqno_; }
+
+    bool condition(wsrep_seqno_t, wsrep_seqno_t last_left) const
+    {
+        return (!in_order_ || last_left + 1 == seqno_);
+    }
+
+#ifdef GU_DBUG_ON
+    void debug_sync(gu::Mutex&) {}
+#endif // GU_DBUG_ON
+
+private:
+
+    wsrep_seqno_t const seqno_;
+    bool          const in_order_;
+};
+
+struct BenchArgs
+{
+    galera::Monitor<BenchOrder>* mon;
+    gu::Atomic<wsrep_seqno_t>*   next;
+    wsrep_seqno_t                last;
+    bool                         in_order;
+    int                          commit_usec;
+};
+
+static void*
+bench_thread(void* arg)
+{
+    BenchArgs* const args(static_cast<BenchArgs*>(arg));
+
+    for (;;)
+    {
+        wsrep_seqno_t const seqno(args->next->add_and_fetch(1));
+
+        if (seqno > args->last) break;
+
+        BenchOrder o(seqno, args->in_order);
+        args->mon->enter(o);
+        if (args->commit_usec > 0) ::usleep(args->commit_usec);
+        args->mon->leave(o);
+    }
+
+    return NULL;
+}
+
+static double
+bench(wsrep_seqno_t const seqnos, int const n_threads, BenchMode const mode,
+      int const commit_usec)
+{
+    galera::Monitor<BenchOrder> mon(GROUP == mode);
+    mon.set_initial_position(0);
+
+    gu::Atomic<wsrep_seqno_t> next(0);
+    BenchArgs args = { &mon, &next, seqnos, OUT_OF_ORDER != mode,
+                       commit_usec };
+
+    std::vector<gu_thread_t> threads(n_threads);
+
+    struct timeval start, stop;
+    gettimeofday(&start, NULL);
+
+    for (int i(0); i < n_threads; ++i)
+    {
+        gu_thread_create(&threads[i], NULL, bench_thread, &args);
+    }
+
+    for (int i(0); i < n_threads; ++i)
+    {
+        gu_thread_join(threads[i], NULL);
+    }
+
+    gettimeofday(&stop, NULL);
+
+    if (mon.last_left() != seqnos)
+    {
+        std::cerr << "Monitor last left " << mon.last_left()
+                  << ", expected " << seqnos << std::endl;
+        abort();
+    }
+
+    return time_diff(stop, start);
+}
+
+int main(int argc, char* argv[])
+{
+    long long const seqnos     (argc > 1 ? ::atoll(argv[1]) : 1000000);
+    int       const max_threads(argc > 2 ? ::atoi(argv[2])  : 32);
+    int       const commit_usec(argc > 3 ? ::atoi(argv[3])  : 0);
+
+    if (seqnos <= 0 || max_threads <= 0 || commit_usec < 0)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [seqnos] [max threads] [commit usec]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Passing " << seqnos << " seqnos through monitor"
+              << std::endl;
+
+    for (int mode(OUT_OF_ORDER); mode <= GROUP; ++mode)
+    {
+        for (int threads(1); threads <= max_threads; threads *= 2)
+        {
+            double const t(bench(seqnos, threads, BenchMode(mode),
+                                 commit_usec));
+            std::cout << bench_mode_str[mode]
+                      << "\tthreads: " << threads
+                      << "\ttime: " << t << " sec"
+                      << "\tseqno/sec: " << seqnos/t << std::endl;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
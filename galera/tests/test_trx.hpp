@@ -0,0 +1,99 @@
+/* Copyright (C) 2020 Codership Oy <info@codership.com>
+ *
+ * $Id$
+ */
+
+#ifndef _TEST_TRX_HPP_
+#define _TEST_TRX_HPP_
+
+#include "test_key.hpp"
+#include "../src/write_set_ng.hpp"
+#include "../src/trx_handle.hpp"
+
+#include "gu_uuid.h"
+
+#include <string>
+#include <vector>
+
+/* Serialized NG write set, as it would be received from the group */
+class TestWriteSet
+{
+public:
+
+    TestWriteSet (const wsrep_uuid_t&             source,
+                  wsrep_trx_id_t            const trx_id,
+                  wsrep_seqno_t             const last_seen,
+                  const std::vector<std::string>& keys,
+                  wsrep_key_type_t          const key_type =
+                  WSREP_KEY_EXCLUSIVE)
+        :
+        buf_()
+    {
+        WriteSetOut wso(".", trx_id, KeySet::FLAT8A, 0, 0,
+                        WriteSetNG::F_COMMIT, gu::RecordSet::VER2,
+                        WriteSetNG::MAX_VERSION);
+
+        for (size_t i(0); i < keys.size(); ++i)
+        {
+            TestKey tk(KeySet::MAX_VERSION, key_type, true,
+                       "test_db", keys[i].c_str());
+            wso.append_key(tk());
+        }
+
+        WriteSetNG::GatherVector out;
+        size_t const out_size(wso.gather(source, 1, trx_id, out));
+
+        wso.set_last_seen(last_seen);
+
+        buf_.reserve(out_size);
+        for (size_t i(0); i < out->size(); ++i)
+        {
+            const gu::byte_t* ptr(static_cast<const gu::byte_t*>(out[i].ptr));
+            buf_.insert(buf_.end(), ptr, ptr + out[i].size);
+        }
+    }
+
+    const std::vector<gu::byte_t>& buf() const { return buf_; }
+
+    /* Creates slave trx handle from the write set. Write set object
+     * must outlive the returned handle. */
+    TrxHandle* trx (TrxHandle::SlavePool& pool, wsrep_seqno_t const seqno)
+        const
+    {
+        TrxHandle* const ret(TrxHandle::New(pool));
+        ret->unserialize(buf_.data(), buf_.size(), 0);
+        ret->set_received(buf_.data(), seqno, seqno);
+        return ret;
+    }
+
+private:
+
+    std::vector<gu::byte_t> buf_;
+};
+
+static inline wsrep_uuid_t
+test_source ()
+{
+    wsrep_uuid_t ret;
+    gu_uuid_generate (reinterpret_cast<gu_uuid_t*>(&ret), NULL, 0);
+    return ret;
+}
+
+/* Key names key_<begin> .. key_<end - 1> */
+static inline std::vector<std::string>
+test_keys (int const begin, int const end)
+{
+    std::vector<std::string> ret;
+    ret.reserve(end - begin);
+
+    for (int i(begin); i < end; ++i)
+    {
+        std::ostringstream os;
+        os << "key_" << i;
+        ret.push_back(os.str());
+    }
+
+    return ret;
+}
+
+#endif /* _TEST_TRX_HPP_ */
@@ -242,9 +242,11 @@ static void ver3_basic(gu::RecordSet::Version const rsv,
         ck_assert(e.get_errno() == EINVAL);
     }
 
+    gu::ThreadPool checksum_pool(1);
+
     try /* this is to test background checksumming + corruption */
     {
-        WriteSetIn wsi(in_buf, 2);
+        WriteSetIn wsi(in_buf, 2, &checksum_pool);
 
         mark_point();
 
@@ -296,6 +298,12 @@ START_TEST (ver3_basic_rsv2_wsv4)
 }
 END_TEST
 
+START_TEST (ver3_basic_rsv2_wsv5)
+{
+    ver3_basic(gu::RecordSet::VER2, WriteSetNG::VER5);
+}
+END_TEST
+
 static void ver3_annotation(gu::RecordSet::Version const rsv)
 {
     union {
@@ -395,6 +403,72 @@ START_TEST (ver3_annotation_rsv2)
 }
 END_TEST
 
+/* many big write sets checksummed concurrently by a small pool, some of them
+ * destroyed without verification */
+START_TEST (ver3_checksum_pool)
+{
+    wsrep_uuid_t source;
+    gu_uuid_generate (reinterpret_cast<gu_uuid_t*>(&source), NULL, 0);
+
+    WriteSetOut wso (".", 1, KeySet::FLAT8A, 0, 0, WriteSetNG::F_COMMIT,
+                     gu::RecordSet::VER2, WriteSetNG::MAX_VERSION);
+
+    TestKey tk(KeySet::MAX_VERSION, WSREP_KEY_EXCLUSIVE, true, "a0");
+    wso.append_key(tk());
+    std::vector<gu::byte_t> const data(1 << 16, 0x5a);
+    wso.append_data (data.data(), data.size(), false);
+
+    WriteSetNG::GatherVector out;
+    size_t const out_size(wso.gather(source, 1, 1, out));
+    wso.set_last_seen(0);
+
+    std::vector<gu::byte_t> in;
+    in.reserve(out_size);
+    for (size_t i(0); i < out->size(); ++i)
+    {
+        const gu::byte_t* ptr(static_cast<const gu::byte_t*>(out[i].ptr));
+        in.insert (in.end(), ptr, ptr + out[i].size);
+    }
+    ck_assert(in.size() == out_size);
+
+    std::vector<gu::byte_t> bad(in);
+    bad[bad.size() - 1] ^= 1; // corrupt payload
+
+    gu::Buf const in_buf  = { in.data(),  static_cast<ssize_t>(in.size())  };
+    gu::Buf const bad_buf = { bad.data(), static_cast<ssize_t>(bad.size()) };
+
+    gu::ThreadPool pool(2);
+
+    int const n_ws(32);
+    std::vector<WriteSetIn*> ws;
+    for (int i(0); i < n_ws; ++i)
+    {
+        ws.push_back(new WriteSetIn(i % 4 ? in_buf : bad_buf, 2, &pool));
+    }
+
+    for (int i(0); i < n_ws; ++i)
+    {
+        if (i % 3 == 0) continue; // destroy without verification
+
+        try
+        {
+            ws[i]->verify_checksum();
+            ck_assert_msg(i % 4, "corrupted write set %d verified", i);
+        }
+        catch (gu::Exception& e)
+        {
+            ck_assert_msg(0 == i % 4, "good write set %d failed: %s",
+                          i, e.what());
+            ck_assert(e.get_errno() == EINVAL);
+        }
+    }
+
+    for (int i(0); i < n_ws; ++i) delete ws[i];
+
+    ck_assert(pool.queue_len() == 0);
+}
+END_TEST
+
 Suite* write_set_ng_suite ()
 {
     Suite* s = suite_create ("WriteSet");
@@ -405,6 +479,8 @@ Suite* write_set_ng_suite ()
 #endif
     tcase_add_test (t, ver3_basic_rsv2_wsv3);
     tcase_add_test (t, ver3_basic_rsv2_wsv4);
+    tcase_add_test (t, ver3_basic_rsv2_wsv5);
+    tcase_add_test (t, ver3_checksum_pool);
     tcase_set_timeout(t, 60);
     suite_add_tcase (s, t);
 
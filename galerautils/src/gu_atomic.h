@@ -1,4 +1,4 @@
-// Copyright (C) 2013-2014 Codership Oy <info@codership.com>
+// Copyright (C) 2013-2020 Codership Oy <info@codership.com>
 
 /**
  * @file Atomic memory access functions. At the moment these follow
@@ -58,6 +58,13 @@ extern "C" {
 #define gu_atomic_get(ptr, vptr)                        \
     __atomic_load(ptr, vptr, GU_ATOMIC_SYNC_DEFAULT)
 
+// stores val into ptr if its contents equal *eptr, otherwise loads contents
+// of ptr to eptr, returns true if val was stored
+#define gu_atomic_compare_exchange(ptr, eptr, val)                      \
+    __atomic_compare_exchange_n(ptr, eptr, val, 0,                      \
+                                GU_ATOMIC_SYNC_DEFAULT,                 \
+                                GU_ATOMIC_SYNC_DEFAULT)
+
 #elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8) // use __sync_XXX builtins
 
 #define GU_ATOMIC_SYNC_NONE    0
@@ -83,6 +90,11 @@ extern "C" {
 
 #define gu_atomic_get(ptr, vptr) *vptr = __sync_fetch_and_or(ptr, 0)
 
+#define gu_atomic_compare_exchange(ptr, eptr, val)                      \
+    ({ __typeof__(*(ptr)) const _gu_e = *(eptr);                        \
+       *(eptr) = __sync_val_compare_and_swap(ptr, _gu_e, val);          \
+       *(eptr) == _gu_e; })
+
 #else
 #error "This GCC version does not support 8-byte atomics on this platform. Use GCC >= 4.7.x."
 #endif /* __ATOMIC_RELAXED */
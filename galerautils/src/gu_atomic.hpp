@@ -71,6 +71,13 @@ namespace gu
             return *this;
         }
 
+        /* stores i if the value equals expected, otherwise loads the value
+         * to expected, returns true if i was stored */
+        bool compare_exchange(I& expected, I i)
+        {
+            return gu_atomic_compare_exchange(&i_, &expected, i);
+        }
+
         bool operator!=(I i)
         {
             return (operator()() != i);
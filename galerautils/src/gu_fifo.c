@@ -370,6 +370,55 @@ void gu_fifo_pop_head (gu_fifo_t* q)
     }
 }
 
+/*! If FIFO is not empty, stores pointers to up to max head items and locks
+ *  FIFO, otherwise blocks. Or returns error code if FIFO is closed. */
+long gu_fifo_get_heads (gu_fifo_t* q, void* items[], long max)
+{
+    int const err = fifo_lock_get (q);
+
+    assert (max > 0);
+
+    if (gu_likely(-ECANCELED != err && q->used)) {
+        ulong pos = q->head;
+        long  n;
+
+        if ((ulong)max > q->used) max = q->used;
+
+        for (n = 0; n < max; n++) {
+            items[n] = FIFO_PTR(q, pos);
+            pos = FIFO_INC(q, pos);
+        }
+
+        return max;
+    }
+    else {
+        assert (q->get_err);
+        fifo_unlock (q);
+        return err;
+    }
+}
+
+/*! Advances FIFO head by n items and unlocks FIFO. */
+void gu_fifo_pop_heads (gu_fifo_t* q, long n)
+{
+    assert (n > 0);
+    assert ((ulong)n <= q->used);
+
+    long i;
+    for (i = 0; i < n; i++) fifo_advance_head(q);
+
+    /* several putters may be waiting for free space */
+    for (i = 1; i < n && q->put_wait > 1; i++) {
+        q->put_wait--;
+        gu_cond_signal (&q->put_cond);
+    }
+
+    if (fifo_unlock_get(q)) {
+        gu_fatal ("Faled to unlock queue to get items.");
+        abort();
+    }
+}
+
 /*! If FIFO is not full, returns pointer to the tail item and locks FIFO,
  *  otherwise blocks. Or returns NULL if FIFO is closed. */
 void* gu_fifo_get_tail (gu_fifo_t* q)
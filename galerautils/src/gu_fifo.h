@@ -45,6 +45,13 @@ extern void  gu_fifo_release   (gu_fifo_t *q);
 extern void* gu_fifo_get_head  (gu_fifo_t* q, int* err);
 /*! Advance FIFO head pointer and release FIFO. */
 extern void  gu_fifo_pop_head  (gu_fifo_t* q);
+/*! Lock FIFO and get pointers to up to max consecutive head items, so that
+ * several items can be dequeued at the cost of a single lock.
+ * @param items array to store item pointers to
+ * @retval number of items or negative error code as in gu_fifo_get_head() */
+extern long  gu_fifo_get_heads (gu_fifo_t* q, void* items[], long max);
+/*! Advance FIFO head pointer by n items and release FIFO. */
+extern void  gu_fifo_pop_heads (gu_fifo_t* q, long n);
 /*! Lock FIFO and get pointer to tail item */
 extern void* gu_fifo_get_tail  (gu_fifo_t* q);
 /*! Advance FIFO tail pointer and release FIFO. */
@@ -0,0 +1,272 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+/**
+ * @file Open addressing hash set of pointers.
+ *
+ * Pointers are kept in a single flat array of slots together with the full
+ * hash value of the object they point to, so that most probes are resolved by
+ * comparing hashes within one cache line, and only the objects with matching
+ * hash are ever dereferenced. Collisions are resolved by linear probing with
+ * Robin Hood displacement and backward shift deletion, which keeps probe
+ * sequences short even at high load factor.
+ *
+ * Null pointer can't be stored in the set as it marks an empty slot.
+ * Both insert() and erase() invalidate iterators.
+ *
+ * Hash is a functor returning size_t hash value of the object pointed to,
+ * Equal is a functor comparing two objects by pointers.
+ */
+
+#ifndef GU_FLAT_SET_HPP
+#define GU_FLAT_SET_HPP
+
+#include "gu_macros.h" // gu_unlikely()
+
+#include <algorithm> // std::swap()
+#include <utility>   // std::pair<>
+#include <iterator>  // forward_iterator_tag
+#include <cassert>
+#include <cstddef>
+#include <stdint.h>
+
+namespace gu
+{
+
+template <typename T, class Hash, class Equal>
+class FlatPtrSet
+{
+    struct Slot
+    {
+        uint64_t hash;
+        T*       ptr;
+    };
+
+public:
+
+    typedef T*     value_type;
+    typedef size_t size_type;
+
+    class iterator
+    {
+    public:
+
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T*                        value_type;
+        typedef ptrdiff_t                 difference_type;
+        typedef T* const*                 pointer;
+        typedef T* const&                 reference;
+
+        iterator() : slot_(0), end_(0) {}
+
+        reference operator*()  const { return slot_->ptr; }
+        pointer   operator->() const { return &slot_->ptr; }
+
+        iterator& operator++() { ++slot_; skip_empty(); return *this; }
+        iterator  operator++(int) { iterator ret(*this); ++*this; return ret; }
+
+        bool operator==(const iterator& o) const { return slot_ == o.slot_; }
+        bool operator!=(const iterator& o) const { return slot_ != o.slot_; }
+
+    private:
+
+        friend class FlatPtrSet;
+
+        iterator(Slot* const slot, Slot* const end) : slot_(slot), end_(end)
+        {}
+
+        void skip_empty() { while (slot_ != end_ && 0 == slot_->ptr) ++slot_; }
+
+        Slot* slot_;
+        Slot* end_;
+    };
+
+    /* set contents are never modified through iterator */
+    typedef iterator const_iterator;
+
+    FlatPtrSet() : slots_(0), size_(0), mask_(0), shift_(0) {}
+
+    ~FlatPtrSet() { delete[] slots_; }
+
+    size_type size()  const { return size_; }
+    bool      empty() const { return 0 == size_; }
+
+    /** Number of allocated slots */
+    size_type capacity() const { return slots_ ? mask_ + 1 : 0; }
+
+    iterator begin() const
+    {
+        iterator ret(slots_, slots_ + capacity());
+        ret.skip_empty();
+        return ret;
+    }
+
+    iterator end() const
+    {
+        Slot* const e(slots_ + capacity());
+        return iterator(e, e);
+    }
+
+    iterator find(const T* const p) const
+    {
+        if (0 == size_) return end();
+
+        uint64_t const h(Hash()(p));
+        size_type      i(home(h));
+
+        for (size_type dist(0); ; ++dist, i = (i + 1) & mask_)
+        {
+            Slot& s(slots_[i]);
+
+            /* if the resident is closer to its home than we would be, the
+             * key would have displaced it on insertion: not found */
+            if (0 == s.ptr || distance(i, s.hash) < dist) return end();
+
+            if (s.hash == h && Equal()(s.ptr, p)) return make_iterator(i);
+        }
+    }
+
+    std::pair<iterator, bool> insert(T* const p)
+    {
+        assert(p);
+
+        iterator const found(find(p));
+        if (found != end()) return std::make_pair(found, false);
+
+        if (gu_unlikely((size_ + 1) * MAX_LOAD_DEN > capacity() * MAX_LOAD_NUM))
+        {
+            rehash(capacity() ? capacity() * 2 : size_type(MIN_CAPACITY));
+        }
+
+        Slot const s = { Hash()(p), p };
+        size_type const pos(place(s));
+        ++size_;
+
+        return std::make_pair(make_iterator(pos), true);
+    }
+
+    void erase(iterator const it)
+    {
+        assert(it.slot_ >= slots_ && it.slot_ < slots_ + capacity());
+        assert(it.slot_->ptr);
+
+        size_type i(it.slot_ - slots_);
+
+        /* shift the following displaced entries one slot back */
+        for (;;)
+        {
+            size_type const next((i + 1) & mask_);
+            Slot&           n(slots_[next]);
+
+            if (0 == n.ptr || 0 == distance(next, n.hash))
+            {
+                slots_[i].ptr = 0;
+                break;
+            }
+
+            slots_[i] = n;
+            i = next;
+        }
+
+        --size_;
+    }
+
+    /** Removes all entries (not the objects) and frees memory */
+    void clear()
+    {
+        delete[] slots_;
+        slots_ = 0;
+        size_  = 0;
+        mask_  = 0;
+        shift_ = 0;
+    }
+
+private:
+
+    FlatPtrSet(const FlatPtrSet&);
+    FlatPtrSet& operator=(const FlatPtrSet&);
+
+    enum
+    {
+        MIN_CAPACITY = 16,
+        MAX_LOAD_NUM = 7, // max load factor 7/8
+        MAX_LOAD_DEN = 8
+    };
+
+    /* Fibonacci hashing: spreads all bits of the hash over the slot index,
+     * so that hash values with constant low or high bits still work */
+    size_type home(uint64_t const h) const
+    {
+        return static_cast<size_type>((h * 0x9e3779b97f4a7c15ULL) >> shift_);
+    }
+
+    size_type distance(size_type const i, uint64_t const h) const
+    {
+        return (i - home(h)) & mask_;
+    }
+
+    iterator make_iterator(size_type const i) const
+    {
+        return iterator(slots_ + i, slots_ + capacity());
+    }
+
+    /* places entry which is known to be absent, returns its position */
+    size_type place(Slot s)
+    {
+        size_type i(home(s.hash));
+        size_type ret(capacity());
+
+        for (size_type dist(0); ; ++dist, i = (i + 1) & mask_)
+        {
+            Slot& r(slots_[i]);
+
+            if (0 == r.ptr)
+            {
+                r = s;
+                return (ret == capacity() ? i : ret);
+            }
+
+            size_type const r_dist(distance(i, r.hash));
+
+            if (r_dist < dist)
+            {
+                /* steal the slot from the richer resident and carry on
+                 * placing the resident */
+                std::swap(r, s);
+                if (ret == capacity()) ret = i;
+                dist = r_dist;
+            }
+        }
+    }
+
+    void rehash(size_type const new_cap)
+    {
+        assert(new_cap >= MIN_CAPACITY);
+        assert(0 == (new_cap & (new_cap - 1)));
+
+        Slot* const     old(slots_);
+        size_type const old_cap(capacity());
+
+        slots_ = new Slot[new_cap];
+        for (size_type i(0); i < new_cap; ++i) slots_[i].ptr = 0;
+
+        mask_  = new_cap - 1;
+        shift_ = 64;
+        for (size_type c(new_cap); c > 1; c >>= 1) --shift_;
+
+        for (size_type i(0); i < old_cap; ++i)
+        {
+            if (old[i].ptr) place(old[i]);
+        }
+
+        delete[] old;
+    }
+
+    Slot*     slots_;
+    size_type size_;
+    size_type mask_;
+    int       shift_;
+};
+
+} /* namespace gu */
+
+#endif /* GU_FLAT_SET_HPP */
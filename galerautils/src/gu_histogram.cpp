@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2014 Codership Oy <info@codership.com>
+ * Copyright (C) 2014-2020 Codership Oy <info@codership.com>
  */
 
 #include "gu_histogram.hpp"
@@ -89,7 +89,8 @@ std::ostream& gu::operator<<(std::ostream& os, const Histogram& hs)
     {
         i_next = i;
         ++i_next;
-        os << i->first << ":" << std::fabs(double(i->second)/double(norm));
+        os << i->first << ":"
+           << (norm > 0 ? std::fabs(double(i->second)/double(norm)) : 0.);
         if (i_next != hs.cnt_.end()) os << ",";
     }
 
@@ -0,0 +1,206 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#include "gu_lz4.hpp"
+
+#include <cstring>
+#include <stdint.h>
+
+/* format constants */
+static size_t   const MIN_MATCH     = 4;
+static size_t   const LAST_LITERALS = 5;  // block must end with literals
+static size_t   const MF_LIMIT      = 12; // last match must start before that
+static size_t   const MAX_OFFSET    = 65535;
+static unsigned const RUN_MASK      = 15;
+
+static int      const HASH_LOG      = 12;
+
+static inline uint32_t
+read32(const uint8_t* const p)
+{
+    uint32_t ret;
+    ::memcpy(&ret, p, sizeof(ret));
+    return ret;
+}
+
+static inline unsigned
+hash(uint32_t const seq)
+{
+    return (seq * 2654435761U) >> (32 - HASH_LOG);
+}
+
+/* writes length continuation bytes */
+static inline uint8_t*
+write_length(uint8_t* op, size_t len)
+{
+    for (; len >= 255; len -= 255) *op++ = 255;
+    *op++ = uint8_t(len);
+    return op;
+}
+
+/* writes sequence token and literals, returns 0 if it does not fit */
+static inline uint8_t*
+write_literals(uint8_t* op, const uint8_t* const oend,
+               const uint8_t* const lit, size_t const lit_len,
+               size_t const match_len)
+{
+    /* token + literal length + literals + offset + match length */
+    if (size_t(oend - op) < 1 + lit_len/255 + 1 + lit_len + 2 +
+        match_len/255 + 1) return 0;
+
+    uint8_t* const token(op++);
+
+    if (lit_len >= RUN_MASK)
+    {
+        *token = RUN_MASK << 4;
+        op = write_length(op, lit_len - RUN_MASK);
+    }
+    else
+    {
+        *token = uint8_t(lit_len << 4);
+    }
+
+    if (match_len >= RUN_MASK) *token |= RUN_MASK;
+    else                       *token |= uint8_t(match_len);
+
+    ::memcpy(op, lit, lit_len);
+    return op + lit_len;
+}
+
+size_t
+gu::lz4_compress(const void* const src, size_t const src_size,
+                 void* const dst, size_t const dst_capacity)
+{
+    const uint8_t* const in  (static_cast<const uint8_t*>(src));
+    const uint8_t* const iend(in + src_size);
+    uint8_t*       const out (static_cast<uint8_t*>(dst));
+    uint8_t*       const oend(out + dst_capacity);
+
+    const uint8_t* ip    (in);
+    const uint8_t* anchor(in);
+    uint8_t*       op    (out);
+
+    if (src_size > MF_LIMIT)
+    {
+        const uint8_t* const mflimit   (iend - MF_LIMIT);
+        const uint8_t* const matchlimit(iend - LAST_LITERALS);
+
+        uint32_t table[1 << HASH_LOG];
+        ::memset(table, 0, sizeof(table));
+
+        for (++ip; ip < mflimit;)
+        {
+            uint32_t const seq(read32(ip));
+            uint32_t&      pos(table[hash(seq)]);
+            const uint8_t* ref(in + pos);
+            pos = uint32_t(ip - in);
+
+            if (size_t(ip - ref) > MAX_OFFSET || read32(ref) != seq)
+            {
+                ++ip;
+                continue;
+            }
+
+            while (ip > anchor && ref > in && ip[-1] == ref[-1])
+            {
+                --ip; --ref;
+            }
+
+            const uint8_t* mp(ip  + MIN_MATCH);
+            const uint8_t* rp(ref + MIN_MATCH);
+            while (mp < matchlimit && *mp == *rp) { ++mp; ++rp; }
+
+            size_t const match_len(mp - ip - MIN_MATCH);
+
+            op = write_literals(op, oend, anchor, ip - anchor, match_len);
+            if (0 == op) return 0;
+
+            size_t const offset(ip - ref);
+            *op++ = uint8_t(offset);
+            *op++ = uint8_t(offset >> 8);
+
+            if (match_len >= RUN_MASK)
+            {
+                op = write_length(op, match_len - RUN_MASK);
+            }
+
+            ip = anchor = mp;
+        }
+    }
+
+    op = write_literals(op, oend, anchor, iend - anchor, 0);
+    if (0 == op) return 0;
+
+    return op - out;
+}
+
+/* reads length continuation bytes, returns false on input overrun */
+static inline bool
+read_length(const uint8_t*& ip, const uint8_t* const iend, size_t& len)
+{
+    uint8_t b;
+    do
+    {
+        if (ip >= iend) return false;
+        b = *ip++;
+        len += b;
+    }
+    while (255 == b);
+
+    return true;
+}
+
+bool
+gu::lz4_decompress(const void* const src, size_t const src_size,
+                   void* const dst, size_t const dst_size)
+{
+    const uint8_t*       ip  (static_cast<const uint8_t*>(src));
+    const uint8_t* const iend(ip + src_size);
+    uint8_t*       const out (static_cast<uint8_t*>(dst));
+    uint8_t*             op  (out);
+    uint8_t*       const oend(out + dst_size);
+
+    while (ip < iend)
+    {
+        unsigned const token(*ip++);
+
+        size_t lit_len(token >> 4);
+        if (RUN_MASK == lit_len && !read_length(ip, iend, lit_len))
+            return false;
+
+        if (size_t(iend - ip) < lit_len || size_t(oend - op) < lit_len)
+            return false;
+
+        ::memcpy(op, ip, lit_len);
+        op += lit_len;
+        ip += lit_len;
+
+        if (ip == iend) break; // last sequence has no match
+
+        if (iend - ip < 2) return false;
+        size_t const offset(ip[0] | (size_t(ip[1]) << 8));
+        ip += 2;
+
+        if (0 == offset || size_t(op - out) < offset) return false;
+
+        size_t match_len(token & RUN_MASK);
+        if (RUN_MASK == match_len && !read_length(ip, iend, match_len))
+            return false;
+        match_len += MIN_MATCH;
+
+        if (size_t(oend - op) < match_len) return false;
+
+        const uint8_t* ref(op - offset);
+        if (offset >= match_len)
+        {
+            ::memcpy(op, ref, match_len);
+            op += match_len;
+        }
+        else /* overlapping copy repeats the pattern */
+        {
+            uint8_t* const mend(op + match_len);
+            while (op < mend) *op++ = *ref++;
+        }
+    }
+
+    return (op == oend);
+}
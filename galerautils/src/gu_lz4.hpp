@@ -0,0 +1,42 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+/**
+ * @file Minimal LZ4 block format compressor and decompressor.
+ *
+ * Favors speed over compression ratio: single pass greedy matching with
+ * a small hash table, no dictionary, no frame format. Output is a plain LZ4
+ * block, so it can be decoded by any LZ4 implementation provided that the
+ * size of uncompressed data is known.
+ */
+
+#ifndef GU_LZ4_HPP
+#define GU_LZ4_HPP
+
+#include <cstddef>
+
+namespace gu
+{
+    /*! @return maximum compressed size of the data of a given size */
+    static inline size_t
+    lz4_compress_bound(size_t const size) { return size + size/255 + 16; }
+
+    /*!
+     * Compresses data.
+     *
+     * @return size of the compressed data or 0 if it did not fit into dst
+     */
+    size_t lz4_compress  (const void* src, size_t src_size,
+                          void* dst, size_t dst_capacity);
+
+    /*!
+     * Decompresses data.
+     *
+     * @return true if exactly dst_size bytes were decompressed, false if the
+     *         input is malformed or decompresses to a different size.
+     */
+    bool   lz4_decompress(const void* src, size_t src_size,
+                          void* dst, size_t dst_size);
+
+} /* namespace gu */
+
+#endif /* GU_LZ4_HPP */
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "gu_mem_policy.hpp"
+
+#include "gu_limits.h" // GU_PAGE_SIZE
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cerrno>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+/* shrinks range to the whole pages inside it,
+ * returns false if there are none */
+static bool
+align_range(void*& ptr, size_t& size)
+{
+    uintptr_t const mask(GU_PAGE_SIZE - 1);
+    uintptr_t const begin((reinterpret_cast<uintptr_t>(ptr) + mask) & ~mask);
+    uintptr_t const end  ((reinterpret_cast<uintptr_t>(ptr) + size) & ~mask);
+
+    if (end <= begin) return false;
+
+    ptr  = reinterpret_cast<void*>(begin);
+    size = end - begin;
+    return true;
+}
+
+/* extends range to the whole pages it touches */
+static void
+expand_range(void*& ptr, size_t& size)
+{
+    uintptr_t const mask(GU_PAGE_SIZE - 1);
+    uintptr_t const begin(reinterpret_cast<uintptr_t>(ptr) & ~mask);
+    uintptr_t const end  ((reinterpret_cast<uintptr_t>(ptr) + size + mask)
+                          & ~mask);
+
+    ptr  = reinterpret_cast<void*>(begin);
+    size = end - begin;
+}
+
+int
+gu::mem_numa_node()
+{
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu, node;
+    if (0 == syscall(SYS_getcpu, &cpu, &node, NULL)) return node;
+#endif
+    return -1;
+}
+
+int
+gu::mem_bind_node(void* ptr, size_t size, int const node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    /* from <numaif.h>, to avoid dependency on libnuma */
+    static int      const POLICY_BIND = 2;      // MPOL_BIND
+    static unsigned const FLAG_MOVE   = 1 << 1; // MPOL_MF_MOVE
+
+    unsigned long mask;
+    if (node < 0 || size_t(node) >= sizeof(mask) * 8) return EINVAL;
+    if (!align_range(ptr, size)) return 0;
+
+    mask = 1UL << node;
+    /* kernel considers only maxnode - 1 bits of the mask */
+    if (syscall(SYS_mbind, ptr, size, POLICY_BIND, &mask,
+                sizeof(mask) * 8 + 1, FLAG_MOVE)) return errno;
+
+    return 0;
+#else
+    return ENOSYS;
+#endif
+}
+
+int
+gu::mem_advise_huge(void* ptr, size_t size)
+{
+#if defined(MADV_HUGEPAGE)
+    if (!align_range(ptr, size)) return 0;
+    if (::madvise(ptr, size, MADV_HUGEPAGE)) return errno;
+    return 0;
+#else
+    return ENOSYS;
+#endif
+}
+
+int
+gu::mem_advise_willneed(const void* const p, size_t size)
+{
+#if defined(MADV_WILLNEED)
+    void* ptr(const_cast<void*>(p));
+    expand_range(ptr, size);
+    if (size > 0 && ::madvise(ptr, size, MADV_WILLNEED)) return errno;
+    return 0;
+#else
+    return ENOSYS;
+#endif
+}
+
+size_t
+gu::mem_page_size(const void* const ptr)
+{
+    std::ifstream smaps("/proc/self/smaps");
+    uintptr_t const addr(reinterpret_cast<uintptr_t>(ptr));
+
+    size_t page_kb(0);
+    size_t huge_kb(0);
+    bool   found(false);
+    std::string line;
+
+    while (std::getline(smaps, line))
+    {
+        std::istringstream is(line);
+        std::string key;
+        is >> key;
+
+        if (key.empty()) continue;
+
+        if (key[key.length() - 1] != ':') /* mapping header: begin-end ... */
+        {
+            if (found) break;
+
+            std::istringstream range(key);
+            unsigned long long begin, end;
+            char dash;
+            range >> std::hex >> begin >> dash >> end;
+
+            found = (!range.fail() && begin <= addr && addr < end);
+            continue;
+        }
+
+        if (!found) continue;
+
+        size_t kb(0);
+        is >> kb;
+
+        if (key == "KernelPageSize:")
+        {
+            page_kb = kb;
+        }
+        else if (key == "AnonHugePages:"  ||
+                 key == "ShmemPmdMapped:" ||
+                 key == "FilePmdMapped:")
+        {
+            huge_kb += kb;
+        }
+    }
+
+    size_t const page_size(page_kb << 10);
+
+    /* some of the mapping is backed by transparent huge pages, which are
+     * as big as the memory mapped by one page of page table entries */
+    if (huge_kb > 0) return page_size * (page_size / sizeof(void*));
+
+    return page_size;
+}
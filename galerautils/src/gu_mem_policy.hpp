@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/**
+ * @file Memory placement policy helpers: NUMA binding, huge pages and
+ *       read-ahead.
+ *
+ * All functions are best effort: where the facility is not supported by the
+ * platform they do nothing and report it through the return value. Ranges
+ * need not be page aligned, unless noted otherwise only the whole pages
+ * inside them are affected.
+ *
+ * Policy applies to whole pages, so ranges must belong to mappings owned by
+ * the caller, not to malloc() heap, where pages are shared with unrelated
+ * allocations.
+ */
+
+#ifndef __GU_MEM_POLICY__
+#define __GU_MEM_POLICY__
+
+#include <cstddef>
+
+namespace gu
+{
+    /*! @return NUMA node of the CPU the calling thread runs on,
+     *          -1 if it can't be determined */
+    int    mem_numa_node();
+
+    /*! Binds memory range to a given NUMA node, migrating pages which are
+     *  already allocated elsewhere.
+     *  @return 0 on success, error code otherwise */
+    int    mem_bind_node(void* ptr, size_t size, int node);
+
+    /*! Advises kernel to back memory range with transparent huge pages.
+     *  @return 0 on success, error code otherwise */
+    int    mem_advise_huge(void* ptr, size_t size);
+
+    /*! Advises kernel that memory range will be accessed soon, so that
+     *  file backed pages get read ahead. All pages touched by the range
+     *  are affected.
+     *  @return 0 on success, error code otherwise */
+    int    mem_advise_willneed(const void* ptr, size_t size);
+
+    /*! @return size of the pages backing the mapping which contains ptr,
+     *          0 if it can't be determined */
+    size_t mem_page_size(const void* ptr);
+
+} /* namespace gu */
+
+#endif /* __GU_MEM_POLICY__ */
@@ -79,6 +79,16 @@ namespace gu
         }
     }
 
+    void
+    MMap::will_need() const
+    {
+        if (posix_madvise(reinterpret_cast<char*>(ptr), size, MADV_WILLNEED))
+        {
+            log_warn << "Failed to set MADV_WILLNEED on " << ptr << ": "
+                     << errno << " (" << strerror(errno) << ')';
+        }
+    }
+
     void
     MMap::sync(void* const addr, size_t const length) const
     {
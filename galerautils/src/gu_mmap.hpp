@@ -25,6 +25,7 @@ public:
     ~MMap ();
 
     void dont_need() const;
+    void will_need() const;
     void sync(void *addr, size_t length) const;
     void sync() const;
     void unmap();
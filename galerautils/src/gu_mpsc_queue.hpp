@@ -0,0 +1,143 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+/**
+ * @file Bounded lock-free multiple producer, single consumer queue.
+ *
+ * Values are kept in a ring of cells, every cell carries a sequence number
+ * which tells whether it is free for the producer holding a given ticket or
+ * holds a value for the consumer. Producers claim tickets with
+ * compare-and-swap, the consumer does not need any read-modify-write
+ * operations. Values are constructed in place and destroyed on pop(), so T
+ * needs only to be copy constructible.
+ *
+ * push() never blocks: it fails if the queue is full. front() and pop() may
+ * be called only from a single consumer thread.
+ */
+
+#ifndef GU_MPSC_QUEUE_HPP
+#define GU_MPSC_QUEUE_HPP
+
+#include "gu_atomic.hpp"
+
+#include <new>     // placement new
+#include <cassert>
+#include <cstddef>
+
+namespace gu
+{
+    template <typename T>
+    class MPSCQueue
+    {
+    public:
+
+        /*! @param capacity is rounded up to a power of 2 */
+        explicit MPSCQueue(size_t const capacity)
+            :
+            mask_ (round_up(capacity) - 1),
+            cells_(new Cell[mask_ + 1]),
+            head_ (0),
+            tail_ (0)
+        {
+            for (size_t i(0); i <= mask_; ++i) cells_[i].seq = i;
+        }
+
+        ~MPSCQueue()
+        {
+            while (front()) pop();
+            delete[] cells_;
+        }
+
+        /*! @return false if the queue is full */
+        bool push(const T& val)
+        {
+            long long pos(tail_());
+
+            while (true)
+            {
+                Cell& cell(cells_[pos & mask_]);
+                long long const diff(cell.seq() - pos);
+
+                if (0 == diff)
+                {
+                    /* on failure pos is updated to the current tail */
+                    if (tail_.compare_exchange(pos, pos + 1))
+                    {
+                        new (cell.ptr()) T(val);
+                        cell.seq = pos + 1;
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false; // cell was not consumed yet
+                }
+                else
+                {
+                    pos = tail_(); // other producer took the cell
+                }
+            }
+        }
+
+        /*! @return the oldest value or 0 if the queue is empty */
+        T* front()
+        {
+            long long const pos(head_());
+            Cell& cell(cells_[pos & mask_]);
+            return (cell.seq() == pos + 1 ? cell.ptr() : 0);
+        }
+
+        /*! removes the oldest value, the queue must not be empty */
+        void pop()
+        {
+            long long const pos(head_());
+            Cell& cell(cells_[pos & mask_]);
+            assert(cell.seq() == pos + 1);
+            cell.ptr()->~T();
+            cell.seq = pos + mask_ + 1;
+            head_ = pos + 1;
+        }
+
+        /*! @return number of values in the queue, approximate if there are
+         *          concurrent operations */
+        size_t size() const
+        {
+            long long const ret(tail_() - head_());
+            return (ret > 0 ? ret : 0);
+        }
+
+        size_t capacity() const { return mask_ + 1; }
+
+    private:
+
+        struct Cell
+        {
+            Cell() : seq(0) { }
+
+            T* ptr() { return reinterpret_cast<T*>(buf); }
+
+            gu::Atomic<long long> seq;
+            char buf[sizeof(T)] __attribute__((aligned(16)));
+        };
+
+        static size_t round_up(size_t const n)
+        {
+            size_t ret(1);
+            while (ret < n) ret <<= 1;
+            return ret;
+        }
+
+        /* producers and consumer positions are kept on separate cache lines
+         * to avoid false sharing */
+        size_t                const mask_;
+        Cell*                 const cells_;
+        char                        pad1_[64];
+        gu::Atomic<long long>       head_;
+        char                        pad2_[64];
+        gu::Atomic<long long>       tail_;
+
+        MPSCQueue(const MPSCQueue&);
+        MPSCQueue& operator=(const MPSCQueue&);
+    };
+}
+
+#endif /* GU_MPSC_QUEUE_HPP */
@@ -35,6 +35,7 @@ RecordSet::check_size (RecordSet::CheckType const ct)
     case RecordSet::CHECK_MMH32:  return 4;
     case RecordSet::CHECK_MMH64:  return 8;
     case RecordSet::CHECK_MMH128: return 16;
+    case RecordSet::CHECK_CRC32C: return 8;
 #define MAX_CHECKSUM_SIZE                16
     }
 
@@ -275,8 +276,17 @@ RecordSetOutBase::write_header (byte_t* const buf, ssize_t const size)
     if (check_type() != CHECK_NONE)
     {
         assert (csize <= size - off);
-        check_.append (buf + hdr_offset, off - hdr_offset); /* append header */
-        check_.gather (buf + off, csize);
+
+        if (CHECK_CRC32C == check_type())
+        {
+            crc_.append (buf + hdr_offset, off - hdr_offset); /* header */
+            gu::serialize8(uint64_t(crc_.get()), buf, off);
+        }
+        else
+        {
+            check_.append (buf + hdr_offset, off - hdr_offset); /* header */
+            check_.gather (buf + off, csize);
+        }
     }
 
     return hdr_offset;
@@ -375,6 +385,7 @@ RecordSetOutBase::RecordSetOutBase (byte_t*                 reserved,
 #endif
     alloc_      (base_name, reserved, reserved_size),
     check_      (),
+    crc_        (),
     bufs_       (),
     prev_stored_(true)
 {
@@ -427,6 +438,7 @@ header_check_type(RecordSet::Version const ver,
             return RecordSet::CHECK_MMH32;
         case RecordSet::CHECK_MMH64:  return RecordSet::CHECK_MMH64;
         case RecordSet::CHECK_MMH128: return RecordSet::CHECK_MMH128;
+        case RecordSet::CHECK_CRC32C: return RecordSet::CHECK_CRC32C;
         }
 
         gu_throw_error (EPROTO) << "Unsupported RecordSet checksum type: " << ct;
@@ -535,14 +547,27 @@ RecordSetInBase::checksum() const
 
     if (cs > 0) /* checksum records */
     {
-        Hash check;
-
-        check.append (head_ + begin_, serial_size() - begin_); /* records */
-        check.append (head_, begin_ - cs);                     /* header  */
-
         assert(cs <= MAX_CHECKSUM_SIZE);
         byte_t result[MAX_CHECKSUM_SIZE];
-        check.gather<sizeof(result)>(result);
+
+        if (CHECK_CRC32C == check_type())
+        {
+            CRC32C check;
+
+            check.append (head_ + begin_, serial_size() - begin_); /* records */
+            check.append (head_, begin_ - cs);                     /* header  */
+
+            gu::serialize8(uint64_t(check.get()), result, 0);
+        }
+        else
+        {
+            Hash check;
+
+            check.append (head_ + begin_, serial_size() - begin_); /* records */
+            check.append (head_, begin_ - cs);                     /* header  */
+
+            check.gather<sizeof(result)>(result);
+        }
 
         const byte_t* const stored_checksum(head_ + begin_ - cs);
 
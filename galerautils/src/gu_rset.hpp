@@ -16,6 +16,7 @@
 #include "gu_vector.hpp"
 #include "gu_alloc.hpp"
 #include "gu_digest.hpp"
+#include "gu_crc.hpp"
 
 #include "gu_limits.h" // GU_MIN_ALIGNMENT
 
@@ -46,7 +47,9 @@ public:
         CHECK_NONE   = 0,
         CHECK_MMH32,
         CHECK_MMH64,
-        CHECK_MMH128
+        CHECK_MMH128,
+        CHECK_CRC32C  /* hardware accelerated where available, stored
+                       * as 64-bit value to preserve VER2 alignment */
     };
 
     static int check_size(CheckType ct);
@@ -115,6 +118,9 @@ public:
     /*! return number of disjoint pages in the record set */
     ssize_t page_count() const { return bufs_->size() + padding_page_needed(); }
 
+    /*! return total size of memory allocated for stored records */
+    size_t alloc_size() const { return alloc_.size(); }
+
     /*! return vector of RecordSet fragments in adjusent order */
     ssize_t gather (GatherVector& out);
 
@@ -215,6 +221,7 @@ private:
 #endif
     Allocator     alloc_;
     Hash          check_;
+    CRC32C        crc_;
     Vector<Buf, Allocator::INITIAL_VECTOR_SIZE> bufs_;
     bool          prev_stored_;
 
@@ -252,7 +259,11 @@ private:
                  const byte_t* const ptr,
                  ssize_t const       size)
     {
-        check_.append (ptr, size);
+        if (CHECK_CRC32C == check_type())
+            crc_.append (ptr, size);
+        else
+            check_.append (ptr, size);
+
         post_alloc (new_page, ptr, size);
     }
 
@@ -0,0 +1,141 @@
+//
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+//
+
+#include "gu_thread_pool.hpp"
+
+#include "gu_throw.hpp"
+#include "gu_logger.hpp"
+
+gu::ThreadPool::ThreadPool(size_t const n_threads)
+    :
+    mtx_    (),
+    cond_   (),
+    queue_  (),
+    threads_(),
+    exit_   (false)
+{
+    threads_.reserve(n_threads);
+
+    for (size_t i(0); i < n_threads; ++i)
+    {
+        gu_thread_t thd;
+        int const err(gu_thread_create(&thd, NULL, thread_func, this));
+
+        if (gu_unlikely(err != 0))
+        {
+            {
+                Lock lock(mtx_);
+                exit_ = true;
+                cond_.broadcast();
+            }
+
+            for (size_t j(0); j < threads_.size(); ++j)
+            {
+                gu_thread_join(threads_[j], NULL);
+            }
+
+            gu_throw_error(err) << "Failed to create thread pool thread "
+                                << i << " of " << n_threads;
+        }
+
+        threads_.push_back(thd);
+    }
+}
+
+gu::ThreadPool::~ThreadPool()
+{
+    {
+        Lock lock(mtx_);
+        exit_ = true;
+        cond_.broadcast();
+    }
+
+    for (size_t i(0); i < threads_.size(); ++i)
+    {
+        gu_thread_join(threads_[i], NULL);
+    }
+
+    assert(queue_.empty());
+}
+
+size_t
+gu::ThreadPool::queue_len() const
+{
+    Lock lock(mtx_);
+    return queue_.size();
+}
+
+void
+gu::ThreadPool::run_job(Job& job)
+{
+    try
+    {
+        job.run();
+    }
+    catch (std::exception& e)
+    {
+        log_error << "Exception in thread pool job: " << e.what();
+        assert(0);
+    }
+    catch (...)
+    {
+        log_error << "Unknown exception in thread pool job";
+        assert(0);
+    }
+}
+
+void
+gu::ThreadPool::submit(Job& job)
+{
+    if (threads_.empty())
+    {
+        run_job(job);
+        return;
+    }
+
+    Lock lock(mtx_);
+
+    assert(job.done_);
+    job.done_ = false;
+    queue_.push_back(&job);
+    cond_.signal();
+}
+
+void
+gu::ThreadPool::wait(Job& job)
+{
+    Lock lock(mtx_);
+
+    while (!job.done_) lock.wait(job.cond_);
+}
+
+void*
+gu::ThreadPool::thread_func(void* arg)
+{
+    static_cast<ThreadPool*>(arg)->work();
+    return 0;
+}
+
+void
+gu::ThreadPool::work()
+{
+    Lock lock(mtx_);
+
+    while (true)
+    {
+        while (queue_.empty() && !exit_) lock.wait(cond_);
+
+        if (queue_.empty()) break; // exit_ is set and nothing left to do
+
+        Job* const job(queue_.front());
+        queue_.pop_front();
+
+        mtx_.unlock();
+        run_job(*job);
+        mtx_.lock();
+
+        job->done_ = true;
+        job->cond_.signal();
+    }
+}
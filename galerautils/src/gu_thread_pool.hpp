@@ -0,0 +1,93 @@
+//
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+//
+
+//
+// Fixed size pool of worker threads executing jobs in FIFO order.
+//
+
+#ifndef GU_THREAD_POOL_HPP
+#define GU_THREAD_POOL_HPP
+
+#include "gu_threads.h"
+#include "gu_lock.hpp" // gu::Mutex and gu::Cond
+
+#include <deque>
+#include <vector>
+
+namespace gu
+{
+    class ThreadPool
+    {
+    public:
+
+        //
+        // Unit of work to be executed by the pool. Jobs are not owned by
+        // the pool: the submitter must keep the job object alive until
+        // wait() on it has returned. Job may be resubmitted after that.
+        //
+        // run() is expected to handle its own errors. Exceptions escaping
+        // from run() are logged and the job is considered done.
+        //
+        class Job
+        {
+        public:
+
+            Job() : cond_(), done_(true) { }
+
+            virtual ~Job() { }
+
+            virtual void run() = 0;
+
+        private:
+
+            friend class ThreadPool;
+
+            Job(const Job&);
+            Job& operator=(const Job&);
+
+            Cond cond_;
+            bool done_;
+        };
+
+        //
+        // Create pool of n_threads worker threads. If n_threads is 0,
+        // jobs are executed synchronously in the context of submit().
+        //
+        explicit ThreadPool(size_t n_threads);
+
+        //
+        // Executes all jobs remaining in queue and joins worker threads.
+        //
+        ~ThreadPool();
+
+        // Number of worker threads
+        size_t size() const { return threads_.size(); }
+
+        // Number of jobs waiting for a free worker
+        size_t queue_len() const;
+
+        // Enqueue job for execution
+        void submit(Job& job);
+
+        // Wait until job submitted earlier has been run
+        void wait(Job& job);
+
+    private:
+
+        ThreadPool(const ThreadPool&);
+        ThreadPool& operator=(const ThreadPool&);
+
+        static void* thread_func(void* arg);
+        void         work();
+        static void  run_job(Job& job);
+
+        Mutex                    mtx_;
+        Cond                     cond_;
+        std::deque<Job*>         queue_;
+        std::vector<gu_thread_t> threads_;
+        bool                     exit_;
+    };
+}
+
+#endif // GU_THREAD_POOL_HPP
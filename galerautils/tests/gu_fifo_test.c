@@ -94,6 +94,54 @@ START_TEST (gu_fifo_test)
 }
 END_TEST
 
+#define BATCH_MAX 100
+
+START_TEST (gu_fifo_batch_test)
+{
+    gu_fifo_t* fifo = gu_fifo_create (FIFO_LENGTH, sizeof(size_t));
+    ck_assert(fifo != NULL);
+
+    size_t* item;
+    long i;
+
+    for (i = 0; i < FIFO_LENGTH; i++) {
+        item = gu_fifo_get_tail (fifo);
+        ck_assert_msg(item != NULL, "could not get item %ld", i);
+        *item = i;
+        gu_fifo_push_tail (fifo);
+    }
+
+    void* items[BATCH_MAX];
+    long  expected = 0;
+
+    /* batches must cross row boundaries */
+    while (expected < FIFO_LENGTH) {
+        long const n = gu_fifo_get_heads (fifo, items, BATCH_MAX);
+        ck_assert_msg(n == BATCH_MAX || n == FIFO_LENGTH - expected,
+                      "got %ld items at %ld", n, expected);
+
+        for (i = 0; i < n; i++, expected++) {
+            item = items[i];
+            ck_assert_msg(*item == (size_t)expected, "got %zu, expected %ld",
+                          *item, expected);
+        }
+
+        gu_fifo_pop_heads (fifo, n);
+
+        ck_assert_msg(gu_fifo_length(fifo) == FIFO_LENGTH - expected,
+                      "length %ld, expected %ld",
+                      gu_fifo_length(fifo), FIFO_LENGTH - expected);
+    }
+
+    gu_fifo_close (fifo);
+
+    long const ret = gu_fifo_get_heads (fifo, items, BATCH_MAX);
+    ck_assert(ret == -ENODATA);
+
+    gu_fifo_destroy (fifo);
+}
+END_TEST
+
 static gu_mutex_t
 sync_mtx = GU_MUTEX_INITIALIZER;
 
@@ -242,6 +290,7 @@ Suite *gu_fifo_suite(void)
 
     suite_add_tcase (s, tc);
     tcase_add_test  (tc, gu_fifo_test);
+    tcase_add_test  (tc, gu_fifo_batch_test);
     tcase_add_test  (tc, gu_fifo_cancel_test);
     tcase_set_timeout(tc, 60);
 
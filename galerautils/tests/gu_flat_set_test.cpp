@@ -0,0 +1,152 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#include "../src/gu_flat_set.hpp"
+
+#include "gu_flat_set_test.hpp"
+
+#include <cstdlib> // rand()
+#include <set>
+#include <vector>
+
+struct IntHash
+{
+    size_t operator()(const int* const i) const { return *i; }
+};
+
+/* forces collisions to exercise probing and displacement */
+struct BadIntHash
+{
+    size_t operator()(const int* const i) const { return *i % 7; }
+};
+
+struct IntEqual
+{
+    bool operator()(const int* const l, const int* const r) const
+    {
+        return *l == *r;
+    }
+};
+
+START_TEST(basic)
+{
+    typedef gu::FlatPtrSet<int, IntHash, IntEqual> Set;
+    Set s;
+
+    ck_assert(s.empty());
+    ck_assert(s.capacity() == 0);
+    ck_assert(s.begin() == s.end());
+
+    int a(1), b(2), a1(1);
+
+    ck_assert(s.find(&a) == s.end());
+
+    std::pair<Set::iterator, bool> res(s.insert(&a));
+    ck_assert(res.second);
+    ck_assert(*res.first == &a);
+    ck_assert(s.size() == 1);
+
+    res = s.insert(&a1); // equal value
+    ck_assert(!res.second);
+    ck_assert(*res.first == &a);
+    ck_assert(s.size() == 1);
+
+    s.insert(&b);
+    ck_assert(s.size() == 2);
+    ck_assert(*s.find(&a1) == &a);
+    ck_assert(*s.find(&b) == &b);
+
+    size_t n(0);
+    for (Set::iterator i(s.begin()); i != s.end(); ++i) ++n;
+    ck_assert(n == s.size());
+
+    s.erase(s.find(&a));
+    ck_assert(s.size() == 1);
+    ck_assert(s.find(&a) == s.end());
+    ck_assert(*s.find(&b) == &b);
+
+    s.clear();
+    ck_assert(s.empty());
+    ck_assert(s.capacity() == 0);
+    ck_assert(s.find(&b) == s.end());
+}
+END_TEST
+
+template <class Hash>
+static void
+random_test(int const max_val)
+{
+    typedef gu::FlatPtrSet<int, Hash, IntEqual> Set;
+    Set           s;
+    std::set<int> control;
+
+    std::vector<int> vals(max_val);
+    for (int i(0); i < max_val; ++i) vals[i] = i;
+
+    ::srand(max_val);
+
+    for (int n(0); n < max_val * 20; ++n)
+    {
+        int const v(::rand() % max_val);
+        int*  const p(&vals[v]);
+
+        if (::rand() % 3)
+        {
+            bool const inserted(s.insert(p).second);
+            ck_assert(inserted == control.insert(v).second);
+        }
+        else
+        {
+            typename Set::iterator const it(s.find(p));
+            bool const found(it != s.end());
+            ck_assert(found == (control.erase(v) > 0));
+            if (found) s.erase(it);
+        }
+
+        ck_assert(s.size() == control.size());
+        ck_assert(s.size() <= s.capacity());
+    }
+
+    for (int i(0); i < max_val; ++i)
+    {
+        bool const found(s.find(&vals[i]) != s.end());
+        ck_assert(found == (control.count(i) > 0));
+    }
+
+    size_t n(0);
+    for (typename Set::iterator i(s.begin()); i != s.end(); ++i)
+    {
+        ck_assert(control.count(**i) > 0);
+        ++n;
+    }
+    ck_assert(n == control.size());
+}
+
+START_TEST(random_good_hash)
+{
+    random_test<IntHash>(10000);
+}
+END_TEST
+
+START_TEST(random_bad_hash)
+{
+    random_test<BadIntHash>(500);
+}
+END_TEST
+
+Suite* gu_flat_set_suite()
+{
+    Suite* s = suite_create("gu::FlatPtrSet");
+    TCase* t;
+
+    t = tcase_create("basic");
+    tcase_add_test(t, basic);
+    suite_add_tcase(s, t);
+
+    t = tcase_create("random");
+    tcase_add_test(t, random_good_hash);
+    tcase_add_test(t, random_bad_hash);
+    tcase_set_timeout(t, 60);
+    suite_add_tcase(s, t);
+
+    return s;
+}
@@ -0,0 +1,10 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#ifndef __gu_flat_set_test__
+#define __gu_flat_set_test__
+
+#include <check.h>
+
+extern Suite *gu_flat_set_suite(void);
+
+#endif /* __gu_flat_set_test__ */
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2014 Codership Oy <info@codership.com>
+ * Copyright (C) 2014-2020 Codership Oy <info@codership.com>
  */
 
 #include "../src/gu_histogram.hpp"
@@ -28,6 +28,8 @@ START_TEST(test_histogram)
     hs.clear();
 
     log_info << hs;
+    ck_assert_msg(hs.to_string().find("nan") == std::string::npos,
+                  "empty histogram: %s", hs.to_string().c_str());
 }
 END_TEST
 
@@ -0,0 +1,110 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#include "../src/gu_lz4.hpp"
+
+#include "gu_lz4_test.hpp"
+
+#include <cstdlib> // rand()
+#include <cstring>
+#include <string>
+#include <vector>
+
+static void
+roundtrip(const std::vector<unsigned char>& in, size_t const max_size)
+{
+    std::vector<unsigned char> c(gu::lz4_compress_bound(in.size()));
+    size_t const c_size(gu::lz4_compress(in.data(), in.size(),
+                                         c.data(), c.size()));
+
+    ck_assert_msg(c_size > 0 && c_size <= max_size,
+                  "%zu bytes compressed to %zu, expected at most %zu",
+                  in.size(), c_size, max_size);
+
+    std::vector<unsigned char> out(in.size());
+    ck_assert(gu::lz4_decompress(c.data(), c_size, out.data(), out.size()));
+    ck_assert(out == in);
+
+    /* wrong expected size must be detected */
+    std::vector<unsigned char> longer(in.size() + 1);
+    ck_assert(!gu::lz4_decompress(c.data(), c_size,
+                                  longer.data(), longer.size()));
+}
+
+START_TEST(compressible)
+{
+    std::string const text("INSERT INTO t1 VALUES (1, 'some text here'); ");
+    std::vector<unsigned char> in;
+
+    for (int i(0); i < 1000; ++i) in.insert(in.end(), text.begin(), text.end());
+    roundtrip(in, in.size() / 10);
+
+    /* long runs: overlapping matches and long length encoding */
+    std::vector<unsigned char> zeros(100000, 0);
+    roundtrip(zeros, zeros.size() / 100);
+}
+END_TEST
+
+START_TEST(incompressible)
+{
+    std::vector<unsigned char> in(65536);
+    ::srand(65536);
+    for (size_t i(0); i < in.size(); ++i) in[i] = ::rand();
+
+    roundtrip(in, gu::lz4_compress_bound(in.size()));
+
+    /* does not fit into the size of the input */
+    std::vector<unsigned char> c(in.size());
+    ck_assert(0 == gu::lz4_compress(in.data(), in.size(), c.data(), c.size()));
+}
+END_TEST
+
+START_TEST(small)
+{
+    for (size_t size(0); size < 32; ++size)
+    {
+        std::vector<unsigned char> in(size, 'a');
+        roundtrip(in, gu::lz4_compress_bound(size));
+    }
+}
+END_TEST
+
+START_TEST(corrupted)
+{
+    std::vector<unsigned char> in(10000);
+    for (size_t i(0); i < in.size(); ++i) in[i] = i % 100;
+
+    std::vector<unsigned char> c(gu::lz4_compress_bound(in.size()));
+    size_t const c_size(gu::lz4_compress(in.data(), in.size(),
+                                         c.data(), c.size()));
+    ck_assert(c_size > 0);
+
+    std::vector<unsigned char> out(in.size());
+
+    /* truncated input */
+    ck_assert(!gu::lz4_decompress(c.data(), c_size / 2,
+                                  out.data(), out.size()));
+
+    /* garbage must never write past the output buffer */
+    ::srand(c_size);
+    for (int i(0); i < 1000; ++i)
+    {
+        std::vector<unsigned char> bad(c.begin(), c.begin() + c_size);
+        bad[::rand() % bad.size()] = ::rand();
+        gu::lz4_decompress(bad.data(), bad.size(), out.data(), out.size());
+    }
+}
+END_TEST
+
+Suite *gu_lz4_suite(void)
+{
+    Suite *s  = suite_create("gu::lz4");
+    TCase *tc = tcase_create("lz4");
+
+    tcase_add_test(tc, compressible);
+    tcase_add_test(tc, incompressible);
+    tcase_add_test(tc, small);
+    tcase_add_test(tc, corrupted);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
@@ -0,0 +1,108 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#include "../src/gu_mpsc_queue.hpp"
+#include "../src/gu_threads.h"
+
+#include "gu_mpsc_queue_test.hpp"
+
+#include <sched.h> // sched_yield()
+#include <string>
+#include <vector>
+
+START_TEST(basic)
+{
+    gu::MPSCQueue<std::string> q(3);
+
+    ck_assert(q.capacity() == 4);
+    ck_assert(q.front() == 0);
+    ck_assert(q.size() == 0);
+
+    for (int i(0); i < 4; ++i) ck_assert(q.push(std::string(i + 1, 'a')));
+    ck_assert(!q.push("full"));
+    ck_assert(q.size() == 4);
+
+    /* wrap around several times */
+    for (int i(0); i < 10; ++i)
+    {
+        ck_assert(q.front() != 0);
+        ck_assert_msg(q.front()->size() == size_t(i + 1), "expected %d, got %zu",
+                      i + 1, q.front()->size());
+        q.pop();
+        ck_assert(q.push(std::string(i + 5, 'a')));
+    }
+
+    ck_assert(q.size() == 4);
+    /* remaining values are destroyed by destructor */
+}
+END_TEST
+
+struct ProducerArgs
+{
+    gu::MPSCQueue<long>* q;
+    long                 id;
+    long                 n;
+};
+
+static void* producer(void* arg)
+{
+    ProducerArgs* const a(static_cast<ProducerArgs*>(arg));
+
+    for (long i(0); i < a->n; ++i)
+    {
+        while (!a->q->push(a->id * a->n + i)) sched_yield();
+    }
+
+    return 0;
+}
+
+START_TEST(producers)
+{
+    static int  const P = 4;
+    static long const N = 100000;
+
+    gu::MPSCQueue<long> q(64);
+
+    std::vector<ProducerArgs> args(P);
+    std::vector<gu_thread_t>  threads(P);
+
+    for (int p(0); p < P; ++p)
+    {
+        ProducerArgs const a = { &q, p, N };
+        args[p] = a;
+        gu_thread_create(&threads[p], NULL, producer, &args[p]);
+    }
+
+    /* values of each producer must come in order */
+    std::vector<long> next(P, 0);
+
+    for (long i(0); i < P * N; ++i)
+    {
+        long* v;
+        while (0 == (v = q.front())) sched_yield();
+
+        long const p(*v / N);
+        ck_assert(p >= 0 && p < P);
+        ck_assert_msg(*v % N == next[p], "producer %ld: expected %ld, got %ld",
+                      p, next[p], *v % N);
+        ++next[p];
+        q.pop();
+    }
+
+    for (int p(0); p < P; ++p) gu_thread_join(threads[p], NULL);
+
+    ck_assert(q.front() == 0);
+}
+END_TEST
+
+Suite *gu_mpsc_queue_suite(void)
+{
+    Suite *s  = suite_create("gu::MPSCQueue");
+    TCase *tc = tcase_create("mpsc_queue");
+
+    tcase_add_test(tc, basic);
+    tcase_add_test(tc, producers);
+    tcase_set_timeout(tc, 60);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
@@ -0,0 +1,10 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#ifndef __gu_mpsc_queue_test__
+#define __gu_mpsc_queue_test__
+
+#include <check.h>
+
+extern Suite *gu_mpsc_queue_suite(void);
+
+#endif /* __gu_mpsc_queue_test__ */
@@ -126,7 +126,8 @@ START_TEST (empty)
 END_TEST
 
 static void
-test_version (gu::RecordSet::Version version)
+test_version (gu::RecordSet::Version  version,
+              gu::RecordSet::CheckType ct = gu::RecordSet::CHECK_MMH64)
 {
     int const alignment(gu::RecordSet::VER2 == version ?
                         gu::RecordSet::VER2_ALIGNMENT : 1);
@@ -155,10 +156,10 @@ test_version (gu::RecordSet::Version version)
     union { gu_word_t align; gu::byte_t buf[1024]; } reserved;
     assert((uintptr_t(reserved.buf) % GU_WORD_BYTES) == 0);
     std::ostringstream os;
-    os << "gu_rset_test_ver" << version;
+    os << "gu_rset_test_ver" << version << "_ct" << ct;
     TestBaseName str(os.str().c_str());
     gu::RecordSetOut<TestRecord> rset_out(reserved.buf, sizeof(reserved), str,
-                                          gu::RecordSet::CHECK_MMH64, version);
+                                          ct, version);
 
     size_t offset(rset_out.size());
     ck_assert(1 == rset_out.page_count());
@@ -344,6 +345,7 @@ test_version (gu::RecordSet::Version version)
 
     gu::RecordSetIn<TestRecord> const rset_in(in_buf.data(), in_buf.size());
 
+    ck_assert(rset_in.check_type() == ct);
     ck_assert(rset_in.size()  == rset_out.size());
     ck_assert(rset_in.count() == rset_out.count());
     ck_assert(rset_in.serial_size() == rset_out.serial_size());
@@ -424,6 +426,20 @@ START_TEST (ver2)
 }
 END_TEST
 
+START_TEST (ver1_crc32c)
+{
+    gu_crc32c_configure();
+    test_version(gu::RecordSet::VER1, gu::RecordSet::CHECK_CRC32C);
+}
+END_TEST
+
+START_TEST (ver2_crc32c)
+{
+    gu_crc32c_configure();
+    test_version(gu::RecordSet::VER2, gu::RecordSet::CHECK_CRC32C);
+}
+END_TEST
+
 /* This test is to test how padding mixes with persistent (stored outside)
  * pages. In this case new padding buf needs to be allocated */
 static void
@@ -531,6 +547,8 @@ START_TEST (ver2_sizes)
     size_t s, ct_s, rs, es;
     int c;
 
+    gu_crc32c_configure(); // for CHECK_CRC32C
+
 #ifdef NDEBUG
     ct   = gu::RecordSet::CHECK_MMH32;
     ct_s = gu::RecordSet::check_size(ct);
@@ -578,6 +596,15 @@ START_TEST (ver2_sizes)
     es   = 16 + ct_s + GU_ALIGN(c*s, gu::RecordSet::VER2_ALIGNMENT);
     ck_assert(rs == es);
 
+    ct   = gu::RecordSet::CHECK_CRC32C;
+    ct_s = gu::RecordSet::check_size(ct);
+    c  = 1;  // record count
+    s  = 64; // record size
+    rs = ver2_size(c, s, ct);
+    // expected size: short header(8) + checksum size + aligned payload size
+    es   = 8 + ct_s + GU_ALIGN(c*s, gu::RecordSet::VER2_ALIGNMENT);
+    ck_assert(rs == es);
+
     ct   = gu::RecordSet::CHECK_NONE;
     ct_s = gu::RecordSet::check_size(ct);
     c  = 1023;
@@ -597,6 +624,7 @@ Suite* gu_rset_suite ()
     tcase_add_test (t, empty);
     tcase_add_test (t, ver1);
     tcase_add_test (t, ver1_padding);
+    tcase_add_test (t, ver1_crc32c);
 #ifndef GALERA_ONLY_ALIGNED
     suite_add_tcase (s, t);
 #endif
@@ -604,6 +632,7 @@ Suite* gu_rset_suite ()
     t = tcase_create("RecordSet v2");
     tcase_add_test (t, ver2);
     tcase_add_test (t, ver2_padding);
+    tcase_add_test (t, ver2_crc32c);
     tcase_add_test (t, ver2_sizes);
     suite_add_tcase (s, t);
 //    tcase_set_timeout(t, 60);
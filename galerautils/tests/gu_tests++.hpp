@@ -26,8 +26,12 @@
 #include "gu_histogram_test.hpp"
 #include "gu_stats_test.hpp"
 #include "gu_thread_test.hpp"
+#include "gu_thread_pool_test.hpp"
 #include "gu_asio_test.hpp"
 #include "gu_deqmap_test.hpp"
+#include "gu_flat_set_test.hpp"
+#include "gu_lz4_test.hpp"
+#include "gu_mpsc_queue_test.hpp"
 
 typedef Suite *(*suite_creator_t)(void);
 
@@ -49,8 +53,12 @@ static suite_creator_t suites[] =
     gu_histogram_suite,
     gu_stats_suite,
     gu_thread_suite,
+    gu_thread_pool_suite,
     gu_asio_suite,
     gu_deqmap_suite,
+    gu_flat_set_suite,
+    gu_lz4_suite,
+    gu_mpsc_queue_suite,
     0
 };
 
@@ -0,0 +1,110 @@
+//
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+//
+
+#include "gu_thread_pool.hpp"
+#include "gu_atomic.hpp"
+
+#include "gu_thread_pool_test.hpp"
+
+#include <vector>
+
+class CountJob : public gu::ThreadPool::Job
+{
+public:
+
+    CountJob(gu::Atomic<long>& count) : count_(count), self_() { }
+
+    void run()
+    {
+        ++count_;
+        self_ = gu_thread_self();
+    }
+
+    gu_thread_t self() const { return self_; }
+
+private:
+
+    gu::Atomic<long>& count_;
+    gu_thread_t       self_;
+};
+
+START_TEST(test_thread_pool_sync)
+{
+    gu::ThreadPool pool(0);
+    ck_assert(pool.size() == 0);
+
+    gu::Atomic<long> count(0);
+    CountJob job(count);
+
+    pool.submit(job);
+    ck_assert(count() == 1);
+    ck_assert(gu_thread_equal(job.self(), gu_thread_self()));
+
+    pool.wait(job); // must not block
+    ck_assert(count() == 1);
+}
+END_TEST
+
+START_TEST(test_thread_pool_async)
+{
+    static size_t const n_threads(4);
+    static size_t const n_jobs(64);
+    static int    const n_rounds(16);
+
+    gu::ThreadPool pool(n_threads);
+    ck_assert(pool.size() == n_threads);
+
+    gu::Atomic<long> count(0);
+    std::vector<CountJob*> jobs;
+    for (size_t i(0); i < n_jobs; ++i) jobs.push_back(new CountJob(count));
+
+    for (int r(0); r < n_rounds; ++r)
+    {
+        for (size_t i(0); i < n_jobs; ++i) pool.submit(*jobs[i]);
+        for (size_t i(0); i < n_jobs; ++i) pool.wait(*jobs[i]);
+
+        ck_assert_msg(count() == long((r + 1)*n_jobs),
+                      "count %ld, expected %ld", count(), long((r+1)*n_jobs));
+    }
+
+    for (size_t i(0); i < n_jobs; ++i)
+    {
+        ck_assert(!gu_thread_equal(jobs[i]->self(), gu_thread_self()));
+        delete jobs[i];
+    }
+
+    ck_assert(pool.queue_len() == 0);
+}
+END_TEST
+
+START_TEST(test_thread_pool_drain)
+{
+    gu::Atomic<long> count(0);
+    std::vector<CountJob*> jobs;
+    for (size_t i(0); i < 32; ++i) jobs.push_back(new CountJob(count));
+
+    {
+        gu::ThreadPool pool(2);
+        for (size_t i(0); i < jobs.size(); ++i) pool.submit(*jobs[i]);
+        // destructor must run all queued jobs before joining
+    }
+
+    ck_assert(count() == long(jobs.size()));
+
+    for (size_t i(0); i < jobs.size(); ++i) delete jobs[i];
+}
+END_TEST
+
+Suite* gu_thread_pool_suite()
+{
+    Suite* s(suite_create("galerautils ThreadPool"));
+    TCase* tc(tcase_create("thread_pool"));
+
+    suite_add_tcase(s, tc);
+    tcase_add_test(tc, test_thread_pool_sync);
+    tcase_add_test(tc, test_thread_pool_async);
+    tcase_add_test(tc, test_thread_pool_drain);
+
+    return s;
+}
@@ -0,0 +1,12 @@
+//
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+//
+
+#ifndef GU_THREAD_POOL_TEST_HPP
+#define GU_THREAD_POOL_TEST_HPP
+
+#include <check.h>
+
+extern Suite *gu_thread_pool_suite();
+
+#endif // GU_THREAD_POOL_TEST_HPP
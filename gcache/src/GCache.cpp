@@ -6,6 +6,7 @@
 #include "gcache_bh.hpp"
 
 #include <gu_logger.hpp>
+#include <gu_mem_policy.hpp>
 
 #include <cerrno>
 #include <unistd.h>
@@ -15,6 +16,8 @@ namespace gcache
     void
     GCache::reset()
     {
+        discard_compressed();
+
         mem.reset();
         rb.reset();
         ps.reset();
@@ -29,6 +32,7 @@ namespace gcache
         seqno_locked_count = 0;
 
         seqno2ptr.clear(SEQNO_NONE);
+        seqno_index.clear();
 
 #ifndef NDEBUG
         buf_tracker.clear();
@@ -41,19 +45,30 @@ namespace gcache
         params    (config, data_dir),
         mtx       (),
         seqno2ptr (SEQNO_NONE),
+        seqno_index(),
         gid       (),
         mem       (params.mem_size(), seqno2ptr, params.debug()),
         rb        (params.rb_name(), params.rb_size(), seqno2ptr, gid,
-                   params.debug(), params.recover()),
+                   params.debug(), params.recover(),
+                   params.recover_threads(), params.huge_pages()),
         ps        (params.dir_name(),
                    params.keep_pages_size(),
                    params.page_size(),
                    params.debug(),
                    /* keep last page if PS is the only storage */
-                   !((params.mem_size() + params.rb_size()) > 0)),
+                   !((params.mem_size() + params.rb_size()) > 0),
+                   params.page_pool_size()),
         mallocs   (0),
         reallocs  (0),
         frees     (0),
+        compress_raw (0),
+        compress_out (0),
+        compress_ns  (0),
+        decompress_ns(0),
+        compress_buf (),
+        compress_jobs(),
+        compress_cond(),
+        compress_busy(false),
         seqno_max     (seqno2ptr.empty() ?
                        SEQNO_NONE : seqno2ptr.index_back()),
         seqno_released(seqno_max),
@@ -62,16 +77,46 @@ namespace gcache
 #ifndef NDEBUG
         ,buf_tracker()
 #endif
-    {}
+    {
+        mem.set_huge_pages(params.huge_pages());
+
+        /* publish recovered history */
+        for (seqno2ptr_t::iterator i(seqno2ptr.begin()); i != seqno2ptr.end();
+             ++i)
+        {
+            if (*i) seqno_index.insert(seqno2ptr.index(i), *i);
+        }
+    }
 
     GCache::~GCache ()
     {
         gu::Lock lock(mtx);
+        while (compress_busy) lock.wait(compress_cond);
+        discard_compressed(); // otherwise pages can't be deleted
         log_debug << "\n" << "GCache mallocs : " << mallocs
                   << "\n" << "GCache reallocs: " << reallocs
                   << "\n" << "GCache frees   : " << frees;
     }
 
+    void GCache::numa_bind()
+    {
+        if (!params.numa_bind()) return;
+
+        int const node(gu::mem_numa_node());
+
+        if (node < 0)
+        {
+            log_warn << "Failed to determine NUMA node of the current thread, "
+                     << "GCache memory is left unbound.";
+            return;
+        }
+
+        gu::Lock lock(mtx);
+
+        mem.set_numa_node(node);
+        rb.bind_node(node);
+    }
+
     /*! prints object properties */
     void print (std::ostream& os) {}
 }
@@ -115,6 +160,12 @@ int64_t gcache_seqno_min (gcache_t* gc)
     return gcache->seqno_min ();
 }
 
+void gcache_numa_bind (gcache_t* gc)
+{
+    gcache::GCache* gcache = reinterpret_cast<gcache::GCache*>(gc);
+    gcache->numa_bind ();
+}
+
 #if DEPRECATED
 void  gcache_seqno_init   (gcache_t* gc, int64_t seqno)
 {
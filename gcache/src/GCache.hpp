@@ -8,14 +8,17 @@
 #include "gcache_mem_store.hpp"
 #include "gcache_rb_store.hpp"
 #include "gcache_page_store.hpp"
+#include "gcache_seqno_index.hpp"
 #include "gcache_types.hpp"
 
 #include <gu_types.hpp>
 #include <gu_lock.hpp> // for gu::Mutex and gu::Cond
+#include <gu_atomic.hpp>
 #include <gu_config.hpp>
 
 #include <string>
 #include <iostream>
+#include <vector>
 #ifndef NDEBUG
 #include <set>
 #endif
@@ -84,6 +87,45 @@ namespace gcache
                 return SEQNO_ILL;
         }
 
+        /*!
+         * Returns time spent on ring buffer recovery on startup (ns)
+         */
+        long long recover_time() const { return rb.recover_time(); }
+
+        /*!
+         * Returns page store statistics
+         */
+        PageStore::Stats page_stats() const
+        {
+            gu::Lock lock(mtx);
+            return ps.stats();
+        }
+
+        struct CompressStats
+        {
+            long long raw_bytes;        // compressed so far
+            long long compressed_bytes; // what raw_bytes were compressed to
+            long long compress_ns;      // total time spent on compression
+            long long decompress_ns;    // total time spent on decompression
+        };
+
+        /*!
+         * Returns buffer compression statistics (gcache.compress)
+         */
+        CompressStats compress_stats() const;
+
+        /*!
+         * Returns size of the pages backing ring buffer
+         */
+        size_t rb_page_size() const { return rb.page_size(); }
+
+        /*!
+         * Binds cache memory to the NUMA node of the calling thread
+         * if gcache.numa_bind is set. Meant to be called by the thread
+         * which writes incoming actions to cache.
+         */
+        void  numa_bind();
+
         /*!
          * Move lock to a given seqno.
          * @throws gu::NotFound if seqno is not in the cache.
@@ -93,7 +135,7 @@ namespace gcache
         /*!          DEPRECATED
          * Get pointer to buffer identified by seqno.
          * Moves lock to the given seqno.
-         * @throws NotFound
+         * @throws NotFound, also if the buffer is compressed
          */
         const void* seqno_get_ptr (seqno_t  seqno_g,
                                    seqno_t& seqno_d,
@@ -103,15 +145,21 @@ namespace gcache
         {
         public:
 
-            Buffer() : seqno_g_(), seqno_d_(), ptr_(), size_() { }
+            Buffer() : seqno_g_(), seqno_d_(), ptr_(), size_(), fd_(-1),
+                       offset_(), plain_() { }
 
             Buffer (const Buffer& other)
                 :
                 seqno_g_(other.seqno_g_),
                 seqno_d_(other.seqno_d_),
                 ptr_    (other.ptr_),
-                size_   (other.size_)
-            { }
+                size_   (other.size_),
+                fd_     (other.fd_),
+                offset_ (other.offset_),
+                plain_  ()
+            {
+                copy_plain(other);
+            }
 
             Buffer& operator= (const Buffer& other)
             {
@@ -119,6 +167,9 @@ namespace gcache
                 seqno_d_ = other.seqno_d_;
                 ptr_     = other.ptr_;
                 size_    = other.size_;
+                fd_      = other.fd_;
+                offset_  = other.offset_;
+                copy_plain(other);
                 return *this;
             }
 
@@ -127,11 +178,23 @@ namespace gcache
             const gu::byte_t* ptr()     const { return ptr_;     }
             ssize_type        size()    const { return size_;    }
 
+            /*! descriptor of the file which backs the buffer, -1 if none.
+             *  Valid as long as the buffer is seqno locked. */
+            int               fd()      const { return fd_;      }
+            /*! offset of ptr() in that file */
+            off_t             offset()  const { return offset_;  }
+
         protected:
 
             void set_ptr   (const void* p)
             {
                 ptr_ = reinterpret_cast<const gu::byte_t*>(p);
+                fd_  = -1;
+            }
+
+            void set_file  (int fd, off_t offset)
+            {
+                fd_ = fd; offset_ = offset;
             }
 
             void set_other (int64_t g, int64_t d, ssize_type s)
@@ -140,12 +203,34 @@ namespace gcache
                 seqno_g_ = g; seqno_d_ = d; size_ = s;
             }
 
+            /* storage for decompressed buffer contents */
+            gu::byte_t* plain (size_t s)
+            {
+                plain_.resize(s);
+                ptr_ = &plain_[0];
+                fd_  = -1;
+                return &plain_[0];
+            }
+
         private:
 
+            /* data decompressed by other must be copied, not referenced */
+            void copy_plain (const Buffer& other)
+            {
+                if (!other.plain_.empty() && ptr_ == &other.plain_[0])
+                {
+                    plain_ = other.plain_;
+                    ptr_   = &plain_[0];
+                }
+            }
+
             seqno_t           seqno_g_;
             seqno_t           seqno_d_;
             const gu::byte_t* ptr_;
             ssize_type        size_; /* same type as passed to malloc() */
+            int               fd_;
+            off_t             offset_;
+            std::vector<gu::byte_t> plain_;
 
             friend class GCache;
         };
@@ -153,6 +238,7 @@ namespace gcache
         /*!
          * Fills a vector with Buffer objects starting with seqno start
          * until either vector length or seqno map is exhausted.
+         * Compressed buffers are decompressed to Buffer objects' own storage.
          * Moves seqno lock to start.
          *
          * @retval number of buffers filled (<= v.size())
@@ -175,6 +261,37 @@ namespace gcache
 
         void free_common (BufferHeader*);
 
+        /* ring buffer buffer compressed by seqno_release() with mtx
+         * unlocked, see compress_prepare() */
+        struct CompressJob
+        {
+            const BufferHeader* bh;
+            seqno_t             seqno;
+            size_t              offset; // of compressed data in compress_buf
+            size_t              size;   // of compressed data, 0 if failed
+        };
+
+        /* picks ring buffer buffers about to be released in [idx, end] for
+         * compression, returns the last seqno covered by compress_jobs */
+        seqno_t compress_prepare (seqno_t idx, seqno_t end);
+
+        /* compresses compress_jobs, must be called with mtx unlocked,
+         * returns time spent in nanoseconds */
+        long long compress_run ();
+
+        /* moves just released ring buffer buffer to compressed page buffer
+         * prepared by compress_run() */
+        void compress_buffer   (BufferHeader* bh, const CompressJob& job);
+
+        /* keeps compressed history within gcache.size */
+        void trim_compressed   ();
+
+        /* discards all compressed buffers in history */
+        void discard_compressed();
+
+        /* decompresses buffer contents into Buffer's own storage */
+        void decompress_buffer (const BufferHeader* bh, Buffer& buf);
+
         gu::Config&     config;
 
         class Params
@@ -192,12 +309,19 @@ namespace gcache
             size_t rb_size()             const { return rb_size_;         }
             size_t page_size()           const { return page_size_;       }
             size_t keep_pages_size()     const { return keep_pages_size_; }
+            size_t page_pool_size()      const { return page_pool_size_;  }
             int    debug()               const { return debug_;           }
             bool   recover()             const { return recover_;         }
+            int    recover_threads()     const { return recover_threads_; }
+            bool   huge_pages()          const { return huge_pages_;      }
+            bool   numa_bind()           const { return numa_bind_;       }
+            bool   compress()            const { return compress_;        }
 
             void mem_size        (size_t s) { mem_size_        = s; }
             void page_size       (size_t s) { page_size_       = s; }
             void keep_pages_size (size_t s) { keep_pages_size_ = s; }
+            void page_pool_size  (size_t s) { page_pool_size_  = s; }
+            void compress        (bool   c) { compress_        = c; }
 #ifndef NDEBUG
             void debug           (int    d) { debug_           = d; }
 #endif
@@ -210,14 +334,20 @@ namespace gcache
             size_t      const rb_size_;
             size_t            page_size_;
             size_t            keep_pages_size_;
+            size_t            page_pool_size_;
             int               debug_;
             bool        const recover_;
+            int         const recover_threads_;
+            bool        const huge_pages_;
+            bool        const numa_bind_;
+            bool              compress_;
         }
             params;
 
         gu::Mutex       mtx;
 
         seqno2ptr_t     seqno2ptr;
+        SeqnoIndex      seqno_index; // lock-free readable copy of seqno2ptr
         gu::UUID        gid;
 
         MemStore        mem;
@@ -228,6 +358,17 @@ namespace gcache
         long long       reallocs;
         long long       frees;
 
+        long long       compress_raw;
+        long long       compress_out;
+        long long       compress_ns;
+        gu::Atomic<long long> decompress_ns;
+        std::vector<gu::byte_t>  compress_buf;
+        std::vector<CompressJob> compress_jobs;
+        gu::Cond        compress_cond;
+        /* compress_jobs are being compressed with mtx unlocked: their
+         * buffers must not be released or discarded meanwhile */
+        bool            compress_busy;
+
         seqno_t         seqno_max;
         seqno_t         seqno_released;
 
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/*! @file Compression of released buffers (gcache.compress)
+ *
+ * Ring buffer is written sequentially, so the history it holds is limited
+ * to the last gcache.size bytes written, no matter what happens to buffers
+ * afterwards. To keep more history, ring buffer buffers are compressed into
+ * page store when released and their ring buffer space is discarded right
+ * away. Ring buffer then mostly holds actions which are still in process,
+ * while history lives in compressed pages which are kept up to gcache.size
+ * bytes in total.
+ *
+ * Compression itself runs with GCache mutex unlocked: buffers picked for it
+ * stay unreleased until they are compressed, so ring buffer can't reuse
+ * their space, and compress_busy keeps away other releasers and history
+ * reset.
+ */
+
+#include "GCache.hpp"
+#include "gcache_bh.hpp"
+#include "gcache_limits.hpp"
+
+#include <gu_lz4.hpp>
+#include <gu_datetime.hpp>
+#include <gu_throw.hpp>
+
+#include <cstring>
+#include <cassert>
+
+namespace gcache
+{
+    /* compressed buffer payload starts with this */
+    struct CompressedHeader
+    {
+        uint32_t raw_size;        // size of the original payload
+        uint32_t compressed_size; // size of compressed data which follows
+    };
+
+    /* smaller buffers are not worth the effort */
+    static size_t const MIN_COMPRESS_SIZE = 64;
+
+    /* compressed buffer must save at least 1/8 of space, otherwise it is
+     * not worth the decompression effort */
+    static inline size_t
+    compress_max_size(size_t const raw_size)
+    {
+        return raw_size - raw_size/8 - sizeof(CompressedHeader);
+    }
+
+    /* don't hold more than that in compress_buf at a time */
+    static size_t const MAX_COMPRESS_BATCH = 16 << 20; // 16M
+
+    seqno_t
+    GCache::compress_prepare (seqno_t idx, seqno_t const end)
+    {
+        assert(!compress_busy);
+
+        compress_jobs.clear();
+
+        size_t offset(0);
+
+        for (; idx <= end && idx < seqno2ptr.index_end(); ++idx)
+        {
+            const void* const ptr(seqno2ptr[idx]);
+            if (seqno2ptr_t::not_set(ptr)) continue;
+
+            const BufferHeader* const bh(ptr2BH(ptr));
+            size_t const raw_size(bh->size - sizeof(BufferHeader));
+
+            if (BH_is_released(bh) || BUFFER_IN_RB != bh->store ||
+                raw_size < MIN_COMPRESS_SIZE) continue;
+
+            if (offset > 0 && offset + raw_size > MAX_COMPRESS_BATCH) break;
+
+            CompressJob const job = { bh, idx, offset, 0 };
+            compress_jobs.push_back(job);
+            offset += compress_max_size(raw_size);
+        }
+
+        if (compress_buf.size() < offset) compress_buf.resize(offset);
+
+        return idx - 1;
+    }
+
+    long long
+    GCache::compress_run ()
+    {
+        gu::datetime::Date const start(gu::datetime::Date::monotonic());
+
+        for (size_t i(0); i < compress_jobs.size(); ++i)
+        {
+            CompressJob& job(compress_jobs[i]);
+            size_t const raw_size(job.bh->size - sizeof(BufferHeader));
+
+            job.size = gu::lz4_compress(job.bh + 1, raw_size,
+                                        &compress_buf[job.offset],
+                                        compress_max_size(raw_size));
+        }
+
+        return (gu::datetime::Date::monotonic() - start).get_nsecs();
+    }
+
+    void
+    GCache::compress_buffer (BufferHeader* const bh, const CompressJob& job)
+    {
+        assert(BH_is_released(bh));
+        assert(BUFFER_IN_RB == bh->store);
+        assert(bh->seqno_g == job.seqno);
+        assert(bh == job.bh);
+
+        if (0 == job.size) return;
+
+        size_t const raw_size(bh->size - sizeof(BufferHeader));
+        size_type const size(MemOps::align_size(sizeof(BufferHeader) +
+                                                sizeof(CompressedHeader) +
+                                                job.size));
+        void* const ptr(ps.malloc(size));
+
+        if (0 == ptr) return; // keep original
+
+        BufferHeader* const cbh(ptr2BH(ptr));
+        cbh->seqno_g = bh->seqno_g;
+        cbh->seqno_d = bh->seqno_d;
+        cbh->flags  |= BUFFER_RELEASED | BUFFER_COMPRESSED;
+
+        CompressedHeader* const ch(static_cast<CompressedHeader*>(ptr));
+        ch->raw_size        = raw_size;
+        ch->compressed_size = job.size;
+        ::memcpy(ch + 1, &compress_buf[job.offset], job.size);
+
+        seqno2ptr.insert(cbh->seqno_g, ptr);
+        seqno_index.insert(cbh->seqno_g, ptr);
+
+        discard_buffer(bh);
+
+        compress_raw += raw_size;
+        compress_out += size - sizeof(BufferHeader);
+    }
+
+    void
+    GCache::trim_compressed ()
+    {
+        /* pages are not deleted while they are within keep_pages_size */
+        size_t const max_size(std::max(params.rb_size(),
+                                       params.keep_pages_size()));
+
+        while (ps.total_size() > max_size && !seqno2ptr.empty())
+        {
+            const BufferHeader* const bh(ptr2BH(seqno2ptr.front()));
+
+            if (!BH_is_compressed(bh) || !discard_seqno(bh->seqno_g)) break;
+        }
+    }
+
+    void
+    GCache::discard_compressed ()
+    {
+        seqno2ptr_t::iterator i(seqno2ptr.begin());
+
+        while (i != seqno2ptr.end())
+        {
+            if (*i && BH_is_compressed(ptr2BH(*i)))
+            {
+                BufferHeader* const bh(ptr2BH(*i));
+                i = seqno2ptr.erase(i);
+                discard_buffer(bh);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    void
+    GCache::decompress_buffer (const BufferHeader* const bh, Buffer& buf)
+    {
+        gu::datetime::Date const start(gu::datetime::Date::monotonic());
+
+        const CompressedHeader* const ch
+            (static_cast<const CompressedHeader*>(
+                static_cast<const void*>(bh + 1)));
+
+        if (gu_unlikely(sizeof(BufferHeader) + sizeof(CompressedHeader) +
+                        ch->compressed_size > bh->size ||
+                        !gu::lz4_decompress(ch + 1, ch->compressed_size,
+                                            buf.plain(ch->raw_size),
+                                            ch->raw_size)))
+        {
+            gu_throw_fatal << "Corrupt compressed buffer: " << bh;
+        }
+
+        buf.set_other(bh->seqno_g, bh->seqno_d, ch->raw_size);
+
+        decompress_ns += (gu::datetime::Date::monotonic() - start).get_nsecs();
+    }
+
+    GCache::CompressStats
+    GCache::compress_stats() const
+    {
+        CompressStats ret;
+
+        {
+            gu::Lock lock(mtx);
+            ret.raw_bytes        = compress_raw;
+            ret.compressed_bytes = compress_out;
+            ret.compress_ns      = compress_ns;
+        }
+
+        ret.decompress_ns = decompress_ns();
+
+        return ret;
+    }
+}
@@ -21,6 +21,8 @@ namespace gcache
     {
         gu::Lock lock(mtx);
 
+        while (compress_busy) lock.wait(compress_cond);
+
         assert(seqno2ptr.empty() || seqno_max == seqno2ptr.index_back());
 
         if (g == gid && s != SEQNO_ILL && seqno_max >= s)
@@ -28,6 +30,7 @@ namespace gcache
             if (seqno_max > s)
             {
                 discard_tail(s);
+                seqno_index.truncate(s + 1);
                 seqno_max = s;
                 seqno_released = s;
                 assert(seqno_max == seqno2ptr.index_back());
@@ -42,10 +45,12 @@ namespace gcache
         gid = g;
 
         /* order is significant here */
+        discard_compressed();
         rb.seqno_reset();
         mem.seqno_reset();
 
         seqno2ptr.clear(SEQNO_NONE);
+        seqno_index.clear();
         seqno_max = SEQNO_NONE;
     }
 
@@ -94,6 +99,11 @@ namespace gcache
 
         bh->seqno_g = seqno_g;
         bh->seqno_d = seqno_d;
+
+        /* buffer header must be complete before the buffer is published to
+         * lock-free readers */
+        seqno_index.insert(seqno_g, ptr);
+        seqno_index.trim(seqno2ptr.index_begin());
     }
 
     void
@@ -160,8 +170,40 @@ namespace gcache
 
             seqno_t const start  (idx - 1);
             seqno_t const max_end(std::min(seqno, seqno_locked - 1));
-            seqno_t const end    (max_end - start >= 2*batch_size ?
+            seqno_t       end    (max_end - start >= 2*batch_size ?
                                   start + batch_size : max_end);
+
+            if (compress_busy)
+            {
+                /* another thread compresses buffers which precede ours,
+                 * let it release them first */
+                lock.wait(compress_cond);
+                loop = true;
+                continue;
+            }
+
+            size_t job(0); // next element of compress_jobs
+
+            if (params.compress())
+            {
+                end = compress_prepare(idx, end);
+
+                if (!compress_jobs.empty())
+                {
+                    compress_busy = true;
+                    mtx.unlock();
+                    long long const ns(compress_run());
+                    mtx.lock();
+                    compress_busy = false;
+                    compress_cond.broadcast();
+
+                    compress_ns += ns;
+
+                    /* seqno lock could have been set meanwhile */
+                    end = std::min(end, seqno_locked - 1);
+                    idx = seqno2ptr.upper_bound(seqno_released);
+                }
+            }
 #ifndef NDEBUG
             if (params.debug())
             {
@@ -191,12 +233,29 @@ namespace gcache
                            seqno_released == SEQNO_NONE);
                 }
 #endif
-                if (gu_likely(!BH_is_released(bh))) free_common(bh);
+                if (gu_likely(!BH_is_released(bh)))
+                {
+                    free_common(bh);
+
+                    while (job < compress_jobs.size() &&
+                           compress_jobs[job].seqno < idx) ++job;
+
+                    if (job < compress_jobs.size() &&
+                        compress_jobs[job].seqno == idx &&
+                        compress_jobs[job].bh    == bh)
+                    {
+                        compress_buffer(bh, compress_jobs[job]);
+                    }
+                }
                 /* free_common() could modify a map, look for next unreleased
                  * seqno. */
                 idx = seqno2ptr.upper_bound(idx);
             }
 
+            if (params.compress()) trim_compressed();
+
+            compress_jobs.clear();
+
             assert (loop || seqno == seqno_released);
 
             loop = (end < seqno) && loop;
@@ -252,6 +311,10 @@ namespace gcache
         assert (ptr);
 
         const BufferHeader* const bh (ptr2BH(ptr)); // this can result in IO
+
+        /* compressed buffers can be read only by seqno_get_buffers() */
+        if (gu_unlikely(BH_is_compressed(bh))) throw gu::NotFound();
+
         seqno_d = bh->seqno_d;
         size    = bh->size - sizeof(BufferHeader);
 
@@ -268,24 +331,25 @@ namespace gcache
 
         size_t found(0);
 
+#ifndef NDEBUG
         {
             gu::Lock lock(mtx);
-
             assert(seqno_locked <= start);
             // the caller should have locked the range first
+        }
+#endif
+        /* Locked range can't be discarded, so it can be read without taking
+         * the mutex and blocking the writers. */
+        {
+            SeqnoIndex::Reader const index(seqno_index);
 
-            seqno2ptr_iter_t p = seqno2ptr.find(start);
-
-            if (p != seqno2ptr.end() && *p)
+            const void* ptr;
+            while (found < max && (ptr = index.find(start + found)))
             {
-                do {
-                    assert(seqno2ptr.index(p) == seqno_t(start + found));
-                    assert(*p);
-                    v[found].set_ptr(*p);
-                }
-                while (++found < max && ++p != seqno2ptr.end() && *p);
-                /* the last condition ensures seqno continuty, #643 */
+                v[found].set_ptr(ptr);
+                ++found;
             }
+            /* stopping at the first hole ensures seqno continuity, #643 */
         }
 
         // the following may cause IO
@@ -296,9 +360,20 @@ namespace gcache
             assert (bh->seqno_g == seqno_t(start + i));
             Limits::assert_size(bh->size);
 
-            v[i].set_other (bh->seqno_g,
-                            bh->seqno_d,
-                            bh->size - sizeof(BufferHeader));
+            if (gu_unlikely(BH_is_compressed(bh)))
+            {
+                decompress_buffer(bh, v[i]);
+            }
+            else
+            {
+                v[i].set_other (bh->seqno_g,
+                                bh->seqno_d,
+                                bh->size - sizeof(BufferHeader));
+
+                off_t offset;
+                int const fd(bh->ctx->file_offset(v[i].ptr(), offset));
+                if (fd >= 0) v[i].set_file(fd, offset);
+            }
         }
 
         return found;
@@ -27,6 +27,8 @@ extern void* gcache_realloc     (gcache_t* gc, void* ptr, int size);
 
 extern int64_t gcache_seqno_min (gcache_t* gc);
 
+extern void    gcache_numa_bind (gcache_t* gc);
+
 #ifdef __cplusplus
 }
 #endif
@@ -17,8 +17,10 @@
 
 namespace gcache
 {
-    static uint32_t const BUFFER_RELEASED  = 1 << 0;
-    static uint32_t const BUFFER_FLAGS_MAX = BUFFER_RELEASED;
+    static uint32_t const BUFFER_RELEASED   = 1 << 0;
+    static uint32_t const BUFFER_COMPRESSED = 1 << 1; // see GCache_compress.cpp
+    static uint32_t const BUFFER_FLAGS_MAX  = BUFFER_RELEASED |
+                                              BUFFER_COMPRESSED;
 
     enum StorageType
     {
@@ -88,6 +90,12 @@ namespace gcache
         bh->flags |= BUFFER_RELEASED;
     }
 
+    static inline bool
+    BH_is_compressed (const BufferHeader* const bh)
+    {
+        return (bh->flags & BUFFER_COMPRESSED);
+    }
+
     static inline BufferHeader* BH_next(BufferHeader* bh)
     {
         return BH_cast((reinterpret_cast<uint8_t*>(bh) + bh->size));
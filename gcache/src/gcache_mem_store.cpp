@@ -6,10 +6,83 @@
 #include "gcache_page_store.hpp"
 
 #include <gu_logger.hpp>
+#include <gu_mem_policy.hpp>
+
+#include <sys/mman.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 
 namespace gcache
 {
 
+void*
+MemStore::buf_alloc (size_type const size)
+{
+    if (size < MMAP_MIN_SIZE || (!huge_pages_ && node_ < 0))
+    {
+        return ::malloc (size);
+    }
+
+    void* const ptr(::mmap (NULL, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+
+    if (MAP_FAILED == ptr)
+    {
+        log_debug << "Failed to map " << size << " bytes: " << errno
+                  << ", falling back to malloc()";
+        return ::malloc (size);
+    }
+
+    /* must be done before the pages are touched */
+    if (huge_pages_) gu::mem_advise_huge(ptr, size);
+    if (node_ >= 0)  gu::mem_bind_node(ptr, size, node_);
+
+    mapped_.insert(ptr);
+
+    return ptr;
+}
+
+void*
+MemStore::buf_realloc (void* const     ptr,
+                       size_type const old_size,
+                       size_type const size)
+{
+    bool const was_mapped(mapped_.find(ptr) != mapped_.end());
+
+    if (!was_mapped && (size < MMAP_MIN_SIZE || (!huge_pages_ && node_ < 0)))
+    {
+        return ::realloc (ptr, size);
+    }
+
+    void* const ret(buf_alloc (size));
+
+    if (ret && ptr)
+    {
+        ::memcpy (ret, ptr, std::min(old_size, size));
+        buf_free (ptr, old_size);
+    }
+
+    return ret;
+}
+
+void
+MemStore::buf_free (void* const ptr, size_type const size)
+{
+    if (mapped_.erase(ptr) > 0)
+    {
+        if (::munmap (ptr, size))
+        {
+            log_error << "Failed to unmap " << size << " bytes at " << ptr
+                      << ": " << errno << " (" << ::strerror(errno) << ')';
+        }
+    }
+    else
+    {
+        ::free (ptr);
+    }
+}
+
 bool
 MemStore::have_free_space (size_type size)
 {
@@ -68,7 +141,7 @@ MemStore::seqno_reset()
             allocd_.erase (tmp);
 
             size_ -= bh->size;
-            ::free (bh);
+            buf_free (bh, bh->size);
         }
     }
 }
@@ -25,8 +25,11 @@ namespace gcache
             : max_size_ (max_size),
               size_     (0),
               allocd_   (),
+              mapped_   (),
               seqno2ptr_(seqno2ptr),
-              debug_    (dbg & DEBUG)
+              debug_    (dbg & DEBUG),
+              huge_pages_(false),
+              node_     (-1)
         {}
 
         void reset ()
@@ -34,7 +37,7 @@ namespace gcache
             for (std::set<void*>::iterator buf(allocd_.begin());
                  buf != allocd_.end(); ++buf)
             {
-                ::free (*buf);
+                buf_free (*buf, BH_cast(*buf)->size);
             }
 
             allocd_.clear();
@@ -51,7 +54,7 @@ namespace gcache
 
             assert (size_ + size <= max_size_);
 
-            BufferHeader* bh (BH_cast (::malloc (size)));
+            BufferHeader* bh (BH_cast (buf_alloc (size)));
 
             if (gu_likely(0 != bh))
             {
@@ -101,7 +104,7 @@ namespace gcache
 
             assert (size_ + diff_size <= max_size_);
 
-            void* tmp = ::realloc (bh, size);
+            void* tmp = buf_realloc (bh, old_size, size);
 
             if (tmp)
             {
@@ -125,7 +128,7 @@ namespace gcache
             assert (BH_is_released(bh));
 
             size_ -= bh->size;
-            ::free (bh);
+            buf_free (bh, bh->size);
             allocd_.erase(bh);
         }
 
@@ -138,17 +141,35 @@ namespace gcache
 
         void set_debug(int const dbg) { debug_ = dbg & DEBUG; }
 
+        /*! back big buffers allocated from now on with huge pages */
+        void set_huge_pages(bool const h) { huge_pages_ = h; }
+
+        /*! bind big buffers allocated from now on to NUMA node */
+        void set_numa_node(int const node) { node_ = node; }
+
     private:
 
         static int const DEBUG = 1;
 
+        /* Smaller buffers come from the heap where they share pages with
+         * other allocations, so memory policy can't be applied to them.
+         * Bigger ones are mapped separately when policy is set. */
+        static size_type const MMAP_MIN_SIZE = 4 << 20;
+
         bool have_free_space (size_type size);
 
+        void* buf_alloc   (size_type size);
+        void* buf_realloc (void* ptr, size_type old_size, size_type size);
+        void  buf_free    (void* ptr, size_type size);
+
         size_t          max_size_;
         size_t          size_;
         std::set<void*> allocd_;
+        std::set<void*> mapped_; // allocd_ buffers which are mmap()'ed
         seqno2ptr_t&    seqno2ptr_;
         int             debug_;
+        bool            huge_pages_;
+        int             node_;
     };
 }
 
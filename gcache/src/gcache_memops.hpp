@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010-2015 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  */
 
 /*! @file memory operations interface */
@@ -10,6 +10,7 @@
 #include <gu_arch.h>
 #include <gu_macros.h>
 #include <stdint.h>
+#include <sys/types.h>
 
 namespace gcache
 {
@@ -45,6 +46,14 @@ namespace gcache
         virtual void
         reset   ()                        = 0;
 
+        /*! @return descriptor of the file which backs ptr and sets offset
+         *          of ptr in that file, -1 if memory is not file backed */
+        virtual int
+        file_offset (const void* ptr, off_t& offset) const
+        {
+            return -1;
+        }
+
         /* GCache 3.x is not supposed to be portable between platforms */
         static size_type const ALIGNMENT  = GU_WORD_BYTES;
 
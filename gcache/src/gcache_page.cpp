@@ -15,6 +15,9 @@
 #define _XOPEN_SOURCE 600
 #endif
 #include <fcntl.h>
+#if defined(__linux__)
+#include <linux/falloc.h> // FALLOC_FL_ZERO_RANGE
+#endif
 
 void
 gcache::Page::reset ()
@@ -28,6 +31,25 @@ gcache::Page::reset ()
 
     space_ = mmap_.size;
     next_  = static_cast<uint8_t*>(mmap_.ptr);
+    BH_clear (reinterpret_cast<BufferHeader*>(next_));
+}
+
+void
+gcache::Page::recycle ()
+{
+#if defined(FALLOC_FL_ZERO_RANGE)
+    /* turns written extents back into unwritten ones, so that faulting them
+     * in later does not read stale data from disk */
+    if (fallocate (fd_.get(), FALLOC_FL_ZERO_RANGE, 0, fd_.size()))
+    {
+        int const err(errno);
+        log_debug << "Failed to discard contents of " << fd_.name() << ": "
+                  << err << " (" << strerror(err) << ")";
+    }
+#endif
+
+    reset();
+    mmap_.will_need();
 }
 
 void
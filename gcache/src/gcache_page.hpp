@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010-2018 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  */
 
 /*! @file page file class */
@@ -56,8 +56,19 @@ namespace gcache
 
         const std::string& name() const { return fd_.name(); }
 
+        int file_offset(const void* const ptr, off_t& offset) const
+        {
+            offset = static_cast<const uint8_t*>(ptr) -
+                     static_cast<const uint8_t*>(mmap_.ptr);
+            return fd_.get();
+        }
+
         void reset ();
 
+        /* Prepare unused page for reuse: discard file contents while keeping
+         * the disk space allocated and fault the mapping back in */
+        void recycle ();
+
         /* Drop filesystem cache on the file */
         void drop_fs_cache() const;
 
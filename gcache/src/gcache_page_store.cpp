@@ -10,6 +10,7 @@
 
 #include <gu_logger.hpp>
 #include <gu_throw.hpp>
+#include <gu_datetime.hpp>
 
 #include <cstdio>
 #include <cstring>
@@ -76,27 +77,43 @@ remove_file (void* __restrict__ arg)
     pthread_exit(NULL);
 }
 
-bool
-gcache::PageStore::delete_page ()
+static void*
+recycle_page (void* __restrict__ arg)
 {
-    Page* const page = pages_.front();
-
-    if (page->used() > 0) return false;
+    static_cast<gcache::Page*>(arg)->recycle();
 
-    pages_.pop_front();
+    pthread_exit(NULL);
+}
 
-    char* const file_name(strdup(page->name().c_str()));
+void
+gcache::PageStore::join_page_thread ()
+{
+#ifndef GCACHE_DETACH_THREAD
+    if (delete_thr_ != pthread_t(-1))
+    {
+        pthread_join (delete_thr_, NULL);
+        delete_thr_ = pthread_t(-1);
+    }
 
-    total_size_ -= page->size();
+    if (recycled_)
+    {
+        pool_.push_back(recycled_);
+        recycled_ = 0;
+    }
+#endif /* GCACHE_DETACH_THREAD */
+}
 
-    if (current_ == page) current_ = 0;
+void
+gcache::PageStore::delete_page_file (Page* const page)
+{
+    char* const file_name(strdup(page->name().c_str()));
 
     delete page;
 
 #ifdef GCACHE_DETACH_THREAD
     pthread_t delete_thr_;
 #else
-    if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
+    join_page_thread();
 #endif /* GCACHE_DETACH_THERAD */
 
     int err = pthread_create (&delete_thr_, &delete_page_attr_, remove_file,
@@ -106,10 +123,90 @@ gcache::PageStore::delete_page ()
         delete_thr_ = pthread_t(-1);
         gu_throw_error(err) << "Failed to create page file deletion thread";
     }
+}
+
+void
+gcache::PageStore::recycle_page_file (Page* const page)
+{
+#ifndef GCACHE_DETACH_THREAD
+    join_page_thread();
+
+    /* zeroing and faulting in the whole page takes a while, so it is done
+     * in background, same as page file removal */
+    int const err(pthread_create (&delete_thr_, &delete_page_attr_,
+                                  recycle_page, page));
+    if (0 == err)
+    {
+        recycled_ = page;
+        return;
+    }
+
+    delete_thr_ = pthread_t(-1);
+    log_warn << "Failed to create page recycling thread: " << err << " ("
+             << strerror(err) << "). Recycling page " << page->name()
+             << " in place.";
+#endif /* GCACHE_DETACH_THREAD */
+
+    page->recycle();
+    pool_.push_back(page);
+}
+
+bool
+gcache::PageStore::delete_page ()
+{
+    Page* const page = pages_.front();
+
+    if (page->used() > 0) return false;
+
+    pages_.pop_front();
+
+    total_size_ -= page->size();
+
+    if (current_ == page) current_ = 0;
+
+    /* pages of irregular size (allocated for big buffers) are not pooled */
+    if (pool_pages() < pool_size_ && page->size() == page_size_)
+    {
+        log_info << "Moving page " << page->name() << " to pool";
+        recycle_page_file(page);
+    }
+    else
+    {
+        delete_page_file(page);
+    }
 
     return true;
 }
 
+void
+gcache::PageStore::trim_pool ()
+{
+    /* page being recycled goes to the pool first */
+    join_page_thread();
+
+    while (pool_.size() > pool_size_)
+    {
+        Page* const page(pool_.back());
+        pool_.pop_back();
+        delete_page_file(page);
+    }
+
+    /* page size may have changed, the pool must hold only regular pages */
+    for (PageQueue::iterator i(pool_.begin()); i != pool_.end();)
+    {
+        if ((*i)->size() != page_size_)
+        {
+            Page* const page(*i);
+            i = pool_.erase(i);
+            delete_page_file(page);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
 /* Deleting pages only from the beginning kinda means that some free pages
  * can be locked in the middle for a while. Leaving it like that for simplicity
  * for now. */
@@ -131,33 +228,62 @@ gcache::PageStore::reset ()
 inline void
 gcache::PageStore::new_page (size_type size)
 {
-    Page* const page(new Page
-                     (this, make_page_name (base_name_, count_), size, debug_));
+    gu::datetime::Date const start(gu::datetime::Date::monotonic());
+
+    Page* page;
+
+#ifndef GCACHE_DETACH_THREAD
+    /* waiting for the page being recycled is still faster than creating
+     * a new one */
+    if (pool_.empty() && recycled_) join_page_thread();
+#endif /* GCACHE_DETACH_THREAD */
+
+    if (!pool_.empty() && pool_.front()->size() >= size)
+    {
+        page = pool_.front();
+        pool_.pop_front();
+        stats_.page_reuses++;
+        log_info << "Reusing page " << page->name();
+    }
+    else
+    {
+        page = new Page(this, make_page_name (base_name_, count_), size,
+                        debug_);
+        count_++;
+    }
 
     pages_.push_back (page);
     total_size_ += page->size();
     current_ = page;
-    count_++;
+
+    stats_.page_allocs++;
+    stats_.page_alloc_ns +=
+        (gu::datetime::Date::monotonic() - start).get_nsecs();
 }
 
 gcache::PageStore::PageStore (const std::string& dir_name,
                               size_t             keep_size,
                               size_t             page_size,
                               int                dbg,
-                              bool               keep_page)
+                              bool               keep_page,
+                              size_t             pool_size)
     :
     base_name_ (make_base_name(dir_name)),
     keep_size_ (keep_size),
     page_size_ (page_size),
     keep_page_ (keep_page),
+    pool_size_ (pool_size),
     count_     (0),
     pages_     (),
+    pool_      (),
+    stats_     (),
     current_   (0),
     total_size_(0),
     delete_page_attr_(),
     debug_     (dbg & DEBUG)
 #ifndef GCACHE_DETACH_THREAD
     , delete_thr_(pthread_t(-1))
+    , recycled_  (0)
 #endif /* GCACHE_DETACH_THREAD */
 {
     int err = pthread_attr_init (&delete_page_attr_);
@@ -178,16 +304,35 @@ gcache::PageStore::PageStore (const std::string& dir_name,
                             << "page file deletion thread";
     }
 #endif /* GCACHE_DETACH_THREAD */
+
+    /* preallocate the pool, so that the first pages don't have to be
+     * created on demand */
+    try
+    {
+        while (pool_.size() < pool_size_)
+        {
+            Page* const page(new Page(this,
+                                      make_page_name (base_name_, count_),
+                                      page_size_, debug_));
+            count_++;
+            pool_.push_back(page);
+            page->recycle();
+        }
+    }
+    catch (gu::Exception& e)
+    {
+        log_warn << "Failed to preallocate page pool: " << e.what();
+    }
 }
 
 gcache::PageStore::~PageStore ()
 {
     try
     {
+        pool_size_ = 0;
         while (pages_.size() && delete_page()) {};
-#ifndef GCACHE_DETACH_THREAD
-        if (delete_thr_ != pthread_t(-1)) pthread_join (delete_thr_, NULL);
-#endif /* GCACHE_DETACH_THREAD */
+        trim_pool();
+        join_page_thread();
     }
     catch (gu::Exception& e)
     {
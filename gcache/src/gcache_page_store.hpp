@@ -24,7 +24,8 @@ namespace gcache
                    size_t             keep_size,
                    size_t             page_size,
                    int                dbg,
-                   bool               keep_page);
+                   bool               keep_page,
+                   size_t             pool_size = 0);
 
         ~PageStore ();
 
@@ -48,16 +49,34 @@ namespace gcache
 
         void  reset();
 
-        void  set_page_size (size_t size) { page_size_ = size; }
+        void  set_page_size (size_t size) { page_size_ = size; trim_pool(); }
 
         void  set_keep_size (size_t size) { keep_size_ = size; }
 
+        void  set_pool_size (size_t size) { pool_size_ = size; trim_pool(); }
+
         void  set_debug(int dbg);
 
         /* for unit tests */
         size_t count()       const { return count_;        }
         size_t total_pages() const { return pages_.size(); }
         size_t total_size()  const { return total_size_;   }
+        size_t pool_pages()  const
+        {
+#ifndef GCACHE_DETACH_THREAD
+            if (recycled_) return pool_.size() + 1;
+#endif /* GCACHE_DETACH_THREAD */
+            return pool_.size();
+        }
+
+        struct Stats
+        {
+            long long page_allocs;   // pages put to use
+            long long page_reuses;   // of them taken from the pool
+            long long page_alloc_ns; // total time spent on getting pages
+        };
+
+        const Stats& stats() const { return stats_; }
 
     private:
 
@@ -67,15 +86,19 @@ namespace gcache
         size_t            keep_size_; /* how much pages to keep after freeing*/
         size_t            page_size_; /* min size of the individual page */
         bool        const keep_page_; /* whether to keep the last page */
+        size_t            pool_size_; /* how many free pages to keep */
         size_t            count_;
         typedef std::deque<Page*> PageQueue;
         PageQueue         pages_;
+        PageQueue         pool_;      /* free pages ready for reuse */
+        Stats             stats_;
         Page*             current_;
         size_t            total_size_;
         pthread_attr_t    delete_page_attr_;
         int               debug_;
 #ifndef GCACHE_DETACH_THREAD
-        pthread_t         delete_thr_;
+        pthread_t         delete_thr_; /* page file deletion or recycling */
+        Page*             recycled_;   /* page being recycled in delete_thr_ */
 #endif /* GCACHE_DETACH_THREAD */
 
         void new_page    (size_type size);
@@ -83,6 +106,18 @@ namespace gcache
         // returns true if a page could be deleted
         bool delete_page ();
 
+        // deletes page object and removes its file in background
+        void delete_page_file (Page* page);
+
+        // recycles page in background, after that it goes to the pool
+        void recycle_page_file (Page* page);
+
+        // waits for background page thread, moves recycled page to the pool
+        void join_page_thread ();
+
+        // deletes pool pages which are extra or too small
+        void trim_pool   ();
+
         // cleans up extra pages.
         void cleanup     ();
 
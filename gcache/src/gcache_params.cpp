@@ -16,12 +16,22 @@ static const std::string GCACHE_PARAMS_PAGE_SIZE  ("gcache.page_size");
 static const std::string GCACHE_DEFAULT_PAGE_SIZE (GCACHE_DEFAULT_RB_SIZE);
 static const std::string GCACHE_PARAMS_KEEP_PAGES_SIZE("gcache.keep_pages_size");
 static const std::string GCACHE_DEFAULT_KEEP_PAGES_SIZE("0");
+static const std::string GCACHE_PARAMS_PAGE_POOL_SIZE ("gcache.page_pool_size");
+static const std::string GCACHE_DEFAULT_PAGE_POOL_SIZE("0");
 #ifndef NDEBUG
 static const std::string GCACHE_PARAMS_DEBUG      ("gcache.debug");
 static const std::string GCACHE_DEFAULT_DEBUG     ("0");
 #endif
 static const std::string GCACHE_PARAMS_RECOVER    ("gcache.recover");
 static const std::string GCACHE_DEFAULT_RECOVER   ("no");
+static const std::string GCACHE_PARAMS_RECOVER_THREADS ("gcache.recover_threads");
+static const std::string GCACHE_DEFAULT_RECOVER_THREADS("4");
+static const std::string GCACHE_PARAMS_HUGE_PAGES ("gcache.huge_pages");
+static const std::string GCACHE_DEFAULT_HUGE_PAGES("no");
+static const std::string GCACHE_PARAMS_NUMA_BIND  ("gcache.numa_bind");
+static const std::string GCACHE_DEFAULT_NUMA_BIND ("no");
+static const std::string GCACHE_PARAMS_COMPRESS   ("gcache.compress");
+static const std::string GCACHE_DEFAULT_COMPRESS  ("no");
 
 void
 gcache::GCache::Params::register_params(gu::Config& cfg)
@@ -32,10 +42,15 @@ gcache::GCache::Params::register_params(gu::Config& cfg)
     cfg.add(GCACHE_PARAMS_RB_SIZE,         GCACHE_DEFAULT_RB_SIZE);
     cfg.add(GCACHE_PARAMS_PAGE_SIZE,       GCACHE_DEFAULT_PAGE_SIZE);
     cfg.add(GCACHE_PARAMS_KEEP_PAGES_SIZE, GCACHE_DEFAULT_KEEP_PAGES_SIZE);
+    cfg.add(GCACHE_PARAMS_PAGE_POOL_SIZE,  GCACHE_DEFAULT_PAGE_POOL_SIZE);
 #ifndef NDEBUG
     cfg.add(GCACHE_PARAMS_DEBUG,           GCACHE_DEFAULT_DEBUG);
 #endif
     cfg.add(GCACHE_PARAMS_RECOVER,         GCACHE_DEFAULT_RECOVER);
+    cfg.add(GCACHE_PARAMS_RECOVER_THREADS, GCACHE_DEFAULT_RECOVER_THREADS);
+    cfg.add(GCACHE_PARAMS_HUGE_PAGES,      GCACHE_DEFAULT_HUGE_PAGES);
+    cfg.add(GCACHE_PARAMS_NUMA_BIND,       GCACHE_DEFAULT_NUMA_BIND);
+    cfg.add(GCACHE_PARAMS_COMPRESS,        GCACHE_DEFAULT_COMPRESS);
 }
 
 static const std::string&
@@ -63,6 +78,20 @@ name_value (gu::Config& cfg, const std::string& data_dir)
     return cfg.get(GCACHE_PARAMS_RB_NAME);
 }
 
+static int
+recover_threads_value (gu::Config& cfg)
+{
+    int const ret(cfg.get<int>(GCACHE_PARAMS_RECOVER_THREADS));
+
+    if (ret < 1)
+    {
+        gu_throw_error(EINVAL) << "'" << GCACHE_PARAMS_RECOVER_THREADS
+                               << "' must be positive, got " << ret;
+    }
+
+    return ret;
+}
+
 gcache::GCache::Params::Params (gu::Config& cfg, const std::string& data_dir)
     :
     rb_name_  (name_value (cfg, data_dir)),
@@ -71,12 +100,17 @@ gcache::GCache::Params::Params (gu::Config& cfg, const std::string& data_dir)
     rb_size_  (cfg.get<size_t>(GCACHE_PARAMS_RB_SIZE)),
     page_size_(cfg.get<size_t>(GCACHE_PARAMS_PAGE_SIZE)),
     keep_pages_size_(cfg.get<size_t>(GCACHE_PARAMS_KEEP_PAGES_SIZE)),
+    page_pool_size_(cfg.get<size_t>(GCACHE_PARAMS_PAGE_POOL_SIZE)),
 #ifndef NDEBUG
     debug_    (cfg.get<int>(GCACHE_PARAMS_DEBUG)),
 #else
     debug_    (0),
 #endif
-    recover_  (cfg.get<bool>(GCACHE_PARAMS_RECOVER))
+    recover_  (cfg.get<bool>(GCACHE_PARAMS_RECOVER)),
+    recover_threads_(recover_threads_value(cfg)),
+    huge_pages_(cfg.get<bool>(GCACHE_PARAMS_HUGE_PAGES)),
+    numa_bind_(cfg.get<bool>(GCACHE_PARAMS_NUMA_BIND)),
+    compress_ (cfg.get<bool>(GCACHE_PARAMS_COMPRESS))
 {}
 
 void
@@ -130,7 +164,32 @@ gcache::GCache::param_set (const std::string& key, const std::string& val)
         params.keep_pages_size(tmp_size);
         ps.set_keep_size(params.keep_pages_size());
     }
-    else if (key == GCACHE_PARAMS_RECOVER)
+    else if (key == GCACHE_PARAMS_PAGE_POOL_SIZE)
+    {
+        size_t tmp_size = gu::Config::from_config<size_t>(val);
+
+        gu::Lock lock(mtx);
+        /* locking here serves two purposes: ensures atomic setting of config
+         * and params.ram_size and syncs with malloc() method */
+
+        config.set<size_t>(key, tmp_size);
+        params.page_pool_size(tmp_size);
+        ps.set_pool_size(params.page_pool_size());
+    }
+    else if (key == GCACHE_PARAMS_COMPRESS)
+    {
+        bool const tmp(gu::Config::from_config<bool>(val));
+
+        gu::Lock lock(mtx);
+        /* syncs with seqno_release() */
+
+        config.set<bool>(key, tmp);
+        params.compress(tmp);
+    }
+    else if (key == GCACHE_PARAMS_RECOVER         ||
+             key == GCACHE_PARAMS_RECOVER_THREADS ||
+             key == GCACHE_PARAMS_HUGE_PAGES      ||
+             key == GCACHE_PARAMS_NUMA_BIND)
     {
         gu_throw_error(EINVAL) << "'" << key
                                << "' has a meaning only on startup.";
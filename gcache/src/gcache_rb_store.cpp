@@ -12,7 +12,12 @@
 #include <gu_progress.hpp>
 #include <gu_hexdump.hpp>
 #include <gu_hash.h>
+#include <gu_datetime.hpp>
+#include <gu_mem_policy.hpp>
+#include <gu_threads.h>
 
+#include <algorithm>
+#include <vector>
 #include <cassert>
 
 namespace gcache
@@ -48,7 +53,9 @@ namespace gcache
                             seqno2ptr_t&       seqno2ptr,
                             gu::UUID&          gid,
                             int const          dbg,
-                            bool const         recover)
+                            bool const         recover,
+                            int const          recover_threads,
+                            bool const         huge_pages)
     :
         fd_        (name, check_size(size)),
         mmap_      (fd_),
@@ -67,12 +74,30 @@ namespace gcache
 //        mallocs_   (0),
 //        reallocs_  (0),
         debug_     (dbg & DEBUG),
+        recover_threads_(recover_threads),
+        recover_ns_(0),
+        page_size_ (0),
         open_      (true)
     {
         assert((uintptr_t(start_) % MemOps::ALIGNMENT) == 0);
         constructor_common ();
+
+        /* must be done before the pages are touched by recovery */
+        if (huge_pages)
+        {
+            int const err(gu::mem_advise_huge(mmap_.ptr, mmap_.size));
+            if (err)
+            {
+                log_warn << "Failed to advise huge pages for '" << name
+                         << "': " << err << " (" << strerror(err) << ')';
+            }
+        }
+
         open_preamble(recover);
         BH_clear (BH_cast(next_));
+
+        /* reading it takes a scan of /proc/self/smaps */
+        page_size_ = gu::mem_page_size(mmap_.ptr);
     }
 
     RingBuffer::~RingBuffer ()
@@ -82,6 +107,24 @@ namespace gcache
         mmap_.sync();
     }
 
+    void
+    RingBuffer::bind_node(int const node)
+    {
+        int const err(gu::mem_bind_node(mmap_.ptr, mmap_.size, node));
+
+        if (err)
+        {
+            log_warn << "Failed to bind '" << fd_.name() << "' to NUMA node "
+                     << node << ": " << err << " (" << strerror(err) << ')';
+        }
+        else
+        {
+            log_info << "Bound '" << fd_.name() << "' to NUMA node " << node;
+        }
+
+        page_size_ = gu::mem_page_size(mmap_.ptr);
+    }
+
     static inline void
     empty_buffer(BufferHeader* const bh) //mark buffer as empty
     {
@@ -639,6 +682,8 @@ namespace gcache
                 log_info << "Recovering GCache ring buffer: version: " << version
                          << ", UUID: " << gid_ << ", offset: " << offset;
 
+                gu::datetime::Date const start(gu::datetime::Date::monotonic());
+
                 try
                 {
                     recover(offset - (start_ - preamble), version);
@@ -649,6 +694,11 @@ namespace gcache
                              << e.what();
                     reset();
                 }
+
+                recover_ns_ = (gu::datetime::Date::monotonic() - start)
+                    .get_nsecs();
+                log_info << "GCache ring buffer recovery took "
+                         << double(recover_ns_)/gu::datetime::Sec << " sec";
             }
             else
             {
@@ -666,6 +716,215 @@ namespace gcache
         write_preamble(true);
     }
 
+    /* true if ptr points at a valid buffer followed by another header */
+    static inline bool
+    scan_buffer_test(const uint8_t* const ptr, const uint8_t* const limit)
+    {
+        const BufferHeader* const bh(reinterpret_cast<const BufferHeader*>(ptr));
+
+        return (BH_test(bh) && bh->size > 0 && ptr + bh->size <= limit &&
+                BH_test(ptr + bh->size));
+    }
+
+    /* Parallel part of the initial scan. The cache is split into partitions,
+     * each partition is walked by its own thread which resynchronizes on the
+     * first thing that looks like a valid buffer header and then follows the
+     * chain of headers. A false match inside buffer payload only starts
+     * a bogus run which breaks soon, and once a walk meets the actual chain
+     * it follows it to the end of the partition.
+     *
+     * Threads record checkpoints: the start of every run of headers that
+     * passed the scan test plus a header every CHECKPOINT_DISTANCE bytes
+     * within the run, each with the last header of its run. The merge step in
+     * scan() follows the actual chain sequentially and, once it hits
+     * a checkpoint, knows that all headers up to the end of the run are valid
+     * without reading the next header again. Buffer boundaries and seqno
+     * collision handling depend on the order of the walk, so insertion into
+     * seqno2ptr happens only there. */
+    class ScanPartitions
+    {
+    public:
+
+        ScanPartitions(const uint8_t* start, const uint8_t* end,
+                       int scan_step, int threads);
+
+        /* true if ptr is a header which passed the scan test against the end
+         * of the cache. Must be called for the headers in the order they are
+         * visited by the scan, reset() when the scan jumps elsewhere. */
+        bool known(const uint8_t* ptr);
+
+        void reset() { run_begin_ = run_end_ = NULL; }
+
+    private:
+
+        static ptrdiff_t const CHECKPOINT_DISTANCE = 1 << 16;
+
+        struct Checkpoint
+        {
+            const uint8_t* ptr;
+            const uint8_t* run_end; // last valid header of the run
+        };
+
+        struct Partition
+        {
+            const uint8_t*          begin;
+            const uint8_t*          end;
+            const uint8_t*          limit;
+            int                     scan_step;
+            std::vector<Checkpoint> checkpoints;
+        };
+
+        static void  close_run(Partition& p, size_t run, const uint8_t* last);
+        static void* walk(void* arg);
+
+        static bool  checkpoint_less(const Checkpoint& cp,
+                                     const uint8_t* const ptr)
+        {
+            return cp.ptr < ptr;
+        }
+
+        const uint8_t* const   start_;
+        std::vector<Partition> parts_;
+        size_t                 part_size_;
+        const uint8_t*         run_begin_;
+        const uint8_t*         run_end_;
+    };
+
+    ScanPartitions::ScanPartitions(const uint8_t* const start,
+                                   const uint8_t* const end,
+                                   int const scan_step,
+                                   int const threads)
+        :
+        start_    (start),
+        parts_    (),
+        part_size_(0),
+        run_begin_(NULL),
+        run_end_  (NULL)
+    {
+        size_t const cache_size(end - start);
+        size_t const n(threads);
+
+        if (n < 2 || cache_size < n * (1 << 20)) return;
+
+        part_size_ = cache_size / n;
+        part_size_ -= part_size_ % scan_step;
+
+        parts_.resize(n);
+        std::vector<gu_thread_t> threads_v(n);
+        size_t started(0);
+
+        for (size_t i(0); i < n; ++i)
+        {
+            Partition& p(parts_[i]);
+            p.begin     = start + i * part_size_;
+            p.end       = (i + 1 < n ? p.begin + part_size_ : end);
+            p.limit     = end - sizeof(BufferHeader);
+            p.scan_step = scan_step;
+
+            int const err(gu_thread_create(&threads_v[i], NULL, walk, &p));
+            if (err)
+            {
+                log_warn << "Failed to start GCache scan thread: " << err
+                         << " (" << ::strerror(err) << ')';
+                break;
+            }
+
+            ++started;
+        }
+
+        size_t checkpoints(0);
+        for (size_t i(0); i < started; ++i)
+        {
+            gu_thread_join(threads_v[i], NULL);
+            checkpoints += parts_[i].checkpoints.size();
+        }
+
+        /* partitions without a thread have no checkpoints and are scanned
+         * sequentially */
+        log_info << "GCache::RingBuffer scanned " << started << " partitions "
+                 << "in parallel, " << checkpoints << " checkpoints";
+    }
+
+    void
+    ScanPartitions::close_run(Partition& p, size_t const run,
+                              const uint8_t* const last)
+    {
+        for (size_t i(run); i < p.checkpoints.size(); ++i)
+        {
+            p.checkpoints[i].run_end = last;
+        }
+    }
+
+    void*
+    ScanPartitions::walk(void* const arg)
+    {
+        Partition& p(*static_cast<Partition*>(arg));
+        const uint8_t* const cache_end(p.limit + sizeof(BufferHeader));
+        const uint8_t* ptr(p.begin);
+        const uint8_t* last(NULL);
+        const uint8_t* next_checkpoint(NULL);
+        size_t run(0);
+        bool   in_run(false);
+
+        while (ptr < p.end && ptr + sizeof(BufferHeader) < cache_end)
+        {
+            if (scan_buffer_test(ptr, p.limit))
+            {
+                if (!in_run || ptr >= next_checkpoint)
+                {
+                    if (!in_run) run = p.checkpoints.size();
+
+                    Checkpoint const cp = { ptr, NULL };
+                    p.checkpoints.push_back(cp);
+                    next_checkpoint = ptr + CHECKPOINT_DISTANCE;
+                    in_run = true;
+                }
+
+                last = ptr;
+                ptr += reinterpret_cast<const BufferHeader*>(ptr)->size;
+            }
+            else
+            {
+                if (in_run)
+                {
+                    close_run(p, run, last);
+                    in_run = false;
+                }
+
+                ptr += p.scan_step;
+            }
+        }
+
+        if (in_run) close_run(p, run, last);
+
+        return NULL;
+    }
+
+    bool
+    ScanPartitions::known(const uint8_t* const ptr)
+    {
+        if (ptr > run_begin_ && ptr <= run_end_) return true;
+
+        if (parts_.empty() || ptr < start_) return false;
+
+        size_t const i(std::min<size_t>((ptr - start_) / part_size_,
+                                        parts_.size() - 1));
+        const std::vector<Checkpoint>& cps(parts_[i].checkpoints);
+
+        std::vector<Checkpoint>::const_iterator const cp
+            (std::lower_bound(cps.begin(), cps.end(), ptr, checkpoint_less));
+
+        if (cp != cps.end() && cp->ptr == ptr)
+        {
+            /* from here the scan follows the same chain as the thread did */
+            run_begin_ = ptr;
+            run_end_   = cp->run_end;
+            return true;
+        }
+
+        return false;
+    }
+
     seqno_t
     RingBuffer::scan(off_t const offset, int const scan_step)
     {
@@ -691,6 +950,8 @@ namespace gcache
                 segment_scans = 1;
         }
 
+        ScanPartitions partitions(start_, end_, scan_step, recover_threads_);
+
         gu::Progress<ptrdiff_t> progress("GCache::RingBuffer initial scan",
                                          " bytes", end_ - start_, 1<<22 /*4Mb*/);
 
@@ -701,10 +962,14 @@ namespace gcache
             ptr = segment_start;
             bh = BH_cast(ptr);
 
+            partitions.reset();
+
 #define GCACHE_SCAN_BUFFER_TEST                                 \
-            (BH_test(bh) && bh->size > 0 &&                     \
-             ptr + bh->size <= segment_end &&                   \
-             BH_test(BH_cast(ptr + bh->size)))
+            (partitions.known(ptr) ?                            \
+             ptr + bh->size <= segment_end :                    \
+             (BH_test(bh) && bh->size > 0 &&                    \
+              ptr + bh->size <= segment_end &&                  \
+              BH_test(BH_cast(ptr + bh->size))))
 
             while (GCACHE_SCAN_BUFFER_TEST)
             {
@@ -841,6 +1106,7 @@ namespace gcache
                 /* started with the second segment, try to find the first one */
                 assert(1 == segment_scans);
                 next_ = ptr;
+                partitions.reset();
 
                 while (!GCACHE_SCAN_BUFFER_TEST &&
                        ptr + sizeof(BufferHeader) < end_)
@@ -28,7 +28,9 @@ namespace gcache
                     seqno2ptr_t&       seqno2ptr,
                     gu::UUID&          gid,
                     int                dbg,
-                    bool               recover);
+                    bool               recover,
+                    int                recover_threads = 1,
+                    bool               huge_pages = false);
 
         ~RingBuffer ();
 
@@ -114,6 +116,23 @@ namespace gcache
 
         void set_debug(int const dbg) { debug_ = dbg & DEBUG; }
 
+        /*! time spent on recovery at startup in nanoseconds */
+        long long recover_time() const { return recover_ns_; }
+
+        /*! binds ring buffer memory to a given NUMA node */
+        void bind_node(int node);
+
+        /*! size of the pages which actually back the ring buffer, as of
+         *  the end of recovery or the last bind_node() */
+        size_t page_size() const { return page_size_; }
+
+        int file_offset(const void* const ptr, off_t& offset) const
+        {
+            offset = static_cast<const uint8_t*>(ptr) -
+                     static_cast<const uint8_t*>(mmap_.ptr);
+            return fd_.get();
+        }
+
 #ifdef GCACHE_RB_UNIT_TEST
         ptrdiff_t offset(const void* const ptr) const
         {
@@ -151,6 +170,9 @@ namespace gcache
         size_t             size_trail_;
 
         int                debug_;
+        int          const recover_threads_;
+        long long          recover_ns_;
+        size_t             page_size_; // see page_size()
 
         bool               open_;
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "gcache_seqno_index.hpp"
+
+#include <cassert>
+
+namespace gcache
+{
+    static size_t const MIN_DIR_SIZE = 64;
+
+    SeqnoIndex::SeqnoIndex()
+        :
+        dir_           (0),
+        epoch_         (0),
+        active_        (),
+        lo_            (0),
+        hi_            (0),
+        retired_blocks_(),
+        retired_dirs_  ()
+    {}
+
+    SeqnoIndex::~SeqnoIndex()
+    {
+        clear();
+
+        for (int i(0); i < 2; ++i)
+        {
+            assert(0 == active_[i]());
+
+            for (size_t j(0); j < retired_blocks_[i].size(); ++j)
+                delete retired_blocks_[i][j];
+
+            for (size_t j(0); j < retired_dirs_[i].size(); ++j)
+                delete retired_dirs_[i][j];
+        }
+
+        delete dir_();
+    }
+
+    /* Reader registers in the current epoch. If epoch changed in between,
+     * writer may have missed the registration, so retry. */
+    SeqnoIndex::Reader::Reader(const SeqnoIndex& idx)
+        :
+        idx_  (idx),
+        epoch_()
+    {
+        for (;;)
+        {
+            epoch_ = idx_.epoch_();
+            ++idx_.active_[epoch_ & 1];
+            if (gu_likely(idx_.epoch_() == epoch_)) break;
+            --idx_.active_[epoch_ & 1];
+        }
+    }
+
+    /* Objects retired during epoch E are reclaimed when epoch advances from
+     * E + 1 to E + 2. That requires all readers registered in E to be gone,
+     * while readers registered later can't see the objects. */
+    void
+    SeqnoIndex::reclaim()
+    {
+        long long const e(epoch_());
+        int       const prev((e + 1) & 1);
+
+        if (active_[prev]() != 0) return;
+
+        for (size_t j(0); j < retired_blocks_[prev].size(); ++j)
+            delete retired_blocks_[prev][j];
+        retired_blocks_[prev].clear();
+
+        for (size_t j(0); j < retired_dirs_[prev].size(); ++j)
+            delete retired_dirs_[prev][j];
+        retired_dirs_[prev].clear();
+
+        epoch_ = e + 1;
+    }
+
+    void
+    SeqnoIndex::retire(Block* const b)
+    {
+        retired_blocks_[epoch_() & 1].push_back(b);
+    }
+
+    void
+    SeqnoIndex::retire(Dir* const d)
+    {
+        retired_dirs_[epoch_() & 1].push_back(d);
+    }
+
+    /* makes directory big enough for a given number of blocks */
+    void
+    SeqnoIndex::reserve(seqno_t const blocks)
+    {
+        Dir* const old(dir_());
+
+        if (old && size_t(blocks) <= old->mask + 1) return;
+
+        size_t cap(old ? (old->mask + 1) * 2 : MIN_DIR_SIZE);
+        while (cap < size_t(blocks)) cap *= 2;
+
+        Dir* const d(new Dir(cap));
+
+        for (seqno_t n(lo_); n < hi_; ++n)
+        {
+            d->ring[n & d->mask] = old->ring[n & old->mask]();
+        }
+
+        dir_ = d;
+
+        if (old) retire(old);
+    }
+
+    SeqnoIndex::Block*
+    SeqnoIndex::block(seqno_t const n)
+    {
+        if (lo_ == hi_) /* empty */
+        {
+            reserve(1);
+            lo_ = n;
+            hi_ = n + 1;
+        }
+        else if (n < lo_)
+        {
+            reserve(hi_ - n);
+            lo_ = n;
+        }
+        else if (n >= hi_)
+        {
+            reserve(n + 1 - lo_);
+            hi_ = n + 1;
+        }
+
+        Dir::Ring& slot(dir_()->ring[n & dir_()->mask]);
+        Block* ret(slot());
+
+        if (0 == ret)
+        {
+            ret = new Block(n);
+            slot = ret;
+        }
+
+        assert(ret->number == n);
+        return ret;
+    }
+
+    void
+    SeqnoIndex::release_block(seqno_t const n)
+    {
+        Dir::Ring& slot(dir_()->ring[n & dir_()->mask]);
+        Block* const b(slot());
+
+        if (b)
+        {
+            slot = 0;
+            retire(b);
+        }
+    }
+
+    void
+    SeqnoIndex::insert(seqno_t const seqno, const void* const ptr)
+    {
+        assert(seqno >= 0);
+        assert(ptr);
+
+        block(seqno >> BLOCK_SHIFT)->slots[seqno & BLOCK_MASK] = ptr;
+
+        reclaim();
+    }
+
+    void
+    SeqnoIndex::trim(seqno_t const begin)
+    {
+        seqno_t const n(begin >> BLOCK_SHIFT);
+
+        if (lo_ >= n) return;
+
+        for (; lo_ < hi_ && lo_ < n; ++lo_) release_block(lo_);
+
+        if (lo_ == hi_) lo_ = hi_ = 0;
+
+        reclaim();
+    }
+
+    void
+    SeqnoIndex::truncate(seqno_t const end)
+    {
+        seqno_t const n(end >> BLOCK_SHIFT);
+
+        for (; hi_ > lo_ && hi_ - 1 > n; --hi_) release_block(hi_ - 1);
+
+        if (hi_ > lo_ && hi_ - 1 == n)
+        {
+            Block* const b(dir_()->ring[n & dir_()->mask]());
+
+            if (b)
+            {
+                for (seqno_t i(end & BLOCK_MASK); i < BLOCK_SIZE; ++i)
+                    b->slots[i] = 0;
+            }
+        }
+
+        if (lo_ == hi_) lo_ = hi_ = 0;
+
+        reclaim();
+    }
+
+    void
+    SeqnoIndex::clear()
+    {
+        for (; lo_ < hi_; ++lo_) release_block(lo_);
+
+        lo_ = hi_ = 0;
+
+        reclaim();
+    }
+
+} /* namespace gcache */
@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/*!
+ * @file Lock-free readable seqno->ptr index.
+ *
+ * Shadows seqno2ptr map for readers which can't afford to take GCache mutex,
+ * like IST sender reading historical seqnos while new ones are assigned.
+ * Seqnos are kept in fixed size blocks of atomic pointers, blocks are
+ * referenced from a circular directory which is reallocated when it gets
+ * full. Blocks and directories removed by writer are reclaimed only after
+ * all readers which could have seen them are gone (epoch based reclamation),
+ * so readers never wait for writer and writer never waits for readers.
+ *
+ * Writer methods must be serialized by the caller. The index does not own
+ * the buffers: it is the caller's responsibility to ensure that buffers
+ * looked up by readers are not discarded meanwhile (seqno lock).
+ */
+
+#ifndef __GCACHE_SEQNO_INDEX__
+#define __GCACHE_SEQNO_INDEX__
+
+#include "gcache_seqno.hpp"
+
+#include <gu_atomic.hpp>
+#include <gu_macros.h>
+
+#include <vector>
+#include <cstddef>
+
+namespace gcache
+{
+    class SeqnoIndex
+    {
+        static int     const BLOCK_SHIFT = 10;
+        static seqno_t const BLOCK_SIZE  = seqno_t(1) << BLOCK_SHIFT;
+        static seqno_t const BLOCK_MASK  = BLOCK_SIZE - 1;
+
+        struct Block
+        {
+            explicit Block(seqno_t const n) : number(n), slots() {}
+
+            seqno_t           const number;
+            gu::Atomic<const void*> slots[BLOCK_SIZE];
+        };
+
+        struct Dir
+        {
+            explicit Dir(size_t const cap) : mask(cap - 1), ring(new Ring[cap])
+            {}
+
+            ~Dir() { delete[] ring; }
+
+            typedef gu::Atomic<Block*> Ring;
+
+            size_t const mask;
+            Ring*  const ring;
+
+        private:
+            Dir(const Dir&);
+            Dir& operator=(const Dir&);
+        };
+
+    public:
+
+        SeqnoIndex();
+        ~SeqnoIndex();
+
+        /* writer interface */
+
+        void insert  (seqno_t seqno, const void* ptr);
+
+        /*! forgets seqnos below begin (not necessarily all of them) */
+        void trim    (seqno_t begin);
+
+        /*! forgets seqnos starting from end */
+        void truncate(seqno_t end);
+
+        void clear   ();
+
+        /* reader interface */
+
+        /*! Protects index memory from reclamation for its lifetime,
+         *  lookups must be done within a Reader scope. */
+        class Reader
+        {
+        public:
+
+            explicit Reader(const SeqnoIndex& idx);
+            ~Reader() { --idx_.active_[epoch_ & 1]; }
+
+            /*! @return pointer set for seqno or 0 if not found */
+            const void* find(seqno_t const seqno) const
+            {
+                const Dir* const d(idx_.dir_());
+
+                if (gu_unlikely(seqno < 0 || 0 == d)) return 0;
+
+                seqno_t const n(seqno >> BLOCK_SHIFT);
+                Block*  const b(d->ring[n & d->mask]());
+
+                if (0 == b || b->number != n) return 0;
+
+                return b->slots[seqno & BLOCK_MASK]();
+            }
+
+        private:
+
+            const SeqnoIndex& idx_;
+            long long         epoch_;
+
+            Reader(const Reader&);
+            Reader& operator=(const Reader&);
+        };
+
+    private:
+
+        Block* block  (seqno_t n);
+        void   reserve(seqno_t blocks);
+        void   release_block(seqno_t n);
+        void   retire (Block* b);
+        void   retire (Dir* d);
+        void   reclaim();
+
+        /* shared with readers */
+        gu::Atomic<Dir*>              dir_;
+        gu::Atomic<long long>         epoch_;
+        mutable gu::Atomic<long>      active_[2];
+
+        /* writer private */
+        seqno_t                       lo_; // first block number in use
+        seqno_t                       hi_; // past the last block number
+        std::vector<Block*>           retired_blocks_[2];
+        std::vector<Dir*>             retired_dirs_[2];
+
+        SeqnoIndex(const SeqnoIndex&);
+        SeqnoIndex& operator=(const SeqnoIndex&);
+    };
+
+} /* namespace gcache */
+
+#endif /* __GCACHE_SEQNO_INDEX__ */
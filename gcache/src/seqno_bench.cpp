@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/**
+ * This is to benchmark GCache seqno assign throughput while concurrent
+ * IST-like readers stream locked history, and the throughput of the readers.
+ *
+ * Usage: gcache_seqno_bench [seqnos] [max readers] [history]
+ */
+
+#include "GCache.hpp"
+
+#include <gu_atomic.hpp>
+#include <gu_threads.h>
+
+#include <sys/time.h>
+#include <unistd.h>
+#include <iostream>
+#include <cstdlib>
+
+static double time_diff(const struct timeval& l,
+                        const struct timeval& r)
+{
+    double const left(double(l.tv_usec)*1.0e-06 + l.tv_sec);
+    double const right(double(r.tv_usec)*1.0e-06 + r.tv_sec);
+    return left - right;
+}
+
+static const char* const GCACHE_NAME = "seqno_bench.gcache";
+
+static size_t const BUF_SIZE = 64;
+
+struct ReaderArgs
+{
+    gcache::GCache*   gcache;
+    gcache::seqno_t   history;
+    gu::Atomic<int>*  stop;
+    long long         read;
+};
+
+/* reads history in batches over and over again, like IST sender does */
+static void*
+reader_thread(void* arg)
+{
+    ReaderArgs* const args(static_cast<ReaderArgs*>(arg));
+
+    std::vector<gcache::GCache::Buffer> bufs(128);
+
+    while (0 == (*args->stop)())
+    {
+        gcache::seqno_t seqno(1);
+        while (seqno <= args->history)
+        {
+            size_t const n(args->gcache->seqno_get_buffers(bufs, seqno));
+            if (0 == n) abort();
+            seqno += n;
+            args->read += n;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+assign(gcache::GCache& gcache, gcache::seqno_t const seqno)
+{
+    void* const ptr(gcache.malloc(BUF_SIZE));
+    if (!ptr) abort();
+    gcache.seqno_assign(ptr, seqno, seqno - 1);
+}
+
+static void
+bench(gcache::seqno_t const seqnos, int const n_readers,
+      gcache::seqno_t const history)
+{
+    gu::Config conf;
+    gcache::GCache::register_params(conf);
+    conf.set("gcache.name", GCACHE_NAME);
+    conf.set("gcache.size", "1M");
+    conf.set("gcache.mem_size", "4G");
+
+    {
+        gcache::GCache gcache(conf, ".");
+
+        for (gcache::seqno_t s(1); s <= history; ++s) assign(gcache, s);
+
+        gcache.seqno_lock(1); // keep history for readers
+
+        gu::Atomic<int> stop(0);
+        std::vector<ReaderArgs>  args(n_readers);
+        std::vector<gu_thread_t> threads(n_readers);
+
+        for (int i(0); i < n_readers; ++i)
+        {
+            ReaderArgs const a = { &gcache, history, &stop, 0 };
+            args[i] = a;
+            gu_thread_create(&threads[i], NULL, reader_thread, &args[i]);
+        }
+
+        struct timeval start, stop_time;
+        gettimeofday(&start, NULL);
+
+        for (gcache::seqno_t s(history + 1); s <= history + seqnos; ++s)
+        {
+            assign(gcache, s);
+        }
+
+        gettimeofday(&stop_time, NULL);
+
+        stop = 1;
+        long long read(0);
+        for (int i(0); i < n_readers; ++i)
+        {
+            gu_thread_join(threads[i], NULL);
+            read += args[i].read;
+        }
+
+        gcache.seqno_unlock();
+
+        double const t(time_diff(stop_time, start));
+        std::cout << "readers: " << n_readers
+                  << "\ttime: " << t << " sec"
+                  << "\tassign/sec: " << seqnos/t
+                  << "\tread/sec: " << read/t << std::endl;
+    }
+
+    ::unlink(GCACHE_NAME);
+}
+
+int main(int argc, char* argv[])
+{
+    long long const seqnos     (argc > 1 ? ::atoll(argv[1]) : 1000000);
+    int       const max_readers(argc > 2 ? ::atoi(argv[2])  : 4);
+    long long const history    (argc > 3 ? ::atoll(argv[3]) : 100000);
+
+    if (seqnos <= 0 || max_readers < 0 || history <= 0)
+    {
+        std::cerr << "Usage: " << argv[0]
+                  << " [seqnos] [max readers] [history]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "Assigning " << seqnos << " seqnos with " << history
+              << " seqnos of history being read" << std::endl;
+
+    bench(seqnos, 0, history);
+
+    for (int readers(1); readers <= max_readers; readers *= 2)
+    {
+        bench(seqnos, readers, history);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "GCache.hpp"
+#include "gcache_compress_test.hpp"
+
+#include <gu_exception.hpp>
+#include <gu_threads.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+using namespace gcache;
+
+static const char* const GCACHE_NAME = "compress_test.cache";
+
+static int const BUF_SIZE = 1000;
+
+/* compressible contents which can be verified */
+static void
+fill_text(void* const ptr, seqno_t const seqno)
+{
+    char* const buf(static_cast<char*>(ptr));
+    int off(0);
+
+    while (off < BUF_SIZE)
+    {
+        off += ::snprintf(buf + off, BUF_SIZE - off,
+                          "UPDATE t1 SET c = 'value' WHERE id = %lld; ",
+                          static_cast<long long>(seqno));
+    }
+}
+
+static void
+fill_random(void* const ptr, seqno_t)
+{
+    unsigned char* const buf(static_cast<unsigned char*>(ptr));
+    for (int i(0); i < BUF_SIZE; ++i) buf[i] = ::rand();
+}
+
+static void
+add_history(GCache& gc, seqno_t const begin, seqno_t const end,
+            void (*fill)(void*, seqno_t))
+{
+    for (seqno_t s(begin); s < end; ++s)
+    {
+        void* const ptr(gc.malloc(BUF_SIZE));
+        ck_assert(ptr != 0);
+        fill(ptr, s);
+        gc.seqno_assign(ptr, s, s - 1);
+        gc.seqno_release(s);
+    }
+}
+
+static void
+check_history(GCache& gc, seqno_t const begin, seqno_t const end)
+{
+    std::vector<GCache::Buffer> v(100);
+    char expected[BUF_SIZE + 1];
+
+    gc.seqno_lock(begin);
+
+    seqno_t s(begin);
+    while (s < end)
+    {
+        size_t const n(gc.seqno_get_buffers(v, s));
+        ck_assert(n > 0);
+
+        for (size_t i(0); i < n && s < end; ++i, ++s)
+        {
+            ck_assert(v[i].seqno_g() == s);
+            ck_assert(v[i].seqno_d() == s - 1);
+            ck_assert(v[i].size() >= BUF_SIZE);
+            fill_text(expected, s);
+            ck_assert(0 == ::memcmp(v[i].ptr(), expected, BUF_SIZE));
+        }
+    }
+
+    /* buffers must stay valid when copied */
+    std::vector<GCache::Buffer> const copy(v);
+    v.clear();
+    fill_text(expected, copy[0].seqno_g());
+    ck_assert(0 == ::memcmp(copy[0].ptr(), expected, BUF_SIZE));
+
+    gc.seqno_unlock();
+}
+
+START_TEST(history)
+{
+    ::unlink(GCACHE_NAME);
+
+    gu::Config conf;
+    GCache::register_params(conf);
+    conf.set("gcache.name", GCACHE_NAME);
+    conf.set("gcache.size", "1M");
+    conf.set("gcache.page_size", "64K");
+    conf.set("gcache.compress", "yes");
+
+    {
+        GCache gc(conf, ".");
+
+        /* 2M of raw history won't fit into 1M ring buffer uncompressed */
+        seqno_t const end(2001);
+        add_history(gc, 1, end, fill_text);
+
+        ck_assert_msg(1 == gc.seqno_min(), "seqno_min: %lld",
+                      static_cast<long long>(gc.seqno_min()));
+        check_history(gc, 1, end);
+
+        GCache::CompressStats const cs(gc.compress_stats());
+        ck_assert(cs.raw_bytes >= (end - 1) * BUF_SIZE);
+        ck_assert(cs.compressed_bytes * 4 < cs.raw_bytes);
+        ck_assert(cs.decompress_ns > 0);
+
+        /* compressed buffer can't be returned as a pointer */
+        seqno_t sd;
+        ssize_t size;
+        try
+        {
+            gc.seqno_get_ptr(1, sd, size);
+            ck_abort_msg("seqno_get_ptr() must throw on compressed buffer");
+        }
+        catch (gu::NotFound&) {}
+
+        /* incompressible buffers stay in the ring buffer */
+        add_history(gc, end, end + 10, fill_random);
+        ck_assert(gc.compress_stats().raw_bytes == cs.raw_bytes);
+
+        /* compressed history is bounded by gcache.size */
+        seqno_t const end2(end + 10 + 20000);
+        add_history(gc, end + 10, end2, fill_text);
+        ck_assert(gc.seqno_min() > end + 10);
+        check_history(gc, gc.seqno_min(), end2);
+
+        /* switching it off in runtime */
+        gc.param_set("gcache.compress", "no");
+        long long const raw(gc.compress_stats().raw_bytes);
+        add_history(gc, end2, end2 + 100, fill_text);
+        ck_assert(gc.compress_stats().raw_bytes == raw);
+        check_history(gc, end2 - 100, end2 + 100);
+
+        /* history reset must get rid of compressed pages */
+        gc.seqno_reset(gu::UUID(NULL, 0), SEQNO_NONE);
+        ck_assert(SEQNO_ILL == gc.seqno_min());
+    }
+
+    ::unlink(GCACHE_NAME);
+}
+END_TEST
+
+struct ReleaseArg
+{
+    GCache* gc;
+    seqno_t end;
+};
+
+static void*
+release_thread(void* const arg)
+{
+    ReleaseArg* const ra(static_cast<ReleaseArg*>(arg));
+
+    for (seqno_t s(1); s < ra->end; s += 7) ra->gc->seqno_release(s);
+    ra->gc->seqno_release(ra->end - 1);
+
+    return NULL;
+}
+
+/* buffers are compressed with GCache mutex unlocked: concurrent releases
+ * must still release and compress them in order */
+START_TEST(concurrent)
+{
+    ::unlink(GCACHE_NAME);
+
+    gu::Config conf;
+    GCache::register_params(conf);
+    conf.set("gcache.name", GCACHE_NAME);
+    conf.set("gcache.size", "1M");
+    conf.set("gcache.page_size", "64K");
+    conf.set("gcache.compress", "yes");
+
+    {
+        GCache gc(conf, ".");
+
+        seqno_t const end(501);
+
+        for (seqno_t s(1); s < end; ++s)
+        {
+            void* const ptr(gc.malloc(BUF_SIZE));
+            ck_assert(ptr != 0);
+            fill_text(ptr, s);
+            gc.seqno_assign(ptr, s, s - 1);
+        }
+
+        ReleaseArg arg = { &gc, end };
+        gu_thread_t thr[2];
+
+        for (size_t i(0); i < sizeof(thr)/sizeof(thr[0]); ++i)
+        {
+            ck_assert(0 == gu_thread_create(&thr[i], NULL, release_thread,
+                                            &arg));
+        }
+
+        for (size_t i(0); i < sizeof(thr)/sizeof(thr[0]); ++i)
+        {
+            gu_thread_join(thr[i], NULL);
+        }
+
+        ck_assert(gc.compress_stats().raw_bytes >= (end - 1) * BUF_SIZE);
+        check_history(gc, 1, end);
+
+        /* new buffers must fit into ring buffer space freed by compression */
+        add_history(gc, end, 2*end, fill_text);
+        check_history(gc, 1, 2*end);
+    }
+
+    ::unlink(GCACHE_NAME);
+}
+END_TEST
+
+Suite* gcache_compress_suite()
+{
+    Suite* s = suite_create("gcache::compress");
+    TCase* tc = tcase_create("compress");
+
+    tcase_add_test(tc, history);
+    tcase_add_test(tc, concurrent);
+    tcase_set_timeout(tc, 60);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
@@ -8,6 +8,10 @@
 #include "gcache_bh.hpp"
 #include "gcache_mem_test.hpp"
 
+#include <gu_mem_policy.hpp>
+
+#include <cstring>
+
 using namespace gcache;
 
 START_TEST(test1)
@@ -78,6 +82,53 @@ START_TEST(test1)
 }
 END_TEST
 
+/* Big buffers are mapped separately when memory policy is set: contents
+ * must survive reallocation across the mapping threshold */
+START_TEST(mem_policy)
+{
+    ssize_t const bh_size (sizeof(gcache::BufferHeader));
+    size_t  const big     (5 << 20);
+    size_t  const small   (1 << 20);
+
+    seqno2ptr_t s2p(SEQNO_NONE);
+    MemStore ms(4 * big, s2p, 0);
+
+    ms.set_huge_pages(true);
+    int const node(gu::mem_numa_node());
+    if (node >= 0) ms.set_numa_node(node);
+
+    void* buf = ms.malloc (small + bh_size);
+    ck_assert(NULL != buf);
+    ::memset(buf, 1, small);
+
+    buf = ms.realloc (buf, big + bh_size);
+    ck_assert(NULL != buf);
+    ck_assert(static_cast<char*>(buf)[small - 1] == 1);
+    ::memset(buf, 2, big);
+
+    buf = ms.realloc (buf, 2 * big + bh_size);
+    ck_assert(NULL != buf);
+    ck_assert(static_cast<char*>(buf)[big - 1] == 2);
+
+    BufferHeader* const bh(ptr2BH(buf));
+    ck_assert(bh->size == 2 * big + bh_size);
+    BH_release(bh);
+    ms.free (bh);
+
+    /* released buffer with seqno stays until reset */
+    void* const other = ms.malloc (big + bh_size);
+    ck_assert(NULL != other);
+    BufferHeader* const obh(ptr2BH(other));
+    obh->seqno_g = 1;
+    BH_release(obh);
+    ms.free (obh);
+    ck_assert(ms._allocd() == big + bh_size);
+    ms.reset();
+
+    ck_assert(!ms._allocd());
+}
+END_TEST
+
 Suite* gcache_mem_suite()
 {
     Suite* s = suite_create("gcache::MemStore");
@@ -85,6 +136,7 @@ Suite* gcache_mem_suite()
 
     tc = tcase_create("test");
     tcase_add_test(tc, test1);
+    tcase_add_test(tc, mem_policy);
     suite_add_tcase(s, tc);
 
     return s;
@@ -115,6 +115,85 @@ START_TEST(test3) // check that all page size is efficiently used
 }
 END_TEST
 
+START_TEST(test_pool) // check that free pages are recycled through the pool
+{
+    const char* const dir_name = "";
+    ssize_t const bh_size = sizeof(gcache::BufferHeader);
+    ssize_t const keep_size = 0;
+    ssize_t const page_size = (1 << 20) + bh_size;
+
+    gcache::PageStore ps (dir_name, keep_size, page_size, 0, false, 2);
+
+    ck_assert_msg(ps.pool_pages()  == 2,"expected 2 pool pages, got %zu",
+                  ps.pool_pages());
+    ck_assert_msg(ps.total_pages() == 0,"expected 0 pages, got %zu",
+                  ps.total_pages());
+
+    void* buf = ps.malloc (page_size);
+
+    ck_assert(0 != buf);
+    ck_assert_msg(ps.count()       == 2,"expected count 2, got %zu",ps.count());
+    ck_assert_msg(ps.pool_pages()  == 1,"expected 1 pool page, got %zu",
+                  ps.pool_pages());
+    ck_assert_msg(ps.total_pages() == 1,"expected 1 page, got %zu",
+                  ps.total_pages());
+
+    // does not fit in a regular page, new one must be created
+    void* big = ps.malloc (2 * page_size);
+
+    ck_assert(0 != big);
+    ck_assert_msg(ps.count()       == 3,"expected count 3, got %zu",ps.count());
+    ck_assert_msg(ps.pool_pages()  == 1,"expected 1 pool page, got %zu",
+                  ps.pool_pages());
+
+    ps_free(buf); ps.discard(ptr2BH(buf));
+
+    ck_assert_msg(ps.pool_pages()  == 2,"expected 2 pool pages, got %zu",
+                  ps.pool_pages());
+    ck_assert_msg(ps.total_pages() == 1,"expected 1 page, got %zu",
+                  ps.total_pages());
+
+    // irregular page must be deleted
+    ps_free(big); ps.discard(ptr2BH(big));
+
+    ck_assert_msg(ps.pool_pages()  == 2,"expected 2 pool pages, got %zu",
+                  ps.pool_pages());
+    ck_assert_msg(ps.total_pages() == 0,"expected 0 pages, got %zu",
+                  ps.total_pages());
+
+    ps.set_pool_size(1);
+    ck_assert_msg(ps.pool_pages()  == 1,"expected 1 pool page, got %zu",
+                  ps.pool_pages());
+
+    const gcache::PageStore::Stats& stats(ps.stats());
+    ck_assert(stats.page_allocs == 2);
+    ck_assert(stats.page_reuses == 1);
+    ck_assert(stats.page_alloc_ns > 0);
+
+    // page recycled in background must be reused, not created anew
+    buf = ps.malloc (page_size);
+
+    ck_assert(0 != buf);
+    ck_assert_msg(ps.count()       == 3,"expected count 3, got %zu",ps.count());
+    ck_assert_msg(ps.pool_pages()  == 0,"expected 0 pool pages, got %zu",
+                  ps.pool_pages());
+    ck_assert(stats.page_reuses == 2);
+
+    ps_free(buf); ps.discard(ptr2BH(buf));
+
+    ck_assert_msg(ps.pool_pages()  == 1,"expected 1 pool page, got %zu",
+                  ps.pool_pages());
+
+    buf = ps.malloc (page_size);
+
+    ck_assert(0 != buf);
+    ck_assert_msg(ps.count()       == 3,"expected count 3, got %zu",ps.count());
+    ck_assert(stats.page_reuses == 3);
+
+    ps_free(buf); ps.discard(ptr2BH(buf));
+}
+END_TEST
+
 Suite* gcache_page_suite()
 {
     Suite* s = suite_create("gcache::PageStore");
@@ -124,6 +203,7 @@ Suite* gcache_page_suite()
     tcase_add_test(tc, test1);
     tcase_add_test(tc, test2);
     tcase_add_test(tc, test3);
+    tcase_add_test(tc, test_pool);
     suite_add_tcase(s, tc);
 
     return s;
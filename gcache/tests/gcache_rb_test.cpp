@@ -11,7 +11,11 @@
 #include "gcache_rb_test.hpp"
 
 #include <gu_logger.hpp>
+#include <gu_mem_policy.hpp>
 #include <gu_throw.hpp>
+#include <gu_limits.h>
+
+#include <vector>
 
 using namespace gcache;
 
@@ -503,6 +507,107 @@ START_TEST(recovery)
 }
 END_TEST
 
+/* Recovery with parallel partitioned scan must find all the buffers the ring
+ * buffer had before it was closed, including the case of rollover */
+START_TEST(recovery_threads)
+{
+    ::unlink(RB_NAME.c_str());
+
+    size_t const rb_size(8 << 20);
+    int    const threads(4);
+
+    std::vector<ptrdiff_t> offsets;
+    seqno_t seqno_min, seqno_max;
+
+    {
+        seqno2ptr_t s2p(SEQNO_NONE);
+        gu::UUID    gid(GID);
+        RingBuffer  rb(RB_NAME, rb_size, s2p, gid, 0, false);
+
+        /* fill the buffer one and a half times with buffers of varying size,
+         * some of them big enough to span several scan partitions */
+        size_t total(0);
+        for (seqno_t g(1); total < rb_size + rb_size/2; ++g)
+        {
+            size_type const size(g % 97 ? ALLOC_SIZE(g % 4099) :
+                                 ALLOC_SIZE(rb_size/3));
+            void* const ptr(rb.malloc(size));
+            ck_assert_msg(NULL != ptr, "Failed to allocate seqno %lld",
+                          (long long)g);
+            ::memset(ptr, int(g), size - BH_SIZE);
+
+            s2p.insert(g, ptr);
+            BufferHeader* const bh(ptr2BH(ptr));
+            bh->seqno_g = g;
+            bh->seqno_d = g - 1;
+            BH_release(bh);
+            rb.free(bh);
+
+            total += size;
+        }
+
+        seqno_min = s2p.index_front();
+        seqno_max = s2p.index_back();
+        for (seqno_t g(seqno_min); g <= seqno_max; ++g)
+        {
+            offsets.push_back(rb.offset(s2p[g]));
+        }
+    }
+
+    {
+        seqno2ptr_t s2p(SEQNO_NONE);
+        gu::UUID    gid(GID);
+        RingBuffer  rb(RB_NAME, rb_size, s2p, gid, 0, true, threads);
+
+        ck_assert(gid == GID);
+        ck_assert(rb.recover_time() > 0);
+        ck_assert_msg(s2p.index_front() == seqno_min,
+                      "Expected first seqno %lld, got %lld",
+                      (long long)seqno_min, (long long)s2p.index_front());
+        ck_assert_msg(s2p.index_back() == seqno_max,
+                      "Expected last seqno %lld, got %lld",
+                      (long long)seqno_max, (long long)s2p.index_back());
+
+        for (seqno_t g(seqno_min); g <= seqno_max; ++g)
+        {
+            ck_assert_msg(rb.offset(s2p[g]) == offsets[g - seqno_min],
+                          "Seqno %lld recovered at wrong offset",
+                          (long long)g);
+        }
+    }
+
+    ::unlink(RB_NAME.c_str());
+}
+END_TEST
+
+/* Memory placement policy must not affect ring buffer operation */
+START_TEST(mem_policy)
+{
+    ::unlink(RB_NAME.c_str());
+
+    {
+        seqno2ptr_t s2p(SEQNO_NONE);
+        gu::UUID    gid(GID);
+        RingBuffer  rb(RB_NAME, 4 << 20, s2p, gid, 0, false, 1, true);
+
+        int const node(gu::mem_numa_node());
+        if (node >= 0) rb.bind_node(node);
+
+        void* const ptr(rb.malloc(ALLOC_SIZE(1 << 20)));
+        ck_assert(NULL != ptr);
+        ::memset(ptr, 1, 1 << 20);
+        BH_release(ptr2BH(ptr));
+        rb.free(ptr2BH(ptr));
+
+#if defined(__linux__)
+        ck_assert_msg(rb.page_size() >= GU_PAGE_SIZE,
+                      "Ring buffer page size %zu", rb.page_size());
+#endif
+    }
+
+    ::unlink(RB_NAME.c_str());
+}
+END_TEST
 
 Suite* gcache_rb_suite()
 {
@@ -511,12 +616,14 @@ Suite* gcache_rb_suite()
 
     tcase_set_timeout(tc, 60);
     tcase_add_test(tc, test1);
+    tcase_add_test(tc, mem_policy);
     suite_add_tcase(ts, tc);
 
     tc = tcase_create("recovery");
 
     tcase_set_timeout(tc, 60);
     tcase_add_test(tc, recovery);
+    tcase_add_test(tc, recovery_threads);
     suite_add_tcase(ts, tc);
 
     return ts;
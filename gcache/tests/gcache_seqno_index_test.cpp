@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+#include "gcache_seqno_index.hpp"
+#include "gcache_seqno_index_test.hpp"
+
+#include <gu_atomic.hpp>
+#include <gu_threads.h>
+
+using namespace gcache;
+
+/* fake buffer pointer which encodes seqno */
+static const void* seqno_ptr(seqno_t const s)
+{
+    return reinterpret_cast<const void*>(s * 8);
+}
+
+START_TEST(basic)
+{
+    SeqnoIndex idx;
+
+    {
+        SeqnoIndex::Reader r(idx);
+        ck_assert(0 == r.find(1));
+    }
+
+    /* span several blocks, starting and ending in the middle of them */
+    seqno_t const begin(1000), end(5000);
+    for (seqno_t s(begin); s < end; ++s) idx.insert(s, seqno_ptr(s));
+
+    {
+        SeqnoIndex::Reader r(idx);
+        ck_assert(0 == r.find(begin - 1));
+        ck_assert(0 == r.find(end));
+        for (seqno_t s(begin); s < end; ++s)
+            ck_assert(r.find(s) == seqno_ptr(s));
+    }
+
+    idx.truncate(4000);
+    idx.trim(3000);
+
+    {
+        SeqnoIndex::Reader r(idx);
+        ck_assert(0 == r.find(4000));
+        ck_assert(0 == r.find(4999));
+        ck_assert(0 == r.find(2000));
+        for (seqno_t s(3000); s < 4000; ++s)
+            ck_assert(r.find(s) == seqno_ptr(s));
+    }
+
+    /* out of order insert before the front */
+    idx.insert(10, seqno_ptr(10));
+    {
+        SeqnoIndex::Reader r(idx);
+        ck_assert(r.find(10) == seqno_ptr(10));
+        ck_assert(r.find(3500) == seqno_ptr(3500));
+    }
+
+    idx.clear();
+    {
+        SeqnoIndex::Reader r(idx);
+        ck_assert(0 == r.find(10));
+        ck_assert(0 == r.find(3500));
+    }
+
+    idx.insert(1 << 20, seqno_ptr(1 << 20));
+    {
+        SeqnoIndex::Reader r(idx);
+        ck_assert(r.find(1 << 20) == seqno_ptr(1 << 20));
+    }
+}
+END_TEST
+
+struct ReaderArgs
+{
+    const SeqnoIndex*      idx;
+    gu::Atomic<long long>* locked;
+    gu::Atomic<int>*       stop;
+    long long              found;
+};
+
+/* reads everything from the locked seqno up, like IST sender */
+static void* reader_thread(void* arg)
+{
+    ReaderArgs* const args(static_cast<ReaderArgs*>(arg));
+
+    while (0 == (*args->stop)())
+    {
+        SeqnoIndex::Reader r(*args->idx);
+
+        seqno_t s((*args->locked)());
+        const void* ptr;
+        while ((ptr = r.find(s)))
+        {
+            ck_assert_msg(ptr == seqno_ptr(s), "Wrong pointer for %lld",
+                          (long long)s);
+            ++s;
+            ++args->found;
+        }
+    }
+
+    return NULL;
+}
+
+/* Readers must always find consistent locked history while writer appends
+ * at the head and trims the tail. */
+START_TEST(concurrent)
+{
+    SeqnoIndex idx;
+    gu::Atomic<long long> locked(1);
+    gu::Atomic<int>       stop(0);
+
+    idx.insert(1, seqno_ptr(1));
+
+    int const n_readers(4);
+    std::vector<ReaderArgs>  args(n_readers);
+    std::vector<gu_thread_t> threads(n_readers);
+
+    for (int i(0); i < n_readers; ++i)
+    {
+        ReaderArgs const a = { &idx, &locked, &stop, 0 };
+        args[i] = a;
+        gu_thread_create(&threads[i], NULL, reader_thread, &args[i]);
+    }
+
+    seqno_t const total(1 << 20);
+    seqno_t const window(20000);
+
+    for (seqno_t s(2); s <= total; ++s)
+    {
+        idx.insert(s, seqno_ptr(s));
+
+        /* "release" history below window, moving the lock first */
+        if (s > window)
+        {
+            locked = s - window;
+            idx.trim(s - window);
+        }
+    }
+
+    stop = 1;
+
+    for (int i(0); i < n_readers; ++i)
+    {
+        gu_thread_join(threads[i], NULL);
+        ck_assert(args[i].found > 0);
+    }
+}
+END_TEST
+
+Suite* gcache_seqno_index_suite()
+{
+    Suite* s = suite_create("gcache::SeqnoIndex");
+    TCase* tc;
+
+    tc = tcase_create("test");
+    tcase_add_test(tc, basic);
+    tcase_set_timeout(tc, 60);
+    tcase_add_test(tc, concurrent);
+    suite_add_tcase(s, tc);
+
+    return s;
+}
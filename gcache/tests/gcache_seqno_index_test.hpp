@@ -0,0 +1,13 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+#ifndef __gcache_seqno_index_test_hpp__
+#define __gcache_seqno_index_test_hpp__
+
+extern "C" {
+#include <check.h>
+}
+
+extern Suite* gcache_seqno_index_suite();
+
+#endif // __gcache_seqno_index_test_hpp__
@@ -11,6 +11,8 @@
 #include "gcache_mem_test.hpp"
 #include "gcache_rb_test.hpp"
 #include "gcache_page_test.hpp"
+#include "gcache_seqno_index_test.hpp"
+#include "gcache_compress_test.hpp"
 
 extern "C" {
 #include <check.h>
@@ -23,6 +25,8 @@ static suite_creator_t suites[] =
     gcache_mem_suite,
     gcache_rb_suite,
     gcache_page_suite,
+    gcache_seqno_index_suite,
+    gcache_compress_suite,
     0
 };
 
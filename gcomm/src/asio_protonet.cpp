@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010-2019 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  */
 
 
@@ -31,7 +31,14 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
     mtu_(1 << 15),
     checksum_(NetHeader::checksum_type(
                   conf.get<int>(gcomm::Conf::SocketChecksum,
-                                NetHeader::CS_CRC32C)))
+                                NetHeader::CS_CRC32C))),
+    io_services_(),
+    io_work_(),
+    io_threads_(),
+    io_mutex_(),
+    io_next_(0),
+    dispatch_q_(),
+    dispatch_posted_(false)
 {
     conf.set(gcomm::Conf::SocketChecksum, checksum_);
     // use ssl if either private key or cert file is specified
@@ -50,11 +57,105 @@ gcomm::AsioProtonet::AsioProtonet(gu::Config& conf, int version)
         log_info << "initializing ssl context";
         gu::ssl_prepare_context(conf_, ssl_context_);
     }
+
+    const int io_threads(conf.get<int>(gcomm::Conf::ProtonetIoThreads, 0));
+    if (io_threads < 0)
+    {
+        gu_throw_error(EINVAL) << "invalid " << gcomm::Conf::ProtonetIoThreads
+                               << ": " << io_threads;
+    }
+    start_io_threads(io_threads);
 }
 
 gcomm::AsioProtonet::~AsioProtonet()
 {
+    stop_io_threads();
+}
+
+void* gcomm::AsioProtonet::io_thread_func(void* arg)
+{
+    asio::io_service& io_service(*static_cast<asio::io_service*>(arg));
+
+    while (true)
+    {
+        try
+        {
+            io_service.run();
+            break;
+        }
+        catch (std::exception& e)
+        {
+            log_error << "exception in protonet I/O thread: " << e.what();
+        }
+    }
+
+    return 0;
+}
+
+void gcomm::AsioProtonet::start_io_threads(size_t const n)
+{
+    for (size_t i(0); i < n; ++i)
+    {
+        asio::io_service* const io_service(new asio::io_service());
+        io_services_.push_back(io_service);
+        // keeps run() from returning while there are no sockets
+        io_work_.push_back(new asio::io_service::work(*io_service));
+
+        gu_thread_t thd;
+        int const err(gu_thread_create(&thd, NULL, io_thread_func, io_service));
+
+        if (err != 0)
+        {
+            stop_io_threads();
+            gu_throw_error(err) << "Failed to create protonet I/O thread "
+                                << i << " of " << n;
+        }
+
+        io_threads_.push_back(thd);
+    }
+
+    if (n > 0)
+    {
+        log_info << "protonet I/O threads: " << n;
+    }
+}
+
+void gcomm::AsioProtonet::stop_io_threads()
+{
+    for (size_t i(0); i < io_services_.size(); ++i)
+    {
+        io_services_[i]->stop();
+    }
+
+    for (size_t i(0); i < io_threads_.size(); ++i)
+    {
+        gu_thread_join(io_threads_[i], NULL);
+    }
+
+    {
+        gu::Lock lock(io_mutex_);
+        dispatch_q_.clear();
+    }
+
+    for (size_t i(0); i < io_services_.size(); ++i)
+    {
+        delete io_work_[i];
+        delete io_services_[i];
+    }
+
+    io_threads_.clear();
+    io_work_.clear();
+    io_services_.clear();
+}
+
+asio::io_service& gcomm::AsioProtonet::socket_io_service()
+{
+    if (io_services_.empty()) return io_service_;
 
+    gu::Lock lock(io_mutex_);
+    asio::io_service& ret(*io_services_[io_next_]);
+    io_next_ = (io_next_ + 1) % io_services_.size();
+    return ret;
 }
 
 void gcomm::AsioProtonet::enter()
@@ -129,6 +230,81 @@ void gcomm::AsioProtonet::dispatch(const SocketId& id,
 }
 
 
+void gcomm::AsioProtonet::post_dispatch(const SocketPtr&   socket,
+                                        const Datagram&    dg,
+                                        const ProtoUpMeta& um)
+{
+    gu::Lock lock(io_mutex_);
+
+    dispatch_q_.push_back(DispatchEvent(socket, dg, um));
+
+    if (dispatch_posted_ == false)
+    {
+        dispatch_posted_ = true;
+        io_service_.post(boost::bind(&AsioProtonet::handle_dispatch, this));
+    }
+}
+
+
+gcomm::AsioProtonet::DispatchEvent gcomm::AsioProtonet::pop_dispatch()
+{
+    gu::Lock lock(io_mutex_);
+    DispatchEvent ret(dispatch_q_.front());
+    dispatch_q_.pop_front();
+    return ret;
+}
+
+
+void gcomm::AsioProtonet::end_dispatch()
+{
+    gu::Lock lock(io_mutex_);
+
+    if (dispatch_q_.empty() == false)
+    {
+        io_service_.post(boost::bind(&AsioProtonet::handle_dispatch, this));
+    }
+    else
+    {
+        dispatch_posted_ = false;
+    }
+}
+
+
+void gcomm::AsioProtonet::handle_dispatch()
+{
+    Critical<AsioProtonet> crit(*this);
+
+    // Events queued while dispatching are left for the next round,
+    // so that timers get their turn under steady load.
+    size_t n;
+    {
+        gu::Lock lock(io_mutex_);
+        n = dispatch_q_.size();
+    }
+
+    try
+    {
+        for (; n > 0; --n)
+        {
+            const DispatchEvent ev(pop_dispatch());
+
+            // socket may have been closed after the event was queued
+            if (ev.socket_->state() != Socket::S_CLOSED)
+            {
+                dispatch(ev.socket_->id(), ev.dg_, ev.um_);
+            }
+        }
+    }
+    catch (...)
+    {
+        end_dispatch();
+        throw;
+    }
+
+    end_dispatch();
+}
+
+
 void gcomm::AsioProtonet::interrupt()
 {
     io_service_.stop();
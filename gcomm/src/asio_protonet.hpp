@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  */
 
 #ifndef GCOMM_ASIO_PROTONET_HPP
@@ -9,6 +9,8 @@
 #include "socket.hpp"
 
 #include "gu_monitor.hpp"
+#include "gu_lock.hpp"
+#include "gu_threads.h"
 #include "gu_asio.hpp"
 
 #include <vector>
@@ -48,6 +50,34 @@ private:
 
     void handle_wait(const asio::error_code& ec);
 
+    // Returns io_service for a new TCP socket: one of I/O thread services
+    // in turn or io_service_ if there are no I/O threads.
+    asio::io_service& socket_io_service();
+
+    // Queues socket event to be dispatched in event loop thread. Used by
+    // sockets serviced by I/O threads.
+    void post_dispatch(const SocketPtr&, const Datagram&, const ProtoUpMeta&);
+    void handle_dispatch();
+    // Reposts handle_dispatch() if more events were queued meanwhile
+    void end_dispatch();
+    void start_io_threads(size_t n);
+    void stop_io_threads();
+    static void* io_thread_func(void* arg);
+
+    struct DispatchEvent
+    {
+        DispatchEvent(const SocketPtr&   socket,
+                      const Datagram&    dg,
+                      const ProtoUpMeta& um)
+            : socket_(socket), dg_(dg), um_(um) { }
+
+        SocketPtr   socket_;
+        Datagram    dg_;
+        ProtoUpMeta um_;
+    };
+
+    DispatchEvent pop_dispatch();
+
     gu::RecursiveMutex          mutex_;
     gu::datetime::Date          poll_until_;
     asio::io_service            io_service_;
@@ -56,6 +86,16 @@ private:
     size_t                      mtu_;
 
     NetHeader::checksum_t       checksum_;
+
+    // Each I/O thread runs its own io_service, so all handlers of a socket
+    // are executed by the same thread.
+    std::vector<asio::io_service*>        io_services_;
+    std::vector<asio::io_service::work*>  io_work_;
+    std::vector<gu_thread_t>              io_threads_;
+    gu::Mutex                             io_mutex_; // protects below
+    size_t                                io_next_;
+    std::deque<DispatchEvent>             dispatch_q_;
+    bool                                  dispatch_posted_;
 };
 
 #endif // GCOMM_ASIO_PROTONET_HPP
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2012-2019 Codership Oy <info@codership.com>
+ * Copyright (C) 2012-2020 Codership Oy <info@codership.com>
  */
 
 #include "asio_tcp.hpp"
@@ -67,7 +67,7 @@ gcomm::AsioTcpSocket::AsioTcpSocket(AsioProtonet& net, const gu::URI& uri)
     :
     Socket       (uri),
     net_         (net),
-    socket_      (net.io_service_),
+    socket_      (net.socket_io_service()),
     ssl_socket_  (0),
     send_q_      (),
     last_queued_tstamp_(),
@@ -113,7 +113,20 @@ void gcomm::AsioTcpSocket::failed_handler(const asio::error_code& ec,
 
     if (prev_state != S_FAILED && prev_state != S_CLOSED)
     {
-        net_.dispatch(id(), Datagram(), ProtoUpMeta(ec.value()));
+        dispatch(Datagram(), ProtoUpMeta(ec.value()));
+    }
+}
+
+void gcomm::AsioTcpSocket::dispatch(const Datagram& dg, const ProtoUpMeta& um)
+{
+    if (has_io_thread())
+    {
+        net_.post_dispatch(shared_from_this(), dg, um);
+    }
+    else
+    {
+        Critical<AsioProtonet> crit(net_);
+        net_.dispatch(id(), dg, um);
     }
 }
 
@@ -154,7 +167,7 @@ void gcomm::AsioTcpSocket::handshake_handler(const asio::error_code& ec)
              << (compression_name != NULL ? compression_name : "none");
     state_ = S_CONNECTED;
     init_tstamps();
-    net_.dispatch(id(), Datagram(), ProtoUpMeta(ec.value()));
+    dispatch(Datagram(), ProtoUpMeta(ec.value()));
     async_receive();
 }
 
@@ -193,7 +206,7 @@ void gcomm::AsioTcpSocket::connect_handler(const asio::error_code& ec)
                           << local_addr();
                 state_ = S_CONNECTED;
                 init_tstamps();
-                net_.dispatch(id(), Datagram(), ProtoUpMeta(ec.value()));
+                dispatch(Datagram(), ProtoUpMeta(ec.value()));
                 async_receive();
 
             }
@@ -223,7 +236,7 @@ void gcomm::AsioTcpSocket::connect(const gu::URI& uri)
         if (uri.get_scheme() == gu::scheme::ssl)
         {
             ssl_socket_ = new asio::ssl::stream<asio::ip::tcp::socket>(
-                net_.io_service_, net_.ssl_context_
+                socket_.get_io_service(), net_.ssl_context_
             );
 
             ssl_socket_->lowest_layer().open(i->endpoint().protocol());
@@ -273,7 +286,16 @@ void gcomm::AsioTcpSocket::close()
 
     if (send_q_.empty() == true || state() != S_CONNECTED)
     {
-        close_socket();
+        if (has_io_thread())
+        {
+            // socket must not be closed while I/O thread may be using it
+            socket_.get_io_service().post(
+                boost::bind(&AsioTcpSocket::close_socket, shared_from_this()));
+        }
+        else
+        {
+            close_socket();
+        }
         state_ = S_CLOSED;
     }
     else
@@ -469,7 +491,8 @@ int gcomm::AsioTcpSocket::send(int segment, const Datagram& dg)
     send_q_.push_back(segment, priv_dg);
     if (send_q_.size() == 1)
     {
-        net_.io_service_.post(AsioPostForSendHandler(shared_from_this()));
+        socket_.get_io_service().post(
+            AsioPostForSendHandler(shared_from_this()));
     }
     return 0;
 }
@@ -478,28 +501,34 @@ int gcomm::AsioTcpSocket::send(int segment, const Datagram& dg)
 void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                                         const size_t bytes_transferred)
 {
-    Critical<AsioProtonet> crit(net_);
-
-    if (ec)
     {
-        if (ec.category() == asio::error::get_ssl_category() &&
-            gu::exclude_ssl_error(ec) == false)
+        Critical<AsioProtonet> crit(net_);
+
+        if (ec)
         {
-            log_warn << "read_handler(): " << ec.message() << " ("
-                     << gu::extra_error_info(ec) << ")";
+            if (ec.category() == asio::error::get_ssl_category() &&
+                gu::exclude_ssl_error(ec) == false)
+            {
+                log_warn << "read_handler(): " << ec.message() << " ("
+                         << gu::extra_error_info(ec) << ")";
+            }
+            FAILED_HANDLER(ec);
+            return;
         }
-        FAILED_HANDLER(ec);
-        return;
-    }
 
-    if (state() != S_CONNECTED && state() != S_CLOSING)
-    {
-        log_debug << "read handler for " << id()
-                  << " state " << state();
-        return;
+        if (state() != S_CONNECTED && state() != S_CLOSING)
+        {
+            log_debug << "read handler for " << id()
+                      << " state " << state();
+            return;
+        }
     }
 
+    // Receive buffer is accessed only by the thread running read handlers,
+    // so received messages are unserialized and checksummed without
+    // holding protonet lock.
     recv_offset_ += bytes_transferred;
+    bool delivered(false);
 
     while (recv_offset_ >= NetHeader::serial_size_)
     {
@@ -510,6 +539,7 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
         }
         catch (gu::Exception& e)
         {
+            Critical<AsioProtonet> crit(net_);
             FAILED_HANDLER(asio::error_code(e.get_errno(),
                                             asio::error::system_category));
             return;
@@ -537,6 +567,7 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                              << " has_crc32="  << hdr.has_crc32()
                              << " has_crc32c=" << hdr.has_crc32c()
                              << " crc32=" << hdr.crc32();
+                    Critical<AsioProtonet> crit(net_);
                     FAILED_HANDLER(asio::error_code(
                                        EPROTO,
                                        asio::error::system_category));
@@ -544,8 +575,8 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
                 }
             }
             ProtoUpMeta um;
-            last_delivered_tstamp_ = gu::datetime::Date::monotonic();
-            net_.dispatch(id(), dg, um);
+            dispatch(dg, um);
+            delivered = true;
             recv_offset_ -= NetHeader::serial_size_ + hdr.len();
 
             if (recv_offset_ > 0)
@@ -561,6 +592,13 @@ void gcomm::AsioTcpSocket::read_handler(const asio::error_code& ec,
         }
     }
 
+    Critical<AsioProtonet> crit(net_);
+
+    if (delivered)
+    {
+        last_delivered_tstamp_ = gu::datetime::Date::monotonic();
+    }
+
     gu::array<asio::mutable_buffer, 1>::type mbs;
     mbs[0] = asio::mutable_buffer(&recv_buf_[0] + recv_offset_,
                                   recv_buf_.size() - recv_offset_);
@@ -571,9 +609,9 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
     const asio::error_code& ec,
     const size_t bytes_transferred)
 {
-    Critical<AsioProtonet> crit(net_);
     if (ec)
     {
+        Critical<AsioProtonet> crit(net_);
         if (ec.category() == asio::error::get_ssl_category() &&
             gu::exclude_ssl_error(ec) == false)
         {
@@ -584,13 +622,8 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
         return 0;
     }
 
-    if (state() != S_CONNECTED && state() != S_CLOSING)
-    {
-        log_debug << "read completion condition for " << id()
-                  << " state " << state();
-        return 0;
-    }
-
+    // Only receive buffer is looked at here, which does not need protonet
+    // lock. Socket state is checked in read_handler().
     if (recv_offset_ + bytes_transferred >= NetHeader::serial_size_)
     {
         NetHeader hdr;
@@ -601,6 +634,7 @@ size_t gcomm::AsioTcpSocket::read_completion_condition(
         catch (gu::Exception& e)
         {
             log_warn << "unserialize error " << e.what();
+            Critical<AsioProtonet> crit(net_);
             FAILED_HANDLER(asio::error_code(e.get_errno(),
                                             asio::error::system_category));
             return 0;
@@ -871,7 +905,7 @@ void gcomm::AsioTcpAcceptor::accept_handler(
         {
             new_socket->ssl_socket_ =
                 new asio::ssl::stream<asio::ip::tcp::socket>(
-                    net_.io_service_, net_.ssl_context_);
+                    new_socket->socket_.get_io_service(), net_.ssl_context_);
         }
         acceptor_.async_accept(new_socket->socket(),
                                boost::bind(&AsioTcpAcceptor::accept_handler,
@@ -914,7 +948,7 @@ void gcomm::AsioTcpAcceptor::listen(const gu::URI& uri)
         {
             new_socket->ssl_socket_ =
                 new asio::ssl::stream<asio::ip::tcp::socket>(
-                    net_.io_service_, net_.ssl_context_);
+                    new_socket->socket_.get_io_service(), net_.ssl_context_);
         }
         acceptor_.async_accept(new_socket->socket(),
                                boost::bind(&AsioTcpAcceptor::accept_handler,
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010-2019 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  */
 
 #ifndef GCOMM_ASIO_TCP_HPP
@@ -85,6 +85,9 @@ private:
         gu::datetime::Date now(gu::datetime::Date::monotonic());
         last_queued_tstamp_ = last_delivered_tstamp_ = now;
     }
+    // Passes event up, directly or via protonet dispatch queue
+    // if socket is serviced by I/O thread
+    void dispatch(const Datagram& dg, const ProtoUpMeta& um);
     void read_one(gu::array<asio::mutable_buffer, 1>::type& mbs);
     void write_one(const gu::array<asio::const_buffer, 2>::type& cbs);
     void close_socket();
@@ -101,6 +104,12 @@ private:
     basic_socket_t&
     socket() { return (ssl_socket_ ? ssl_socket_->lowest_layer() : socket_); }
 
+    // true if socket handlers are run by protonet I/O thread
+    bool has_io_thread()
+    {
+        return (&socket_.get_io_service() != &net_.io_service_);
+    }
+
     AsioProtonet&                             net_;
     asio::ip::tcp::socket                     socket_;
     asio::ssl::stream<asio::ip::tcp::socket>* ssl_socket_;
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2009-2014 Codership Oy <info@codership.com>
+ * Copyright (C) 2009-2020 Codership Oy <info@codership.com>
  */
 
 #include "gcomm/conf.hpp"
@@ -13,6 +13,7 @@ static std::string const Delim = ".";
 // Protonet
 std::string const gcomm::Conf::ProtonetBackend("protonet.backend");
 std::string const gcomm::Conf::ProtonetVersion("protonet.version");
+std::string const gcomm::Conf::ProtonetIoThreads("protonet.io_threads");
 
 // TCP
 static std::string const SocketPrefix("socket" + Delim);
@@ -127,6 +128,7 @@ gcomm::Conf::register_params(gu::Config& cnf)
 
     GCOMM_CONF_ADD_DEFAULT(ProtonetBackend);
     GCOMM_CONF_ADD_DEFAULT(ProtonetVersion);
+    GCOMM_CONF_ADD_DEFAULT(ProtonetIoThreads);
 
     GCOMM_CONF_ADD        (TcpNonBlocking);
     GCOMM_CONF_ADD_DEFAULT(SocketChecksum);
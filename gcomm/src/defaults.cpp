@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2012-2019 Codership Oy <info@codership.com>
+ * Copyright (C) 2012-2020 Codership Oy <info@codership.com>
  */
 
 #include "defaults.hpp"
@@ -16,6 +16,7 @@ namespace gcomm
 #endif /* HAVE_ASIO_HPP */
 
     std::string const Defaults::ProtonetVersion         = "0";
+    std::string const Defaults::ProtonetIoThreads       = "0";
     std::string const Defaults::SocketChecksum          = "2";
     std::string const Defaults::SocketRecvBufSize       =
         GCOMM_ASIO_AUTO_BUF_SIZE;
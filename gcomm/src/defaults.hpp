@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2009-2019 Codership Oy <info@codership.com>
+ * Copyright (C) 2009-2020 Codership Oy <info@codership.com>
  */
 
 #ifndef GCOMM_DEFAULTS_HPP
@@ -13,6 +13,7 @@ namespace gcomm
     {
         static std::string const ProtonetBackend          ;
         static std::string const ProtonetVersion          ;
+        static std::string const ProtonetIoThreads        ;
         static std::string const SocketChecksum           ;
         static std::string const SocketRecvBufSize        ;
         static std::string const SocketSendBufSize        ;
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2009 Codership Oy <info@codership.com>
+ * Copyright (C) 2009-2020 Codership Oy <info@codership.com>
  */
 
 
@@ -10,6 +10,7 @@
 #include "gu_buffer.hpp"
 #include <stdexcept>
 #include <numeric>
+#include <new>
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -90,6 +91,18 @@ std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMapMsg& m)
 }
 
 
+std::ostream& gcomm::evs::operator<<(std::ostream& os,
+                                     const InputMapMsgIndex& mi)
+{
+    for (InputMapMsgIndex::const_iterator i(mi.begin()); i != mi.end(); ++i)
+    {
+        os << "(" << InputMapMsgIndex::key(i) << ","
+           << InputMapMsgIndex::value(i) << ")";
+    }
+    return (os << " recovery=" << mi.n_recovery());
+}
+
+
 std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMap& im)
 {
     return (os << "evs::input_map: {"
@@ -98,14 +111,357 @@ std::ostream& gcomm::evs::operator<<(std::ostream& os, const InputMap& im)
             << "node_index="     << *im.node_index_
 #ifndef NDEBUG
             << ","
-            << "msg_index="      << *im.msg_index_      << ","
-            << "recovery_index=" << *im.recovery_index_
+            << "msg_index="      << *im.msg_index_
 #endif // !NDEBUG
             << "}");
 }
 
 
 
+//////////////////////////////////////////////////////////////////////////
+//
+// Message index
+//
+//////////////////////////////////////////////////////////////////////////
+
+
+gcomm::evs::InputMapMsgRing::Chunk::Chunk() :
+    msgs_ (static_cast<InputMapMsg*>(
+               ::operator new(CHUNK_SIZE * sizeof(InputMapMsg)))),
+    n_msg_(0)
+{
+    std::fill(msg_, msg_ + CHUNK_WORDS, 0);
+    std::fill(rec_, rec_ + CHUNK_WORDS, 0);
+}
+
+
+gcomm::evs::InputMapMsgRing::Chunk::~Chunk()
+{
+    ::operator delete(msgs_);
+}
+
+
+gcomm::evs::InputMapMsgRing::InputMapMsgRing() :
+    chunks_    (),
+    spare_     (0),
+    base_      (0),
+    begin_     (0),
+    end_       (0),
+    msg_lo_    (0),
+    n_msg_     (0),
+    n_recovery_(0)
+{ }
+
+
+gcomm::evs::InputMapMsgRing::~InputMapMsgRing()
+{
+    clear();
+    delete spare_;
+}
+
+
+gcomm::evs::InputMapMsgRing::Chunk* gcomm::evs::InputMapMsgRing::get_chunk()
+{
+    Chunk* const ret(spare_ ? spare_ : new Chunk());
+    spare_ = 0;
+    return ret;
+}
+
+
+void gcomm::evs::InputMapMsgRing::put_chunk(Chunk* const c)
+{
+    assert(0 == c->n_msg_);
+
+    if (0 == spare_)
+    {
+        spare_ = c;
+    }
+    else
+    {
+        delete c;
+    }
+}
+
+
+void gcomm::evs::InputMapMsgRing::extend(seqno_t const begin,
+                                         seqno_t const end)
+{
+    if (chunks_.empty())
+    {
+        base_ = begin - slot(begin);
+    }
+
+    while (begin < base_)
+    {
+        chunks_.push_front(get_chunk());
+        base_ -= CHUNK_SIZE;
+    }
+
+    while (base_ + seqno_t(chunks_.size()) * CHUNK_SIZE < end)
+    {
+        chunks_.push_back(get_chunk());
+    }
+}
+
+
+void gcomm::evs::InputMapMsgRing::shrink()
+{
+    /* slots outside of [begin_, end_) are always empty */
+    if (begin_ == end_)
+    {
+        while (!chunks_.empty())
+        {
+            put_chunk(chunks_.back());
+            chunks_.pop_back();
+        }
+        return;
+    }
+
+    while (begin_ - base_ >= CHUNK_SIZE)
+    {
+        put_chunk(chunks_.front());
+        chunks_.pop_front();
+        base_ += CHUNK_SIZE;
+    }
+}
+
+
+void gcomm::evs::InputMapMsgRing::insert(seqno_t const seq,
+                                         const InputMapMsg& msg)
+{
+    gcomm_assert(seq >= 0 && state(seq) == S_EMPTY);
+
+    if (begin_ == end_)
+    {
+        assert(chunks_.empty());
+        begin_ = end_ = seq;
+    }
+
+    seqno_t const begin(std::min(begin_, seq));
+    seqno_t const end  (std::max(end_, seq + 1));
+
+    extend(begin, end);
+
+    begin_ = begin;
+    end_   = end;
+
+    Chunk& c(chunk(seq));
+    size_t const i(slot(seq));
+
+    new (&c.msgs_[i]) InputMapMsg(msg);
+    c.msg_[i / 64] |= bit(i);
+    ++c.n_msg_;
+
+    if (0 == n_msg_ || seq < msg_lo_) msg_lo_ = seq;
+    ++n_msg_;
+}
+
+
+void gcomm::evs::InputMapMsgRing::erase(seqno_t const seq)
+{
+    gcomm_assert(state(seq) == S_MSG);
+
+    Chunk& c(chunk(seq));
+    size_t const i(slot(seq));
+
+    c.msg_[i / 64] &= ~bit(i);
+    c.rec_[i / 64] |= bit(i);
+    --c.n_msg_;
+    --n_msg_;
+    ++n_recovery_;
+
+    if (seq == msg_lo_ && n_msg_ > 0)
+    {
+        msg_lo_ = next_msg(seq + 1);
+        assert(msg_lo_ > seq);
+    }
+}
+
+
+gcomm::evs::seqno_t
+gcomm::evs::InputMapMsgRing::next_msg(seqno_t const seq) const
+{
+    if (0 == n_msg_) return -1;
+
+    seqno_t const s(std::max(seq, msg_lo_));
+    if (s >= end_) return -1;
+
+    size_t i(slot(s));
+
+    for (size_t ci((s - base_) / CHUNK_SIZE); ci < chunks_.size(); ++ci, i = 0)
+    {
+        const Chunk& c(*chunks_[ci]);
+        if (0 == c.n_msg_) continue;
+
+        for (size_t w(i / 64); w < CHUNK_WORDS; ++w)
+        {
+            uint64_t const bits(w == i / 64 ?
+                                c.msg_[w] & (~uint64_t(0) << (i % 64)) :
+                                c.msg_[w]);
+            if (bits)
+            {
+                return base_ + seqno_t(ci * CHUNK_SIZE + w * 64 +
+                                       __builtin_ctzll(bits));
+            }
+        }
+    }
+
+    return -1;
+}
+
+
+void gcomm::evs::InputMapMsgRing::cleanup(seqno_t const seq)
+{
+    for (seqno_t s(begin_); s <= seq && s < end_; ++s)
+    {
+        Chunk& c(chunk(s));
+        size_t const i(slot(s));
+
+        if (c.rec_[i / 64] & bit(i))
+        {
+            c.msgs_[i].~InputMapMsg();
+            c.rec_[i / 64] &= ~bit(i);
+            --n_recovery_;
+        }
+    }
+
+    while (begin_ < end_ && state(begin_) == S_EMPTY) ++begin_;
+
+    shrink();
+}
+
+
+void gcomm::evs::InputMapMsgRing::clear()
+{
+    for (seqno_t s(begin_); s < end_; ++s)
+    {
+        if (state(s) != S_EMPTY)
+        {
+            Chunk& c(chunk(s));
+            size_t const i(slot(s));
+
+            c.msgs_[i].~InputMapMsg();
+            c.msg_[i / 64] &= ~bit(i);
+            c.rec_[i / 64] &= ~bit(i);
+        }
+    }
+
+    for (size_t ci(0); ci < chunks_.size(); ++ci) chunks_[ci]->n_msg_ = 0;
+
+    begin_      = end_;
+    n_msg_      = 0;
+    n_recovery_ = 0;
+
+    shrink();
+}
+
+
+gcomm::evs::InputMapMsgIndex::iterator
+gcomm::evs::InputMapMsgIndex::next(size_t const index, seqno_t const seq) const
+{
+    iterator ret(end());
+
+    for (Heads::const_iterator h(heads_.begin()); h != heads_.end(); ++h)
+    {
+        /* rings further on have nothing below the found message */
+        if (ret.seq_ != -1 && h->first > ret.seq_) break;
+
+        size_t const i(h->second);
+
+        /* at the same seqno only nodes with higher index follow */
+        seqno_t const s(rings_[i]->next_msg(i > index ? seq : seq + 1));
+
+        if (s != -1 &&
+            (ret.seq_ == -1 || s < ret.seq_ ||
+             (s == ret.seq_ && i < ret.index_)))
+        {
+            ret = iterator(this, i, s);
+        }
+    }
+
+    return ret;
+}
+
+
+void gcomm::evs::InputMapMsgIndex::update_head(size_t const index,
+                                               seqno_t const old_lo)
+{
+    seqno_t const lo(rings_[index]->msg_lo());
+
+    if (lo == old_lo) return;
+
+    if (old_lo != -1)
+    {
+        Heads::iterator const h(std::lower_bound(heads_.begin(), heads_.end(),
+                                                 std::make_pair(old_lo,index)));
+        assert(h != heads_.end() && h->second == index);
+        heads_.erase(h);
+    }
+
+    if (lo != -1)
+    {
+        std::pair<seqno_t, size_t> const head(lo, index);
+        heads_.insert(std::lower_bound(heads_.begin(), heads_.end(), head),
+                      head);
+    }
+}
+
+
+void gcomm::evs::InputMapMsgIndex::insert(size_t const index,
+                                          seqno_t const seq,
+                                          const InputMapMsg& msg)
+{
+    seqno_t const old_lo(rings_[index]->msg_lo());
+    rings_[index]->insert(seq, msg);
+    update_head(index, old_lo);
+}
+
+
+void gcomm::evs::InputMapMsgIndex::erase(size_t const index,
+                                         seqno_t const seq)
+{
+    seqno_t const old_lo(rings_[index]->msg_lo());
+    rings_[index]->erase(seq);
+    update_head(index, old_lo);
+}
+
+
+void gcomm::evs::InputMapMsgIndex::cleanup(seqno_t const seq)
+{
+    for (size_t i(0); i < rings_.size(); ++i) rings_[i]->cleanup(seq);
+}
+
+
+void gcomm::evs::InputMapMsgIndex::reset(size_t const nodes)
+{
+    for (size_t i(0); i < rings_.size(); ++i) delete rings_[i];
+    rings_.clear();
+    heads_.clear();
+
+    for (size_t i(0); i < nodes; ++i)
+    {
+        rings_.push_back(new InputMapMsgRing());
+    }
+}
+
+
+size_t gcomm::evs::InputMapMsgIndex::n_msg() const
+{
+    size_t ret(0);
+    for (size_t i(0); i < rings_.size(); ++i) ret += rings_[i]->n_msg();
+    return ret;
+}
+
+
+size_t gcomm::evs::InputMapMsgIndex::n_recovery() const
+{
+    size_t ret(0);
+    for (size_t i(0); i < rings_.size(); ++i) ret += rings_[i]->n_recovery();
+    return ret;
+}
+
+
+
 //////////////////////////////////////////////////////////////////////////
 //
 // Constructors/destructors
@@ -117,8 +473,7 @@ gcomm::evs::InputMap::InputMap() :
     safe_seq_       (-1),
     aru_seq_        (-1),
     node_index_     (new InputMapNodeIndex()),
-    msg_index_      (new InputMapMsgIndex()),
-    recovery_index_ (new InputMapMsgIndex())
+    msg_index_      (new InputMapMsgIndex())
 { }
 
 
@@ -127,7 +482,6 @@ gcomm::evs::InputMap::~InputMap()
     clear();
     delete node_index_;
     delete msg_index_;
-    delete recovery_index_;
 }
 
 
@@ -141,9 +495,10 @@ gcomm::evs::InputMap::~InputMap()
 
 void gcomm::evs::InputMap::reset(const size_t nodes)
 {
-    gcomm_assert(msg_index_->empty()                           == true &&
-                 recovery_index_->empty()                      == true);
+    gcomm_assert(msg_index_->n_msg()      == 0 &&
+                 msg_index_->n_recovery() == 0);
     node_index_->clear();
+    msg_index_->reset(nodes);
 
     log_debug << " size " << node_index_->size();
     gu_trace(node_index_->resize(nodes, InputMapNode()));
@@ -211,18 +566,17 @@ void gcomm::evs::InputMap::set_safe_seq(const size_t uuid, const seqno_t seq)
 
 void gcomm::evs::InputMap::clear()
 {
-    if (msg_index_->empty() == false)
+    if (msg_index_->n_msg() > 0)
     {
-        log_warn << "discarding " << msg_index_->size() <<
+        log_warn << "discarding " << msg_index_->n_msg() <<
             " messages from message index";
     }
-    msg_index_->clear();
-    if (recovery_index_->empty() == false)
+    if (msg_index_->n_recovery() > 0)
     {
-        log_debug << "discarding " << recovery_index_->size()
+        log_debug << "discarding " << msg_index_->n_recovery()
                   << " messages from recovery index";
     }
-    recovery_index_->clear();
+    msg_index_->reset(0);
     node_index_->clear();
     aru_seq_ = -1;
     safe_seq_ = -1;
@@ -244,10 +598,11 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // messages.
     gcomm_assert(aru_seq_ < msg.seq())
         << "aru seq " << aru_seq_ << " msg seq " << msg.seq()
-        << " index size " << msg_index_->size();
+        << " index size " << msg_index_->n_msg();
 
     gcomm_assert(uuid < node_index_->size());
     InputMapNode& node((*node_index_)[uuid]);
+    const InputMapMsgRing& ring(msg_index_->ring(node.index()));
     range = node.range();
 
     // User should check LU before inserting. This check is left
@@ -260,8 +615,7 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // Check whether this message has already been seen
     if (msg.seq() < node.range().lu() ||
         (msg.seq() <= node.range().hs() &&
-         recovery_index_->find(InputMapMsgKey(node.index(), msg.seq())) !=
-         recovery_index_->end()))
+         ring.state(msg.seq()) == InputMapMsgRing::S_RECOVERY))
     {
         return node.range();
     }
@@ -270,35 +624,22 @@ gcomm::evs::InputMap::insert(const size_t uuid,
     // already found
     for (seqno_t s = msg.seq(); s <= msg.seq() + msg.seq_range(); ++s)
     {
-        InputMapMsgIndex::iterator msg_i;
-
-        if (range.hs() < s)
-        {
-            msg_i = msg_index_->end();
-        }
-        else
+        if (ring.state(s) == InputMapMsgRing::S_EMPTY)
         {
-            msg_i = msg_index_->find(InputMapMsgKey(node.index(), s));
-        }
-
-        if (msg_i == msg_index_->end())
-        {
-            Datagram ins_dg(s == msg.seq() ?
-                                Datagram(rb)   :
-                                Datagram());
-            gu_trace((void)msg_index_->insert_unique(
-                         std::make_pair(
-                             InputMapMsgKey(node.index(), s),
-                             InputMapMsg(
-                                 (s == msg.seq() ?
-                                  msg :
-                                  UserMessage(msg.version(),
-                                              msg.source(),
-                                              msg.source_view_id(),
-                                              s,
-                                              msg.aru_seq(),
-                                              0,
-                                              O_DROP)), ins_dg))));
+            gu_trace(msg_index_->insert(
+                         node.index(),
+                         s,
+                         InputMapMsg(
+                             (s == msg.seq() ?
+                              msg :
+                              UserMessage(msg.version(),
+                                          msg.source(),
+                                          msg.source_view_id(),
+                                          s,
+                                          msg.aru_seq(),
+                                          0,
+                                          O_DROP)),
+                             (s == msg.seq() ? rb : Datagram()))));
         }
 
         // Update highest seen
@@ -315,12 +656,8 @@ gcomm::evs::InputMap::insert(const size_t uuid,
             {
                 ++i;
             }
-            while (
-                i <= range.hs() &&
-                (msg_index_->find(InputMapMsgKey(node.index(), i))
-                 != msg_index_->end() ||
-                 recovery_index_->find(InputMapMsgKey(node.index(), i))
-                 != recovery_index_->end()));
+            while (i <= range.hs() &&
+                   ring.state(i) != InputMapMsgRing::S_EMPTY);
             range.set_lu(i);
         }
     }
@@ -333,30 +670,34 @@ gcomm::evs::InputMap::insert(const size_t uuid,
 
 void gcomm::evs::InputMap::erase(iterator i)
 {
-    gu_trace(recovery_index_->insert_unique(*i));
-    gu_trace(msg_index_->erase(i));
+    const InputMapMsgKey key(InputMapMsgIndex::key(i));
+    gu_trace(msg_index_->erase(key.index(), key.seq()));
 }
 
 
 gcomm::evs::InputMap::iterator
 gcomm::evs::InputMap::find(const size_t uuid, const seqno_t seq) const
 {
-    iterator ret;
     const InputMapNode& node(node_index_->at(uuid));
-    const InputMapMsgKey key(node.index(), seq);
-    gu_trace(ret = msg_index_->find(key));
-    return ret;
+    if (msg_index_->ring(node.index()).state(seq) == InputMapMsgRing::S_MSG)
+    {
+        return msg_index_->make_iterator(node.index(), seq);
+    }
+    return msg_index_->end();
 }
 
 
 gcomm::evs::InputMap::iterator
 gcomm::evs::InputMap::recover(const size_t uuid, const seqno_t seq) const
 {
-    iterator ret;
     const InputMapNode& node(node_index_->at(uuid));
-    const InputMapMsgKey key(node.index(), seq);
-    gu_trace(ret = recovery_index_->find_checked(key));
-    return ret;
+    if (msg_index_->ring(node.index()).state(seq) !=
+        InputMapMsgRing::S_RECOVERY)
+    {
+        gu_throw_fatal << "element " << InputMapMsgKey(node.index(), seq)
+                       << " not found";
+    }
+    return msg_index_->make_iterator(node.index(), seq);
 }
 
 static void append_gap_range_list(std::vector<gcomm::evs::Range>& range_list,
@@ -383,16 +724,10 @@ gcomm::evs::InputMap::gap_range_list(size_t index, const Range& range) const
     const InputMapNode& node(node_index_->at(index));
     seqno_t max_lu(std::max(range.lu(), node.range().lu()));
     std::vector<Range> ret;
+    const InputMapMsgRing& ring(msg_index_->ring(node.index()));
     for (seqno_t seq(range.lu()); seq <= range.hs(); ++seq)
     {
-        const InputMapMsgKey key(index, seq);
-        gcomm::evs::InputMap::const_iterator msg_i(msg_index_->find(key));
-        if (msg_i != msg_index_->end())
-        {
-            continue;
-        }
-        msg_i = recovery_index_->find(key);
-        if (msg_i != recovery_index_->end())
+        if (ring.state(seq) != InputMapMsgRing::S_EMPTY)
         {
             continue;
         }
@@ -425,7 +760,5 @@ inline void gcomm::evs::InputMap::update_aru()
 void gcomm::evs::InputMap::cleanup_recovery_index()
 {
     gcomm_assert(node_index_->size() > 0);
-    InputMapMsgIndex::iterator i = recovery_index_->lower_bound(
-        InputMapMsgKey(0, safe_seq_ + 1));
-    recovery_index_->erase(recovery_index_->begin(), i);
+    msg_index_->cleanup(safe_seq_);
 }
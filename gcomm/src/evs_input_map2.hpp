@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2009 Codership Oy <info@codership.com>
+ * Copyright (C) 2009-2020 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -20,10 +20,12 @@
 #define EVS_INPUT_MAP2_HPP
 
 #include "evs_message2.hpp"
-#include "gcomm/map.hpp"
 #include "gcomm/datagram.hpp"
 
 #include <vector>
+#include <deque>
+#include <algorithm>
+#include <cassert>
 
 
 namespace gcomm
@@ -35,7 +37,9 @@ namespace gcomm
     {
         class InputMapMsg;
         std::ostream& operator<<(std::ostream&, const InputMapMsg&);
+        class InputMapMsgRing;
         class InputMapMsgIndex;
+        std::ostream& operator<<(std::ostream&, const InputMapMsgIndex&);
         class InputMapNode;
         std::ostream& operator<<(std::ostream&, const InputMapNode&);
         typedef std::vector<InputMapNode> InputMapNodeIndex;
@@ -92,31 +96,230 @@ private:
 };
 
 
-#if defined(GALERA_USE_BOOST_POOL_ALLOC)
+/*!
+ * Messages of a single source node indexed by seqno.
+ *
+ * Seqnos of a source are dense, so messages are kept in fixed size chunks
+ * of slots which cover seqnos from the lowest one still kept to the highest
+ * one seen. A chunk is never moved once allocated, so a reference to a stored
+ * message stays valid until the message is dropped by cleanup() or clear(),
+ * even if more messages are inserted meanwhile. Every slot is either empty,
+ * holds a message waiting for delivery or a delivered message kept for
+ * recovery, slot states are kept in per chunk bitmaps.
+ */
+class gcomm::evs::InputMapMsgRing
+{
+public:
+
+    enum State
+    {
+        S_EMPTY,
+        S_MSG,      /*!< not delivered yet           */
+        S_RECOVERY  /*!< delivered, kept for recovery */
+    };
+
+    InputMapMsgRing();
+    ~InputMapMsgRing();
+
+    State state(const seqno_t seq) const
+    {
+        if (seq < begin_ || seq >= end_) return S_EMPTY;
+
+        const Chunk&   c(chunk(seq));
+        size_t   const i(slot(seq));
+        uint64_t const b(bit(i));
+
+        if (c.msg_[i / 64] & b) return S_MSG;
+        if (c.rec_[i / 64] & b) return S_RECOVERY;
+        return S_EMPTY;
+    }
+
+    const InputMapMsg& value(const seqno_t seq) const
+    {
+        assert(state(seq) != S_EMPTY);
+        return chunk(seq).msgs_[slot(seq)];
+    }
+
+    /*! Stores message with seqno seq, slot must be empty */
+    void insert(const seqno_t seq, const InputMapMsg& msg);
+
+    /*! Moves message with seqno seq to recovery */
+    void erase(const seqno_t seq);
+
+    /*! Drops recovery messages with seqnos up to seq */
+    void cleanup(const seqno_t seq);
+
+    void clear();
+
+    /*! @return lowest seqno of message waiting for delivery which is not
+     *          below seq, -1 if there is none */
+    seqno_t next_msg(const seqno_t seq) const;
+
+    /*! @return lowest seqno of message waiting for delivery, -1 if none */
+    seqno_t msg_lo() const { return (n_msg_ > 0 ? msg_lo_ : -1); }
+
+    size_t n_msg()      const { return n_msg_;      }
+    size_t n_recovery() const { return n_recovery_; }
+
+private:
+
+    InputMapMsgRing(const InputMapMsgRing&);
+    void operator=(const InputMapMsgRing&);
+
+    enum
+    {
+        CHUNK_SIZE  = 256, /*!< Slots per chunk, power of 2 */
+        CHUNK_WORDS = CHUNK_SIZE / 64
+    };
+
+    class Chunk
+    {
+    public:
+        Chunk();
+        ~Chunk();
+
+        InputMapMsg* const msgs_;              /*!< Slots (raw storage)  */
+        uint64_t           msg_[CHUNK_WORDS];  /*!< S_MSG slots          */
+        uint64_t           rec_[CHUNK_WORDS];  /*!< S_RECOVERY slots     */
+        size_t             n_msg_;             /*!< Number of S_MSG slots */
+    private:
+        Chunk(const Chunk&);
+        void operator=(const Chunk&);
+    };
+
+    Chunk& chunk(const seqno_t seq) const
+    {
+        return *chunks_[(seq - base_) / CHUNK_SIZE];
+    }
 
-#include <boost/pool/pool_alloc.hpp>
+    static size_t   slot(const seqno_t seq) { return seq & (CHUNK_SIZE - 1); }
+    static uint64_t bit (const size_t i)    { return uint64_t(1) << (i % 64); }
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg,
-               std::map<InputMapMsgKey,
-                        InputMapMsg,
-                        std::less<InputMapMsgKey>,
-                        boost::fast_pool_allocator<
-                            std::pair<const InputMapMsgKey, InputMapMsg>,
-                            boost::default_user_allocator_new_delete,
-                            boost::details::pool::null_mutex
-                            >
-                        >
-               >
-{};
+    /*! Adds chunks to cover seqnos [begin, end) */
+    void extend(seqno_t begin, seqno_t end);
 
-#else /* GALERA_USE_BOOST_POOL_ALLOC */
+    /*! Drops chunks below begin_ */
+    void shrink();
 
-class gcomm::evs::InputMapMsgIndex :
-    public Map<InputMapMsgKey, InputMapMsg>
-{};
+    Chunk* get_chunk();
+    void   put_chunk(Chunk* c);
 
-#endif /* GALERA_USE_BOOST_POOL_ALLOC */
+    std::deque<Chunk*> chunks_;
+    Chunk*             spare_;      /*!< Released chunk kept for reuse    */
+    seqno_t            base_;       /*!< Seqno of the first slot          */
+    seqno_t            begin_;      /*!< Lowest seqno which may be stored */
+    seqno_t            end_;        /*!< Past highest seqno stored        */
+    seqno_t            msg_lo_;     /*!< Lowest seqno in S_MSG state      */
+    size_t             n_msg_;      /*!< Number of slots in S_MSG         */
+    size_t             n_recovery_; /*!< Number of slots in S_RECOVERY    */
+};
+
+
+/*!
+ * Index of messages of all source nodes. Iteration goes in the order of
+ * (seqno, node index) over messages waiting for delivery, it merges
+ * per node rings on the fly. Rings which have messages waiting for delivery
+ * are kept ordered by their lowest such seqno, so that the merge looks only
+ * at the rings which may have the next message.
+ */
+class gcomm::evs::InputMapMsgIndex
+{
+public:
+
+    class iterator
+    {
+    public:
+        iterator() : index_(0), seq_(-1), mi_(0) { }
+
+        iterator& operator++()
+        {
+            *this = mi_->next(index_, seq_);
+            return *this;
+        }
+
+        bool operator==(const iterator& cmp) const
+        {
+            return (seq_ == cmp.seq_ && (seq_ == -1 || index_ == cmp.index_));
+        }
+
+        bool operator!=(const iterator& cmp) const
+        {
+            return !(*this == cmp);
+        }
+
+    private:
+        friend class InputMapMsgIndex;
+
+        iterator(const InputMapMsgIndex* mi, size_t index, seqno_t seq)
+            :
+            index_(index),
+            seq_  (seq),
+            mi_   (mi)
+        { }
+
+        size_t                  index_;
+        seqno_t                 seq_;   /*!< -1 for end() */
+        const InputMapMsgIndex* mi_;
+    };
+
+    typedef iterator const_iterator;
+
+    InputMapMsgIndex() : rings_(), heads_() { }
+    ~InputMapMsgIndex() { reset(0); }
+
+    static InputMapMsgKey key(const iterator& i)
+    {
+        return InputMapMsgKey(i.index_, i.seq_);
+    }
+
+    static const InputMapMsg& value(const iterator& i)
+    {
+        return i.mi_->rings_[i.index_]->value(i.seq_);
+    }
+
+    iterator begin() const { return next(0, -1); }
+    iterator end()   const { return iterator(this, 0, -1); }
+
+    const InputMapMsgRing& ring(size_t index) const { return *rings_[index]; }
+
+    iterator make_iterator(size_t index, seqno_t seq) const
+    {
+        return iterator(this, index, seq);
+    }
+
+    /*! Stores message from node index with seqno seq */
+    void insert(size_t index, seqno_t seq, const InputMapMsg& msg);
+
+    /*! Moves message from node index with seqno seq to recovery */
+    void erase(size_t index, seqno_t seq);
+
+    /*! Drops recovery messages with seqnos up to seq */
+    void cleanup(seqno_t seq);
+
+    /*! Sets number of nodes, drops all messages */
+    void reset(size_t nodes);
+
+    size_t n_msg()      const;
+    size_t n_recovery() const;
+
+private:
+
+    friend class iterator;
+
+    InputMapMsgIndex(const InputMapMsgIndex&);
+    void operator=(const InputMapMsgIndex&);
+
+    /* (lowest seqno waiting for delivery, node index) */
+    typedef std::vector<std::pair<seqno_t, size_t> > Heads;
+
+    /*! @return iterator to the first message after (seq, index) */
+    iterator next(size_t index, seqno_t seq) const;
+
+    void update_head(size_t index, seqno_t old_lo);
+
+    std::vector<InputMapMsgRing*> rings_;
+    Heads                         heads_;
+};
 
 /* Internal node representation */
 class gcomm::evs::InputMapNode
@@ -361,8 +564,9 @@ private:
     seqno_t            safe_seq_;       /*!< Safe seqno               */
     seqno_t            aru_seq_;        /*!< All received up to seqno */
     InputMapNodeIndex* node_index_;     /*!< Index of nodes           */
-    InputMapMsgIndex*  msg_index_;      /*!< Index of messages        */
-    InputMapMsgIndex*  recovery_index_; /*!< Recovery index           */
+    InputMapMsgIndex*  msg_index_;      /*!< Index of messages, also
+                                             keeps delivered messages
+                                             for recovery          */
 };
 
 #endif // EVS_INPUT_MAP2_HPP
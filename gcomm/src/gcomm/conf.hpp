@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2009-2014 Codership Oy <info@codership.com>
+ * Copyright (C) 2009-2020 Codership Oy <info@codership.com>
  */
 
 /*!
@@ -47,6 +47,16 @@ namespace gcomm
         static std::string const ProtonetBackend;
         static std::string const ProtonetVersion;
 
+        /*!
+         * @brief Number of threads for socket I/O ("protonet.io_threads")
+         *
+         * Socket reads, message checksum verification and writes are
+         * done by this many threads, protocol processing stays in the
+         * thread running the event loop. 0 - do all in the event loop
+         * thread.
+         */
+        static std::string const ProtonetIoThreads;
+
         /*!
          * @brief TCP non-blocking flag ("socket.non_blocking")
          *
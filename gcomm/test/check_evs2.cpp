@@ -455,6 +455,92 @@ START_TEST(test_input_map_gap_range_list)
 }
 END_TEST
 
+START_TEST(test_input_map_erase_iterate)
+{
+    log_info << "START";
+    InputMap im;
+    UUID uuid1(1), uuid2(2);
+    ViewId view(V_REG, uuid1, 1);
+
+    im.reset(2);
+
+    // node 0 runs ahead of node 1
+    for (seqno_t s = 0; s < 100; ++s)
+    {
+        im.insert(0, UserMessage(0, uuid1, view, s));
+        if (s < 50) im.insert(1, UserMessage(0, uuid2, view, s));
+    }
+
+    // iteration goes in (seqno, node index) order and is not disturbed by
+    // erasing the current message, like in transitional delivery
+    size_t n(0);
+    seqno_t prev_seq(-1);
+    size_t  prev_index(1);
+    InputMap::iterator i, i_next;
+    for (i = im.begin(); i != im.end(); i = i_next)
+    {
+        i_next = i;
+        ++i_next;
+        const InputMapMsgKey key(InputMapMsgIndex::key(i));
+        ck_assert(key.seq() > prev_seq ||
+                  (key.seq() == prev_seq && key.index() > prev_index));
+        ck_assert(InputMapMsgIndex::value(i).msg().seq() == key.seq());
+        ck_assert(InputMapMsgIndex::value(i).msg().source() ==
+                  (key.index() == 0 ? uuid1 : uuid2));
+        if (n % 2 == 0) im.erase(i);
+        prev_seq   = key.seq();
+        prev_index = key.index();
+        ++n;
+    }
+    ck_assert(n == 150);
+
+    // erased messages can be recovered, others are still in the map
+    n = 0;
+    for (seqno_t s = 0; s < 100; ++s)
+    {
+        for (size_t idx = 0; idx < (s < 50 ? 2U : 1U); ++idx, ++n)
+        {
+            if (n % 2 == 0)
+            {
+                ck_assert(im.find(idx, s) == im.end());
+                (void)im.recover(idx, s);
+            }
+            else
+            {
+                ck_assert(im.find(idx, s) != im.end());
+            }
+        }
+    }
+
+    // safe messages are dropped from recovery
+    im.set_safe_seq(0, 49);
+    im.set_safe_seq(1, 49);
+    ck_assert(im.safe_seq() == 49);
+    try
+    {
+        im.recover(0, 10);
+        ck_abort_msg("Exception not thrown, "
+                     "setting safe seq should purge index");
+    }
+    catch (...) { }
+    (void)im.recover(0, 50);
+    ck_assert(im.find(1, 10) != im.end());
+    ck_assert(InputMapMsgIndex::key(im.begin()).index() == 1);
+    ck_assert(InputMapMsgIndex::key(im.begin()).seq() == 0);
+
+    // messages stay in place while more messages from the same source are
+    // inserted, like when delivery re-enters sending of own message
+    const InputMapMsg& head(InputMapMsgIndex::value(im.begin()));
+    for (seqno_t s = 50; s < 1100; ++s)
+    {
+        im.insert(1, UserMessage(0, uuid2, view, s));
+    }
+    ck_assert(&head == &InputMapMsgIndex::value(im.begin()));
+    ck_assert(head.msg().seq() == 0);
+    ck_assert(head.msg().source() == uuid2);
+}
+END_TEST
+
 static Datagram* get_msg(DummyTransport* tp, Message* msg, bool release = true)
 {
     Datagram* rb = tp->out();
@@ -2550,6 +2636,10 @@ Suite* evs2_suite()
     tcase_add_test(tc, test_input_map_gap_range_list);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_input_map_erase_iterate");
+    tcase_add_test(tc, test_input_map_erase_iterate);
+    suite_add_tcase(s, tc);
+
     tc = tcase_create("test_proto_single_join");
     tcase_add_test(tc, test_proto_single_join);
     suite_add_tcase(s, tc);
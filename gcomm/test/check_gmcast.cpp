@@ -43,7 +43,7 @@ START_TEST(test_gmcast_multicast)
 END_TEST
 
 
-START_TEST(test_gmcast_w_user_messages)
+static void gmcast_w_user_messages(int const io_threads)
 {
     class User : public Toplay
     {
@@ -156,6 +156,7 @@ START_TEST(test_gmcast_w_user_messages)
     gu::Config conf;
     gu::ssl_register_params(conf);
     gcomm::Conf::register_params(conf);
+    conf.set(gcomm::Conf::ProtonetIoThreads, io_threads);
     mark_point();
     auto_ptr<Protonet> pnet(Protonet::create(conf));
     mark_point();
@@ -249,6 +250,17 @@ START_TEST(test_gmcast_w_user_messages)
     pnet->event_loop(0);
 
 }
+
+START_TEST(test_gmcast_w_user_messages)
+{
+    gmcast_w_user_messages(0);
+}
+END_TEST
+
+START_TEST(test_gmcast_w_user_messages_io_threads)
+{
+    gmcast_w_user_messages(2);
+}
 END_TEST
 
 
@@ -496,6 +508,11 @@ Suite* gmcast_suite()
     tcase_set_timeout(tc, 30);
     suite_add_tcase(s, tc);
 
+    tc = tcase_create("test_gmcast_w_user_messages_io_threads");
+    tcase_add_test(tc, test_gmcast_w_user_messages_io_threads);
+    tcase_set_timeout(tc, 30);
+    suite_add_tcase(s, tc);
+
     // not run by default, hard coded port
     tc = tcase_create("test_gmcast_auto_addr");
     tcase_add_test(tc, test_gmcast_auto_addr);
@@ -26,6 +26,8 @@
 #include "gcs_sm.hpp"
 #include "gcs_gcache.hpp"
 
+#include <gu_utils.hpp> // gu::to_string()
+
 const char* gcs_node_state_to_str (gcs_node_state_t state)
 {
     static const char* str[GCS_NODE_STATE_MAX + 1] =
@@ -170,6 +172,7 @@ struct gcs_conn
     long         stats_fc_stop_sent;  // FC stats counters
     long         stats_fc_cont_sent;  //
     long         stats_fc_received;   //
+    long long    stats_send_batched;  // actions sent by other threads
     gcs_fc_t     stfc; // state transfer FC object
 
     /* #603, #606 join control */
@@ -210,10 +213,12 @@ struct gcs_repl_act
     struct gcs_action*   action;
     gu_mutex_t           wait_mutex;
     gu_cond_t            wait_cond;
+    long                 send_ret; // set if sent by another thread and failed
     gcs_repl_act(const struct gu_buf* a_act_in, struct gcs_action* a_action)
       :
         act_in(a_act_in),
-        action(a_action)
+        action(a_action),
+        send_ret(0)
     { }
 };
 
@@ -292,6 +297,8 @@ gcs_create (gu_config_t* const conf, gcache_t* const gcache,
         goto core_create_failed;
     }
 
+    gcs_core_set_adaptive_frag (conn->core, conn->params.adaptive_frags);
+
     conn->repl_q = gcs_fifo_lite_create (GCS_MAX_REPL_THREADS,
                                          sizeof (struct gcs_repl_act*));
     if (!conn->repl_q) {
@@ -1269,6 +1276,9 @@ static void *gcs_recv_thread (void *arg)
     gcs_sm_leave(conn->sm);
     gu_cond_destroy (&tmp_cond);
 
+    /* this thread writes all incoming actions to cache */
+    gcs_gcache_numa_bind (conn->gcache);
+
     while (conn->state < GCS_CONN_CLOSED)
     {
         gcs_seqno_t this_act_id = GCS_SEQNO_ILL;
@@ -1626,6 +1636,81 @@ fc_active(gcs_conn_t* conn)
     return conn->stop_count > 0;
 }
 
+/* Sends replicated action and puts it to repl_q to wait for delivery.
+ * Must be called from within send monitor.
+ * @return action size or negative error code */
+static long
+_gcs_repl_send (gcs_conn_t* const conn, struct gcs_repl_act* const repl_act)
+{
+    const struct gcs_action* const act(repl_act->action);
+    struct gcs_repl_act**          act_ptr;
+    long                           ret;
+
+    // some hack here to achieve one if() instead of two:
+    // ret = -EAGAIN part is a workaround for #569
+    // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
+    // ret will be -ENOTCONN
+    if ((ret = -EAGAIN,
+         !fc_active(conn) || act->type != GCS_ACT_TORDERED) &&
+        (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state)     &&
+        (act_ptr = (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q)))
+    {
+        *act_ptr = repl_act;
+        gcs_fifo_lite_push_tail (conn->repl_q);
+
+        // Keep on trying until something else comes out
+        while ((ret = gcs_core_send (conn->core, repl_act->act_in, act->size,
+                                     act->type)) == -ERESTART) {}
+
+        if (ret < 0) {
+            /* remove item from the queue, it will never be delivered */
+            gu_warn ("Send action {%p, %zd, %s} returned %d (%s)",
+                     act->buf, act->size,gcs_act_type_to_str(act->type),
+                     ret, strerror(-ret));
+
+            if (!gcs_fifo_lite_remove (conn->repl_q)) {
+                gu_fatal ("Failed to remove unsent item from repl_q");
+                assert(0);
+                ret = -ENOTRECOVERABLE;
+            }
+        }
+        else {
+            assert (ret == (ssize_t)act->size);
+        }
+    }
+
+    return ret;
+}
+
+/* Sends actions of the threads waiting in send monitor on their behalf,
+ * up to gcs.send_batch of them, so that the monitor does not have to be
+ * passed from thread to thread for every action and the actions can be
+ * packed together by the group communication backend. */
+static void
+_gcs_repl_send_batch (gcs_conn_t* const conn)
+{
+    for (long i(0); i < conn->params.send_batch; ++i)
+    {
+        struct gcs_repl_act* const repl_act
+            (static_cast<struct gcs_repl_act*>(gcs_sm_take_next (conn->sm)));
+
+        if (NULL == repl_act) break;
+
+        long const ret(_gcs_repl_send (conn, repl_act));
+
+        if (ret < 0) {
+            /* action won't be delivered, wake up the waiter ourselves */
+            gu_mutex_lock   (&repl_act->wait_mutex);
+            repl_act->send_ret = ret;
+            gu_cond_signal  (&repl_act->wait_cond);
+            gu_mutex_unlock (&repl_act->wait_mutex);
+            break;
+        }
+
+        conn->stats_send_batched++;
+    }
+}
+
 /* Puts action in the send queue and returns after it is replicated */
 long gcs_replv (gcs_conn_t*          const conn,      //!<in
                 const struct gu_buf* const act_in,    //!<in
@@ -1652,99 +1737,81 @@ long gcs_replv (gcs_conn_t*          const conn,      //!<in
      * we need to lock a mutex before we can go wait for signal */
     if (!(ret = gu_mutex_lock (&repl_act.wait_mutex)))
     {
+        void* const ctx(conn->params.send_batch > 0 ? &repl_act : NULL);
+
+//#ifndef NDEBUG
+        const void* const orig_buf = act->buf;
+//#endif
+
         // Lock here does the following:
         // 1. serializes gcs_core_send() access between gcs_repl() and
         //    gcs_send()
         // 2. avoids race with gcs_close() and gcs_destroy()
-        if (!(ret = gcs_sm_enter (conn->sm, &repl_act.wait_cond, scheduled, true)))
+        if (!(ret = gcs_sm_enter (conn->sm, &repl_act.wait_cond, scheduled,
+                                  true, ctx)))
         {
-            struct gcs_repl_act** act_ptr;
+            ret = _gcs_repl_send (conn, &repl_act);
 
-//#ifndef NDEBUG
-            const void* const orig_buf = act->buf;
-//#endif
-
-            // some hack here to achieve one if() instead of two:
-            // ret = -EAGAIN part is a workaround for #569
-            // if (conn->state >= GCS_CONN_CLOSE) or (act_ptr == NULL)
-            // ret will be -ENOTCONN
-            if ((ret = -EAGAIN,
-                 !fc_active(conn) || act->type != GCS_ACT_TORDERED) &&
-                (ret = -ENOTCONN, GCS_CONN_OPEN >= conn->state)     &&
-                (act_ptr = (struct gcs_repl_act**)gcs_fifo_lite_get_tail (conn->repl_q)))
-            {
-                *act_ptr = &repl_act;
-                gcs_fifo_lite_push_tail (conn->repl_q);
-
-                // Keep on trying until something else comes out
-                while ((ret = gcs_core_send (conn->core, act_in, act->size,
-                                             act->type)) == -ERESTART) {}
-
-                if (ret < 0) {
-                    /* remove item from the queue, it will never be delivered */
-                    gu_warn ("Send action {%p, %zd, %s} returned %d (%s)",
-                             act->buf, act->size,gcs_act_type_to_str(act->type),
-                             ret, strerror(-ret));
-
-                    if (!gcs_fifo_lite_remove (conn->repl_q)) {
-                        gu_fatal ("Failed to remove unsent item from repl_q");
-                        assert(0);
-                        ret = -ENOTRECOVERABLE;
-                    }
-                }
-                else {
-                    assert (ret == (ssize_t)act->size);
-                }
-            }
+            if (ret >= 0) _gcs_repl_send_batch (conn);
 
             gcs_sm_leave (conn->sm);
 
             assert(ret);
+        }
+        else if (-EALREADY == ret) {
+            /* action was sent by the thread in the monitor, see
+             * _gcs_repl_send_batch() */
+            ret = act->size;
+        }
+
+        /* now we can go waiting for action delivery */
+        if (ret >= 0) {
+            gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
 
-            /* now we can go waiting for action delivery */
-            if (ret >= 0) {
-                gu_cond_wait (&repl_act.wait_cond, &repl_act.wait_mutex);
+            if (repl_act.send_ret < 0)
+            {
+                /* sending by another thread failed */
+                ret = repl_act.send_ret;
+                goto out;
+            }
 #ifndef GCS_FOR_GARB
-                /* assert (act->buf != 0); */
-                if (act->buf == 0)
-                {
-                    /* Recv thread purged repl_q before action was delivered */
-                    ret = -ENOTCONN;
-                    goto out;
-                }
+            /* assert (act->buf != 0); */
+            if (act->buf == 0)
+            {
+                /* Recv thread purged repl_q before action was delivered */
+                ret = -ENOTCONN;
+                goto out;
+            }
 #else
-                assert (act->buf == 0);
+            assert (act->buf == 0);
 #endif /* GCS_FOR_GARB */
 
-                if (act->seqno_g < 0) {
-                    assert (GCS_SEQNO_ILL    == act->seqno_l ||
-                            GCS_ACT_TORDERED != act->type);
-
-                    if (act->seqno_g == GCS_SEQNO_ILL) {
-                        /* action was not replicated for some reason */
-                        assert (orig_buf == act->buf);
-                        ret = -EINTR;
-                    }
-                    else {
-                        /* core provided an error code in global seqno */
-                        assert (orig_buf != act->buf);
-                        ret = act->seqno_g;
-                        act->seqno_g = GCS_SEQNO_ILL;
-                    }
-
-                    if (orig_buf != act->buf) // action was allocated in gcache
-                    {
-                        gu_debug("Freeing gcache buffer %p after receiving %d",
-                                 act->buf, ret);
-                        gcs_gcache_free (conn->gcache, act->buf);
-                        act->buf = orig_buf;
-                    }
+            if (act->seqno_g < 0) {
+                assert (GCS_SEQNO_ILL    == act->seqno_l ||
+                        GCS_ACT_TORDERED != act->type);
+
+                if (act->seqno_g == GCS_SEQNO_ILL) {
+                    /* action was not replicated for some reason */
+                    assert (orig_buf == act->buf);
+                    ret = -EINTR;
+                }
+                else {
+                    /* core provided an error code in global seqno */
+                    assert (orig_buf != act->buf);
+                    ret = act->seqno_g;
+                    act->seqno_g = GCS_SEQNO_ILL;
+                }
+
+                if (orig_buf != act->buf) // action was allocated in gcache
+                {
+                    gu_debug("Freeing gcache buffer %p after receiving %d",
+                             act->buf, ret);
+                    gcs_gcache_free (conn->gcache, act->buf);
+                    act->buf = orig_buf;
                 }
             }
         }
-#ifndef GCS_FOR_GARB
     out:
-#endif /* GCS_FOR_GARB */
         gu_mutex_unlock  (&repl_act.wait_mutex);
     }
     gu_mutex_destroy (&repl_act.wait_mutex);
@@ -1868,45 +1935,99 @@ long gcs_desync (gcs_conn_t* conn, gcs_seqno_t* local)
 }
 
 static inline void
-GCS_FIFO_POP_HEAD (gcs_conn_t* conn, ssize_t size)
+GCS_FIFO_POP_HEADS (gcs_conn_t* conn, long n, ssize_t size)
 {
     assert (conn->recv_q_size >= size);
     conn->recv_q_size -= size;
-    gu_fifo_pop_head (conn->recv_q);
+    gu_fifo_pop_heads (conn->recv_q, n);
 }
 
-/* Returns when an action from another process is received */
-long gcs_recv (gcs_conn_t*        conn,
-               struct gcs_action* action)
+/* Upper limit on the number of actions returned by gcs_recv_batch() */
+static long const GCS_RECV_BATCH_MAX = 64;
+
+/* To be called under slave queue lock. Flow control sends CONT and SYNC
+ * messages when the queue length drops to the lower limit, but actions of
+ * a batch are still to be applied when they leave the queue. So while one of
+ * these messages is pending, the batch is limited to the actions above the
+ * lower limit, which gives the same result as receiving them one by one. */
+static inline long
+gcs_recv_batch_limit (gcs_conn_t* conn, long const n)
 {
-    int                  err;
-    struct gcs_recv_act* recv_act = NULL;
+    if (n > 1 && (conn->stop_sent_ > 0 ||
+                  (GCS_CONN_JOINED == conn->state && !conn->sync_sent())))
+    {
+        long const above(gu_fifo_length (conn->recv_q) - conn->lower_limit);
 
-    assert (action);
+        if (above < n) return (above > 1 ? above : 1);
+    }
+
+    return n;
+}
 
-    if ((recv_act = (struct gcs_recv_act*)gu_fifo_get_head (conn->recv_q, &err)))
+/* Returns when actions from other processes are received */
+long gcs_recv_batch (gcs_conn_t*        conn,
+                     struct gcs_action* actions,
+                     long               max)
+{
+    void* items[GCS_RECV_BATCH_MAX];
+    int   err;
+
+    assert (actions);
+    assert (max > 0);
+
+    if (max > GCS_RECV_BATCH_MAX) max = GCS_RECV_BATCH_MAX;
+
+    long ret(gu_fifo_get_heads (conn->recv_q, items, max));
+
+    if (gu_likely(ret > 0))
     {
-        conn->queue_len = gu_fifo_length (conn->recv_q) - 1;
-        bool send_cont  = gcs_fc_cont_begin   (conn);
-        bool send_sync  = gcs_send_sync_begin (conn);
+        ret = gcs_recv_batch_limit (conn, ret);
 
-        action->buf     = (void*)recv_act->rcvd.act.buf;
-        action->size    = recv_act->rcvd.act.buf_len;
-        action->type    = recv_act->rcvd.act.type;
-        action->seqno_g = recv_act->rcvd.id;
-        action->seqno_l = recv_act->local_id;
-
-        if (gu_unlikely (GCS_ACT_CONF == action->type)) {
-            err = gu_fifo_cancel_gets (conn->recv_q);
-            if (err) {
-                gu_fatal ("Internal logic error: failed to cancel recv_q "
-                          "\"gets\": %d (%s). Aborting.",
-                          err, strerror(-err));
-                gu_abort();
+        ssize_t size(0);
+        long    n;
+
+        for (n = 0; n < ret;)
+        {
+            const struct gcs_recv_act* const recv_act
+                (static_cast<const struct gcs_recv_act*>(items[n]));
+
+            /* error action is returned alone, so that the receiver can act
+             * on it after processing what was received before */
+            if (gu_unlikely (GCS_SEQNO_ILL == recv_act->local_id && n > 0))
+                break;
+
+            struct gcs_action* const action(&actions[n]);
+
+            action->buf     = (void*)recv_act->rcvd.act.buf;
+            action->size    = recv_act->rcvd.act.buf_len;
+            action->type    = recv_act->rcvd.act.type;
+            action->seqno_g = recv_act->rcvd.id;
+            action->seqno_l = recv_act->local_id;
+
+            size += action->size;
+            ++n;
+
+            if (gu_unlikely (GCS_SEQNO_ILL == action->seqno_l)) break;
+
+            /* configuration change must be processed before any further
+             * actions, so it ends the batch */
+            if (gu_unlikely (GCS_ACT_CONF == action->type)) {
+                err = gu_fifo_cancel_gets (conn->recv_q);
+                if (err) {
+                    gu_fatal ("Internal logic error: failed to cancel recv_q "
+                              "\"gets\": %d (%s). Aborting.",
+                              err, strerror(-err));
+                    gu_abort();
+                }
+                break;
             }
         }
 
-        GCS_FIFO_POP_HEAD (conn, action->size); // release the queue
+        conn->queue_len = gu_fifo_length (conn->recv_q) - n;
+        bool send_cont  = gcs_fc_cont_begin   (conn);
+        bool send_sync  = gcs_send_sync_begin (conn);
+
+        GCS_FIFO_POP_HEADS (conn, n, size); // release the queue
 
         if (gu_unlikely(send_cont) && (err = gcs_fc_cont_end(conn))) {
             // We have successfully received an action, but failed to send
@@ -1932,25 +2053,34 @@ long gcs_recv (gcs_conn_t*        conn,
                      err, strerror(-err));
         }
 
-        return action->size;
+        return n;
     }
     else {
-        action->buf     = NULL;
-        action->size    = 0;
-        action->type    = GCS_ACT_ERROR;
-        action->seqno_g = GCS_SEQNO_ILL;
-        action->seqno_l = GCS_SEQNO_ILL;
+        actions->buf     = NULL;
+        actions->size    = 0;
+        actions->type    = GCS_ACT_ERROR;
+        actions->seqno_g = GCS_SEQNO_ILL;
+        actions->seqno_l = GCS_SEQNO_ILL;
 
-        switch (err) {
+        switch (ret) {
         case -ENODATA:
             assert (GCS_CONN_CLOSED == conn->state);
             return GCS_CLOSED_ERROR;
         default:
-            return err;
+            return ret;
         }
     }
 }
 
+/* Returns when an action from another process is received */
+long gcs_recv (gcs_conn_t*        conn,
+               struct gcs_action* action)
+{
+    long const ret(gcs_recv_batch (conn, action, 1));
+
+    return (gu_likely(ret > 0) ? action->size : ret);
+}
+
 long
 gcs_resume_recv (gcs_conn_t* conn)
 {
@@ -2072,6 +2202,8 @@ gcs_flush_stats(gcs_conn_t* conn)
     conn->stats_fc_stop_sent = 0;
     conn->stats_fc_cont_sent = 0;
     conn->stats_fc_received  = 0;
+    conn->stats_send_batched = 0;
+    gcs_core_stats_flush (conn->core);
 }
 
 void gcs_get_status(gcs_conn_t* conn, gu::Status& status)
@@ -2080,6 +2212,8 @@ void gcs_get_status(gcs_conn_t* conn, gu::Status& status)
     {
         gcs_core_get_status(conn->core, status);
     }
+
+    status.insert("gcs_send_batched", gu::to_string(conn->stats_send_batched));
 }
 
 static long
@@ -2258,6 +2392,46 @@ _set_recv_q_soft_limit (gcs_conn_t* conn, const char* value)
     }
 }
 
+static long
+_set_send_batch (gcs_conn_t* conn, const char* value)
+{
+    long long batch;
+    const char* const endptr = gu_str2ll (value, &batch);
+
+    if (batch >= 0 && *endptr == '\0') {
+
+        if (batch > LONG_MAX) batch = LONG_MAX;
+
+        if (batch == conn->params.send_batch) return 0;
+
+        gu_config_set_int64 (conn->config, GCS_PARAMS_SEND_BATCH, batch);
+        conn->params.send_batch = batch;
+
+        return 0;
+    }
+    else {
+        return -EINVAL;
+    }
+}
+
+static long
+_set_adaptive_frags (gcs_conn_t* conn, const char* value)
+{
+    bool af;
+    const char* const endptr = gu_str2bool (value, &af);
+
+    if (endptr[0] != '\0') return -EINVAL;
+
+    if (conn->params.adaptive_frags != af) {
+
+        gu_config_set_bool (conn->config, GCS_PARAMS_ADAPTIVE_FRAGS, af);
+        conn->params.adaptive_frags = af;
+        gcs_core_set_adaptive_frag (conn->core, af);
+    }
+
+    return 0;
+}
+
 static long
 _set_max_throttle (gcs_conn_t* conn, const char* value)
 {
@@ -2309,6 +2483,12 @@ long gcs_param_set  (gcs_conn_t* conn, const char* key, const char *value)
     else if (!strcmp (key, GCS_PARAMS_MAX_THROTTLE)) {
         return _set_max_throttle (conn, value);
     }
+    else if (!strcmp (key, GCS_PARAMS_SEND_BATCH)) {
+        return _set_send_batch (conn, value);
+    }
+    else if (!strcmp (key, GCS_PARAMS_ADAPTIVE_FRAGS)) {
+        return _set_adaptive_frags (conn, value);
+    }
 #ifdef GCS_SM_DEBUG
     else if (!strcmp (key, GCS_PARAMS_SM_DUMP)) {
         gcs_sm_dump_state(conn->sm, stderr);
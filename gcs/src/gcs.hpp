@@ -245,6 +245,22 @@ static inline long gcs_repl (gcs_conn_t*        const conn,
 extern long gcs_recv (gcs_conn_t*        conn,
                       struct gcs_action* action);
 
+/*! @brief Receives several consecutive actions from group.
+ * Same as gcs_recv(), but returns up to max actions which are already
+ * waiting in the receive queue (blocks only if there are none), so that
+ * the queue is locked only once for the whole batch. Configuration change
+ * action is always the last one in the batch, error action is always
+ * returned alone.
+ *
+ * @param conn    group connection handle
+ * @param actions array of at least max action objects
+ * @param max     maximum number of actions to return
+ * @return        negative error code, number of actions in case of success
+ */
+extern long gcs_recv_batch (gcs_conn_t*        conn,
+                            struct gcs_action* actions,
+                            long               max);
+
 /*!
  * @brief Schedules entry to CGS send monitor.
  * Locks send monitor and should be quickly followed by gcs_repl()/gcs_send()
@@ -73,6 +73,33 @@ long fn (gcs_backend_t* const backend,    \
          size_t         const len,        \
          gcs_msg_type_t const msg_type)
 
+/*!
+ * Send a message gathered from several buffers. This is optional: if backend
+ * does not provide it, the message is first gathered into a single buffer
+ * and sent with send().
+ *
+ * @param backend
+ *        a pointer to the backend handle
+ * @param bufs
+ *        array of buffers to gather the message from
+ * @param bufs_num
+ *        number of buffers in the array
+ * @param len
+ *        total length of the message
+ * @param msg_type
+ *        type of the message
+ * @return
+ *        negative error code in case of error
+ *        OR
+ *        amount of bytes sent
+ */
+#define GCS_BACKEND_SENDV_FN(fn)                \
+long fn (gcs_backend_t*       const backend,    \
+         const struct gu_buf* const bufs,       \
+         int                  const bufs_num,   \
+         size_t               const len,        \
+         gcs_msg_type_t       const msg_type)
+
 /*!
  * Receive a message from the backend.
  *
@@ -167,6 +194,7 @@ typedef GCS_BACKEND_DESTROY_FN   ((*gcs_backend_destroy_t));
 typedef GCS_BACKEND_OPEN_FN      ((*gcs_backend_open_t));
 typedef GCS_BACKEND_CLOSE_FN     ((*gcs_backend_close_t));
 typedef GCS_BACKEND_SEND_FN      ((*gcs_backend_send_t));
+typedef GCS_BACKEND_SENDV_FN     ((*gcs_backend_sendv_t));
 typedef GCS_BACKEND_RECV_FN      ((*gcs_backend_recv_t));
 typedef GCS_BACKEND_NAME_FN      ((*gcs_backend_name_t));
 typedef GCS_BACKEND_MSG_SIZE_FN  ((*gcs_backend_msg_size_t));
@@ -181,6 +209,7 @@ struct gcs_backend
     gcs_backend_close_t     close;
     gcs_backend_destroy_t   destroy;
     gcs_backend_send_t      send;
+    gcs_backend_sendv_t     sendv;
     gcs_backend_recv_t      recv;
     gcs_backend_name_t      name;
     gcs_backend_msg_size_t  msg_size;
@@ -17,6 +17,7 @@
 #include "gcs_backend.hpp"
 #include "gcs_comp_msg.hpp"
 #include "gcs_fifo_lite.hpp"
+#include "gcs_frag.hpp"
 #include "gcs_group.hpp"
 #include "gcs_gcache.hpp"
 
@@ -33,6 +34,7 @@ gcs_core_register (gu_config_t* conf)
 
 const size_t CORE_FIFO_LEN = (1 << 10); // 1024 elements (no need to have more)
 const size_t CORE_INIT_BUF_SIZE = (1 << 16); // 65K - IP packet size
+const int    CORE_INIT_IOV_LEN  = 16;
 
 typedef enum core_state
 {
@@ -64,7 +66,10 @@ struct gcs_core
 
     void*           send_buf;
     size_t          send_buf_len;
+    struct gu_buf*  send_iov;  // action fragment gather list for sendv()
+    int             send_iov_len;
     gcs_seqno_t     send_act_no;
+    gcs_frag_t      frag;      // action fragment size
 
     /* recv part */
     gcs_recv_msg_t  recv_msg;
@@ -136,6 +141,7 @@ gcs_core_create (gu_config_t* const conf,
                                                    sizeof (core_act_t));
                 if (core->fifo) {
                     gu_mutex_init  (&core->send_lock, NULL);
+                    gcs_frag_init  (&core->frag, false);
                     core->proto_ver = -1; // shall be bumped in gcs_group_act_conf()
                     gcs_group_init (&core->group, cache, node_name, inc_addr,
                                     GCS_PROTO_MAX, repl_proto_ver,
@@ -241,10 +247,11 @@ core_error (core_state_t state)
  * actions.
  */
 static inline ssize_t
-core_msg_send (gcs_core_t*    core,
-               const void*    msg,
-               size_t         msg_len,
-               gcs_msg_type_t msg_type)
+core_msg_sendv (gcs_core_t*          core,
+                const struct gu_buf* bufs,
+                int                  bufs_num,
+                size_t               msg_len,
+                gcs_msg_type_t       msg_type)
 {
     ssize_t ret;
 
@@ -254,7 +261,15 @@ core_msg_send (gcs_core_t*    core,
                       (CORE_EXCHANGE == core->state && GCS_MSG_STATE_MSG ==
                        msg_type))) {
 
-            ret = core->backend.send (&core->backend, msg, msg_len, msg_type);
+            if (1 == bufs_num) {
+                ret = core->backend.send (&core->backend, bufs[0].ptr,
+                                          msg_len, msg_type);
+            }
+            else {
+                assert (core->backend.sendv);
+                ret = core->backend.sendv (&core->backend, bufs, bufs_num,
+                                           msg_len, msg_type);
+            }
 
             if (ret > 0 && ret != (ssize_t)msg_len &&
                 GCS_MSG_ACTION != msg_type) {
@@ -282,16 +297,18 @@ core_msg_send (gcs_core_t*    core,
 
 /*!
  * Repeats attempt at sending the message if -EAGAIN was returned
- * by core_msg_send()
+ * by core_msg_sendv()
  */
 static inline ssize_t
-core_msg_send_retry (gcs_core_t*    core,
-                     const void*    buf,
-                     size_t         buf_len,
-                     gcs_msg_type_t type)
+core_msg_sendv_retry (gcs_core_t*          core,
+                      const struct gu_buf* bufs,
+                      int                  bufs_num,
+                      size_t               msg_len,
+                      gcs_msg_type_t       type)
 {
     ssize_t ret;
-    while ((ret = core_msg_send (core, buf, buf_len, type)) == -EAGAIN) {
+    while ((ret = core_msg_sendv (core, bufs, bufs_num, msg_len, type)) ==
+           -EAGAIN) {
         /* wait for primary configuration - sleep 0.01 sec */
         gu_debug ("Backend requested wait");
         usleep (10000);
@@ -300,6 +317,36 @@ core_msg_send_retry (gcs_core_t*    core,
     return ret;
 }
 
+static inline ssize_t
+core_msg_send_retry (gcs_core_t*    core,
+                     const void*    buf,
+                     size_t         buf_len,
+                     gcs_msg_type_t type)
+{
+    struct gu_buf const msg = { buf, static_cast<ssize_t>(buf_len) };
+    return core_msg_sendv_retry (core, &msg, 1, buf_len, type);
+}
+
+/*! Makes room for at least len buffers in action fragment gather list */
+static inline long
+core_send_iov_reserve (gcs_core_t* core, int len)
+{
+    if (gu_likely(len <= core->send_iov_len)) return 0;
+
+    int new_len = core->send_iov_len > 0 ? core->send_iov_len :
+                                           CORE_INIT_IOV_LEN;
+    while (new_len < len) new_len *= 2;
+
+    void* const tmp (gu_realloc (core->send_iov,
+                                 new_len * sizeof(struct gu_buf)));
+    if (gu_unlikely(NULL == tmp)) return -ENOMEM;
+
+    core->send_iov     = static_cast<struct gu_buf*>(tmp);
+    core->send_iov_len = new_len;
+
+    return 0;
+}
+
 ssize_t
 gcs_core_send (gcs_core_t*          const conn,
                const struct gu_buf* const action,
@@ -334,6 +381,22 @@ gcs_core_send (gcs_core_t*          const conn,
     if ((ret = gcs_act_proto_write (&frg, conn->send_buf, conn->send_buf_len)))
         return ret;
 
+    frg.frag_len = gcs_frag_size (&conn->frag, frg.frag_len);
+
+    /* If backend can gather the message itself, fragments are passed to it
+     * as a list of action buffer slices following the header in send_buf,
+     * otherwise they are copied to send_buf after the header. */
+    const bool gather = (conn->backend.sendv != NULL);
+
+    if (gather) {
+        /* fragment can't span more buffers than the whole action */
+        int    bufs_num = 0;
+        size_t bufs_size = 0;
+        while (bufs_size < act_size) bufs_size += action[bufs_num++].size;
+
+        if ((ret = core_send_iov_reserve (conn, bufs_num + 1))) return ret;
+    }
+
     if ((local_act = (core_act_t*)gcs_fifo_lite_get_tail (conn->fifo))) {
         *local_act = (core_act_t){ conn->send_act_no, action, act_size };
         gcs_fifo_lite_push_tail (conn->fifo);
@@ -355,18 +418,34 @@ gcs_core_send (gcs_core_t*          const conn,
         /* Here is the only time we have to cast frg.frag */
         char* dst = (char*)frg.frag;
         size_t to_copy = chunk_size;
+        int    iov_num = 1;
+
+        if (gather) {
+            conn->send_iov[0].ptr  = conn->send_buf;
+            conn->send_iov[0].size = hdr_size;
+        }
 
         while (to_copy > 0) {        // gather action bufs into one
-            if (to_copy <= left) {
-                memcpy (dst, ptr, to_copy);
-                ptr     += to_copy;
-                left    -= to_copy;
-                to_copy = 0;
+            size_t const chunk = to_copy <= left ? to_copy : left;
+
+            if (!gather) {
+                memcpy (dst, ptr, chunk);
+                dst += chunk;
+            }
+            else if (chunk > 0) {
+                assert (iov_num < conn->send_iov_len);
+                conn->send_iov[iov_num].ptr  = ptr;
+                conn->send_iov[iov_num].size = chunk;
+                iov_num++;
+            }
+
+            to_copy -= chunk;
+
+            if (0 == to_copy) {
+                ptr  += chunk;
+                left -= chunk;
             }
             else {
-                memcpy (dst, ptr, left);
-                dst     += left;
-                to_copy -= left;
                 idx++;
                 ptr  = (const uint8_t*)action[idx].ptr;
                 left = action[idx].size;
@@ -375,13 +454,22 @@ gcs_core_send (gcs_core_t*          const conn,
 
         send_size = hdr_size + chunk_size;
 
+        gcs_frag_send (&conn->frag, frg.act_id, frg.frag_no, chunk_size,
+                       frg.act_size);
+
 #ifdef GCS_CORE_TESTING
         gu_lock_step_wait (&conn->ls); // pause after every fragment
         gu_info ("Sent %p of size %zu. Total sent: %zu, left: %zu",
                  (char*)conn->send_buf + hdr_size, chunk_size, sent, act_size);
 #endif
-        ret = core_msg_send_retry (conn, conn->send_buf, send_size,
-                                   GCS_MSG_ACTION);
+        if (gather) {
+            ret = core_msg_sendv_retry (conn, conn->send_iov, iov_num,
+                                        send_size, GCS_MSG_ACTION);
+        }
+        else {
+            ret = core_msg_send_retry (conn, conn->send_buf, send_size,
+                                       GCS_MSG_ACTION);
+        }
         GU_DBUG_SYNC_WAIT("gcs_core_after_frag_send");
 #ifdef GCS_CORE_TESTING
 //        gu_lock_step_wait (&conn->ls); // pause after every fragment
@@ -428,6 +516,7 @@ gcs_core_send (gcs_core_t*          const conn,
                 gu_fatal ("Cannot send message: header is too big");
                 ret = -ENOTRECOVERABLE;
             }
+            gcs_frag_reset (&conn->frag);
             /* At this point we have an unsent action in local FIFO
              * and parts of this action already could have been received
              * by other group members.
@@ -545,6 +634,8 @@ core_handle_act_msg (gcs_core_t*          core,
             return -ENOTRECOVERABLE;
         }
 
+        if (my_msg) gcs_frag_recv (&core->frag, frg.act_id, frg.frag_no);
+
         ret = gcs_group_handle_act_msg (group, &frg, msg, act,
                                         commonly_supported_version);
 
@@ -735,6 +826,9 @@ core_handle_comp_msg (gcs_core_t*          core,
     if (gu_mutex_lock (&core->send_lock)) abort();
     ret = gcs_group_handle_comp_msg (group, (const gcs_comp_msg_t*)msg->buf);
 
+    /* own fragments sent in the previous configuration may be lost */
+    gcs_frag_reset (&core->frag);
+
     switch (ret) {
     case GCS_GROUP_PRIMARY:
         /* New primary configuration. This happens if:
@@ -1229,6 +1323,7 @@ long gcs_core_destroy (gcs_core_t* core)
 
     /* after that we must be able to destroy mutexes */
     while (gu_mutex_destroy (&core->send_lock));
+    gcs_frag_destroy (&core->frag);
     /* now noone will interfere */
     while ((tmp = (core_act_t*)gcs_fifo_lite_get_head (core->fifo))) {
         // whatever is in tmp.action is allocated by app., just forget it.
@@ -1240,6 +1335,7 @@ long gcs_core_destroy (gcs_core_t* core)
     /* free buffers */
     gu_free (core->recv_msg.buf);
     gu_free (core->send_buf);
+    gu_free (core->send_iov);
 
 #ifdef GCS_CORE_TESTING
     gu_lock_step_destroy (&core->ls);
@@ -1422,6 +1518,18 @@ void gcs_core_get_status(gcs_core_t* core, gu::Status& status)
         core->backend.status_get(&core->backend, status);
     }
     gu_mutex_unlock(&core->send_lock);
+
+    gcs_frag_get_status(&core->frag, status);
+}
+
+void gcs_core_set_adaptive_frag(gcs_core_t* core, bool adaptive)
+{
+    gcs_frag_set_adaptive(&core->frag, adaptive);
+}
+
+void gcs_core_stats_flush(gcs_core_t* core)
+{
+    gcs_frag_stats_flush(&core->frag);
 }
 
 #ifdef GCS_CORE_TESTING
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2008-2014 Codership Oy <info@codership.com>
+ * Copyright (C) 2008-2020 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -165,6 +165,11 @@ gcs_core_param_get (gcs_core_t* core, const char* key);
 
 void gcs_core_get_status(gcs_core_t* core, gu::Status& status);
 
+/* Enables fragment size adaptation to group latency */
+void gcs_core_set_adaptive_frag(gcs_core_t* core, bool adaptive);
+
+void gcs_core_stats_flush(gcs_core_t* core);
+
 #ifdef GCS_CORE_TESTING
 
 /* gcs_core_send() interface does not allow enough concurrency control to model
@@ -44,7 +44,7 @@ dummy_msg_create (gcs_msg_type_t const type,
 
     if ((msg = static_cast<dummy_msg_t*>(gu_malloc (sizeof(dummy_msg_t) + len))))
     {
-        memcpy (msg->buf, buf, len);
+        if (buf) memcpy (msg->buf, buf, len);
         msg->len        = len;
         msg->type       = type;
         msg->sender_idx = sender;
@@ -102,6 +102,14 @@ GCS_BACKEND_DESTROY_FN(dummy_destroy)
     return 0;
 }
 
+static inline long
+dummy_send_error (dummy_state_t const state)
+{
+    static long send_error[DUMMY_PRIM] =
+        { -EBADFD, -EBADFD, -ENOTCONN, -EAGAIN };
+    return send_error[state];
+}
+
 static
 GCS_BACKEND_SEND_FN(dummy_send)
 {
@@ -116,14 +124,60 @@ GCS_BACKEND_SEND_FN(dummy_send)
                                     backend->conn->my_idx);
     }
     else {
-        static long send_error[DUMMY_PRIM] =
-            { -EBADFD, -EBADFD, -ENOTCONN, -EAGAIN };
-        err = send_error[dummy->state];
+        err = dummy_send_error (dummy->state);
     }
 
     return err;
 }
 
+static long
+dummy_msg_push (dummy_t* const dummy, dummy_msg_t* const msg)
+{
+    long const len = msg->len; // msg may be gone once it is in the queue
+    dummy_msg_t** ptr = static_cast<dummy_msg_t**>(
+        gu_fifo_get_tail (dummy->gc_q));
+
+    if (gu_likely(ptr != NULL)) {
+        *ptr = msg;
+        gu_fifo_push_tail (dummy->gc_q);
+        return len;
+    }
+    else {
+        dummy_msg_destroy (msg);
+        return -EBADFD; // closed
+    }
+}
+
+static
+GCS_BACKEND_SENDV_FN(dummy_sendv)
+{
+    dummy_t* dummy = backend->conn;
+
+    if (gu_unlikely(NULL == dummy)) return -EBADFD;
+
+    if (gu_unlikely(DUMMY_PRIM != dummy->state))
+    {
+        return dummy_send_error (dummy->state);
+    }
+
+    size_t const send_size = len < dummy->max_send_size ?
+                             len : dummy->max_send_size;
+    dummy_msg_t* const msg = dummy_msg_create (msg_type, send_size,
+                                               dummy->my_idx, NULL);
+    if (gu_unlikely(NULL == msg)) return -ENOMEM;
+
+    uint8_t* dst  = msg->buf;
+    size_t   left = send_size;
+    for (int i = 0; i < bufs_num && left > 0; i++) {
+        size_t const chunk = size_t(bufs[i].size) < left ? bufs[i].size : left;
+        memcpy (dst, bufs[i].ptr, chunk);
+        dst  += chunk;
+        left -= chunk;
+    }
+
+    return dummy_msg_push (dummy, msg);
+}
+
 static
 GCS_BACKEND_RECV_FN(dummy_recv)
 {
@@ -298,6 +352,7 @@ GCS_BACKEND_CREATE_FN(gcs_dummy_create)
     backend->close     = dummy_close;
     backend->destroy   = dummy_destroy;
     backend->send      = dummy_send;
+    backend->sendv     = dummy_sendv;
     backend->recv      = dummy_recv;
     backend->name      = dummy_name;
     backend->msg_size  = dummy_msg_size;
@@ -333,18 +388,7 @@ gcs_dummy_inject_msg (gcs_backend_t* backend,
 
     if (msg)
     {
-        dummy_msg_t** ptr = static_cast<dummy_msg_t**>(
-            gu_fifo_get_tail (backend->conn->gc_q));
-
-        if (gu_likely(ptr != NULL)) {
-            *ptr = msg;
-            gu_fifo_push_tail (backend->conn->gc_q);
-            ret = send_size;
-        }
-        else {
-            dummy_msg_destroy (msg);
-            ret = -EBADFD; // closed
-        }
+        ret = dummy_msg_push (backend->conn, msg);
     }
     else {
         ret = -ENOMEM;
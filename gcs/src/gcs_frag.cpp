@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/*! @file Adaptive action fragment size, see gcs_frag.hpp */
+
+#include "gcs_frag.hpp"
+
+#include <gu_utils.hpp> // gu::to_string()
+
+#include <sstream>
+#include <string.h>
+
+static size_t const class_limit[GCS_FRAG_CLASSES - 1] =
+    { 1 << 10, 1 << 16, 1 << 20 };
+static const char* const class_name[GCS_FRAG_CLASSES] =
+    { "1K", "64K", "1M", "inf" };
+
+static long   const small_len   = 1024; //! messages up to it are small
+static long   const min_size    = 4096; //! fragment size does not go below
+static long   const min_samples = 4;    //! samples needed to adjust size
+static double const avg_factor  = 0.125;
+
+void
+gcs_frag_init (gcs_frag_t* const frag, bool const adaptive)
+{
+    memset (frag, 0, sizeof(*frag));
+    gu_mutex_init (&frag->lock, NULL);
+    frag->adaptive = adaptive;
+}
+
+void
+gcs_frag_destroy (gcs_frag_t* const frag)
+{
+    while (gu_mutex_destroy (&frag->lock));
+}
+
+void
+gcs_frag_set_adaptive (gcs_frag_t* const frag, bool const adaptive)
+{
+    gu_mutex_lock (&frag->lock);
+
+    if (frag->adaptive != adaptive) {
+        frag->adaptive   = adaptive;
+        frag->size       = frag->max_size; // start over from the largest
+        frag->full_num   = 0;
+        frag->sample_len = 0;
+    }
+
+    gu_mutex_unlock (&frag->lock);
+}
+
+long
+gcs_frag_size (gcs_frag_t* const frag, long const max_size)
+{
+    long ret;
+
+    gu_mutex_lock (&frag->lock);
+
+    if (gu_unlikely(frag->max_size != max_size)) {
+        frag->max_size = max_size;
+        frag->size     = max_size;
+        frag->full_num = 0;
+    }
+
+    ret = frag->adaptive ? frag->size : frag->max_size;
+
+    gu_mutex_unlock (&frag->lock);
+
+    return ret;
+}
+
+static inline int
+frag_class (size_t const act_size)
+{
+    int i(0);
+    while (i < GCS_FRAG_CLASSES - 1 && act_size > class_limit[i]) i++;
+    return i;
+}
+
+void
+gcs_frag_send (gcs_frag_t*   const frag,
+               gcs_seqno_t   const act_id,
+               unsigned long const frag_no,
+               size_t        const frag_len,
+               size_t        const act_size)
+{
+    gcs_frag_stats_t& stats(frag->stats[frag_class(act_size)]);
+
+    gu_mutex_lock (&frag->lock);
+
+    if (0 == frag_no) stats.acts++;
+    stats.frags++;
+
+    /* own fragments are delivered in the order they were sent, so nothing is
+     * in flight unless the last delivered one is behind the last sent one.
+     * Not requiring them to be equal tolerates stale deliveries after
+     * gcs_frag_reset(). */
+    bool const idle(frag->recv_act > frag->sent_act ||
+                    (frag->recv_act  == frag->sent_act &&
+                     frag->recv_frag >= frag->sent_frag));
+
+    frag->sent_act  = act_id;
+    frag->sent_frag = frag_no;
+
+    if (frag->adaptive && idle && 0 == frag->sample_len &&
+        (long(frag_len) <= small_len ||
+         long(frag_len) >= frag->size - frag->size/4)) {
+        frag->sample_act   = act_id;
+        frag->sample_frag  = frag_no;
+        frag->sample_len   = frag_len;
+        frag->sample_start = gu_time_monotonic();
+    }
+
+    gu_mutex_unlock (&frag->lock);
+}
+
+void
+gcs_frag_reset (gcs_frag_t* const frag)
+{
+    gu_mutex_lock (&frag->lock);
+    /* otherwise sent and delivered fragments never match again and no more
+     * samples are taken */
+    frag->sent_act   = frag->recv_act;
+    frag->sent_frag  = frag->recv_frag;
+    frag->sample_len = 0;
+    gu_mutex_unlock (&frag->lock);
+}
+
+static inline void
+frag_average (double& avg, long& num, double const val)
+{
+    if (0 == num) avg = val;
+    else          avg += (val - avg) * avg_factor;
+    num++;
+}
+
+/*! Adjusts fragment size when there is enough samples for both small messages
+ *  and fragments of the current size */
+static void
+frag_adjust (gcs_frag_t* const frag)
+{
+    if (frag->small_num < min_samples || frag->full_num < min_samples) return;
+
+    double const transfer(frag->full_lat - frag->small_lat);
+    long   const old_size(frag->size);
+
+    if (transfer > frag->small_lat) {
+        frag->size -= frag->size/4;
+        if (frag->size < min_size) frag->size = min_size;
+    }
+    else if (transfer < frag->small_lat/4) {
+        frag->size += frag->size/8;
+    }
+
+    if (frag->size > frag->max_size) frag->size = frag->max_size;
+
+    if (frag->size != old_size) {
+        gu_debug ("Fragment size %ld -> %ld, latency small: %.6f, full: %.6f",
+                  old_size, frag->size, frag->small_lat, frag->full_lat);
+        frag->full_num = 0; // latency of new size is unknown yet
+    }
+}
+
+void
+gcs_frag_recv (gcs_frag_t*   const frag,
+               gcs_seqno_t   const act_id,
+               unsigned long const frag_no)
+{
+    gu_mutex_lock (&frag->lock);
+
+    frag->recv_act  = act_id;
+    frag->recv_frag = frag_no;
+
+    /* nothing else was in flight when the timed fragment was sent, so the
+     * first own fragment delivered after that is either the timed one or
+     * the timed one was lost */
+    if (frag->sample_len > 0 &&
+        act_id == frag->sample_act && frag_no == frag->sample_frag) {
+        double const lat((gu_time_monotonic() - frag->sample_start) * 1.e-9);
+
+        if (frag->sample_len <= small_len) {
+            frag_average (frag->small_lat, frag->small_num, lat);
+        }
+        else if (frag->sample_len >= frag->size - frag->size/4) {
+            frag_average (frag->full_lat, frag->full_num, lat);
+            frag_adjust (frag);
+        }
+    }
+
+    frag->sample_len = 0;
+
+    gu_mutex_unlock (&frag->lock);
+}
+
+void
+gcs_frag_stats_flush (gcs_frag_t* const frag)
+{
+    gu_mutex_lock (&frag->lock);
+    memset (frag->stats, 0, sizeof(frag->stats));
+    gu_mutex_unlock (&frag->lock);
+}
+
+void
+gcs_frag_get_status (gcs_frag_t* const frag, gu::Status& status)
+{
+    std::ostringstream os;
+
+    gu_mutex_lock (&frag->lock);
+
+    /* class:actions/fragments */
+    for (int i(0); i < GCS_FRAG_CLASSES; ++i) {
+        if (i > 0) os << ',';
+        os << class_name[i] << ':' << frag->stats[i].acts << '/'
+           << frag->stats[i].frags;
+    }
+
+    long   const size(frag->adaptive ? frag->size : frag->max_size);
+    double const small_lat(frag->small_lat);
+    double const full_lat(frag->full_lat);
+
+    gu_mutex_unlock (&frag->lock);
+
+    status.insert("gcs_frag_size", gu::to_string(size));
+    status.insert("gcs_frag_latency_small", gu::to_string(small_lat));
+    status.insert("gcs_frag_latency_full", gu::to_string(full_lat));
+    status.insert("gcs_frag_classes", os.str());
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2020 Codership Oy <info@codership.com>
+ */
+
+/*! @file Adaptive action fragment size (gcs.adaptive_fragments)
+ *
+ * Every action fragment travels as a separate group message and holds up
+ * delivery of all messages ordered after it until it is delivered itself.
+ * Large fragments save on headers and message count for big actions, small
+ * ones let small actions through sooner. Which size is right depends on the
+ * link: where transferring a full fragment takes little time compared to
+ * the group latency, fragments may as well be as large as allowed, on a slow
+ * link they should be smaller.
+ *
+ * To find out, delivery latency of own messages is sampled and averaged
+ * separately for small messages and for fragments of the current size.
+ * The difference between the two is the time the link takes to carry the
+ * fragment payload. While it stays well below small message latency,
+ * fragment size grows up to the maximum allowed by gcs.max_packet_size,
+ * when it exceeds it, fragment size shrinks.
+ *
+ * Message is timed only if no other own message is in flight, otherwise its
+ * latency would include waiting for those.
+ */
+
+#ifndef _gcs_frag_h_
+#define _gcs_frag_h_
+
+#include "gcs_seqno.hpp"
+
+#include <galerautils.h>
+#include <gu_status.hpp>
+
+/*! action size classes for statistics: up to 1K, 64K, 1M and above */
+#define GCS_FRAG_CLASSES 4
+
+typedef struct gcs_frag_stats
+{
+    long long acts;  // actions sent
+    long long frags; // fragments they were sent in
+}
+gcs_frag_stats_t;
+
+typedef struct gcs_frag
+{
+    gu_mutex_t    lock;
+    bool          adaptive;
+    long          max_size;     // largest fragment size allowed
+    long          size;         // current fragment size
+    long          small_num;    // number of small message latency samples
+    double        small_lat;    // average small message latency (sec)
+    long          full_num;     // number of full fragment latency samples
+    double        full_lat;     // average full fragment latency (sec)
+    gcs_seqno_t   sent_act;     // last own fragment handed to backend
+    unsigned long sent_frag;
+    gcs_seqno_t   recv_act;     // last own fragment delivered
+    unsigned long recv_frag;
+    gcs_seqno_t   sample_act;   // own fragment being timed
+    unsigned long sample_frag;
+    long          sample_len;   // its length, 0 - none is timed
+    long long     sample_start; // when it was sent (nanosec, monotonic)
+    gcs_frag_stats_t stats[GCS_FRAG_CLASSES];
+}
+gcs_frag_t;
+
+extern void
+gcs_frag_init (gcs_frag_t* frag, bool adaptive);
+
+extern void
+gcs_frag_destroy (gcs_frag_t* frag);
+
+extern void
+gcs_frag_set_adaptive (gcs_frag_t* frag, bool adaptive);
+
+/*! @return fragment size to use for the next action,
+ *          max_size - size allowed by send buffer */
+extern long
+gcs_frag_size (gcs_frag_t* frag, long max_size);
+
+/*! Accounts fragment of own action which is about to be sent */
+extern void
+gcs_frag_send (gcs_frag_t*   frag,
+               gcs_seqno_t   act_id,
+               unsigned long frag_no,
+               size_t        frag_len,
+               size_t        act_size);
+
+/*! Discards latency sample and forgets own fragments in flight. To be called
+ *  when they may never be delivered: after a failed send and on
+ *  configuration change. */
+extern void
+gcs_frag_reset (gcs_frag_t* frag);
+
+/*! Processes delivery of own action fragment */
+extern void
+gcs_frag_recv (gcs_frag_t* frag, gcs_seqno_t act_id, unsigned long frag_no);
+
+extern void
+gcs_frag_stats_flush (gcs_frag_t* frag);
+
+extern void
+gcs_frag_get_status (gcs_frag_t* frag, gu::Status& status);
+
+#endif /* _gcs_frag_h_ */
@@ -42,4 +42,14 @@ gcs_gcache_free (gcache_t* gcache, const void* buf)
         ::free (const_cast<void*>(buf));
 }
 
+/* binds cache memory to the NUMA node of the calling thread (if configured) */
+static inline void
+gcs_gcache_numa_bind (gcache_t* gcache)
+{
+#ifndef GCS_FOR_GARB
+    if (gu_likely (gcache != NULL))
+        gcache_numa_bind (gcache);
+#endif
+}
+
 #endif /* _gcs_gcache_h_ */
@@ -1,13 +1,9 @@
 /*
- * Copyright (C) 2009-2019 Codership Oy <info@codership.com>
+ * Copyright (C) 2009-2020 Codership Oy <info@codership.com>
  */
 
 /*!
  * @file GComm GCS Backend implementation
- *
- * @todo Figure out if there is lock-free way to handle RecvBuf
- *       push/pop operations.
- *
  */
 
 
@@ -26,6 +22,8 @@
 #include <gu_logger.hpp>
 #include <gu_barrier.hpp>
 #include <gu_thread.hpp>
+#include <gu_mpsc_queue.hpp>
+#include <gu_atomic.hpp>
 
 #include <deque>
 
@@ -57,58 +55,89 @@ private:
     ProtoUpMeta um_;
 };
 
-#if defined(GALERA_USE_BOOST_POOL_ALLOC)
+typedef deque<RecvBufData> RecvBufQueue;
 
-#include <boost/pool/pool_alloc.hpp>
-
-typedef deque<RecvBufData,
-              boost::fast_pool_allocator<
-                  RecvBufData,
-                  boost::default_user_allocator_new_delete,
-                  boost::details::pool::null_mutex
-                  >
-              >
-#else
-
-typedef deque<RecvBufData>
-
-#endif /* GALERA_USE_BOOST_POOL_ALLOC */
-
-RecvBufQueue;
+static inline void cpu_relax()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
 
+/*
+ * Messages are passed from gcomm thread to GCS receiving thread through
+ * a lock-free ring. Should the ring get full, messages go to the overflow
+ * queue protected by mutex until it is drained, to preserve the order.
+ * Receiving thread spins for a while before going to sleep, the number of
+ * spins adapts to whether spinning succeeds.
+ */
 class RecvBuf
 {
-private:
-
-    class Waiting
-    {
-    public:
-        Waiting (bool& w) : w_(w) { w_ = true;  }
-        ~Waiting()                { w_ = false; }
-    private:
-        bool& w_;
-    };
-
 public:
 
-    RecvBuf() : mutex_(), cond_(), queue_(), waiting_(false) { }
+    RecvBuf() :
+        ring_         (RING_SIZE),
+        mutex_        (),
+        cond_         (),
+        overflow_     (),
+        overflow_len_ (0),
+        waiting_      (0),
+        signal_time_  (0),
+        from_overflow_(false),
+        spins_        (SPINS_MIN),
+        len_max_      (0),
+        overflows_    (0),
+        wakeups_      (0),
+        wakeup_time_  (0)
+    { }
 
     void push_back(const RecvBufData& p)
     {
-        Lock lock(mutex_);
+        if (overflow_len_() > 0 || !ring_.push(p))
+        {
+            Lock lock(mutex_);
+            overflow_.push_back(p);
+            ++overflow_len_;
+            ++overflows_;
+        }
 
-        queue_.push_back(p);
+        size_t const len(ring_.size() + overflow_len_());
+        if (long(len) > len_max_()) len_max_ = len;
 
-        if (waiting_ == true) { cond_.signal(); }
+        if (waiting_() != 0)
+        {
+            Lock lock(mutex_);
+            signal_time_ = gu_time_monotonic();
+            cond_.signal();
+        }
     }
 
     const RecvBufData& front(const Date& timeout)
     {
+        const RecvBufData* ret;
+
+        for (int spin(0); spin <= spins_; ++spin)
+        {
+            if ((ret = peek()))
+            {
+                if (spin > 0 && spins_ < SPINS_MAX) spins_ <<= 1;
+                return *ret;
+            }
+            cpu_relax();
+        }
+
+        if (spins_ > SPINS_MIN) spins_ >>= 1;
+
         Lock lock(mutex_);
 
-        while (queue_.empty())
+        while (true)
         {
+            /* producer checks waiting_ after pushing, so either it sees it
+             * set or we see the message in the ring */
             Waiting w(waiting_);
+
+            if ((ret = peek_locked())) break;
+
             if (gu_likely (timeout == GU_TIME_ETERNITY))
             {
                 lock.wait(cond_);
@@ -117,25 +146,105 @@ public:
             {
                 lock.wait(cond_, timeout);
             }
+
+            if (signal_time_ > 0)
+            {
+                wakeup_time_ += gu_time_monotonic() - signal_time_;
+                ++wakeups_;
+                signal_time_ = 0;
+            }
         }
-        assert (false == waiting_);
 
-        return queue_.front();
+        return *ret;
     }
 
     void pop_front()
     {
-        Lock lock(mutex_);
-        assert(queue_.empty() == false);
-        queue_.pop_front();
+        if (from_overflow_)
+        {
+            Lock lock(mutex_);
+            assert(overflow_.empty() == false);
+            overflow_.pop_front();
+            --overflow_len_;
+        }
+        else
+        {
+            ring_.pop();
+        }
+    }
+
+    void get_status(gu::Status& status) const
+    {
+        long long const wakeups(wakeups_());
+
+        status.insert("gcomm_recv_buf_len",
+                      gu::to_string(ring_.size() + overflow_len_()));
+        status.insert("gcomm_recv_buf_len_max", gu::to_string(len_max_()));
+        status.insert("gcomm_recv_buf_overflows", gu::to_string(overflows_()));
+        status.insert("gcomm_recv_buf_wakeups", gu::to_string(wakeups));
+        status.insert("gcomm_recv_buf_wakeup_latency",
+                      gu::to_string(wakeups > 0 ?
+                                    double(wakeup_time_())/wakeups/gu::datetime::Sec
+                                    : 0.));
     }
 
 private:
 
-    Mutex mutex_;
-    Cond cond_;
-    RecvBufQueue queue_;
-    bool waiting_;
+    class Waiting
+    {
+    public:
+        Waiting (gu::Atomic<int>& w) : w_(w) { w_ = 1; }
+        ~Waiting()                           { w_ = 0; }
+    private:
+        gu::Atomic<int>& w_;
+    };
+
+    static size_t const RING_SIZE = 1024;
+    static int    const SPINS_MIN = 16;
+    static int    const SPINS_MAX = 4096;
+
+    /* messages in the ring are always older than in the overflow queue */
+    const RecvBufData* peek()
+    {
+        RecvBufData* const ret(ring_.front());
+        if (ret) { from_overflow_ = false; return ret; }
+
+        if (gu_likely(overflow_len_() == 0)) return 0;
+
+        Lock lock(mutex_);
+        return peek_overflow();
+    }
+
+    const RecvBufData* peek_locked()
+    {
+        RecvBufData* const ret(ring_.front());
+        if (ret) { from_overflow_ = false; return ret; }
+
+        return peek_overflow();
+    }
+
+    const RecvBufData* peek_overflow()
+    {
+        if (overflow_.empty()) return 0;
+        from_overflow_ = true;
+        return &overflow_.front(); // deque::push_back() keeps references
+    }
+
+    gu::MPSCQueue<RecvBufData> ring_;
+    Mutex                      mutex_;
+    Cond                       cond_;
+    RecvBufQueue               overflow_;
+    gu::Atomic<long>           overflow_len_;
+    gu::Atomic<int>            waiting_;
+    long long                  signal_time_; // protected by mutex_
+    bool                       from_overflow_;
+    int                        spins_;
+
+    /* stats */
+    gu::Atomic<long>           len_max_;
+    gu::Atomic<long long>      overflows_;
+    gu::Atomic<long long>      wakeups_;
+    gu::Atomic<long long>      wakeup_time_;
 };
 
 class GCommConn : public Toplay
@@ -231,6 +340,7 @@ public:
     void        get_status(gu::Status& status) const
     {
         if (tp_ != 0) tp_->get_status(status);
+        recv_buf_.get_status(status);
     }
 
     gu::ThreadSchedparam schedparam() const { return schedparam_; }
@@ -498,7 +608,10 @@ static GCS_BACKEND_MSG_SIZE_FN(gcomm_msg_size)
 }
 
 
-static GCS_BACKEND_SEND_FN(gcomm_send)
+static long gcomm_send_dg(gcs_backend_t* const backend,
+                          Datagram&            dg,
+                          size_t         const len,
+                          gcs_msg_type_t const msg_type)
 {
     GCommConn::Ref ref(backend);
 
@@ -509,11 +622,6 @@ static GCS_BACKEND_SEND_FN(gcomm_send)
 
     GCommConn& conn(*ref.get());
 
-    Datagram dg(
-        SharedBuffer(
-            new Buffer(reinterpret_cast<const byte_t*>(buf),
-                       reinterpret_cast<const byte_t*>(buf) + len)));
-
     int err;
     // Set thread scheduling params if gcomm thread runs with
     // non-default params
@@ -562,6 +670,35 @@ static GCS_BACKEND_SEND_FN(gcomm_send)
     return (err == 0 ? len : -err);
 }
 
+static GCS_BACKEND_SEND_FN(gcomm_send)
+{
+    Datagram dg(
+        SharedBuffer(
+            new Buffer(reinterpret_cast<const byte_t*>(buf),
+                       reinterpret_cast<const byte_t*>(buf) + len)));
+
+    return gcomm_send_dg(backend, dg, len, msg_type);
+}
+
+/* Gathers message directly into datagram buffer, so that action fragments
+ * don't need to be copied into intermediate send buffer first */
+static GCS_BACKEND_SENDV_FN(gcomm_sendv)
+{
+    Buffer* const buf(new Buffer());
+    SharedBuffer  sb(buf);
+
+    buf->reserve(len);
+    for (int i(0); i < bufs_num; ++i)
+    {
+        const byte_t* const ptr(static_cast<const byte_t*>(bufs[i].ptr));
+        buf->insert(buf->end(), ptr, ptr + bufs[i].size);
+    }
+    assert(buf->size() == len);
+
+    Datagram dg(sb);
+    return gcomm_send_dg(backend, dg, len, msg_type);
+}
+
 
 static void fill_cmp_msg(const View& view, const gcomm::UUID& my_uuid,
                          gcs_comp_msg_t* cm)
@@ -919,6 +1056,7 @@ GCS_BACKEND_CREATE_FN(gcs_gcomm_create)
     backend->close     = gcomm_close;
     backend->destroy   = gcomm_destroy;
     backend->send      = gcomm_send;
+    backend->sendv     = gcomm_sendv;
     backend->recv      = gcomm_recv;
     backend->name      = gcomm_name;
     backend->msg_size  = gcomm_msg_size;
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010-2017 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -20,6 +20,8 @@ const char* const GCS_PARAMS_MAX_PKT_SIZE      = "gcs.max_packet_size";
 const char* const GCS_PARAMS_RECV_Q_HARD_LIMIT = "gcs.recv_q_hard_limit";
 const char* const GCS_PARAMS_RECV_Q_SOFT_LIMIT = "gcs.recv_q_soft_limit";
 const char* const GCS_PARAMS_MAX_THROTTLE      = "gcs.max_throttle";
+const char* const GCS_PARAMS_SEND_BATCH        = "gcs.send_batch";
+const char* const GCS_PARAMS_ADAPTIVE_FRAGS    = "gcs.adaptive_fragments";
 #ifdef GCS_SM_DEBUG
 const char* const GCS_PARAMS_SM_DUMP           = "gcs.sm_dump";
 #endif /* GCS_SM_DEBUG */
@@ -33,6 +35,8 @@ static const char* const GCS_PARAMS_MAX_PKT_SIZE_DEFAULT      = "64500";
 static ssize_t const GCS_PARAMS_RECV_Q_HARD_LIMIT_DEFAULT     = SSIZE_MAX;
 static const char* const GCS_PARAMS_RECV_Q_SOFT_LIMIT_DEFAULT = "0.25";
 static const char* const GCS_PARAMS_MAX_THROTTLE_DEFAULT      = "0.25";
+static const char* const GCS_PARAMS_SEND_BATCH_DEFAULT        = "0";
+static const char* const GCS_PARAMS_ADAPTIVE_FRAGS_DEFAULT    = "no";
 
 bool
 gcs_params_register(gu_config_t* conf)
@@ -61,6 +65,10 @@ gcs_params_register(gu_config_t* conf)
                           GCS_PARAMS_RECV_Q_SOFT_LIMIT_DEFAULT);
     ret |= gu_config_add (conf, GCS_PARAMS_MAX_THROTTLE,
                           GCS_PARAMS_MAX_THROTTLE_DEFAULT);
+    ret |= gu_config_add (conf, GCS_PARAMS_SEND_BATCH,
+                          GCS_PARAMS_SEND_BATCH_DEFAULT);
+    ret |= gu_config_add (conf, GCS_PARAMS_ADAPTIVE_FRAGS,
+                          GCS_PARAMS_ADAPTIVE_FRAGS_DEFAULT);
 #ifdef GCS_SM_DEBUG
     ret |= gu_config_add (conf, GCS_PARAMS_SM_DUMP, "0");
 #endif /* GCS_SM_DEBUG */
@@ -192,6 +200,9 @@ gcs_params_init (struct gcs_params* params, gu_config_t* config)
     if ((ret = params_init_long (config, GCS_PARAMS_MAX_PKT_SIZE, 0,LONG_MAX,
                                  &params->max_packet_size))) return ret;
 
+    if ((ret = params_init_long (config, GCS_PARAMS_SEND_BATCH, 0, LONG_MAX,
+                                 &params->send_batch))) return ret;
+
     if ((ret = params_init_double (config, GCS_PARAMS_FC_FACTOR, 0.0, 1.0,
                                    &params->fc_resume_factor))) return ret;
 
@@ -214,5 +225,8 @@ gcs_params_init (struct gcs_params* params, gu_config_t* config)
 
     if ((ret = params_init_bool (config, GCS_PARAMS_SYNC_DONOR,
                                  &params->sync_donor))) return ret;
+
+    if ((ret = params_init_bool (config, GCS_PARAMS_ADAPTIVE_FRAGS,
+                                 &params->adaptive_frags))) return ret;
     return 0;
 }
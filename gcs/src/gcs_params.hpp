@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010-2014 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -16,9 +16,11 @@ struct gcs_params
     ssize_t recv_q_hard_limit;
     long    fc_base_limit;
     long    max_packet_size;
+    long    send_batch;
     long    fc_debug;
     bool    fc_master_slave;
     bool    sync_donor;
+    bool    adaptive_frags;
 };
 
 extern const char* const GCS_PARAMS_FC_FACTOR;
@@ -30,6 +32,8 @@ extern const char* const GCS_PARAMS_MAX_PKT_SIZE;
 extern const char* const GCS_PARAMS_RECV_Q_HARD_LIMIT;
 extern const char* const GCS_PARAMS_RECV_Q_SOFT_LIMIT;
 extern const char* const GCS_PARAMS_MAX_THROTTLE;
+extern const char* const GCS_PARAMS_SEND_BATCH;
+extern const char* const GCS_PARAMS_ADAPTIVE_FRAGS;
 #ifdef GCS_SM_DEBUG
 extern const char* const GCS_PARAMS_SM_DUMP;
 #endif /* GCS_SM_DEBUG */
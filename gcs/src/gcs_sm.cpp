@@ -98,7 +98,7 @@ gcs_sm_close (gcs_sm_t* sm)
     while (sm->users > 0) { // wait for cleared queue
         sm->users++;
         GCS_SM_INCREMENT(sm->wait_q_tail);
-        _gcs_sm_enqueue_common (sm, &cond, true, sm->wait_q_tail);
+        _gcs_sm_enqueue_common (sm, &cond, true, sm->wait_q_tail, NULL);
         sm->users--;
         GCS_SM_INCREMENT(sm->wait_q_head);
     }
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2010-2013 Codership Oy <info@codership.com>
+ * Copyright (C) 2010-2020 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -24,6 +24,7 @@
 typedef struct gcs_sm_user
 {
     gu_cond_t* cond;
+    void*      ctx;  // waiter context for gcs_sm_take_next()
     bool       wait;
 }
 gcs_sm_user_t;
@@ -208,11 +209,22 @@ _gcs_sm_leave_common (gcs_sm_t* sm)
 
 //#define GCS_SM_SIMULATE_TIMEOUTS
 
+/* waiter status after wake up: -EALREADY if taken over by gcs_sm_take_next()
+ * (which clears ctx), -EINTR if interrupted */
+static inline int
+_gcs_sm_woken_status (gcs_sm_t* sm, unsigned long tail, void* ctx)
+{
+    if (gu_likely(sm->wait_q[tail].wait)) return 0;
+
+    return (ctx != NULL && NULL == sm->wait_q[tail].ctx) ? -EALREADY : -EINTR;
+}
+
 static inline int
 _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
-                        unsigned long tail)
+                        unsigned long tail, void* ctx)
 {
     sm->wait_q[tail].cond = cond;
+    sm->wait_q[tail].ctx  = ctx;
     sm->wait_q[tail].wait = true;
     int ret;
 
@@ -222,7 +234,7 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
         gu_cond_wait (cond, &sm->lock);
         assert(tail == sm->wait_q_head || false == sm->wait_q[tail].wait);
         assert(sm->wait_q[tail].cond == cond || false == sm->wait_q[tail].wait);
-        ret = sm->wait_q[tail].wait ? 0 : -EINTR;
+        ret = _gcs_sm_woken_status(sm, tail, ctx);
     }
     else
     {
@@ -237,7 +249,7 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
         ret = -gu_cond_timedwait(cond, &sm->lock, &ts);
         if (0 == ret)
         {
-            ret = sm->wait_q[tail].wait ? 0 : -EINTR;
+            ret = _gcs_sm_woken_status(sm, tail, ctx);
             // sm->wait_time is incremented by second each time cond wait
             // times out, reset back to one second when cond wait succeeds.
             sm->wait_time = std::max(sm->wait_time*2/3,
@@ -270,6 +282,7 @@ _gcs_sm_enqueue_common (gcs_sm_t* sm, gu_cond_t* cond, bool block,
     }
 
     sm->wait_q[tail].cond = NULL;
+    sm->wait_q[tail].ctx  = NULL;
     sm->wait_q[tail].wait = false;
 
     if (gu_unlikely(0 != ret)) GCS_SM_HIST_LOG("%ld wait failed: %d", tail, ret);
@@ -340,15 +353,19 @@ gcs_sm_schedule (gcs_sm_t* sm)
  * @param cond condition to signal to wake up thread in case of wait
  * @param block if true block until entered or send monitor is closed,
  *              if false enter wait times out eventually
+ * @param ctx  if not NULL, the user may be taken over by gcs_sm_take_next()
+ *             while waiting
  *
  * @retval -EAGAIN - out of space
  * @retval -EBADFD - monitor closed
  * @retval -EINTR  - was interrupted by another thread
+ * @retval -EALREADY - was taken over by another thread, see gcs_sm_take_next()
  * @retval -ETIMEDOUT - timedout waiting for its turn
  * @retval 0 - successfully entered
  */
 static inline long
-gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
+gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block,
+              void* ctx = NULL)
 {
     long ret = 0; /* if scheduled and no queue */
 
@@ -360,7 +377,7 @@ gcs_sm_enter (gcs_sm_t* sm, gu_cond_t* cond, bool scheduled, bool block)
            was true) */
         bool wait = GCS_SM_HAS_TO_WAIT;
         while (wait && ret >= 0) {
-            ret = _gcs_sm_enqueue_common (sm, cond, block, tail);
+            ret = _gcs_sm_enqueue_common (sm, cond, block, tail, ctx);
             if (gu_likely((0 == ret))) {
                 ret = sm->ret;
                 /* weaken the condition, so that we do enter if there
@@ -497,6 +514,56 @@ gcs_sm_interrupt (gcs_sm_t* sm, long handle)
     return ret;
 }
 
+/*!
+ * Takes over the next waiter in the queue, so that the user who is in the
+ * monitor can do waiter's work on its behalf without passing the monitor to
+ * it. Taken over waiter returns from gcs_sm_enter() with -EALREADY and must
+ * not call gcs_sm_leave(), its place in the queue is released as if it was
+ * interrupted. Must be called only by the user who has entered the monitor.
+ *
+ * @return context passed by the waiter to gcs_sm_enter() or NULL if the next
+ *         waiter did not pass a context or there is no waiter, or the monitor
+ *         is paused or closed
+ */
+static inline void*
+gcs_sm_take_next (gcs_sm_t* sm)
+{
+    void* ret = NULL;
+
+    if (gu_unlikely(gu_mutex_lock (&sm->lock))) abort();
+
+    GCS_SM_ASSERT(sm->entered > 0);
+
+    if (gu_likely(0 == sm->ret && !sm->pause)) {
+        unsigned long handle = sm->wait_q_head;
+        long          i;
+
+        /* the caller is at the head of the queue, skip it and the waiters
+         * which were already interrupted or taken over */
+        for (i = 1; i < sm->users; i++) {
+            GCS_SM_INCREMENT(handle);
+
+            gcs_sm_user_t* const user(&sm->wait_q[handle]);
+
+            if (user->wait) {
+                if (user->ctx) {
+                    ret = user->ctx;
+                    user->ctx  = NULL;
+                    user->wait = false;
+                    gu_cond_signal (user->cond);
+                    user->cond = NULL;
+                    GCS_SM_HIST_LOG("took over %lu", handle);
+                }
+                break;
+            }
+        }
+    }
+
+    gu_mutex_unlock (&sm->lock);
+
+    return ret;
+}
+
 /*!
  * Each call to this function resets stats and starts new sampling interval
  *
@@ -433,13 +433,18 @@ core_test_cleanup ()
 }
 
 // just a smoke test for core API
-START_TEST (gcs_core_test_api)
+// gather: let backend gather action fragments from action buffers itself
+static void
+core_test_api (bool const gather)
 {
     gu::Config config;
     core_test_init (&config);
     ck_assert(NULL != Core);
     ck_assert(NULL != Backend);
 
+    ck_assert(NULL != Backend->sendv);
+    if (!gather) Backend->sendv = NULL;
+
     long     ret;
     long     tout = 100; // 100 ms timeout
     const struct gu_buf* act = act3;
@@ -487,6 +492,17 @@ START_TEST (gcs_core_test_api)
 
     core_test_cleanup ();
 }
+
+START_TEST (gcs_core_test_api)
+{
+    core_test_api (true);
+}
+END_TEST
+
+START_TEST (gcs_core_test_api_copy)
+{
+    core_test_api (false);
+}
 END_TEST
 
 // do a single send step, compare with the expected result
@@ -970,6 +986,7 @@ Suite *gcs_core_suite(void)
 
   if (skip == false) {
       tcase_add_test  (tcase, gcs_core_test_api);
+      tcase_add_test  (tcase, gcs_core_test_api_copy);
       tcase_add_test  (tcase, gcs_core_test_own);
 #ifdef GCS_ALLOW_GH74
       tcase_add_test  (tcase, gcs_core_test_gh74);
@@ -0,0 +1,157 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#include "gcs_frag_test.hpp"
+#include "../gcs_frag.hpp"
+
+#include <unistd.h>
+
+static std::string
+frag_status (gcs_frag_t* frag, const char* key)
+{
+    gu::Status status;
+    gcs_frag_get_status (frag, status);
+
+    for (gu::Status::const_iterator i(status.begin()); i != status.end(); ++i)
+    {
+        if (i->first == key) return i->second;
+    }
+
+    return "";
+}
+
+START_TEST(gcs_frag_test_stats)
+{
+    gcs_frag_t frag;
+    gcs_frag_init (&frag, false);
+
+    long const size(gcs_frag_size (&frag, 65536));
+    ck_assert(size == 65536);
+
+    gcs_frag_send (&frag, 1, 0, 100, 100);
+    gcs_frag_recv (&frag, 1, 0);
+
+    for (unsigned long i(0); i < 4; ++i)
+    {
+        gcs_frag_send (&frag, 2, i, size, 200000);
+    }
+    gcs_frag_recv (&frag, 2, 3);
+
+    ck_assert(frag_status(&frag, "gcs_frag_classes") ==
+              "1K:1/1,64K:0/0,1M:1/4,inf:0/0");
+    ck_assert(frag_status(&frag, "gcs_frag_size") == "65536");
+
+    gcs_frag_stats_flush (&frag);
+    ck_assert(frag_status(&frag, "gcs_frag_classes") ==
+              "1K:0/0,64K:0/0,1M:0/0,inf:0/0");
+
+    gcs_frag_destroy (&frag);
+}
+END_TEST
+
+/* sends a fragment of a given length and delivers it after delay (usec) */
+static void
+frag_sample (gcs_frag_t* frag, gcs_seqno_t& act_id, long len, long delay)
+{
+    gcs_frag_send (frag, act_id, 0, len, len);
+    if (delay > 0) usleep (delay);
+    gcs_frag_recv (frag, act_id, 0);
+    act_id++;
+}
+
+START_TEST(gcs_frag_test_adjust)
+{
+    gcs_frag_t  frag;
+    gcs_seqno_t act_id(1);
+    long const  max_size(65536);
+
+    gcs_frag_init (&frag, true);
+    ck_assert(gcs_frag_size(&frag, max_size) == max_size);
+
+    for (int i(0); i < 4; ++i) frag_sample (&frag, act_id, 100, 2000);
+
+    /* full fragments take much longer than small messages: shrink */
+    for (int i(0); i < 4; ++i)
+    {
+        ck_assert(gcs_frag_size(&frag, max_size) == max_size);
+        frag_sample (&frag, act_id, max_size, 10000);
+    }
+
+    long const size(gcs_frag_size(&frag, max_size));
+    ck_assert_msg(size == max_size - max_size/4, "size: %ld", size);
+
+    /* fragment not timed while another one is in flight */
+    gcs_frag_send (&frag, act_id, 0, 100, size + 100);
+    gcs_frag_send (&frag, act_id, 1, size, size + 100);
+    gcs_frag_recv (&frag, act_id, 0);
+    gcs_frag_recv (&frag, act_id, 1);
+    act_id++;
+    ck_assert(0 == frag.full_num);
+
+    /* full fragments are as fast as small messages: grow */
+    for (int i(0); i < 4; ++i) frag_sample (&frag, act_id, size, 0);
+
+    ck_assert(gcs_frag_size(&frag, max_size) == size + size/8);
+
+    /* disabling adaptation restores maximum size */
+    gcs_frag_set_adaptive (&frag, false);
+    ck_assert(gcs_frag_size(&frag, max_size) == max_size);
+
+    gcs_frag_destroy (&frag);
+}
+END_TEST
+
+START_TEST(gcs_frag_test_reset)
+{
+    gcs_frag_t  frag;
+    gcs_seqno_t act_id(1);
+    long const  max_size(65536);
+
+    gcs_frag_init (&frag, true);
+    ck_assert(gcs_frag_size(&frag, max_size) == max_size);
+
+    frag_sample (&frag, act_id, 100, 0);
+    ck_assert(1 == frag.small_num);
+
+    /* last fragment of the action is lost, e.g. in configuration change */
+    gcs_frag_send (&frag, act_id, 0, max_size, 2*max_size);
+    gcs_frag_send (&frag, act_id, 1, max_size, 2*max_size);
+    gcs_frag_recv (&frag, act_id, 0);
+    act_id++;
+
+    /* lost fragment still looks in flight, nothing is sampled */
+    frag_sample (&frag, act_id, 100, 0);
+    ck_assert(1 == frag.small_num);
+
+    gcs_frag_reset (&frag);
+
+    frag_sample (&frag, act_id, 100, 0);
+    ck_assert(2 == frag.small_num);
+
+    /* failed send of the second fragment after the first one was sent */
+    gcs_frag_send (&frag, act_id, 0, max_size, 2*max_size);
+    gcs_frag_send (&frag, act_id, 1, max_size, 2*max_size);
+    gcs_frag_reset (&frag);
+    act_id++;
+
+    /* first fragment is still delivered */
+    gcs_frag_recv (&frag, act_id - 1, 0);
+
+    frag_sample (&frag, act_id, 100, 0);
+    ck_assert(3 == frag.small_num);
+
+    gcs_frag_destroy (&frag);
+}
+END_TEST
+
+Suite *gcs_frag_suite(void)
+{
+    Suite *s  = suite_create("GCS fragment size");
+    TCase *tc = tcase_create("gcs_frag");
+
+    suite_add_tcase (s, tc);
+    tcase_add_test  (tc, gcs_frag_test_stats);
+    tcase_add_test  (tc, gcs_frag_test_adjust);
+    tcase_add_test  (tc, gcs_frag_test_reset);
+
+    return s;
+}
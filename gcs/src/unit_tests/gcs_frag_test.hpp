@@ -0,0 +1,10 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#ifndef __gcs_frag_test__
+#define __gcs_frag_test__
+
+#include <check.h>
+
+Suite *gcs_frag_suite(void);
+
+#endif /* __gcs_frag_test__ */
@@ -0,0 +1,124 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#include "../gcs.hpp"
+
+#include <galerautils.h>
+#include "gu_config.hpp"
+
+#include "gcs_recv_test.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* waits until the receive queue has len actions and STOP is sent */
+static void
+recv_q_wait_stop (gcs_conn_t* conn, int len)
+{
+    struct gcs_stats stats;
+
+    for (int i(0); i < 1000; ++i)
+    {
+        gcs_get_stats (conn, &stats);
+        if (stats.recv_q_len >= len && stats.fc_ssent > 0) break;
+        usleep (1000);
+    }
+
+    ck_assert_msg(stats.recv_q_len == len, "recv_q_len: %d, expected: %d",
+                  stats.recv_q_len, len);
+    ck_assert_msg(1 == stats.fc_ssent, "fc_ssent: %lld", stats.fc_ssent);
+}
+
+static void
+recv_release (struct gcs_action* acts, long n)
+{
+    for (long i(0); i < n; ++i) free (const_cast<void*>(acts[i].buf));
+}
+
+/* gcs_close() returns when receive queue is drained */
+static void*
+recv_close_thread (void* conn)
+{
+    long const ret(gcs_close (static_cast<gcs_conn_t*>(conn)));
+    return reinterpret_cast<void*>(ret);
+}
+
+START_TEST(gcs_recv_test_batch_fc)
+{
+    gu::Config config;
+    gcs_register_params (reinterpret_cast<gu_config_t*>(&config));
+    config.set ("gcs.fc_limit", "8");      // upper limit 8, lower limit 4
+    config.set ("gcs.fc_factor", "0.5");
+
+    gcs_conn_t* const conn(gcs_create (reinterpret_cast<gu_config_t*>(&config),
+                                       NULL, "recv_test", NULL, 0, 0));
+    ck_assert(NULL != conn);
+
+    long ret(gcs_open (conn, "recv_test", "dummy://", true));
+    ck_assert_msg(0 == ret, "gcs_open(): %ld (%s)", ret, strerror(-ret));
+
+    struct gcs_action acts[64];
+
+    ret = gcs_recv_batch (conn, acts, 64);
+    ck_assert_msg(1 == ret, "gcs_recv_batch(): %ld (%s)", ret, strerror(-ret));
+    ck_assert(GCS_ACT_CONF == acts[0].type);
+    recv_release (acts, ret);
+    ck_assert(0 == gcs_resume_recv (conn));
+
+    /* SYNC action sent on receiving configuration and 8 more actions exceed
+     * the upper limit and make the node send STOP */
+    char const buf[] = "action";
+    struct gu_buf const act = { buf, sizeof(buf) };
+    for (int i(0); i < 8; ++i)
+    {
+        ret = gcs_sendv (conn, &act, act.size, GCS_ACT_TORDERED, false);
+        ck_assert_msg(act.size == ret, "gcs_sendv(): %ld (%s)",
+                      ret, strerror(-ret));
+    }
+    recv_q_wait_stop (conn, 9);
+
+    /* actions below the lower limit stay in the queue for CONT to be sent
+     * only when the batch is applied */
+    ret = gcs_recv_batch (conn, acts, 64);
+    ck_assert_msg(5 == ret, "gcs_recv_batch(): %ld (%s)", ret, strerror(-ret));
+    ck_assert(GCS_ACT_SYNC == acts[0].type);
+    recv_release (acts, ret);
+
+    struct gcs_stats stats;
+    gcs_get_stats (conn, &stats);
+    ck_assert_msg(1 == stats.fc_csent, "fc_csent: %lld", stats.fc_csent);
+    ck_assert(4 == stats.recv_q_len);
+
+    /* no flow control messages pending, the rest is taken at once */
+    ret = gcs_recv_batch (conn, acts, 64);
+    ck_assert_msg(4 == ret, "gcs_recv_batch(): %ld (%s)", ret, strerror(-ret));
+    recv_release (acts, ret);
+
+    gu_thread_t close_thread;
+    ck_assert(0 == gu_thread_create (&close_thread, NULL, recv_close_thread,
+                                     conn));
+    do
+    {
+        ret = gcs_recv_batch (conn, acts, 64);
+        if (ret > 0) recv_release (acts, ret);
+    }
+    while (ret > 0);
+
+    void* close_ret;
+    gu_thread_join (close_thread, &close_ret);
+    ck_assert(NULL == close_ret);
+
+    ck_assert(0 == gcs_destroy (conn));
+}
+END_TEST
+
+Suite *gcs_recv_suite(void)
+{
+    Suite *s  = suite_create("GCS receive");
+    TCase *tc = tcase_create("gcs_recv");
+
+    suite_add_tcase (s, tc);
+    tcase_add_test  (tc, gcs_recv_test_batch_fc);
+
+    return s;
+}
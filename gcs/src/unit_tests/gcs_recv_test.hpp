@@ -0,0 +1,10 @@
+// Copyright (C) 2020 Codership Oy <info@codership.com>
+
+#ifndef __gcs_recv_test__
+#define __gcs_recv_test__
+
+#include <check.h>
+
+Suite *gcs_recv_suite(void);
+
+#endif /* __gcs_recv_test__ */
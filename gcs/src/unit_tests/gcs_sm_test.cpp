@@ -529,6 +529,95 @@ START_TEST (gcs_sm_test_interrupt)
 }
 END_TEST
 
+static int take_ctx;
+
+static void* take_thread(void* arg)
+{
+    gcs_sm_t* sm = (gcs_sm_t*) arg;
+
+    global_handle = gcs_sm_schedule (sm);
+
+    if (global_handle >= 0) {
+        pthread_cond_t cond;
+        pthread_cond_init (&cond, NULL);
+
+        if (0 == (global_ret = gcs_sm_enter (sm, &cond, true, true,
+                                             &take_ctx))) {
+            gcs_sm_leave (sm);
+        }
+        pthread_cond_destroy (&cond);
+    }
+
+    return NULL;
+}
+
+START_TEST (gcs_sm_test_take_next)
+{
+    gcs_sm_t* sm = gcs_sm_create(8, 1);
+    ck_assert(sm != NULL);
+
+    gu_cond_t cond;
+    gu_cond_init (&cond, NULL);
+
+    gu_thread_t thr1;
+    gu_thread_t thr2;
+
+    long ret = gcs_sm_enter (sm, &cond, false, true);
+    ck_assert(ret == 0);
+
+    ck_assert(NULL == gcs_sm_take_next (sm)); // nobody is waiting
+
+    /* 1. waiter with context is taken over */
+    global_handle = -1;
+    gu_thread_create (&thr1, NULL, take_thread, sm);
+    WAIT_FOR(global_handle == 3);
+    ck_assert_msg(global_handle == 3, "global_handle = %ld, expected 3",
+                  global_handle);
+
+    void* const ctx = gcs_sm_take_next (sm);
+    ck_assert_msg(ctx == &take_ctx, "ctx = %p, expected %p", ctx, &take_ctx);
+    gu_thread_join (thr1, NULL);
+    ck_assert_msg(global_ret == -EALREADY, "global_ret = %ld, "
+                  "expected %d (-EALREADY)", global_ret, -EALREADY);
+
+    ret = gcs_sm_interrupt (sm, 3); // taken over can't be interrupted
+    ck_assert(ret == -ESRCH);
+
+    /* 2. waiter without context is skipped */
+    TEST_CREATE_THREAD(&thr2, 3, 4, 3);
+    ck_assert(NULL == gcs_sm_take_next (sm));
+
+    gcs_sm_leave (sm); // should let 2nd enter monitor skipping the 1st
+    gu_thread_join (thr2, NULL);
+    ck_assert_msg(global_ret == 0, "global_ret = %ld, expected 0", global_ret);
+    ck_assert_msg(sm->users  == 0, "users = %ld, expected 0", sm->users);
+
+    /* 3. no taking over in paused monitor */
+    ret = gcs_sm_enter (sm, &cond, false, true);
+    ck_assert(ret == 0);
+
+    global_handle = -1;
+    gu_thread_create (&thr1, NULL, take_thread, sm);
+    WAIT_FOR(global_handle == 6);
+    ck_assert_msg(global_handle == 6, "global_handle = %ld, expected 6",
+                  global_handle);
+
+    gcs_sm_pause (sm);
+    ck_assert(NULL == gcs_sm_take_next (sm));
+    gcs_sm_continue (sm);
+
+    ck_assert(&take_ctx == gcs_sm_take_next (sm));
+    gu_thread_join (thr1, NULL);
+    ck_assert(global_ret == -EALREADY);
+
+    gcs_sm_leave (sm);
+    ck_assert_msg(sm->users == 0, "users = %ld, expected 0", sm->users);
+
+    gu_cond_destroy (&cond);
+    gcs_sm_close (sm);
+    gcs_sm_destroy (sm);
+}
+END_TEST
 
 Suite *gcs_send_monitor_suite(void)
 {
@@ -541,6 +630,7 @@ Suite *gcs_send_monitor_suite(void)
   tcase_add_test  (tc, gcs_sm_test_close);
   tcase_add_test  (tc, gcs_sm_test_pause);
   tcase_add_test  (tc, gcs_sm_test_interrupt);
+  tcase_add_test  (tc, gcs_sm_test_take_next);
   return s;
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (C) 2008-2017 Codership Oy <info@codership.com>
+ * Copyright (C) 2008-2020 Codership Oy <info@codership.com>
  *
  * $Id$
  */
@@ -22,6 +22,8 @@
 #include "gcs_backend_test.hpp"
 #include "gcs_core_test.hpp"
 #include "gcs_fc_test.hpp"
+#include "gcs_frag_test.hpp"
+#include "gcs_recv_test.hpp"
 
 typedef Suite *(*suite_creator_t)(void);
 
@@ -39,6 +41,8 @@ static suite_creator_t suites[] =
 	gcs_backend_suite,
 	gcs_core_suite,
 	gcs_fc_suite,
+	gcs_frag_suite,
+	gcs_recv_suite,
 	NULL
     };
 